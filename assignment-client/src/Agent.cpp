@@ -394,7 +394,9 @@ void Agent::executeScript() {
 
     using namespace recording;
     static const FrameType AVATAR_FRAME_TYPE = Frame::registerFrameType(AvatarData::FRAME_NAME);
-    Frame::registerFrameHandler(AVATAR_FRAME_TYPE, [this, scriptedAvatar](Frame::ConstPointer frame) {
+    Frame::registerKeyFrameTest(AVATAR_FRAME_TYPE, &AvatarData::isKeyFrame);
+    auto avatarFrameDecoder = std::make_shared<AvatarFrameDecoder>();
+    Frame::registerFrameHandler(AVATAR_FRAME_TYPE, [this, scriptedAvatar, avatarFrameDecoder](Frame::ConstPointer frame) {
 
         auto recordingInterface = DependencyManager::get<RecordingScriptingInterface>();
         bool useFrameSkeleton = recordingInterface->getPlayerUseSkeletonModel();
@@ -407,7 +409,7 @@ void Agent::executeScript() {
             });
         }
 
-        AvatarData::fromFrame(frame->data, *scriptedAvatar);
+        AvatarData::fromFrame(frame->data, *scriptedAvatar, *avatarFrameDecoder);
     });
 
     using namespace recording;
@@ -467,6 +469,12 @@ void Agent::executeScript() {
     // register ourselves to the script engine
     _scriptEngine->registerGlobalObject("Agent", this);
 
+    // load-test scripts in the bot farm pool can host many recorded avatars from this one Agent
+    if (getPool() == BotFarm::ASSIGNMENT_POOL) {
+        _botFarm = new BotFarm();
+        _scriptEngine->registerGlobalObject("BotFarm", _botFarm);
+    }
+
     _scriptEngine->registerGlobalObject("SoundCache", DependencyManager::get<SoundCache>().data());
     _scriptEngine->registerGlobalObject("AnimationCache", DependencyManager::get<AnimationCache>().data());
 
@@ -516,6 +524,14 @@ void Agent::executeScript() {
     setFinished(true);
 }
 
+void Agent::sendStatsPacket() {
+    QJsonObject statsObject;
+    if (_botFarm && _botFarm->getBotCount() > 0) {
+        statsObject["bot_farm"] = _botFarm->getStatsJson();
+    }
+    addPacketStatsAndSendStatsPacket(statsObject);
+}
+
 QUuid Agent::getSessionUUID() const {
     return DependencyManager::get<NodeList>()->getSessionUUID();
 }
@@ -810,6 +826,12 @@ void Agent::aboutToFinish() {
         _scriptEngine->stop();
     }
 
+    if (_botFarm) {
+        // the farm lives on its own thread once it hosts bots, so it has to remove them and delete itself there
+        QMetaObject::invokeMethod(_botFarm, "stop");
+        _botFarm = nullptr;
+    }
+
     // our entity tree is going to go away so tell that to the EntityScriptingInterface
     DependencyManager::get<EntityScriptingInterface>()->setEntityTree(nullptr);
 
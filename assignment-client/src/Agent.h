@@ -32,6 +32,7 @@
 #include "MixedAudioStream.h"
 #include "entities/EntityTreeHeadlessViewer.h"
 #include "avatars/ScriptableAvatar.h"
+#include "bots/BotFarm.h"
 
 class Agent : public ThreadedAssignment {
     Q_OBJECT
@@ -61,6 +62,7 @@ public:
 
 public slots:
     void run() override;
+    void sendStatsPacket() override;
     void playAvatarSound(SharedSoundPointer avatarSound);
     
     void setIsAvatar(bool isAvatar);
@@ -118,6 +120,8 @@ private:
     Encoder* _encoder { nullptr };
     QTimer _avatarAudioTimer;
     bool _flushEncoder { false };
+
+    BotFarm* _botFarm { nullptr };
 };
 
 #endif // hifi_Agent_h
@@ -0,0 +1,75 @@
+//
+//  AmbientSound.cpp
+//  assignment-client/src/audio
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AmbientSound.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtCore/QDebug>
+
+#include <DependencyManager.h>
+#include <SoundCache.h>
+
+AmbientSound::AmbientSound(const QUrl& url, const glm::vec3& position, float volume, float radius) :
+    _url(url),
+    _id(QUuid::createUuid()),
+    _position(position),
+    _volume(volume),
+    _radius(radius)
+{
+    _sound = DependencyManager::get<SoundCache>()->getSound(url);
+}
+
+bool AmbientSound::prepareFrame() {
+    _frame = nullptr;
+
+    if (_samples.isEmpty()) {
+        if (!_sound || !_sound->isReady()) {
+            return false;
+        }
+
+        if (_sound->isAmbisonic()) {
+            qWarning() << "Ambisonic ambient sounds are not supported, ignoring" << _url;
+            _sound.reset();
+            return false;
+        }
+
+        // take a reference to the decoded buffer, so it outlives any reload of the resource
+        _samples = _sound->getByteArray();
+        _isStereo = _sound->isStereo();
+    }
+
+    const int channels = _isStereo ? AudioConstants::STEREO : AudioConstants::MONO;
+    const int frameSamples = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL * channels;
+    const int16_t* samples = reinterpret_cast<const int16_t*>(_samples.constData());
+    int numSamples = _samples.size() / sizeof(int16_t);
+    numSamples -= numSamples % channels;
+    if (numSamples == 0) {
+        return false;
+    }
+
+    if (_playhead + frameSamples <= numSamples) {
+        // most frames are read in place
+        _frame = samples + _playhead;
+        _playhead = (_playhead + frameSamples) % numSamples;
+    } else {
+        // the frame loops around the end of the sound
+        int written = 0;
+        while (written < frameSamples) {
+            int count = std::min(frameSamples - written, numSamples - _playhead);
+            memcpy(_wrappedFrame + written, samples + _playhead, count * sizeof(int16_t));
+            written += count;
+            _playhead = (_playhead + count) % numSamples;
+        }
+        _frame = _wrappedFrame;
+    }
+    return true;
+}
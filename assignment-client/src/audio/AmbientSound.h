@@ -0,0 +1,69 @@
+//
+//  AmbientSound.h
+//  assignment-client/src/audio
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AmbientSound_h
+#define hifi_AmbientSound_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QUrl>
+#include <QtCore/QUuid>
+
+#include <glm/glm.hpp>
+
+#include <AudioConstants.h>
+#include <Sound.h>
+
+// A looping sound played by the mixer itself, from a fixed position, with no network stream behind it.  The PCM
+// comes from SoundCache and is shared by every listener (and by every ambient sound with the same URL), so all the
+// mixer keeps per sound is a playhead.
+class AmbientSound {
+public:
+    AmbientSound(const QUrl& url, const glm::vec3& position, float volume, float radius);
+
+    // identifies the sound in the listeners' HRTF maps, in place of a node ID
+    const QUuid& getID() const { return _id; }
+    const QUrl& getURL() const { return _url; }
+
+    const glm::vec3& getPosition() const { return _position; }
+    float getVolume() const { return _volume; }
+    float getRadius() const { return _radius; }
+
+    // advances the playhead by one network frame, on the mixer thread, before the slaves mix
+    // returns false if the sound can not be played (yet)
+    bool prepareFrame();
+
+    // the frame found by the last prepareFrame, for the slaves to read
+    bool hasFrame() const { return _frame != nullptr; }
+    bool isStereo() const { return _isStereo; }
+    const int16_t* getFrame() const { return _frame; }
+
+private:
+    QUrl _url;
+    QUuid _id;
+    glm::vec3 _position;
+    float _volume;
+    float _radius;
+
+    SharedSoundPointer _sound;
+    QByteArray _samples; // shares the decoded buffer of _sound
+    bool _isStereo { false };
+    int _playhead { 0 };
+
+    const int16_t* _frame { nullptr };
+    int16_t _wrappedFrame[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO]; // for frames that loop around the end
+};
+
+using AmbientSoundPointer = std::unique_ptr<AmbientSound>;
+using AmbientSounds = std::vector<AmbientSoundPointer>;
+
+#endif // hifi_AmbientSound_h
@@ -24,7 +24,10 @@
 #include <plugins/PluginManager.h>
 #include <plugins/CodecPlugin.h>
 #include <udt/PacketHeaders.h>
+#include <ResourceCache.h>
+#include <ResourceManager.h>
 #include <SharedUtil.h>
+#include <SoundCache.h>
 #include <StDev.h>
 #include <UUID.h>
 #include <CPUDetect.h>
@@ -40,6 +43,7 @@
 static const float DEFAULT_ATTENUATION_PER_DOUBLING_IN_DISTANCE = 0.5f;    // attenuation = -6dB * log2(distance)
 static const int DISABLE_STATIC_JITTER_FRAMES = -1;
 static const float DEFAULT_NOISE_MUTING_THRESHOLD = 1.0f;
+static const int DISABLE_FOA_BED = 0;
 static const QString AUDIO_MIXER_LOGGING_TARGET_NAME = "audio-mixer";
 static const QString AUDIO_ENV_GROUP_KEY = "audio_env";
 static const QString AUDIO_BUFFER_GROUP_KEY = "audio_buffer";
@@ -48,15 +52,21 @@ static const QString AUDIO_THREADING_GROUP_KEY = "audio_threading";
 int AudioMixer::_numStaticJitterFrames{ DISABLE_STATIC_JITTER_FRAMES };
 float AudioMixer::_noiseMutingThreshold{ DEFAULT_NOISE_MUTING_THRESHOLD };
 float AudioMixer::_attenuationPerDoublingInDistance{ DEFAULT_ATTENUATION_PER_DOUBLING_IN_DISTANCE };
+int AudioMixer::_maxHRTFSources{ DISABLE_FOA_BED };
 std::map<QString, std::shared_ptr<CodecPlugin>> AudioMixer::_availableCodecs{ };
 QStringList AudioMixer::_codecPreferenceOrder{};
 QHash<QString, AABox> AudioMixer::_audioZones;
 QVector<AudioMixer::ZoneSettings> AudioMixer::_zoneSettings;
 QVector<AudioMixer::ReverbSettings> AudioMixer::_zoneReverbSettings;
+AmbientSounds AudioMixer::_ambientSounds;
 
 AudioMixer::AudioMixer(ReceivedMessage& message) :
     ThreadedAssignment(message)
 {
+    // ambient sounds are loaded through the SoundCache
+    DependencyManager::set<ResourceManager>();
+    DependencyManager::set<ResourceCacheSharedItems>();
+    DependencyManager::set<SoundCache>();
 
     // Always clear settings first
     // This prevents previous assignment settings from sticking around
@@ -105,6 +115,16 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
     connect(nodeList.data(), &NodeList::nodeKilled, this, &AudioMixer::handleNodeKilled);
 }
 
+void AudioMixer::aboutToFinish() {
+    // release the sounds before their cache
+    _ambientSounds.clear();
+
+    DependencyManager::get<ResourceManager>()->cleanup();
+
+    DependencyManager::destroy<SoundCache>();
+    DependencyManager::destroy<ResourceCacheSharedItems>();
+}
+
 void AudioMixer::queueAudioPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
     if (message->getType() == PacketType::SilentAudioFrame) {
         _numSilentPackets++;
@@ -225,6 +245,7 @@ void AudioMixer::handleKillAvatarPacket(QSharedPointer<ReceivedMessage> packet,
             auto listenerClientData = dynamic_cast<AudioMixerClientData*>(node->getLinkedData());
             if (listenerClientData) {
                 listenerClientData->removeHRTFForStream(sendingNode->getUUID());
+                listenerClientData->removeFOAEncoderForStream(sendingNode->getUUID());
             }
         });
     }
@@ -240,6 +261,7 @@ void AudioMixer::removeHRTFsForFinishedInjector(const QUuid& streamID) {
             auto listenerClientData = dynamic_cast<AudioMixerClientData*>(node->getLinkedData());
             if (listenerClientData) {
                 listenerClientData->removeHRTFForStream(injectorClientData->getNodeID(), streamID);
+                listenerClientData->removeFOAEncoderForStream(injectorClientData->getNodeID(), streamID);
             }
         });
     }
@@ -290,6 +312,7 @@ void AudioMixer::sendStatsPacket() {
     addTiming(_frameTiming, "frame");
     addTiming(_prepareTiming, "prepare");
     addTiming(_mixTiming, "mix");
+    addTiming(_parseTiming, "parse");
     addTiming(_eventsTiming, "events");
     addTiming(_packetsTiming, "packets");
 
@@ -308,10 +331,19 @@ void AudioMixer::sendStatsPacket() {
     mixStats["%_hrtf_throttle_mixes"] = percentageForMixStats(_stats.hrtfThrottleRenders);
     mixStats["%_manual_stereo_mixes"] = percentageForMixStats(_stats.manualStereoMixes);
     mixStats["%_manual_echo_mixes"] = percentageForMixStats(_stats.manualEchoMixes);
+    mixStats["%_idle_stream_skips"] = percentageForMixStats(_stats.idleStreamSkips);
+    mixStats["%_foa_bed_mixes"] = percentageForMixStats(_stats.foaBedMixes);
 
     mixStats["total_mixes"] = _stats.totalMixes;
     mixStats["avg_mixes_per_block"] = _stats.totalMixes / _numStatFrames;
 
+    mixStats["ambient_sounds"] = (int)_ambientSounds.size();
+    mixStats["avg_ambient_mixes_per_block"] = _stats.ambientMixes / _numStatFrames;
+    mixStats["avg_ambient_culls_per_block"] = _stats.ambientCulls / _numStatFrames;
+
+    mixStats["max_hrtf_sources"] = _maxHRTFSources;
+    mixStats["avg_foa_bed_renders_per_block"] = _stats.foaBedRenders / _numStatFrames;
+
     statsObject["mix_stats"] = mixStats;
 
     _numStatFrames = _numSilentPackets = 0;
@@ -399,7 +431,22 @@ void AudioMixer::start() {
 
         auto frameTimer = _frameTiming.timer();
 
+        // advance the ambient sounds, the slaves then mix the same frame of each into every listener in range
+        {
+            auto prepareTimer = _prepareTiming.timer();
+            for (auto& ambientSound : _ambientSounds) {
+                ambientSound->prepareFrame();
+            }
+        }
+
         nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
+            // parse the audio received since the last frame across slave threads
+            // (this finishes before any stream is popped or mixed, so only the pop moves a stream's read position)
+            {
+                auto parseTimer = _parseTiming.timer();
+                _slavePool.processStreamPackets(cbegin, cend);
+            }
+
             // prepare frames; pop off any new audio from their streams
             {
                 auto prepareTimer = _prepareTiming.timer();
@@ -431,7 +478,7 @@ void AudioMixer::start() {
             // since we're a while loop we need to yield to qt's event processing
             QCoreApplication::processEvents();
 
-            // process (node-isolated) audio packets across slave threads
+            // process (node-isolated) control packets across slave threads
             {
                 nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
                     auto packetsTimer = _packetsTiming.timer();
@@ -527,10 +574,24 @@ void AudioMixer::clearDomainSettings() {
     _numStaticJitterFrames = DISABLE_STATIC_JITTER_FRAMES;
     _attenuationPerDoublingInDistance = DEFAULT_ATTENUATION_PER_DOUBLING_IN_DISTANCE;
     _noiseMutingThreshold = DEFAULT_NOISE_MUTING_THRESHOLD;
+    _maxHRTFSources = DISABLE_FOA_BED;
     _codecPreferenceOrder.clear();
     _audioZones.clear();
     _zoneSettings.clear();
     _zoneReverbSettings.clear();
+
+    // the sounds get new IDs when they are recreated, so the listeners' HRTFs for these ones would never be freed
+    if (!_ambientSounds.empty()) {
+        DependencyManager::get<NodeList>()->eachNode([](const SharedNodePointer& node) {
+            auto listenerClientData = dynamic_cast<AudioMixerClientData*>(node->getLinkedData());
+            if (listenerClientData) {
+                for (auto& ambientSound : _ambientSounds) {
+                    listenerClientData->removeHRTFForStream(ambientSound->getID());
+                }
+            }
+        });
+    }
+    _ambientSounds.clear();
 }
 
 void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
@@ -644,6 +705,16 @@ void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
             }
         }
 
+        const QString MAX_HRTF_SOURCES = "max_hrtf_sources";
+        if (audioEnvGroupObject[MAX_HRTF_SOURCES].isString()) {
+            bool ok = false;
+            int maxHRTFSources = audioEnvGroupObject[MAX_HRTF_SOURCES].toString().toInt(&ok);
+            if (ok && maxHRTFSources >= 0) {
+                _maxHRTFSources = maxHRTFSources;
+                qDebug() << "Max HRTF sources per listener changed to" << _maxHRTFSources;
+            }
+        }
+
         const QString AUDIO_ZONES = "zones";
         if (audioEnvGroupObject[AUDIO_ZONES].isObject()) {
             const QJsonObject& zones = audioEnvGroupObject[AUDIO_ZONES].toObject();
@@ -750,6 +821,53 @@ void AudioMixer::parseSettingsObject(const QJsonObject& settingsObject) {
                 }
             }
         }
+
+        const QString AMBIENT_SOUNDS = "ambient_sounds";
+        if (audioEnvGroupObject[AMBIENT_SOUNDS].isArray()) {
+            const QJsonArray& ambientSounds = audioEnvGroupObject[AMBIENT_SOUNDS].toArray();
+
+            const QString URL = "url";
+            const QString X = "x";
+            const QString Y = "y";
+            const QString Z = "z";
+            const QString VOLUME = "volume";
+            const QString RADIUS = "radius";
+            const float DEFAULT_AMBIENT_VOLUME = 1.0f;
+            const float DEFAULT_AMBIENT_RADIUS = 50.0f;
+            for (int i = 0; i < ambientSounds.count(); ++i) {
+                QJsonObject soundObject = ambientSounds[i].toObject();
+
+                if (soundObject.contains(URL) && soundObject.contains(X) &&
+                    soundObject.contains(Y) && soundObject.contains(Z)) {
+
+                    bool ok, allOk = true;
+                    QUrl url(soundObject.value(URL).toString());
+                    glm::vec3 position;
+                    position.x = soundObject.value(X).toString().toFloat(&ok);
+                    allOk &= ok;
+                    position.y = soundObject.value(Y).toString().toFloat(&ok);
+                    allOk &= ok;
+                    position.z = soundObject.value(Z).toString().toFloat(&ok);
+                    allOk &= ok;
+
+                    float volume = soundObject.value(VOLUME).toString().toFloat(&ok);
+                    if (!ok) {
+                        volume = DEFAULT_AMBIENT_VOLUME;
+                    }
+                    float radius = soundObject.value(RADIUS).toString().toFloat(&ok);
+                    if (!ok || radius <= 0.0f) {
+                        radius = DEFAULT_AMBIENT_RADIUS;
+                    }
+
+                    if (allOk && url.isValid() && volume >= 0.0f) {
+                        _ambientSounds.emplace_back(new AmbientSound(url, position, volume, radius));
+
+                        qDebug() << "Added ambient sound:" << url << "(position:" << position
+                                 << ", volume:" << volume << ", radius:" << radius << ")";
+                    }
+                }
+            }
+        }
     }
 }
 
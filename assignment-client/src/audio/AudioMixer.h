@@ -18,6 +18,7 @@
 #include <ThreadedAssignment.h>
 #include <UUIDHasher.h>
 
+#include "AmbientSound.h"
 #include "AudioMixerStats.h"
 #include "AudioMixerSlavePool.h"
 
@@ -46,9 +47,11 @@ public:
     static int getStaticJitterFrames() { return _numStaticJitterFrames; }
     static bool shouldMute(float quietestFrame) { return quietestFrame > _noiseMutingThreshold; }
     static float getAttenuationPerDoublingInDistance() { return _attenuationPerDoublingInDistance; }
+    static int getMaxHRTFSources() { return _maxHRTFSources; }
     static const QHash<QString, AABox>& getAudioZones() { return _audioZones; }
     static const QVector<ZoneSettings>& getZoneSettings() { return _zoneSettings; }
     static const QVector<ReverbSettings>& getReverbSettings() { return _zoneReverbSettings; }
+    static const AmbientSounds& getAmbientSounds() { return _ambientSounds; }
     static const std::pair<QString, CodecPluginPointer> negotiateCodec(std::vector<QString> codecs);
 
     static bool shouldReplicateTo(const Node& from, const Node& to) {
@@ -56,6 +59,9 @@ public:
                to.getPublicSocket() != from.getPublicSocket() &&
                to.getLocalSocket() != from.getLocalSocket();
     }
+
+    void aboutToFinish() override;
+
 public slots:
     void run() override;
     void sendStatsPacket() override;
@@ -123,17 +129,20 @@ private:
     Timer _frameTiming;
     Timer _prepareTiming;
     Timer _mixTiming;
+    Timer _parseTiming;
     Timer _eventsTiming;
     Timer _packetsTiming;
 
     static int _numStaticJitterFrames; // -1 denotes dynamic jitter buffering
     static float _noiseMutingThreshold;
     static float _attenuationPerDoublingInDistance;
+    static int _maxHRTFSources; // 0 renders every source through its own HRTF
     static std::map<QString, CodecPluginPointer> _availableCodecs;
     static QStringList _codecPreferenceOrder;
     static QHash<QString, AABox> _audioZones;
     static QVector<ZoneSettings> _zoneSettings;
     static QVector<ReverbSettings> _zoneReverbSettings;
+    static AmbientSounds _ambientSounds;
 
 };
 
@@ -49,10 +49,47 @@ AudioMixerClientData::~AudioMixerClientData() {
 }
 
 void AudioMixerClientData::queuePacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
-    if (!_packetQueue.node) {
-        _packetQueue.node = node;
+    // audio is parsed on its own pass before each frame is prepared, everything else between frames
+    PacketQueue* queue;
+    switch (message->getType()) {
+        case PacketType::MicrophoneAudioNoEcho:
+        case PacketType::MicrophoneAudioWithEcho:
+        case PacketType::InjectAudio:
+        case PacketType::SilentAudioFrame:
+            queue = &_streamPacketQueue;
+            break;
+        default:
+            queue = &_packetQueue;
+            break;
+    }
+
+    if (!queue->node) {
+        queue->node = node;
+    }
+    queue->push(message);
+}
+
+void AudioMixerClientData::processStreamPackets() {
+    SharedNodePointer node = _streamPacketQueue.node;
+    assert(_streamPacketQueue.empty() || node);
+    _streamPacketQueue.node.clear();
+
+    while (!_streamPacketQueue.empty()) {
+        auto& packet = _streamPacketQueue.front();
+
+        if (node->isUpstream()) {
+            setupCodecForReplicatedAgent(packet);
+        }
+
+        {
+            QMutexLocker lock(&getMutex());
+            parseData(*packet);
+        }
+
+        optionallyReplicatePacket(*packet, *node);
+
+        _streamPacketQueue.pop();
     }
-    _packetQueue.push(message);
 }
 
 void AudioMixerClientData::processPackets() {
@@ -64,22 +101,6 @@ void AudioMixerClientData::processPackets() {
         auto& packet = _packetQueue.front();
 
         switch (packet->getType()) {
-            case PacketType::MicrophoneAudioNoEcho:
-            case PacketType::MicrophoneAudioWithEcho:
-            case PacketType::InjectAudio:
-            case PacketType::SilentAudioFrame: {
-
-                if (node->isUpstream()) {
-                    setupCodecForReplicatedAgent(packet);
-                }
-
-                QMutexLocker lock(&getMutex());
-                parseData(*packet);
-
-                optionallyReplicatePacket(*packet, *node);
-
-                break;
-            }
             case PacketType::AudioStreamStats: {
                 QMutexLocker lock(&getMutex());
                 parseData(*packet);
@@ -213,6 +234,17 @@ AvatarAudioStream* AudioMixerClientData::getAvatarAudioStream() {
     return NULL;
 }
 
+AudioHRTF* AudioMixerClientData::findHRTFForStream(const QUuid& nodeID, const QUuid& streamID) {
+    auto it = _nodeSourcesHRTFMap.find(nodeID);
+    if (it != _nodeSourcesHRTFMap.end()) {
+        auto streamIt = it->second.find(streamID);
+        if (streamIt != it->second.end()) {
+            return &streamIt->second;
+        }
+    }
+    return nullptr;
+}
+
 void AudioMixerClientData::removeHRTFForStream(const QUuid& nodeID, const QUuid& streamID) {
     auto it = _nodeSourcesHRTFMap.find(nodeID);
     if (it != _nodeSourcesHRTFMap.end()) {
@@ -227,11 +259,34 @@ void AudioMixerClientData::removeHRTFForStream(const QUuid& nodeID, const QUuid&
     }
 }
 
+AudioMixerClientData::FOAEncoder* AudioMixerClientData::findFOAEncoderForStream(const QUuid& nodeID,
+        const QUuid& streamID) {
+    auto it = _nodeSourcesFOAEncoderMap.find(nodeID);
+    if (it != _nodeSourcesFOAEncoderMap.end()) {
+        auto streamIt = it->second.find(streamID);
+        if (streamIt != it->second.end()) {
+            return &streamIt->second;
+        }
+    }
+    return nullptr;
+}
+
+void AudioMixerClientData::removeFOAEncoderForStream(const QUuid& nodeID, const QUuid& streamID) {
+    auto it = _nodeSourcesFOAEncoderMap.find(nodeID);
+    if (it != _nodeSourcesFOAEncoderMap.end()) {
+        it->second.erase(streamID);
+        if (it->second.size() == 0) {
+            _nodeSourcesFOAEncoderMap.erase(it);
+        }
+    }
+}
+
 void AudioMixerClientData::removeAgentAvatarAudioStream() {
     QWriteLocker writeLocker { &_streamsLock };
     auto it = _audioStreams.find(QUuid());
     if (it != _audioStreams.end()) {
         _audioStreams.erase(it);
+        _streamsChanged = true;
     }
     writeLocker.unlock();
 }
@@ -287,6 +342,7 @@ int AudioMixerClientData::parseData(ReceivedMessage& message) {
                 );
 
                 micStreamIt = emplaced.first;
+                _streamsChanged = true;
             }
 
             matchingStream = micStreamIt->second;
@@ -324,6 +380,7 @@ int AudioMixerClientData::parseData(ReceivedMessage& message) {
                 );
 
                 streamIt = emplaced.first;
+                _streamsChanged = true;
             }
 
             matchingStream = streamIt->second;
@@ -355,6 +412,9 @@ int AudioMixerClientData::checkBuffersBeforeFrameSend() {
     while (it != _audioStreams.end()) {
         SharedStreamPointer stream = it->second;
 
+        // nothing is parsing or mixing now, so the properties parsed since the last frame can be applied
+        stream->latchProperties();
+
         if (stream->popFrames(1, true) > 0) {
             stream->updateLastPopOutputLoudnessAndTrailingLoudness();
         }
@@ -372,11 +432,22 @@ int AudioMixerClientData::checkBuffersBeforeFrameSend() {
 
             // erase the stream to drop our ref to the shared pointer and remove it
             it = _audioStreams.erase(it);
+            _streamsChanged = true;
         } else {
             ++it;
         }
     }
 
+    // publish the streams for this frame's mix
+    if (_streamsChanged) {
+        _streamsSnapshot.clear();
+        _streamsSnapshot.reserve(_audioStreams.size());
+        for (auto& streamPair : _audioStreams) {
+            _streamsSnapshot.push_back(streamPair.second);
+        }
+        _streamsChanged = false;
+    }
+
     return (int)_audioStreams.size();
 }
 
@@ -393,11 +464,13 @@ void AudioMixerClientData::sendAudioStreamStatsPackets(const SharedNodePointer&
     // and clear its cache of injector stream stats; it helps to prevent buildup of dead audio stream stats in the client.
     quint8 appendFlag = AudioStreamStats::START;
 
-    auto streamsCopy = getAudioStreams();
+    // this runs in the mix, so it holds off the parsing of this node's packets while it reads the stream stats
+    QMutexLocker lock(&getMutex());
+    auto& streams = getStreamsSnapshot();
 
     // pack and send stream stats packets until all audio streams' stats are sent
-    int numStreamStatsRemaining = int(streamsCopy.size());
-    auto it = streamsCopy.cbegin();
+    int numStreamStatsRemaining = int(streams.size());
+    auto it = streams.cbegin();
 
     while (numStreamStatsRemaining > 0) {
         auto statsPacket = NLPacket::create(PacketType::AudioStreamStats);
@@ -421,7 +494,7 @@ void AudioMixerClientData::sendAudioStreamStatsPackets(const SharedNodePointer&
 
         // pack the calculated number of stream stats
         for (int i = 0; i < numStreamStatsToPack; i++) {
-            PositionalAudioStream* stream = it->second.get();
+            PositionalAudioStream* stream = it->get();
 
             stream->perSecondCallbackForUpdatingStats();
 
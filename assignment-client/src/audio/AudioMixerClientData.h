@@ -17,6 +17,7 @@
 #include <QtCore/QJsonObject>
 
 #include <AABox.h>
+#include <AudioFOA.h>
 #include <AudioHRTF.h>
 #include <AudioLimiter.h>
 #include <UUIDHasher.h>
@@ -35,11 +36,20 @@ public:
     using SharedStreamPointer = std::shared_ptr<PositionalAudioStream>;
     using AudioStreamMap = std::unordered_map<QUuid, SharedStreamPointer>;
 
+    using StreamsSnapshot = std::vector<SharedStreamPointer>;
+
     void queuePacket(QSharedPointer<ReceivedMessage> packet, SharedNodePointer node);
+    // processes the queued control packets, which change state the mix reads, so never while mixing
     void processPackets();
+    // parses the queued audio packets into their streams, before the frame is prepared and never while mixing
+    void processStreamPackets();
 
     // locks the mutex to make a copy
     AudioStreamMap getAudioStreams() { QReadLocker readLock { &_streamsLock }; return _audioStreams; }
+
+    // the streams as of the last checkBuffersBeforeFrameSend, stable until the next one, so the mix reads it
+    // without a copy or a lock even while new streams are being parsed
+    const StreamsSnapshot& getStreamsSnapshot() const { return _streamsSnapshot; }
     AvatarAudioStream* getAvatarAudioStream();
 
     // returns whether self (this data's node) should ignore node, memoized by frame
@@ -52,11 +62,40 @@ public:
     // returns a new or existing HRTF object for the given stream from the given node
     AudioHRTF& hrtfForStream(const QUuid& nodeID, const QUuid& streamID = QUuid()) { return _nodeSourcesHRTFMap[nodeID][streamID]; }
 
+    // returns the HRTF object for the given stream from the given node, or nullptr if there is none
+    AudioHRTF* findHRTFForStream(const QUuid& nodeID, const QUuid& streamID = QUuid());
+
     // removes an AudioHRTF object for a given stream
     void removeHRTFForStream(const QUuid& nodeID, const QUuid& streamID = QUuid());
 
+    // the state of a stream mixed into this listener's FOA bed, in place of an HRTF
+    struct FOAEncoder {
+        // B-format gains (W, X, Y, Z) of the last block, the next block ramps from these
+        float coefficients[4] {};
+    };
+
+    // returns a new or existing FOA encoder for the given stream from the given node
+    FOAEncoder& foaEncoderForStream(const QUuid& nodeID, const QUuid& streamID = QUuid()) { return _nodeSourcesFOAEncoderMap[nodeID][streamID]; }
+
+    // returns the FOA encoder for the given stream from the given node, or nullptr if the stream is not in the bed
+    FOAEncoder* findFOAEncoderForStream(const QUuid& nodeID, const QUuid& streamID = QUuid());
+
+    // removes an FOA encoder for a given stream
+    void removeFOAEncoderForStream(const QUuid& nodeID, const QUuid& streamID = QUuid());
+
+    // the bed the far sources are encoded into, rendered to binaural once per block
+    AudioFOA& getFOABed() { return _foaBed; }
+
+    // blocks left to render after the bed goes silent, to flush the decoder tail
+    int getFOABedFlushFrames() const { return _foaBedFlushFrames; }
+    void setFOABedFlushFrames(int frames) { _foaBedFlushFrames = frames; }
+
     // remove all sources and data from this node
-    void removeNode(const QUuid& nodeID) { _nodeSourcesIgnoreMap.unsafe_erase(nodeID); _nodeSourcesHRTFMap.erase(nodeID); }
+    void removeNode(const QUuid& nodeID) {
+        _nodeSourcesIgnoreMap.unsafe_erase(nodeID);
+        _nodeSourcesHRTFMap.erase(nodeID);
+        _nodeSourcesFOAEncoderMap.erase(nodeID);
+    }
 
     void removeAgentAvatarAudioStream();
 
@@ -121,9 +160,12 @@ private:
         QWeakPointer<Node> node;
     };
     PacketQueue _packetQueue;
+    PacketQueue _streamPacketQueue;
 
     QReadWriteLock _streamsLock;
     AudioStreamMap _audioStreams; // microphone stream from avatar is stored under key of null UUID
+    bool _streamsChanged { false }; // guarded by _streamsLock
+    StreamsSnapshot _streamsSnapshot;
 
     void optionallyReplicatePacket(ReceivedMessage& packet, const Node& node);
 
@@ -169,6 +211,13 @@ private:
     using NodeSourcesHRTFMap = std::unordered_map<QUuid, HRTFMap>;
     NodeSourcesHRTFMap _nodeSourcesHRTFMap;
 
+    using FOAEncoderMap = std::unordered_map<QUuid, FOAEncoder>;
+    using NodeSourcesFOAEncoderMap = std::unordered_map<QUuid, FOAEncoderMap>;
+    NodeSourcesFOAEncoderMap _nodeSourcesFOAEncoderMap;
+
+    AudioFOA _foaBed;
+    int _foaBedFlushFrames { 0 };
+
     quint16 _outgoingMixedAudioSequenceNumber;
 
     AudioStreamStats _downstreamAudioStreamStats;
@@ -28,6 +28,7 @@
 #include <UUID.h>
 
 #include "AudioRingBuffer.h"
+#include "AmbientSound.h"
 #include "AudioMixer.h"
 #include "AudioMixerClientData.h"
 #include "AvatarAudioStream.h"
@@ -39,6 +40,55 @@
 using AudioStreamMap = AudioMixerClientData::AudioStreamMap;
 
 // packet helpers
+void AudioMixerSlave::addAmbientSound(AudioMixerClientData& listenerNodeData,
+        const AvatarAudioStream& listeningNodeStream, const AmbientSound& ambientSound) {
+    if (!ambientSound.hasFrame()) {
+        return;
+    }
+
+    glm::vec3 relativePosition = ambientSound.getPosition() - listeningNodeStream.getPosition();
+    float distance = glm::max(glm::length(relativePosition), EPSILON);
+    const int HRTF_DATASET_INDEX = 1;
+
+    if (distance > ambientSound.getRadius()) {
+        ++stats.ambientCulls;
+
+        // a listener that has just left the sound's radius renders its tail once, then releases the HRTF
+        // so culled sounds hold no state at all
+        auto hrtf = listenerNodeData.findHRTFForStream(ambientSound.getID());
+        if (hrtf) {
+            float azimuth = computeAzimuth(listeningNodeStream, listeningNodeStream, relativePosition);
+            static int16_t silentMonoBlock[AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL] = {};
+            hrtf->renderSilent(silentMonoBlock, _mixSamples, HRTF_DATASET_INDEX, azimuth, distance, 0.0f,
+                               AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+            listenerNodeData.removeHRTFForStream(ambientSound.getID());
+        }
+        return;
+    }
+
+    ++stats.ambientMixes;
+
+    float gain = ambientSound.getVolume() *
+        computeDistanceAttenuation(ambientSound.getPosition(), listeningNodeStream.getPosition(), distance);
+    const int16_t* frame = ambientSound.getFrame();
+
+    // stereo sources are not passed through HRTF
+    if (ambientSound.isStereo()) {
+        for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; ++i) {
+            _mixSamples[i] += float(frame[i] * gain / AudioConstants::MAX_SAMPLE_VALUE);
+        }
+        return;
+    }
+
+    float azimuth = computeAzimuth(listeningNodeStream, listeningNodeStream, relativePosition);
+    auto& hrtf = listenerNodeData.hrtfForStream(ambientSound.getID());
+
+    // the HRTF takes mutable input, so the shared frame is copied into the mixing buffer
+    memcpy(_bufferSamples, frame, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL * sizeof(int16_t));
+    hrtf.render(_bufferSamples, _mixSamples, HRTF_DATASET_INDEX, azimuth, distance, gain,
+                AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+}
+
 std::unique_ptr<NLPacket> createAudioPacket(PacketType type, int size, quint16 sequence, QString codec);
 void sendMixPacket(const SharedNodePointer& node, AudioMixerClientData& data, QByteArray& buffer);
 void sendSilentPacket(const SharedNodePointer& node, AudioMixerClientData& data);
@@ -50,6 +100,8 @@ inline float approximateGain(const AvatarAudioStream& listeningNodeStream, const
         const glm::vec3& relativePosition);
 inline float computeGain(const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd,
         const glm::vec3& relativePosition, bool isEcho);
+inline float computeDistanceAttenuation(const glm::vec3& sourcePosition, const glm::vec3& listenerPosition,
+        float distance);
 inline float computeAzimuth(const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd,
         const glm::vec3& relativePosition);
 
@@ -60,6 +112,13 @@ void AudioMixerSlave::processPackets(const SharedNodePointer& node) {
     }
 }
 
+void AudioMixerSlave::processStreamPackets(const SharedNodePointer& node) {
+    AudioMixerClientData* data = (AudioMixerClientData*)node->getLinkedData();
+    if (data) {
+        data->processStreamPackets();
+    }
+}
+
 void AudioMixerSlave::configureMix(ConstIter begin, ConstIter end, unsigned int frame, float throttlingRatio) {
     _begin = begin;
     _end = end;
@@ -139,8 +198,7 @@ bool AudioMixerSlave::prepareMix(const SharedNodePointer& listener) {
             AudioMixerClientData&, const QUuid&, const AvatarAudioStream&, const PositionalAudioStream&);
     auto forAllStreams = [&](const SharedNodePointer& node, AudioMixerClientData* nodeData, MixFunctor mixFunctor) {
         auto nodeID = node->getUUID();
-        for (auto& streamPair : nodeData->getAudioStreams()) {
-            auto nodeStream = streamPair.second;
+        for (auto& nodeStream : nodeData->getStreamsSnapshot()) {
             (this->*mixFunctor)(*listenerData, nodeID, *listenerAudioStream, *nodeStream);
         }
     };
@@ -157,8 +215,7 @@ bool AudioMixerSlave::prepareMix(const SharedNodePointer& listener) {
 
         if (*node == *listener) {
             // only mix the echo, if requested
-            for (auto& streamPair : nodeData->getAudioStreams()) {
-                auto nodeStream = streamPair.second;
+            for (auto& nodeStream : nodeData->getStreamsSnapshot()) {
                 if (nodeStream->shouldLoopbackForNode()) {
                     mixStream(*listenerData, node->getUUID(), *listenerAudioStream, *nodeStream);
                 }
@@ -170,9 +227,12 @@ bool AudioMixerSlave::prepareMix(const SharedNodePointer& listener) {
                 auto nodeID = node->getUUID();
 
                 // compute the node's max relative volume
-                float nodeVolume;
-                for (auto& streamPair : nodeData->getAudioStreams()) {
-                    auto nodeStream = streamPair.second;
+                float nodeVolume = 0.0f;
+                for (auto& nodeStream : nodeData->getStreamsSnapshot()) {
+                    // idle streams add nothing to the mix
+                    if (nodeStream->isIdle()) {
+                        continue;
+                    }
 
                     // approximate the gain
                     glm::vec3 relativePosition = nodeStream->getPosition() - listenerAudioStream->getPosition();
@@ -220,6 +280,14 @@ bool AudioMixerSlave::prepareMix(const SharedNodePointer& listener) {
         }
     }
 
+    // the nearest streams get an HRTF each, the rest share the listener's FOA bed
+    mixHRTFCandidates(*listenerData, *listenerAudioStream);
+
+    // mix the ambient sounds played by the mixer itself
+    for (auto& ambientSound : AudioMixer::getAmbientSounds()) {
+        addAmbientSound(*listenerData, *listenerAudioStream, *ambientSound);
+    }
+
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     auto mixEnd = p_high_resolution_clock::now();
     auto mixTime = std::chrono::duration_cast<std::chrono::nanoseconds>(mixEnd - mixStart);
@@ -249,15 +317,155 @@ void AudioMixerSlave::throttleStream(AudioMixerClientData& listenerNodeData, con
 
 void AudioMixerSlave::mixStream(AudioMixerClientData& listenerNodeData, const QUuid& sourceNodeID,
         const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd) {
+    // with the FOA bed enabled, mono streams are mixed once they can be sorted by distance
+    // (stereo and echo streams do not go through the HRTF, so they are always mixed directly)
+    if (AudioMixer::getMaxHRTFSources() > 0 && !streamToAdd.isStereo() && &streamToAdd != &listeningNodeStream) {
+        if (streamToAdd.isIdle()) {
+            // an idle stream enters the bed again from silence, if at all
+            listenerNodeData.removeFOAEncoderForStream(sourceNodeID, streamToAdd.getStreamIdentifier());
+        } else {
+            glm::vec3 relativePosition = streamToAdd.getPosition() - listeningNodeStream.getPosition();
+            _hrtfCandidates.push_back({ glm::length2(relativePosition), sourceNodeID, &streamToAdd });
+            return;
+        }
+    }
+
     addStream(listenerNodeData, sourceNodeID, listeningNodeStream, streamToAdd, false);
 }
 
+void AudioMixerSlave::mixHRTFCandidates(AudioMixerClientData& listenerNodeData,
+        const AvatarAudioStream& listeningNodeStream) {
+    auto nearestEnd = _hrtfCandidates.begin() + std::min((int)_hrtfCandidates.size(), AudioMixer::getMaxHRTFSources());
+    std::nth_element(_hrtfCandidates.begin(), nearestEnd, _hrtfCandidates.end(),
+        [](const HRTFCandidate& a, const HRTFCandidate& b) {
+            return a.distanceSquared < b.distanceSquared;
+        });
+
+    memset(_foaBedSamples, 0, sizeof(_foaBedSamples));
+    bool bedHasAudio = false;
+
+    for (auto it = _hrtfCandidates.begin(); it != nearestEnd; ++it) {
+        // a stream that has come near enough fades out of the bed as its HRTF fades in
+        if (listenerNodeData.findFOAEncoderForStream(it->nodeID, it->stream->getStreamIdentifier())) {
+            bedHasAudio |= encodeStream(listenerNodeData, it->nodeID, listeningNodeStream, *it->stream, true);
+        }
+        addStream(listenerNodeData, it->nodeID, listeningNodeStream, *it->stream, false);
+    }
+
+    for (auto it = nearestEnd; it != _hrtfCandidates.end(); ++it) {
+        ++stats.totalMixes;
+        bedHasAudio |= encodeStream(listenerNodeData, it->nodeID, listeningNodeStream, *it->stream, false);
+    }
+
+    _hrtfCandidates.clear();
+
+    // the decoder keeps FOA_OVERLAP samples of history, so it is rendered for a while after the bed empties
+    const int FOA_BED_FLUSH_FRAMES = (FOA_OVERLAP + FOA_BLOCK - 1) / FOA_BLOCK;
+    int flushFrames = listenerNodeData.getFOABedFlushFrames();
+    if (bedHasAudio) {
+        flushFrames = FOA_BED_FLUSH_FRAMES;
+    } else if (flushFrames > 0) {
+        --flushFrames;
+    } else {
+        return;
+    }
+    listenerNodeData.setFOABedFlushFrames(flushFrames);
+
+    // the sources were encoded relative to the listener, so the bed is rendered without rotation
+    const int HRTF_DATASET_INDEX = 1;
+    float* bed[4] = { _foaBedSamples[0], _foaBedSamples[1], _foaBedSamples[2], _foaBedSamples[3] };
+    listenerNodeData.getFOABed().render(bed, _mixSamples, HRTF_DATASET_INDEX, 1.0f, 0.0f, 0.0f, 0.0f,
+                                        AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+    ++stats.foaBedRenders;
+}
+
+bool AudioMixerSlave::encodeStream(AudioMixerClientData& listenerNodeData, const QUuid& sourceNodeID,
+        const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd, bool isLeaving) {
+    const QUuid& streamID = streamToAdd.getStreamIdentifier();
+    auto encoder = listenerNodeData.findFOAEncoderForStream(sourceNodeID, streamID);
+
+    glm::vec3 relativePosition = streamToAdd.getPosition() - listeningNodeStream.getPosition();
+    float distance = glm::max(glm::length(relativePosition), EPSILON);
+    float gain = computeGain(listeningNodeStream, streamToAdd, relativePosition, false);
+    const int HRTF_DATASET_INDEX = 1;
+
+    // the bed has no per-source filters, but it does honor the listener's gain for the source
+    auto hrtf = listenerNodeData.findHRTFForStream(sourceNodeID, streamID);
+    if (hrtf) {
+        gain *= hrtf->getGainAdjustment();
+    }
+
+    AudioRingBuffer::ConstIterator streamPopOutput = streamToAdd.getLastPopOutput();
+    if (streamPopOutput.isNull()) {
+        listenerNodeData.removeFOAEncoderForStream(sourceNodeID, streamID);
+        return false;
+    }
+
+    if (!streamToAdd.lastPopSucceeded()) {
+        // as in addStream, injectors go silent and other inputs repeat with a fade
+        bool isInjector = dynamic_cast<const InjectedAudioStream*>(&streamToAdd);
+        gain *= isInjector ? 0.0f : calculateRepeatedFrameFadeFactor(streamToAdd.getConsecutiveNotMixedCount() - 1);
+    }
+
+    streamPopOutput.readSamples(_bufferSamples, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+    if (!encoder) {
+        // the stream is entering the bed, so its HRTF fades out over the block the bed fades in over
+        if (hrtf) {
+            float azimuth = computeAzimuth(listeningNodeStream, listeningNodeStream, relativePosition);
+            hrtf->render(_bufferSamples, _mixSamples, HRTF_DATASET_INDEX, azimuth, distance, 0.0f,
+                         AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+        }
+        encoder = &listenerNodeData.foaEncoderForStream(sourceNodeID, streamID);
+    }
+
+    // encode as a plane wave from the source's direction, in FuMa normalization (W at -3dB)
+    float coefficients[4] = {};
+    if (!isLeaving) {
+        glm::vec3 direction = glm::inverse(listeningNodeStream.getOrientation()) * (relativePosition / distance);
+        float scale = gain / AudioConstants::MAX_SAMPLE_VALUE;
+        const float SQRT1_2 = 0.707106781f;
+
+        // convert from Y-up (OpenGL) to Z-up (Ambisonic) coordinates, with X forward and Y left
+        coefficients[0] = scale * SQRT1_2;
+        coefficients[1] = scale * -direction.z;
+        coefficients[2] = scale * -direction.x;
+        coefficients[3] = scale * direction.y;
+    }
+
+    // ramp from the last block's coefficients, so moving sources do not click
+    const int numFrames = AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+    for (int n = 0; n < 4; ++n) {
+        float coefficient = encoder->coefficients[n];
+        float step = (coefficients[n] - coefficient) / numFrames;
+        for (int i = 0; i < numFrames; ++i) {
+            coefficient += step;
+            _foaBedSamples[n][i] += coefficient * _bufferSamples[i];
+        }
+        encoder->coefficients[n] = coefficients[n];
+    }
+
+    if (isLeaving) {
+        listenerNodeData.removeFOAEncoderForStream(sourceNodeID, streamID);
+    } else {
+        ++stats.foaBedMixes;
+    }
+    return true;
+}
+
 void AudioMixerSlave::addStream(AudioMixerClientData& listenerNodeData, const QUuid& sourceNodeID,
         const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd,
         bool throttle) {
     ++stats.totalMixes;
 
-    // to reduce artifacts we call the HRTF functor for every source, even if throttled or silent
+    // idle streams already flushed this listener's HRTF with their first silent frame, so skip them entirely
+    if (streamToAdd.isIdle()) {
+        ++stats.idleStreamSkips;
+        return;
+    }
+
+    // to reduce artifacts we call the HRTF functor for every other source, even if throttled or silent
     // this ensures the correct tail from last mixed block and the correct spatialization of next first block
 
     // check if this is a server echo of a source back to itself
@@ -509,14 +717,22 @@ float computeGain(const AvatarAudioStream& listeningNodeStream, const Positional
         gain *= offAxisCoefficient;
     }
 
+    gain *= computeDistanceAttenuation(streamToAdd.getPosition(), listeningNodeStream.getPosition(),
+                                       glm::length(relativePosition));
+
+    return gain;
+}
+
+float computeDistanceAttenuation(const glm::vec3& sourcePosition, const glm::vec3& listenerPosition,
+        float distance) {
     auto& audioZones = AudioMixer::getAudioZones();
     auto& zoneSettings = AudioMixer::getZoneSettings();
 
     // find distance attenuation coefficient
     float attenuationPerDoublingInDistance = AudioMixer::getAttenuationPerDoublingInDistance();
     for (int i = 0; i < zoneSettings.length(); ++i) {
-        if (audioZones[zoneSettings[i].source].contains(streamToAdd.getPosition()) &&
-            audioZones[zoneSettings[i].listener].contains(listeningNodeStream.getPosition())) {
+        if (audioZones[zoneSettings[i].source].contains(sourcePosition) &&
+            audioZones[zoneSettings[i].listener].contains(listenerPosition)) {
             attenuationPerDoublingInDistance = zoneSettings[i].coefficient;
             break;
         }
@@ -524,22 +740,17 @@ float computeGain(const AvatarAudioStream& listeningNodeStream, const Positional
 
     // distance attenuation
     const float ATTENUATION_START_DISTANCE = 1.0f;
-    float distance = glm::length(relativePosition);
     assert(ATTENUATION_START_DISTANCE > EPSILON);
-    if (distance >= ATTENUATION_START_DISTANCE) {
-
-        // translate the zone setting to gain per log2(distance)
-        float g = 1.0f - attenuationPerDoublingInDistance;
-        g = glm::clamp(g, EPSILON, 1.0f);
-
-        // calculate the distance coefficient using the distance to this node
-        float distanceCoefficient = fastExp2f(fastLog2f(g) * fastLog2f(distance/ATTENUATION_START_DISTANCE));
-
-        // multiply the current attenuation coefficient by the distance coefficient
-        gain *= distanceCoefficient;
+    if (distance < ATTENUATION_START_DISTANCE) {
+        return 1.0f;
     }
 
-    return gain;
+    // translate the zone setting to gain per log2(distance)
+    float g = 1.0f - attenuationPerDoublingInDistance;
+    g = glm::clamp(g, EPSILON, 1.0f);
+
+    // calculate the distance coefficient using the distance to this node
+    return fastExp2f(fastLog2f(g) * fastLog2f(distance/ATTENUATION_START_DISTANCE));
 }
 
 float computeAzimuth(const AvatarAudioStream& listeningNodeStream, const PositionalAudioStream& streamToAdd,
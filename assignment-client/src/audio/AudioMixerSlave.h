@@ -23,6 +23,7 @@
 
 class PositionalAudioStream;
 class AvatarAudioStream;
+class AmbientSound;
 class AudioHRTF;
 class AudioMixerClientData;
 
@@ -33,6 +34,9 @@ public:
     // process packets for a given node (requires no configuration)
     void processPackets(const SharedNodePointer& node);
 
+    // parse the audio a given node has sent since the last frame into its streams (requires no configuration)
+    void processStreamPackets(const SharedNodePointer& node);
+
     // configure a round of mixing
     void configureMix(ConstIter begin, ConstIter end, unsigned int frame, float throttlingRatio);
 
@@ -52,10 +56,28 @@ private:
     void addStream(AudioMixerClientData& listenerData, const QUuid& streamerID,
             const AvatarAudioStream& listenerStream, const PositionalAudioStream& streamer,
             bool throttle);
+    void addAmbientSound(AudioMixerClientData& listenerData, const AvatarAudioStream& listenerStream,
+            const AmbientSound& ambientSound);
+
+    // gives the nearest candidates an HRTF each, and encodes the rest into the listener's FOA bed
+    void mixHRTFCandidates(AudioMixerClientData& listenerData, const AvatarAudioStream& listenerStream);
+    // encodes the stream into the bed, or fades it out of the bed when it is leaving for an HRTF
+    // returns true if anything was encoded
+    bool encodeStream(AudioMixerClientData& listenerData, const QUuid& streamerID,
+            const AvatarAudioStream& listenerStream, const PositionalAudioStream& streamer, bool isLeaving);
 
     // mixing buffers
     float _mixSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
     int16_t _bufferSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    float _foaBedSamples[4][AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL];
+
+    // mono streams waiting to be sorted by distance, when the FOA bed is enabled
+    struct HRTFCandidate {
+        float distanceSquared;
+        QUuid nodeID;
+        const PositionalAudioStream* stream;
+    };
+    std::vector<HRTFCandidate> _hrtfCandidates;
 
     // frame state
     ConstIter _begin;
@@ -74,6 +74,12 @@ void AudioMixerSlavePool::processPackets(ConstIter begin, ConstIter end) {
     run(begin, end);
 }
 
+void AudioMixerSlavePool::processStreamPackets(ConstIter begin, ConstIter end) {
+    _function = &AudioMixerSlave::processStreamPackets;
+    _configure = [](AudioMixerSlave& slave) {};
+    run(begin, end);
+}
+
 void AudioMixerSlavePool::mix(ConstIter begin, ConstIter end, unsigned int frame, float throttlingRatio) {
     _function = &AudioMixerSlave::mix;
     _configure = [=](AudioMixerSlave& slave) {
@@ -64,6 +64,9 @@ public:
     // process packets on slave threads
     void processPackets(ConstIter begin, ConstIter end);
 
+    // parse the audio received since the last frame on slave threads
+    void processStreamPackets(ConstIter begin, ConstIter end);
+
     // mix on slave threads
     void mix(ConstIter begin, ConstIter end, unsigned int frame, float throttlingRatio);
 
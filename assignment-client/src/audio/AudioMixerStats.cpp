@@ -19,8 +19,13 @@ void AudioMixerStats::reset() {
     hrtfRenders = 0;
     hrtfSilentRenders = 0;
     hrtfThrottleRenders = 0;
+    idleStreamSkips = 0;
+    foaBedMixes = 0;
+    foaBedRenders = 0;
     manualStereoMixes = 0;
     manualEchoMixes = 0;
+    ambientMixes = 0;
+    ambientCulls = 0;
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     mixTime = 0;
 #endif
@@ -34,8 +39,13 @@ void AudioMixerStats::accumulate(const AudioMixerStats& otherStats) {
     hrtfRenders += otherStats.hrtfRenders;
     hrtfSilentRenders += otherStats.hrtfSilentRenders;
     hrtfThrottleRenders += otherStats.hrtfThrottleRenders;
+    idleStreamSkips += otherStats.idleStreamSkips;
+    foaBedMixes += otherStats.foaBedMixes;
+    foaBedRenders += otherStats.foaBedRenders;
     manualStereoMixes += otherStats.manualStereoMixes;
     manualEchoMixes += otherStats.manualEchoMixes;
+    ambientMixes += otherStats.ambientMixes;
+    ambientCulls += otherStats.ambientCulls;
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     mixTime += otherStats.mixTime;
 #endif
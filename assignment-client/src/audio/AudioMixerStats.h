@@ -26,10 +26,16 @@ struct AudioMixerStats {
     int hrtfRenders { 0 };
     int hrtfSilentRenders { 0 };
     int hrtfThrottleRenders { 0 };
+    int idleStreamSkips { 0 };
+    int foaBedMixes { 0 };
+    int foaBedRenders { 0 };
 
     int manualStereoMixes { 0 };
     int manualEchoMixes { 0 };
 
+    int ambientMixes { 0 };
+    int ambientCulls { 0 };
+
 #ifdef HIFI_AUDIO_MIXER_DEBUG
     uint64_t mixTime { 0 };
 #endif
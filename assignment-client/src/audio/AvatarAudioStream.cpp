@@ -29,21 +29,13 @@ int AvatarAudioStream::parseStreamProperties(PacketType type, const QByteArray&
         readBytes += parsePositionalData(packetAfterSeqNum.mid(readBytes));
 
     } else {
-        _shouldLoopbackForNode = (type == PacketType::MicrophoneAudioWithEcho);
+        _parsedProperties.shouldLoopbackForNode = (type == PacketType::MicrophoneAudioWithEcho);
 
         // read the channel flag
         quint8 channelFlag = packetAfterSeqNum.at(readBytes);
-        bool isStereo = channelFlag == 1;
+        parseChannelFlag(channelFlag == 1);
         readBytes += sizeof(quint8);
 
-        // if isStereo value has changed, restart the ring buffer with new frame size
-        if (isStereo != _isStereo) {
-            _ringBuffer.resizeForFrameSize(isStereo
-                                           ? AudioConstants::NETWORK_FRAME_SAMPLES_STEREO
-                                           : AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-            _isStereo = isStereo;
-        }
-
         // read the positional data
         readBytes += parsePositionalData(packetAfterSeqNum.mid(readBytes));
         
@@ -0,0 +1,424 @@
+//
+//  BotFarm.cpp
+//  assignment-client/src/bots
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BotFarm.h"
+
+#include <cstdlib>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QThread>
+
+#include <AudioConstants.h>
+#include <AudioHelpers.h>
+#include <SharedUtil.h>
+#include <ThreadHelpers.h>
+
+const QString BotFarm::ASSIGNMENT_POOL = "bot-farm";
+const float BotFarm::DEFAULT_BOT_SPACING = 1.0f; // meters
+
+// bots run at the same rates as a single Agent avatar
+static const int AVATAR_DATA_HZ = 45;
+static const quint64 AVATAR_DATA_INTERVAL_USECS = USECS_PER_SECOND / AVATAR_DATA_HZ;
+static const int TICK_INTERVAL_MSECS = 10;
+
+// the audio mixer doesn't negotiate codecs for injected streams, they are PCM and name no codec
+static const QString INJECTED_CODEC_NAME = "";
+
+FarmBot::FarmBot(int index, const recording::ClipConstPointer& clip, const glm::vec3& position, quint64 now) :
+    _index(index),
+    _id(QUuid::createUuid()),
+    _clip(clip->share())
+{
+    _avatar.setSessionUUID(_id);
+    _avatar.setForceFaceTrackerConnected(true);
+    _avatar.setSkeletonModelURL(QUrl());
+    // force lazy initialization of the head data, it is needed for every packet we send
+    _avatar.getHeadOrientation();
+    _avatar.setPosition(position);
+    _avatar.setRecordingBasis();
+    _avatar.pushIdentitySequenceNumber();
+
+    // spread the bots over the clip and over the second so they neither move in lockstep nor identify all at once
+    const quint64 SPREAD_MSECS = 7919;
+    quint64 durationMsecs = recording::Frame::secondsToFrameTime(_clip->duration());
+    quint64 offset = durationMsecs > 0 ? ((quint64)index * SPREAD_MSECS) % durationMsecs : 0;
+    _loopStartTime = now - offset * USECS_PER_MSEC;
+    _lastTickTime = now;
+    _nextIdentityTime = now + (index % MSECS_PER_SECOND) * USECS_PER_MSEC;
+
+    // avatar frames are delta coded, so catch the pose up to our starting point without sending any of the audio
+    _clip->seekFrameTime(0);
+    while (_clip->positionFrameTime() < (recording::Frame::Time)offset) {
+        playFrame(*_clip->nextFrame(), nullptr);
+    }
+}
+
+void FarmBot::hold(quint64 now) {
+    // keep our place in the clip so we don't play a backlog of frames once the mixers are back
+    _loopStartTime += now - _lastTickTime;
+    _lastTickTime = now;
+}
+
+void FarmBot::tick(quint64 now, NLPacketList* audioPacketList) {
+    _lastTickTime = now;
+
+    recording::Frame::Time position = (recording::Frame::Time)((now - _loopStartTime) / USECS_PER_MSEC);
+    while (_clip->positionFrameTime() <= position) {
+        playFrame(*_clip->nextFrame(), audioPacketList);
+    }
+    if (_clip->positionFrameTime() == recording::Frame::INVALID_TIME) {
+        _clip->seekFrameTime(0);
+        _avatarFrameDecoder.reset();
+        _loopStartTime = now;
+    }
+}
+
+void FarmBot::playFrame(const recording::Frame& frame, NLPacketList* audioPacketList) {
+    static const recording::FrameType AVATAR_FRAME_TYPE = recording::Frame::registerFrameType(AvatarData::FRAME_NAME);
+    static const recording::FrameType AUDIO_FRAME_TYPE =
+        recording::Frame::registerFrameType(AudioConstants::getAudioFrameName());
+
+    if (frame.type == AVATAR_FRAME_TYPE) {
+        AvatarData::fromFrame(frame.data, _avatar, _avatarFrameDecoder);
+    } else if (frame.type == AUDIO_FRAME_TYPE && audioPacketList) {
+        writeAudio(frame.data, *audioPacketList);
+    }
+}
+
+void FarmBot::writeAudio(const QByteArray& samples, NLPacketList& audioPacketList) {
+    auto pcm = reinterpret_cast<const int16_t*>(samples.constData());
+    int numSamples = samples.size() / AudioConstants::SAMPLE_SIZE;
+    int32_t loudness = 0;
+    for (int i = 0; i < numSamples; ++i) {
+        loudness += std::abs((int32_t)pcm[i]);
+    }
+    float averageLoudness = numSamples > 0 ? (float)loudness / numSamples : 0.0f;
+    _avatar.setAudioLoudness(averageLoudness);
+
+    // the stream properties are laid out the way AudioInjector writes them, QDataStream encoding included
+    QByteArray properties;
+    {
+        QDataStream stream(&properties, QIODevice::WriteOnly);
+        stream << _id;
+
+        // recorded audio is mono, and is not looped back
+        stream << false;
+        stream << (uchar)0;
+
+        glm::vec3 position = _avatar.getPosition();
+        glm::quat orientation = _avatar.getHeadOrientation();
+        glm::vec3 boxCorner = glm::vec3(0);
+        stream.writeRawData(reinterpret_cast<const char*>(&position), sizeof(position));
+        stream.writeRawData(reinterpret_cast<const char*>(&orientation), sizeof(orientation));
+        stream.writeRawData(reinterpret_cast<const char*>(&position), sizeof(position));
+        stream.writeRawData(reinterpret_cast<const char*>(&boxCorner), sizeof(boxCorner));
+
+        // a point source at full volume
+        stream << 0.0f;
+        stream << packFloatGainToByte(1.0f);
+        stream << false;
+    }
+
+    // one frame per packet, the mixer parses each InjectAudio packet as a single frame
+    audioPacketList.startSegment();
+    audioPacketList.writePrimitive(_audioSequenceNumber++);
+    audioPacketList.writeString(INJECTED_CODEC_NAME);
+    audioPacketList.write(properties);
+    audioPacketList.write(samples);
+    audioPacketList.endSegment();
+    audioPacketList.closeCurrentPacket();
+}
+
+void FarmBot::writeAvatarData(NLPacketList& packetList) {
+    // the mixer can't assume it has seen any previous update from us, so like a mixer replicating an avatar
+    // downstream we always send all of it
+    AvatarDataPacket::HasFlags flagsOut;
+    QVector<JointData> noLastSentJointData { _avatar.getJointCount() };
+    QByteArray avatarByteArray = _avatar.toByteArray(AvatarData::SendAllData, 0, noLastSentJointData,
+                                                     flagsOut, false, false, glm::vec3(0), nullptr);
+
+    int maxAvatarByteArraySize = (int)(packetList.getMaxSegmentSize() - NUM_BYTES_RFC4122_UUID - sizeof(quint16)
+        - sizeof(AvatarDataSequenceNumber));
+    if (avatarByteArray.size() > maxAvatarByteArraySize) {
+        avatarByteArray = _avatar.toByteArray(AvatarData::SendAllData, 0, noLastSentJointData,
+                                              flagsOut, true, false, glm::vec3(0), nullptr);
+        if (avatarByteArray.size() > maxAvatarByteArraySize) {
+            avatarByteArray = _avatar.toByteArray(AvatarData::MinimumData, 0, noLastSentJointData,
+                                                  flagsOut, true, false, glm::vec3(0), nullptr);
+            if (avatarByteArray.size() > maxAvatarByteArraySize) {
+                return;
+            }
+        }
+    }
+
+    packetList.startSegment();
+    packetList.write(_id.toRfc4122());
+    packetList.writePrimitive((quint16)(avatarByteArray.size() + sizeof(AvatarDataSequenceNumber)));
+    packetList.writePrimitive(_avatarSequenceNumber++);
+    packetList.write(avatarByteArray);
+    packetList.endSegment();
+}
+
+void FarmBot::sendIdentity(quint64 now, NodeList& nodeList, const SharedNodePointer& avatarMixer) {
+    auto identityPacket = NLPacketList::create(PacketType::ReplicatedAvatarIdentity, QByteArray(), true, true);
+    identityPacket->write(_avatar.identityByteArray(true));
+    nodeList.sendPacketList(std::move(identityPacket), *avatarMixer);
+    _nextIdentityTime = now + AVATAR_IDENTITY_PACKET_SEND_INTERVAL_MSECS * USECS_PER_MSEC;
+}
+
+int BotFarm::getBotCount() const {
+    QMutexLocker locker(&_statsMutex);
+    return _botCount;
+}
+
+void BotFarm::addBots(int count, const QString& clipURL, const glm::vec3& center, float spacing) {
+    if (!_hasThread) {
+        // only a farm that is actually used gets a thread
+        _hasThread = true;
+        moveToNewNamedThread(this, "BotFarm Thread");
+    }
+
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "addBots", Q_ARG(int, count), Q_ARG(const QString&, clipURL),
+                                  Q_ARG(const glm::vec3&, center), Q_ARG(float, spacing));
+        return;
+    }
+
+    if (count <= 0) {
+        return;
+    }
+    start();
+
+    PendingBots pending { count, center, spacing };
+    auto itr = _clips.find(clipURL);
+    if (itr != _clips.end() && itr->loader->isLoaded()) {
+        spawnBots(itr->loader->getClip(), pending);
+        return;
+    }
+    if (itr != _clips.end()) {
+        itr->pending.push_back(pending);
+        return;
+    }
+
+    // every bot playing this URL shares the ClipCache download, each bot only adds a cursor of its own over it
+    SharedClip& sharedClip = _clips[clipURL];
+    sharedClip.pending.push_back(pending);
+    sharedClip.loader = DependencyManager::get<recording::ClipCache>()->getClipLoader(clipURL);
+    connect(sharedClip.loader.data(), &Resource::finished, this, &BotFarm::clipLoaded);
+    if (sharedClip.loader->isLoaded()) {
+        clipLoaded();
+    }
+}
+
+void BotFarm::clipLoaded() {
+    for (auto itr = _clips.begin(); itr != _clips.end(); ++itr) {
+        SharedClip& sharedClip = itr.value();
+        if (sharedClip.pending.empty() || !sharedClip.loader->completed()) {
+            continue;
+        }
+
+        if (!sharedClip.loader->isLoaded()) {
+            qWarning() << "BotFarm: failed to load" << itr.key() << "- dropping" << sharedClip.pending.size() << "bot requests";
+            sharedClip.pending.clear();
+            continue;
+        }
+
+        auto clip = sharedClip.loader->getClip();
+        qDebug() << "BotFarm: loaded" << itr.key() << "with" << clip->frameCount() << "frames";
+
+        for (const auto& pending : sharedClip.pending) {
+            spawnBots(clip, pending);
+        }
+        sharedClip.pending.clear();
+    }
+}
+
+void BotFarm::spawnBots(const recording::ClipConstPointer& clip, const PendingBots& pending) {
+    int side = (int)ceilf(sqrtf((float)pending.count));
+    quint64 now = usecTimestampNow();
+    for (int i = 0; i < pending.count; i++) {
+        glm::vec3 offset((float)(i % side) - 0.5f * (float)side, 0.0f, (float)(i / side) - 0.5f * (float)side);
+        int index = (int)_bots.size();
+        _bots.emplace_back(new FarmBot(index, clip, pending.center + pending.spacing * offset, now));
+    }
+
+    qDebug() << "BotFarm: added" << pending.count << "bots, now hosting" << _bots.size();
+
+    QMutexLocker locker(&_statsMutex);
+    _botCount = (int)_bots.size();
+}
+
+void BotFarm::removeAllBots() {
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "removeAllBots");
+        return;
+    }
+
+    // tell the avatar mixer the bots are gone right away, rather than letting it time them out
+    auto nodeList = DependencyManager::get<NodeList>();
+    SharedNodePointer avatarMixer = nodeList->soloNodeOfType(NodeType::AvatarMixer);
+    if (avatarMixer && avatarMixer->getActiveSocket()) {
+        auto killPacket = NLPacket::create(PacketType::ReplicatedKillAvatar,
+                                           NUM_BYTES_RFC4122_UUID + sizeof(KillAvatarReason));
+        for (auto& bot : _bots) {
+            killPacket->reset();
+            killPacket->write(bot->getID().toRfc4122());
+            killPacket->writePrimitive(KillAvatarReason::AvatarDisconnected);
+            nodeList->sendUnreliablePacket(*killPacket, *avatarMixer);
+        }
+    }
+
+    _bots.clear();
+    for (auto& sharedClip : _clips) {
+        sharedClip.pending.clear();
+    }
+
+    QMutexLocker locker(&_statsMutex);
+    _botCount = 0;
+}
+
+void BotFarm::stop() {
+    removeAllBots();
+    if (_tickTimer) {
+        _tickTimer->stop();
+    }
+    // our thread, if we have one, quits once we are destroyed
+    deleteLater();
+}
+
+void BotFarm::start() {
+    if (_tickTimer) {
+        return;
+    }
+
+    _tickTimer = new QTimer(this);
+    _tickTimer->setTimerType(Qt::PreciseTimer);
+    _tickTimer->setInterval(TICK_INTERVAL_MSECS);
+    connect(_tickTimer, &QTimer::timeout, this, &BotFarm::tick);
+    _tickTimer->start();
+
+    _statsStartTime = usecTimestampNow();
+    _statsStartClock = std::clock();
+}
+
+void BotFarm::tick() {
+    quint64 start = usecTimestampNow();
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    SharedNodePointer avatarMixer = nodeList->soloNodeOfType(NodeType::AvatarMixer);
+    if (avatarMixer && !avatarMixer->getActiveSocket()) {
+        avatarMixer.reset();
+    }
+    SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
+    if (audioMixer && !audioMixer->getActiveSocket()) {
+        audioMixer.reset();
+    }
+
+    // the tick's audio frames of all bots go out together, each in a packet of its own
+    std::unique_ptr<NLPacketList> audioPacketList;
+    if (avatarMixer && audioMixer) {
+        audioPacketList = NLPacketList::create(PacketType::InjectAudio);
+    }
+
+    quint64 botStart = start;
+    for (auto& bot : _bots) {
+        if (avatarMixer) {
+            bot->tick(botStart, audioPacketList.get());
+        } else {
+            bot->hold(botStart);
+        }
+        quint64 botEnd = usecTimestampNow();
+        bot->addUsecsSpent(botEnd - botStart);
+        botStart = botEnd;
+    }
+
+    if (audioPacketList && audioPacketList->getNumPackets() > 0) {
+        _numAudioPackets += (int)audioPacketList->getNumPackets();
+        nodeList->sendPacketList(*audioPacketList, *audioMixer);
+    }
+
+    // one avatar-data pass for all bots keeps them at the Agent rate without a timer each
+    if (avatarMixer && botStart >= _nextAvatarDataTime) {
+        _nextAvatarDataTime += AVATAR_DATA_INTERVAL_USECS;
+        if (_nextAvatarDataTime < botStart) {
+            _nextAvatarDataTime = botStart + AVATAR_DATA_INTERVAL_USECS;
+        }
+        sendAvatarData(botStart, *nodeList, avatarMixer);
+        botStart = usecTimestampNow();
+    }
+
+    _tickUsecs += botStart - start;
+    _numTicks++;
+
+    if (botStart - _statsStartTime >= USECS_PER_SECOND) {
+        updateStats(botStart);
+    }
+}
+
+void BotFarm::sendAvatarData(quint64 now, NodeList& nodeList, const SharedNodePointer& avatarMixer) {
+    auto avatarPacketList = NLPacketList::create(PacketType::ReplicatedBulkAvatarData);
+
+    for (auto& bot : _bots) {
+        quint64 botStart = usecTimestampNow();
+        if (bot->isIdentityDue(now)) {
+            bot->sendIdentity(now, nodeList, avatarMixer);
+        }
+        bot->writeAvatarData(*avatarPacketList);
+        bot->addUsecsSpent(usecTimestampNow() - botStart);
+    }
+
+    if (avatarPacketList->getNumPackets() > 0) {
+        // close the current packet so that we're always sending something
+        avatarPacketList->closeCurrentPacket(true);
+        _numAvatarPackets += (int)avatarPacketList->getNumPackets();
+        nodeList.sendPacketList(std::move(avatarPacketList), *avatarMixer);
+    }
+}
+
+void BotFarm::updateStats(quint64 now) {
+    std::clock_t clock = std::clock();
+    float elapsedUsecs = (float)(now - _statsStartTime);
+    float processUsecs = (float)(clock - _statsStartClock) * (float)USECS_PER_SECOND / (float)CLOCKS_PER_SEC;
+
+    QJsonObject stats;
+    QJsonObject perBot;
+    for (auto& bot : _bots) {
+        perBot[QString::number(bot->getIndex())] = 100.0f * (float)bot->getUsecsSpent() / elapsedUsecs;
+        bot->resetUsecsSpent();
+    }
+
+    stats["bots"] = (int)_bots.size();
+    stats["ticks_per_s"] = (float)_numTicks * (float)USECS_PER_SECOND / elapsedUsecs;
+    stats["avatar_packets_per_s"] = (float)_numAvatarPackets * (float)USECS_PER_SECOND / elapsedUsecs;
+    stats["audio_packets_per_s"] = (float)_numAudioPackets * (float)USECS_PER_SECOND / elapsedUsecs;
+    stats["avg_tick_usecs"] = _numTicks > 0 ? (float)_tickUsecs / (float)_numTicks : 0.0f;
+    stats["farm_thread_cpu_percent"] = 100.0f * (float)_tickUsecs / elapsedUsecs;
+    stats["process_cpu_percent"] = 100.0f * processUsecs / elapsedUsecs;
+    stats["per_bot_cpu_percent"] = perBot;
+
+    _statsStartTime = now;
+    _statsStartClock = clock;
+    _tickUsecs = 0;
+    _numTicks = 0;
+    _numAvatarPackets = 0;
+    _numAudioPackets = 0;
+
+    QMutexLocker locker(&_statsMutex);
+    _stats = stats;
+}
+
+QJsonObject BotFarm::getStatsJson() const {
+    QMutexLocker locker(&_statsMutex);
+    return _stats;
+}
+
+QVariantMap BotFarm::getStats() const {
+    return getStatsJson().toVariantMap();
+}
@@ -0,0 +1,145 @@
+//
+//  BotFarm.h
+//  assignment-client/src/bots
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BotFarm_h
+#define hifi_BotFarm_h
+
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QUuid>
+#include <QtCore/QVariantMap>
+
+#include <glm/glm.hpp>
+
+#include <AvatarData.h>
+#include <NodeList.h>
+#include <recording/ClipCache.h>
+#include <recording/Frame.h>
+
+// A recorded avatar played back by the BotFarm.  A bot is not a node of its own: the farm sends its avatar data to the
+// avatar mixer as replicated packets, under a session ID the bot makes up for itself, and its audio to the audio mixer
+// as an injected stream of the Agent, identified by that same ID.
+class FarmBot {
+public:
+    FarmBot(int index, const recording::ClipConstPointer& clip, const glm::vec3& position, quint64 now);
+
+    int getIndex() const { return _index; }
+    const QUuid& getID() const { return _id; }
+
+    // plays the frames that are due, appending their audio to an InjectAudio packet list, if there is one
+    void tick(quint64 now, NLPacketList* audioPacketList);
+    // pauses the clip, for when the avatar mixer isn't there to see it
+    void hold(quint64 now);
+
+    // appends this bot's avatar data to a ReplicatedBulkAvatarData packet list, as one segment
+    void writeAvatarData(NLPacketList& packetList);
+    bool isIdentityDue(quint64 now) const { return now >= _nextIdentityTime; }
+    void sendIdentity(quint64 now, NodeList& nodeList, const SharedNodePointer& avatarMixer);
+
+    quint64 getUsecsSpent() const { return _usecsSpent; }
+    void addUsecsSpent(quint64 usecs) { _usecsSpent += usecs; }
+    void resetUsecsSpent() { _usecsSpent = 0; }
+
+private:
+    void playFrame(const recording::Frame& frame, NLPacketList* audioPacketList);
+    void writeAudio(const QByteArray& samples, NLPacketList& audioPacketList);
+
+    int _index;
+    QUuid _id;
+    AvatarData _avatar;
+    AvatarFrameDecoder _avatarFrameDecoder;
+
+    // a cursor of our own over the shared clip, frames are decoded as they are played
+    recording::ClipPointer _clip;
+    quint64 _loopStartTime;
+    quint64 _lastTickTime;
+    quint64 _nextIdentityTime;
+
+    AvatarDataSequenceNumber _avatarSequenceNumber { 0 };
+    quint16 _audioSequenceNumber { 0 };
+
+    quint64 _usecsSpent { 0 };
+};
+
+// Hosts many recorded avatars in one Agent for load-testing the mixers.  The bots share the Agent's NodeList, one
+// thread and one fixed-rate tick: each avatar-data pass goes to the avatar mixer as one ReplicatedBulkAvatarData
+// packet list for all of them, and each tick's audio goes to the audio mixer as one InjectAudio packet list.  The avatar
+// mixer only takes replicated packets from upstream servers, so the domain must list the farm's address and port as an
+// upstream avatar mixer; the audio mixer takes injected audio from any Agent.
+class BotFarm : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int botCount READ getBotCount)
+public:
+    // Agents only get a BotFarm when their assignment is in this pool
+    static const QString ASSIGNMENT_POOL;
+    static const float DEFAULT_BOT_SPACING;
+
+    int getBotCount() const;
+
+    /// Adds count bots playing the clip at clipURL in a loop, laid out on a grid around center.
+    Q_INVOKABLE void addBots(int count, const QString& clipURL, const glm::vec3& center,
+                             float spacing = DEFAULT_BOT_SPACING);
+    Q_INVOKABLE void removeAllBots();
+
+    Q_INVOKABLE QVariantMap getStats() const;
+    QJsonObject getStatsJson() const;
+
+public slots:
+    // removes the bots and deletes the farm on the thread it lives on
+    void stop();
+
+private slots:
+    void tick();
+    void clipLoaded();
+
+private:
+    struct PendingBots {
+        int count;
+        glm::vec3 center;
+        float spacing;
+    };
+
+    struct SharedClip {
+        recording::NetworkClipLoaderPointer loader;
+        std::vector<PendingBots> pending;
+    };
+
+    void start();
+    void spawnBots(const recording::ClipConstPointer& clip, const PendingBots& pending);
+    void sendAvatarData(quint64 now, NodeList& nodeList, const SharedNodePointer& avatarMixer);
+    void updateStats(quint64 now);
+
+    bool _hasThread { false };
+    QTimer* _tickTimer { nullptr };
+    QHash<QString, SharedClip> _clips;
+    std::vector<std::unique_ptr<FarmBot>> _bots;
+
+    quint64 _nextAvatarDataTime { 0 };
+
+    quint64 _statsStartTime { 0 };
+    std::clock_t _statsStartClock { 0 };
+    quint64 _tickUsecs { 0 };
+    int _numTicks { 0 };
+    int _numAvatarPackets { 0 };
+    int _numAudioPackets { 0 };
+
+    mutable QMutex _statsMutex;
+    QJsonObject _stats; // guarded by _statsMutex
+    int _botCount { 0 }; // guarded by _statsMutex
+};
+
+#endif // hifi_BotFarm_h
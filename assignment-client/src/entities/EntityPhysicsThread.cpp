@@ -0,0 +1,161 @@
+//
+//  EntityPhysicsThread.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPhysicsThread.h"
+
+#include <algorithm>
+
+#include <QtCore/QLocale>
+
+#include <NodeList.h>
+#include <PhysicsHelpers.h>
+#include <SharedUtil.h>
+
+const int EntityPhysicsThread::DEFAULT_STEP_RATE = 45; // Hz
+const int EntityPhysicsThread::DEFAULT_STEP_BUDGET_MSECS = 8;
+
+EntityPhysicsThread::EntityPhysicsThread(EntityTreePointer tree, ServerPhysicalEntitySimulationPointer simulation,
+                                         int stepRate, int stepBudgetMsecs) :
+    _tree(tree),
+    _simulation(simulation),
+    _physicsEngine(new PhysicsEngine(Vectors::ZERO)),
+    _stepInterval(USECS_PER_SECOND / std::max(stepRate, 1)),
+    _stepBudget(std::max(stepBudgetMsecs, 1) * USECS_PER_MSEC)
+{
+    _physicsEngine->init();
+
+    // everything the simulation would normally send to an entity-server is fed straight back into our own tree
+    _editSender.setLocalEditHandler([this](PacketType type, const EntityItemID& entityID,
+                                           const EntityItemProperties& properties) {
+        _localEdits.push_back({ entityID, properties });
+    });
+    _simulation->init(_tree, _physicsEngine, &_shapeManager, &_editSender);
+}
+
+EntityPhysicsThread::~EntityPhysicsThread() {
+    // detaching the simulation pulls every object out of the engine while our ShapeManager is still around
+    _tree->setSimulation(nullptr);
+}
+
+bool EntityPhysicsThread::process() {
+    quint64 start = usecTimestampNow();
+    if (start < _nextStepTime) {
+        // don't sleep through a whole interval so that terminate() doesn't have to wait on us
+        const quint64 MAX_SLEEP_USECS = 10 * USECS_PER_MSEC;
+        usleep((int)std::min(_nextStepTime - start, MAX_SLEEP_USECS));
+        return isStillRunning();
+    }
+
+    step();
+
+    quint64 end = usecTimestampNow();
+    quint64 elapsed = end - start;
+    _stepTime.updateAverage((float)elapsed);
+    _averageStepUsecs = _stepTime.getAverage();
+    if (elapsed > _maxStepUsecs) {
+        _maxStepUsecs = elapsed;
+    }
+    _numSteps++;
+
+    // PhysicsEngine measures its own timestep so we never need to catch up.  When a step runs over budget we
+    // additionally back off by the overrun, which keeps the tree lock available to the send and persist threads.
+    _nextStepTime = start + _stepInterval;
+    if (elapsed > _stepBudget) {
+        _numOverBudgetSteps++;
+        _nextStepTime = end + (elapsed - _stepBudget);
+    }
+
+    return isStillRunning();
+}
+
+void EntityPhysicsThread::step() {
+    QUuid sessionID = DependencyManager::get<NodeList>()->getSessionUUID();
+    if (sessionID != Physics::getSessionUUID()) {
+        Physics::setSessionUUID(sessionID);
+    }
+
+    // pull the changes the tree's threads queued since the last step
+    _tree->withWriteLock([&] {
+        _simulation->applyIncomingChanges();
+
+        _simulation->getObjectsToRemoveFromPhysics(_motionStates);
+        _physicsEngine->removeObjects(_motionStates);
+        _simulation->deleteObjectsRemovedFromPhysics();
+
+        _simulation->getObjectsToAddToPhysics(_motionStates);
+        _physicsEngine->addObjects(_motionStates);
+
+        _simulation->getObjectsToChange(_motionStates);
+        VectorOfMotionStates stillNeedChange = _physicsEngine->changeObjects(_motionStates);
+        _simulation->setObjectsToChange(stillNeedChange);
+
+        _simulation->applyDynamicChanges();
+        _physicsEngine->forEachDynamic([&](EntityDynamicPointer dynamic) {
+            dynamic->prepareForPhysicsSimulation();
+        });
+    });
+
+    // the step itself runs without the tree lock: results only reach the entities when the motion states are
+    // synchronized below, and everything else that touches an entity during the step goes through its own locks
+    _physicsEngine->stepSimulation();
+
+    if (_physicsEngine->hasOutgoingChanges()) {
+        // nothing on the entity-server consumes collision events, but harvesting them keeps the contact map pruned
+        _physicsEngine->getCollisionEvents();
+
+        _tree->withWriteLock([&] {
+            const VectorOfMotionStates& outgoingChanges = _physicsEngine->getChangedMotionStates();
+            _simulation->volunteerForOrphans(outgoingChanges);
+            _simulation->handleChangedMotionStates(outgoingChanges);
+
+            const VectorOfMotionStates& deactivations = _physicsEngine->getDeactivatedMotionStates();
+            _simulation->handleDeactivatedMotionStates(deactivations);
+
+            // apply the whole batch while we still hold the lock
+            applyLocalEdits();
+        });
+    }
+
+    _numSubsteps = _physicsEngine->getNumSubsteps();
+    _numPhysicalObjects = _simulation->getNumPhysicalObjects();
+}
+
+void EntityPhysicsThread::applyLocalEdits() {
+    for (auto& edit : _localEdits) {
+        // a null sender means the edit comes from our own session, which is the simulation owner we bid with
+        if (_tree->updateEntity(edit.entityID, edit.properties)) {
+            _numEditsApplied++;
+        }
+    }
+    _localEdits.clear();
+}
+
+QString EntityPhysicsThread::getStatsString() const {
+    QLocale locale(QLocale::English);
+    QString statsString;
+
+    statsString += "<b>Entity Server Physics Statistics</b>\r\n";
+    statsString += QString("            Step rate: %1 Hz\r\n")
+        .arg(locale.toString((double)USECS_PER_SECOND / (double)_stepInterval, 'f', 1));
+    statsString += QString("          Step budget: %1 msecs\r\n")
+        .arg(locale.toString((double)_stepBudget / (double)USECS_PER_MSEC, 'f', 1));
+    statsString += QString("    Physical entities: %1\r\n").arg(locale.toString(_numPhysicalObjects.load()));
+    statsString += QString("                Steps: %1\r\n").arg(locale.toString(_numSteps.load()));
+    statsString += QString("             Substeps: %1\r\n").arg(locale.toString(_numSubsteps.load()));
+    statsString += QString("    Average step time: %1 msecs\r\n")
+        .arg(locale.toString((double)_averageStepUsecs.load() / (double)USECS_PER_MSEC, 'f', 3));
+    statsString += QString("        Max step time: %1 msecs\r\n")
+        .arg(locale.toString((double)_maxStepUsecs.load() / (double)USECS_PER_MSEC, 'f', 3));
+    statsString += QString("    Steps over budget: %1\r\n").arg(locale.toString(_numOverBudgetSteps.load()));
+    statsString += QString("        Edits applied: %1\r\n").arg(locale.toString(_numEditsApplied.load()));
+    statsString += "\r\n\r\n";
+
+    return statsString;
+}
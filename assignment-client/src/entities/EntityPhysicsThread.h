@@ -0,0 +1,76 @@
+//
+//  EntityPhysicsThread.h
+//  assignment-client/src/entities
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPhysicsThread_h
+#define hifi_EntityPhysicsThread_h
+
+#include <atomic>
+#include <vector>
+
+#include <EntityEditPacketSender.h>
+#include <EntityTree.h>
+#include <GenericThread.h>
+#include <PhysicsEngine.h>
+#include <ShapeManager.h>
+#include <SimpleMovingAverage.h>
+
+#include "ServerPhysicalEntitySimulation.h"
+
+/// Steps a headless PhysicsEngine over the entity-server's tree at a fixed rate.  Results are written straight back
+/// into the tree as edits from the server's own session, so the EntityTreeSendThreads pick them up like any other change.
+class EntityPhysicsThread : public GenericThread {
+    Q_OBJECT
+public:
+    static const int DEFAULT_STEP_RATE;
+    static const int DEFAULT_STEP_BUDGET_MSECS;
+
+    EntityPhysicsThread(EntityTreePointer tree, ServerPhysicalEntitySimulationPointer simulation,
+                        int stepRate = DEFAULT_STEP_RATE, int stepBudgetMsecs = DEFAULT_STEP_BUDGET_MSECS);
+    ~EntityPhysicsThread();
+
+    QString getStatsString() const;
+
+protected:
+    /// Implements generic processing behavior for this thread.
+    virtual bool process() override;
+
+private:
+    struct LocalEdit {
+        EntityItemID entityID;
+        EntityItemProperties properties;
+    };
+
+    void step();
+    void applyLocalEdits();
+
+    EntityTreePointer _tree;
+    ServerPhysicalEntitySimulationPointer _simulation;
+    PhysicsEnginePointer _physicsEngine;
+    ShapeManager _shapeManager;
+    EntityEditPacketSender _editSender;
+
+    VectorOfMotionStates _motionStates;
+    std::vector<LocalEdit> _localEdits;
+
+    quint64 _stepInterval;
+    quint64 _stepBudget;
+    quint64 _nextStepTime { 0 };
+
+    SimpleMovingAverage _stepTime;
+    std::atomic<float> _averageStepUsecs { 0.0f };
+    std::atomic<quint64> _maxStepUsecs { 0 };
+    std::atomic<quint64> _numSteps { 0 };
+    std::atomic<quint64> _numSubsteps { 0 };
+    std::atomic<quint64> _numOverBudgetSteps { 0 };
+    std::atomic<quint64> _numEditsApplied { 0 };
+    std::atomic<int> _numPhysicalObjects { 0 };
+};
+
+#endif // hifi_EntityPhysicsThread_h
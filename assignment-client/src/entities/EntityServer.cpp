@@ -19,9 +19,11 @@
 
 #include "AssignmentParentFinder.h"
 #include "EntityNodeData.h"
+#include "EntityPhysicsThread.h"
 #include "EntityServer.h"
 #include "EntityServerConsts.h"
 #include "EntityTreeSendThread.h"
+#include "ServerPhysicalEntitySimulation.h"
 
 const char* MODEL_SERVER_NAME = "Entity";
 const char* MODEL_SERVER_LOGGING_TARGET_NAME = "entity-server";
@@ -46,6 +48,11 @@ EntityServer::~EntityServer() {
         _pruneDeletedEntitiesTimer->deleteLater();
     }
 
+    if (_physicsThread) {
+        _physicsThread->terminate();
+        _physicsThread.reset();
+    }
+
     EntityTreePointer tree = std::static_pointer_cast<EntityTree>(_tree);
     tree->removeNewlyCreatedHook(this);
 }
@@ -53,6 +60,10 @@ EntityServer::~EntityServer() {
 void EntityServer::aboutToFinish() {
     DependencyManager::get<ResourceManager>()->cleanup();
 
+    if (_physicsThread) {
+        _physicsThread->terminate();
+    }
+
     OctreeServer::aboutToFinish();
 }
 
@@ -93,6 +104,10 @@ void EntityServer::beforeRun() {
     connect(_pruneDeletedEntitiesTimer, SIGNAL(timeout()), this, SLOT(pruneDeletedEntities()));
     const int PRUNE_DELETED_MODELS_INTERVAL_MSECS = 1 * 1000; // once every second
     _pruneDeletedEntitiesTimer->start(PRUNE_DELETED_MODELS_INTERVAL_MSECS);
+
+    if (_physicsThread) {
+        _physicsThread->initialize(true);
+    }
 }
 
 void EntityServer::entityCreated(const EntityItem& newEntity, const SharedNodePointer& senderNode) {
@@ -315,6 +330,28 @@ void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectio
         
         entityEditFilters->addFilter(EntityItemID(), filterURL);
     }
+
+    bool serverSidePhysics = false;
+    readOptionBool(QString("serverSidePhysics"), settingsSectionObject, serverSidePhysics);
+    qDebug("serverSidePhysics=%s", debug::valueOf(serverSidePhysics));
+
+    if (serverSidePhysics && !_physicsThread) {
+        int physicsStepRate;
+        if (!readOptionInt("physicsStepRate", settingsSectionObject, physicsStepRate) || physicsStepRate <= 0) {
+            physicsStepRate = EntityPhysicsThread::DEFAULT_STEP_RATE;
+        }
+        int physicsStepBudget;
+        if (!readOptionInt("physicsStepBudget", settingsSectionObject, physicsStepBudget) || physicsStepBudget <= 0) {
+            physicsStepBudget = EntityPhysicsThread::DEFAULT_STEP_BUDGET_MSECS;
+        }
+        qDebug() << "server-side physics at" << physicsStepRate << "Hz with a budget of" << physicsStepBudget << "msecs";
+
+        // the persist thread hasn't loaded anything yet, so swapping simulations doesn't lose any state
+        _physicsSimulation = ServerPhysicalEntitySimulationPointer(new ServerPhysicalEntitySimulation());
+        _physicsThread.reset(new EntityPhysicsThread(tree, _physicsSimulation, physicsStepRate, physicsStepBudget));
+        tree->setSimulation(_physicsSimulation);
+        _entitySimulation.reset();
+    }
 }
 
 void EntityServer::entityFilterAdded(EntityItemID id, bool success) {
@@ -355,6 +392,9 @@ void EntityServer::trackViewerGone(const QUuid& sessionID) {
     if (_entitySimulation) {
         _entitySimulation->clearOwnership(sessionID);
     }
+    if (_physicsSimulation) {
+        _physicsSimulation->clearOwnership(sessionID);
+    }
 }
 
 QString EntityServer::serverSubclassStats() {
@@ -367,6 +407,10 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    if (_physicsThread) {
+        statsString += _physicsThread->getStatsString();
+    }
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
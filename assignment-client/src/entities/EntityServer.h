@@ -29,6 +29,9 @@ struct ViewerSendingStats {
 
 class SimpleEntitySimulation;
 using SimpleEntitySimulationPointer = std::shared_ptr<SimpleEntitySimulation>;
+class ServerPhysicalEntitySimulation;
+using ServerPhysicalEntitySimulationPointer = std::shared_ptr<ServerPhysicalEntitySimulation>;
+class EntityPhysicsThread;
 
 
 class EntityServer : public OctreeServer, public NewlyCreatedEntityHook {
@@ -76,6 +79,8 @@ private slots:
 
 private:
     SimpleEntitySimulationPointer _entitySimulation;
+    ServerPhysicalEntitySimulationPointer _physicsSimulation;
+    std::unique_ptr<EntityPhysicsThread> _physicsThread;
     QTimer* _pruneDeletedEntitiesTimer = nullptr;
 
     QReadWriteLock _viewerSendingStatsLock;
@@ -0,0 +1,185 @@
+//
+//  ServerPhysicalEntitySimulation.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ServerPhysicalEntitySimulation.h"
+
+#include <DirtyOctreeElementOperator.h>
+#include <SimulationOwner.h>
+
+bool ServerPhysicalEntitySimulation::canComputeShapeOnServer(ShapeType type) {
+    // these shapes are built from model geometry, which only exists on the clients
+    switch (type) {
+        case SHAPE_TYPE_COMPOUND:
+        case SHAPE_TYPE_SIMPLE_HULL:
+        case SHAPE_TYPE_SIMPLE_COMPOUND:
+        case SHAPE_TYPE_STATIC_MESH:
+            return false;
+        default:
+            return true;
+    }
+}
+
+void ServerPhysicalEntitySimulation::clearOwnership(const QUuid& ownerID) {
+    QMutexLocker lock(&_mutex);
+    SetOfEntities::iterator itemItr = _entitiesWithSimulationOwner.begin();
+    while (itemItr != _entitiesWithSimulationOwner.end()) {
+        EntityItemPointer entity = *itemItr;
+        if (entity->getSimulatorID() == ownerID) {
+            // the simulator has abandoned this object --> remove from owned list
+            qDebug() << "auto-removing simulation owner " << entity->getSimulatorID();
+            itemItr = _entitiesWithSimulationOwner.erase(itemItr);
+
+            // remove ownership and dirty all the tree elements that contain it.  If the object is still moving
+            // the physics thread will volunteer for it the next time it is stepped.
+            entity->clearSimulationOwnership();
+            entity->markAsChangedOnServer();
+            DirtyOctreeElementOperator op(entity->getElement());
+            getEntityTree()->recurseTreeWithOperator(&op);
+            queueChange(ChangeInPhysics, entity);
+        } else {
+            ++itemItr;
+        }
+    }
+}
+
+void ServerPhysicalEntitySimulation::volunteerForOrphans(const VectorOfMotionStates& motionStates) {
+    for (auto state : motionStates) {
+        if (state->getType() == MOTIONSTATE_TYPE_ENTITY && state->getSimulatorID().isNull()) {
+            state->bump(VOLUNTEER_SIMULATION_PRIORITY);
+        }
+    }
+}
+
+int ServerPhysicalEntitySimulation::getNumPhysicalObjects() {
+    QMutexLocker lock(&_mutex);
+    return _physicalObjects.size();
+}
+
+void ServerPhysicalEntitySimulation::applyIncomingChanges() {
+    std::vector<IncomingChange> incomingChanges;
+    {
+        QMutexLocker lock(&_incomingChangesMutex);
+        incomingChanges.swap(_incomingChanges);
+    }
+
+    for (auto& change : incomingChanges) {
+        switch (change.type) {
+            case AddToPhysics:
+                // skip entities that were removed again before we got to them
+                if (change.entity->isSimulated()) {
+                    PhysicalEntitySimulation::addEntityInternal(change.entity);
+                }
+                break;
+            case RemoveFromPhysics:
+                removeFromPhysics(change.entity);
+                break;
+            case ChangeInPhysics:
+                if (change.entity->isSimulated()) {
+                    changeInPhysics(change.entity);
+                }
+                break;
+        }
+    }
+}
+
+void ServerPhysicalEntitySimulation::queueChange(ChangeType type, EntityItemPointer entity) {
+    QMutexLocker lock(&_incomingChangesMutex);
+    _incomingChanges.push_back({ type, entity });
+}
+
+void ServerPhysicalEntitySimulation::addEntityInternal(EntityItemPointer entity) {
+    if (canComputeShapeOnServer(entity->getShapeType())) {
+        queueChange(AddToPhysics, entity);
+    } else {
+        EntitySimulation::addEntityInternal(entity);
+    }
+    updateOwnership(entity);
+}
+
+void ServerPhysicalEntitySimulation::removeEntityInternal(EntityItemPointer entity) {
+    if (entity->isSimulated()) {
+        // the lists the tree's threads work on are cleared right away, the physical side waits for the physics thread
+        EntitySimulation::removeEntityInternal(entity);
+        queueChange(RemoveFromPhysics, entity);
+    }
+    QMutexLocker lock(&_mutex);
+    _entitiesWithSimulationOwner.remove(entity);
+}
+
+void ServerPhysicalEntitySimulation::changeEntityInternal(EntityItemPointer entity) {
+    queueChange(ChangeInPhysics, entity);
+    updateOwnership(entity);
+}
+
+void ServerPhysicalEntitySimulation::clearEntitiesInternal() {
+    {
+        QMutexLocker lock(&_incomingChangesMutex);
+        _incomingChanges.clear();
+    }
+    PhysicalEntitySimulation::clearEntitiesInternal();
+    QMutexLocker lock(&_mutex);
+    _entitiesWithSimulationOwner.clear();
+}
+
+void ServerPhysicalEntitySimulation::removeFromPhysics(EntityItemPointer entity) {
+    QMutexLocker lock(&_mutex);
+    _entitiesToAddToPhysics.remove(entity);
+
+    EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
+    if (motionState) {
+        _outgoingChanges.remove(motionState);
+        _entitiesToRemoveFromPhysics.insert(entity);
+    } else {
+        _entitiesToDelete.insert(entity);
+    }
+}
+
+void ServerPhysicalEntitySimulation::changeInPhysics(EntityItemPointer entity) {
+    if (canComputeShapeOnServer(entity->getShapeType())) {
+        PhysicalEntitySimulation::changeEntityInternal(entity);
+        return;
+    }
+
+    {
+        QMutexLocker lock(&_mutex);
+        _entitiesToAddToPhysics.remove(entity);
+        EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
+        if (motionState) {
+            // the shape changed to something we can't build --> hand the entity back to the clients
+            _pendingChanges.remove(motionState);
+            _physicalObjects.remove(motionState);
+            _outgoingChanges.remove(motionState);
+            _entitiesToRemoveFromPhysics.insert(entity);
+        }
+    }
+    EntitySimulation::changeEntityInternal(entity);
+    // nothing downstream consumes the flags for these entities, so clear them here
+    entity->clearDirtyFlags();
+}
+
+void ServerPhysicalEntitySimulation::sortEntitiesThatMoved() {
+    // simple kinematic entities are moved here rather than by a client, so keep their query cubes current
+    SetOfEntities::iterator itemItr = _entitiesToSort.begin();
+    while (itemItr != _entitiesToSort.end()) {
+        EntityItemPointer entity = *itemItr;
+        entity->checkAndMaybeUpdateQueryAACube();
+        ++itemItr;
+    }
+    EntitySimulation::sortEntitiesThatMoved();
+}
+
+void ServerPhysicalEntitySimulation::updateOwnership(EntityItemPointer entity) {
+    QMutexLocker lock(&_mutex);
+    if (entity->getSimulatorID().isNull()) {
+        _entitiesWithSimulationOwner.remove(entity);
+    } else {
+        _entitiesWithSimulationOwner.insert(entity);
+    }
+}
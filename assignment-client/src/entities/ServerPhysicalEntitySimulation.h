@@ -0,0 +1,74 @@
+//
+//  ServerPhysicalEntitySimulation.h
+//  assignment-client/src/entities
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ServerPhysicalEntitySimulation_h
+#define hifi_ServerPhysicalEntitySimulation_h
+
+#include <memory>
+#include <vector>
+
+#include <PhysicalEntitySimulation.h>
+
+class ServerPhysicalEntitySimulation;
+using ServerPhysicalEntitySimulationPointer = std::shared_ptr<ServerPhysicalEntitySimulation>;
+
+/// PhysicalEntitySimulation used by the entity-server when it runs authoritative physics.  Entities whose collision
+/// shape can't be computed without model data (which the server never downloads) are left to the clients, and
+/// ownership is tracked so that it can be cleared when a simulating viewer goes away.
+///
+/// The tree's threads add, change and remove entities while the physics thread steps, so the physical side of
+/// those calls is only queued here.  The physics thread applies the queue with applyIncomingChanges(), which keeps
+/// the sets that feed the PhysicsEngine on that one thread.
+class ServerPhysicalEntitySimulation : public PhysicalEntitySimulation {
+public:
+    static bool canComputeShapeOnServer(ShapeType type);
+
+    void clearOwnership(const QUuid& ownerID);
+
+    /// Only called by the physics thread, with the tree locked for writing.
+    void applyIncomingChanges();
+
+    /// Upgrade the outgoing priority of changed objects that nobody owns so the server bids on them right away.
+    void volunteerForOrphans(const VectorOfMotionStates& motionStates);
+
+    int getNumPhysicalObjects();
+
+protected:
+    virtual void addEntityInternal(EntityItemPointer entity) override;
+    virtual void removeEntityInternal(EntityItemPointer entity) override;
+    virtual void changeEntityInternal(EntityItemPointer entity) override;
+    virtual void clearEntitiesInternal() override;
+
+    virtual void sortEntitiesThatMoved() override;
+
+private:
+    enum ChangeType {
+        AddToPhysics,
+        RemoveFromPhysics,
+        ChangeInPhysics
+    };
+
+    struct IncomingChange {
+        ChangeType type;
+        EntityItemPointer entity;
+    };
+
+    void queueChange(ChangeType type, EntityItemPointer entity);
+    void removeFromPhysics(EntityItemPointer entity);
+    void changeInPhysics(EntityItemPointer entity);
+    void updateOwnership(EntityItemPointer entity);
+
+    SetOfEntities _entitiesWithSimulationOwner;
+
+    QMutex _incomingChangesMutex;
+    std::vector<IncomingChange> _incomingChanges; // guarded by _incomingChangesMutex
+};
+
+#endif // hifi_ServerPhysicalEntitySimulation_h
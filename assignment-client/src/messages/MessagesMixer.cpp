@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QJsonObject>
 #include <QBuffer>
@@ -20,7 +22,17 @@
 
 const QString MESSAGES_MIXER_LOGGING_NAME = "messages-mixer";
 
-MessagesMixer::MessagesMixer(ReceivedMessage& message) : ThreadedAssignment(message)
+// above this many packet lists per second the fan-out moves to the slave pool, and below the lower
+// threshold it comes back to the event loop
+const int HIGH_LOAD_SENDS_PER_SECOND = 2000;
+const int LOW_LOAD_SENDS_PER_SECOND = 1000;
+
+// the number of channels broken out in the stats packet
+const int MAX_CHANNELS_IN_STATS = 25;
+
+MessagesMixer::MessagesMixer(ReceivedMessage& message) :
+    ThreadedAssignment(message),
+    _slavePool(std::max(1, QThread::idealThreadCount() / 2))
 {
     connect(DependencyManager::get<NodeList>().data(), &NodeList::nodeKilled, this, &MessagesMixer::nodeKilled);
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
@@ -30,40 +42,88 @@ MessagesMixer::MessagesMixer(ReceivedMessage& message) : ThreadedAssignment(mess
 }
 
 void MessagesMixer::nodeKilled(SharedNodePointer killedNode) {
-    for (auto& channel : _channelSubscribers) {
-        channel.remove(killedNode->getUUID());
+    auto channel = _channelSubscribers.begin();
+    while (channel != _channelSubscribers.end()) {
+        channel->remove(killedNode->getUUID());
+        if (channel->isEmpty()) {
+            channel = _channelSubscribers.erase(channel);
+        } else {
+            ++channel;
+        }
     }
 }
 
 void MessagesMixer::handleMessages(QSharedPointer<ReceivedMessage> receivedMessage, SharedNodePointer senderNode) {
-    QString channel, message;
-    QByteArray data;
-    QUuid senderID;
-    bool isText;
-    MessagesClient::decodeMessagesPacket(receivedMessage, channel, isText, message, data, senderID);
+    // only the channel is needed to route the message -- the rest of the payload is forwarded as it came in,
+    // which is byte for byte what MessagesClient::encodeMessagesPacket would produce for each recipient
+    quint16 channelLength;
+    receivedMessage->readPrimitive(&channelLength);
+    QString channel = QString::fromUtf8(receivedMessage->read(channelLength));
 
-    auto nodeList = DependencyManager::get<NodeList>();
+    MessagesMixerFanOut fanOut;
+    fanOut.payload = receivedMessage->getMessage();
 
-    nodeList->eachMatchingNode(
-        [&](const SharedNodePointer& node)->bool {
-        return node->getActiveSocket() && _channelSubscribers[channel].contains(node->getUUID());
-    },
-        [&](const SharedNodePointer& node) {
-        auto packetList = isText ? MessagesClient::encodeMessagesPacket(channel, message, senderID) :
-                                   MessagesClient::encodeMessagesDataPacket(channel, data, senderID);
-        nodeList->sendPacketList(std::move(packetList), *node);
-    });
+    auto subscribers = _channelSubscribers.find(channel);
+    if (subscribers != _channelSubscribers.end()) {
+        fanOut.recipients.reserve(subscribers->size());
+        for (auto& node : *subscribers) {
+            if (node->getActiveSocket()) {
+                fanOut.recipients.push_back(node);
+            }
+        }
+    }
+
+    ChannelStats& stats = _channelStats[channel];
+    stats.messages++;
+    stats.bytesIn += fanOut.payload.size();
+    stats.bytesOut += (quint64)fanOut.payload.size() * fanOut.recipients.size();
+
+    if (fanOut.recipients.empty()) {
+        return;
+    }
+
+    int numSends = (int)fanOut.recipients.size();
+    updateLoad(numSends);
+
+    // once anything is queued on the pool we keep using it until it drains, otherwise an inline send
+    // could overtake an earlier message on the same channel
+    if (_useSlavePool || !_slavePool.isIdle()) {
+        _slavePool.queue(channel, std::move(fanOut));
+        _pooledMessages++;
+    } else {
+        fanOut.send();
+    }
+}
+
+void MessagesMixer::updateLoad(int numSends) {
+    quint64 now = usecTimestampNow();
+    if (now - _loadWindowStart > USECS_PER_SECOND) {
+        bool useSlavePool = _useSlavePool ? _sendsInLoadWindow > LOW_LOAD_SENDS_PER_SECOND :
+                                            _sendsInLoadWindow > HIGH_LOAD_SENDS_PER_SECOND;
+        if (useSlavePool != _useSlavePool) {
+            qDebug() << (useSlavePool ? "Moving" : "Returning") << "message fan-out" << (useSlavePool ? "to" : "from")
+                     << "slave pool at" << _sendsInLoadWindow << "sends per second";
+            _useSlavePool = useSlavePool;
+        }
+        _loadWindowStart = now;
+        _sendsInLoadWindow = 0;
+    }
+    _sendsInLoadWindow += numSends;
 }
 
 void MessagesMixer::handleMessagesSubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
     QString channel = QString::fromUtf8(message->getMessage());
-    _channelSubscribers[channel] << senderNode->getUUID();
+    _channelSubscribers[channel].insert(senderNode->getUUID(), senderNode);
 }
 
 void MessagesMixer::handleMessagesUnsubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
     QString channel = QString::fromUtf8(message->getMessage());
-    if (_channelSubscribers.contains(channel)) {
-        _channelSubscribers[channel].remove(senderNode->getUUID());
+    auto subscribers = _channelSubscribers.find(channel);
+    if (subscribers != _channelSubscribers.end()) {
+        subscribers->remove(senderNode->getUUID());
+        if (subscribers->isEmpty()) {
+            _channelSubscribers.erase(subscribers);
+        }
     }
 }
 
@@ -80,6 +140,46 @@ void MessagesMixer::sendStatsPacket() {
     });
 
     statsObject["messages"] = messagesMixerObject;
+
+    // add stats for the busiest channels since the last stats packet
+    quint64 now = usecTimestampNow();
+    float secondsSinceLastStats = _lastStatsTime ? (float)(now - _lastStatsTime) / (float)USECS_PER_SECOND : 1.0f;
+    _lastStatsTime = now;
+
+    QVector<QHash<QString, ChannelStats>::const_iterator> busiestChannels;
+    busiestChannels.reserve(_channelStats.size());
+    for (auto channel = _channelStats.cbegin(); channel != _channelStats.cend(); ++channel) {
+        busiestChannels.push_back(channel);
+    }
+    int numChannels = std::min(busiestChannels.size(), MAX_CHANNELS_IN_STATS);
+    std::partial_sort(busiestChannels.begin(), busiestChannels.begin() + numChannels, busiestChannels.end(),
+        [](const QHash<QString, ChannelStats>::const_iterator& a, const QHash<QString, ChannelStats>::const_iterator& b) {
+            return a->messages > b->messages;
+        });
+
+    const float BYTES_PER_KILOBIT = 1000.0f / 8.0f;
+    QJsonObject channelsObject;
+    for (int i = 0; i < numChannels; ++i) {
+        auto channel = busiestChannels[i];
+        QJsonObject channelStats;
+        channelStats["subscribers"] = _channelSubscribers.value(channel.key()).size();
+        channelStats["messages_per_second"] = (float)channel->messages / secondsSinceLastStats;
+        channelStats["inbound_kbps"] = (float)channel->bytesIn / BYTES_PER_KILOBIT / secondsSinceLastStats;
+        channelStats["outbound_kbps"] = (float)channel->bytesOut / BYTES_PER_KILOBIT / secondsSinceLastStats;
+        channelsObject[channel.key()] = channelStats;
+    }
+    statsObject["channels"] = channelsObject;
+    statsObject["active_channels"] = _channelStats.size();
+    statsObject["subscribed_channels"] = _channelSubscribers.size();
+    _channelStats.clear();
+
+    QJsonObject fanOutObject;
+    fanOutObject["threads"] = _slavePool.numThreads();
+    fanOutObject["using_slave_pool"] = _useSlavePool;
+    fanOutObject["pooled_messages"] = (double)_pooledMessages;
+    statsObject["fan_out"] = fanOutObject;
+    _pooledMessages = 0;
+
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
 }
 
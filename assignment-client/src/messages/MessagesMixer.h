@@ -17,6 +17,8 @@
 
 #include <ThreadedAssignment.h>
 
+#include "MessagesMixerSlavePool.h"
+
 /// Handles assignments of type MessagesMixer - distribution of avatar data to various clients
 class MessagesMixer : public ThreadedAssignment {
     Q_OBJECT
@@ -34,7 +36,23 @@ private slots:
     void handleMessagesUnsubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
 
 private:
-    QHash<QString,QSet<QUuid>> _channelSubscribers;
+    struct ChannelStats {
+        quint64 messages { 0 };
+        quint64 bytesIn { 0 };
+        quint64 bytesOut { 0 };
+    };
+
+    void updateLoad(int numSends);
+
+    QHash<QString, QHash<QUuid, SharedNodePointer>> _channelSubscribers;
+    QHash<QString, ChannelStats> _channelStats;
+    quint64 _lastStatsTime { 0 };
+
+    MessagesMixerSlavePool _slavePool;
+    bool _useSlavePool { false };
+    quint64 _loadWindowStart { 0 };
+    int _sendsInLoadWindow { 0 };
+    quint64 _pooledMessages { 0 };
 };
 
 #endif // hifi_MessagesMixer_h
@@ -0,0 +1,108 @@
+//
+//  MessagesMixerSlavePool.cpp
+//  assignment-client/src/messages
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <assert.h>
+#include <algorithm>
+
+#include "MessagesMixerSlavePool.h"
+
+void MessagesMixerFanOut::send() const {
+    auto nodeList = DependencyManager::get<NodeList>();
+    for (auto& node : recipients) {
+        auto packetList = NLPacketList::create(PacketType::MessagesData, QByteArray(), true, true);
+        packetList->write(payload);
+        nodeList->sendPacketList(std::move(packetList), *node);
+    }
+}
+
+void MessagesMixerSlaveThread::run() {
+    while (true) {
+        MessagesMixerFanOut fanOut;
+        {
+            Lock lock(_mutex);
+            _condition.wait(lock, [&] { return _stop || !_queue.empty(); });
+            if (_queue.empty()) {
+                // only stop once everything we were given has gone out
+                return;
+            }
+            fanOut = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        fanOut.send();
+        --_pool._numPending;
+    }
+}
+
+void MessagesMixerSlaveThread::push(MessagesMixerFanOut&& fanOut) {
+    {
+        Lock lock(_mutex);
+        _queue.push_back(std::move(fanOut));
+    }
+    _condition.notify_one();
+}
+
+void MessagesMixerSlaveThread::stop() {
+    {
+        Lock lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_one();
+}
+
+void MessagesMixerSlavePool::queue(const QString& channel, MessagesMixerFanOut&& fanOut) {
+    assert(_numThreads > 0);
+    ++_numPending;
+    _slaves[qHash(channel) % (uint)_numThreads]->push(std::move(fanOut));
+}
+
+void MessagesMixerSlavePool::setNumThreads(int numThreads) {
+    // clamp to allowed size
+    {
+        int maxThreads = QThread::idealThreadCount();
+        if (maxThreads == -1) {
+            // idealThreadCount returns -1 if cores cannot be detected
+            static const int MAX_THREADS_IF_UNKNOWN = 4;
+            maxThreads = MAX_THREADS_IF_UNKNOWN;
+        }
+
+        int clampedThreads = std::min(std::max(1, numThreads), maxThreads);
+        if (clampedThreads != numThreads) {
+            qWarning("%s: clamped to %d (was %d)", __FUNCTION__, clampedThreads, numThreads);
+            numThreads = clampedThreads;
+        }
+    }
+
+    resize(numThreads);
+}
+
+void MessagesMixerSlavePool::resize(int numThreads) {
+    assert(_numThreads == (int)_slaves.size());
+
+    qDebug("%s: set %d threads (was %d)", __FUNCTION__, numThreads, _numThreads);
+
+    // stopping drains each slave's queue, so nothing queued is dropped
+    for (auto& slave : _slaves) {
+        slave->stop();
+    }
+    for (auto& slave : _slaves) {
+        slave->wait();
+    }
+    _slaves.clear();
+
+    for (int i = 0; i < numThreads; ++i) {
+        auto slave = new MessagesMixerSlaveThread(*this);
+        slave->start();
+        _slaves.emplace_back(slave);
+    }
+
+    _numThreads = numThreads;
+    assert(_numThreads == (int)_slaves.size());
+}
@@ -0,0 +1,85 @@
+//
+//  MessagesMixerSlavePool.h
+//  assignment-client/src/messages
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MessagesMixerSlavePool_h
+#define hifi_MessagesMixerSlavePool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <QThread>
+
+#include <NodeList.h>
+
+// A single message going out to every subscriber of its channel.  The payload is encoded once and shared by
+// all recipients; each recipient still gets its own packet list since reliable packets are per-connection.
+struct MessagesMixerFanOut {
+    QByteArray payload;
+    std::vector<SharedNodePointer> recipients;
+
+    void send() const;
+};
+
+class MessagesMixerSlavePool;
+
+class MessagesMixerSlaveThread : public QThread {
+    Q_OBJECT
+    using Mutex = std::mutex;
+    using Lock = std::unique_lock<Mutex>;
+
+public:
+    MessagesMixerSlaveThread(MessagesMixerSlavePool& pool) : _pool(pool) {}
+
+    void run() override final;
+
+private:
+    friend class MessagesMixerSlavePool;
+
+    void push(MessagesMixerFanOut&& fanOut);
+    void stop();
+
+    MessagesMixerSlavePool& _pool;
+
+    Mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<MessagesMixerFanOut> _queue; // guarded by _mutex
+    bool _stop { false }; // guarded by _mutex
+};
+
+// Slave pool for the messages mixer
+//   Each channel is always handled by the same slave, so messages on a channel keep their order.
+//   MessagesMixerSlavePool is not thread-safe! It should be instantiated and used from a single thread.
+class MessagesMixerSlavePool {
+public:
+    MessagesMixerSlavePool(int numThreads = QThread::idealThreadCount()) { setNumThreads(numThreads); }
+    ~MessagesMixerSlavePool() { resize(0); }
+
+    void queue(const QString& channel, MessagesMixerFanOut&& fanOut);
+
+    // true when no fan-out is queued or in progress, i.e. it is safe to send inline without reordering
+    bool isIdle() const { return _numPending == 0; }
+
+    void setNumThreads(int numThreads);
+    int numThreads() { return _numThreads; }
+
+private:
+    friend class MessagesMixerSlaveThread;
+
+    void resize(int numThreads);
+
+    std::vector<std::unique_ptr<MessagesMixerSlaveThread>> _slaves;
+    std::atomic<int> _numPending { 0 };
+    int _numThreads { 0 };
+};
+
+#endif // hifi_MessagesMixerSlavePool_h
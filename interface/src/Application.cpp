@@ -81,6 +81,7 @@
 #include <gpu/gl/GLBackend.h>
 #include <HFActionEvent.h>
 #include <HFBackEvent.h>
+#include <HullPointCache.h>
 #include <InfoView.h>
 #include <input-plugins/InputPlugin.h>
 #include <controllers/UserInputMapper.h>
@@ -331,6 +332,10 @@ static const QString DESKTOP_LOCATION = QStandardPaths::writableLocation(QStanda
 
 Setting::Handle<int> maxOctreePacketsPerSecond("maxOctreePPS", DEFAULT_MAX_OCTREE_PPS);
 
+// physics islands are solved on the calling thread unless this is raised
+static const int DEFAULT_PHYSICS_SOLVER_THREADS = 1;
+Setting::Handle<int> physicsSolverThreads("physicsSolverThreads", DEFAULT_PHYSICS_SOLVER_THREADS);
+
 static const QString MARKETPLACE_CDN_HOSTNAME = "mpassets.highfidelity.com";
 static const int INTERVAL_TO_CHECK_HMD_WORN_STATUS = 500; // milliseconds
 static const QString DESKTOP_DISPLAY_PLUGIN_NAME = "Desktop";
@@ -622,6 +627,7 @@ bool setupEssentials(int& argc, char** argv, bool runningMarkerExisted) {
     DependencyManager::set<NodeList>(NodeType::Agent, listenPort);
     DependencyManager::set<GeometryCache>();
     DependencyManager::set<ModelCache>();
+    DependencyManager::set<HullPointCache>();
     DependencyManager::set<ScriptCache>();
     DependencyManager::set<SoundCache>();
     DependencyManager::set<DdeFaceTracker>();
@@ -2107,6 +2113,7 @@ Application::~Application() {
     DependencyManager::destroy<FramebufferCache>();
     DependencyManager::destroy<TextureCache>();
     DependencyManager::destroy<ModelCache>();
+    DependencyManager::destroy<HullPointCache>();
     DependencyManager::destroy<GeometryCache>();
     DependencyManager::destroy<ScriptCache>();
     DependencyManager::destroy<SoundCache>();
@@ -4244,11 +4251,12 @@ void Application::init() {
         return atan2(maxSize, distance);
     });
 
-    ObjectMotionState::setShapeManager(&_shapeManager);
     _physicsEngine->init();
+    _physicsEngine->setNumSolverThreads(physicsSolverThreads.get());
+    DependencyManager::get<AvatarManager>()->setShapeManager(&_shapeManager);
 
     EntityTreePointer tree = getEntities()->getTree();
-    _entitySimulation->init(tree, _physicsEngine, &_entityEditSender);
+    _entitySimulation->init(tree, _physicsEngine, &_shapeManager, &_entityEditSender);
     tree->setSimulation(_entitySimulation);
 
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
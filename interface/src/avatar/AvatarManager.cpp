@@ -183,12 +183,12 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
         if (_shouldRender) {
             avatar->ensureInScene(avatar, qApp->getMain3DScene());
         }
-        if (!avatar->isInPhysicsSimulation()) {
+        if (!avatar->isInPhysicsSimulation() && _shapeManager) {
             ShapeInfo shapeInfo;
             avatar->computeShapeInfo(shapeInfo);
-            btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+            btCollisionShape* shape = const_cast<btCollisionShape*>(_shapeManager->getShape(shapeInfo));
             if (shape) {
-                AvatarMotionState* motionState = new AvatarMotionState(avatar, shape);
+                AvatarMotionState* motionState = new AvatarMotionState(avatar, shape, _shapeManager);
                 motionState->setMass(avatar->computeMass());
                 avatar->setPhysicsCallback([=] (uint32_t flags) { motionState->addDirtyFlags(flags); });
                 _motionStates.insert(avatar.get(), motionState);
@@ -249,7 +249,7 @@ void AvatarManager::updateOtherAvatars(float deltaTime) {
                 ++itr;
             }
         }
-        qApp->getMain3DScene()->enqueueTransaction(transaction);
+        qApp->getMain3DScene()->enqueueTransaction(std::move(transaction));
     }
 
     _numAvatarsUpdated = numAvatarsUpdated;
@@ -460,7 +460,7 @@ void AvatarManager::updateAvatarRenderStatus(bool shouldRenderAvatars) {
             avatar->removeFromScene(avatar, scene, transaction);
         }
     }
-    scene->enqueueTransaction(transaction);
+    scene->enqueueTransaction(std::move(transaction));
 }
 
 AvatarSharedPointer AvatarManager::getAvatarBySessionID(const QUuid& sessionID) const {
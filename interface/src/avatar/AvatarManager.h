@@ -60,6 +60,7 @@ public:
     void clearOtherAvatars();
     void deleteAllAvatars();
 
+    void setShapeManager(ShapeManager* shapeManager) { _shapeManager = shapeManager; }
     void getObjectsToRemoveFromPhysics(VectorOfMotionStates& motionStates);
     void getObjectsToAddToPhysics(VectorOfMotionStates& motionStates);
     void getObjectsToChange(VectorOfMotionStates& motionStates);
@@ -103,6 +104,7 @@ private:
     VectorOfMotionStates _motionStatesToRemoveFromPhysics;
     VectorOfMotionStates _motionStatesToDelete;
     SetOfMotionStates _motionStatesToAddToPhysics;
+    ShapeManager* _shapeManager { nullptr };
 
     std::shared_ptr<MyAvatar> _myAvatar;
     quint64 _lastSendAvatarDataTime = 0; // Controls MyAvatar send data rate.
@@ -16,7 +16,8 @@
 #include <PhysicsHelpers.h>
 
 
-AvatarMotionState::AvatarMotionState(AvatarSharedPointer avatar, const btCollisionShape* shape) : ObjectMotionState(shape), _avatar(avatar) {
+AvatarMotionState::AvatarMotionState(AvatarSharedPointer avatar, const btCollisionShape* shape, ShapeManager* shapeManager) :
+    ObjectMotionState(shape, shapeManager), _avatar(avatar) {
     assert(_avatar);
     _type = MOTIONSTATE_TYPE_AVATAR;
 }
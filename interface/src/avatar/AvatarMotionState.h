@@ -21,7 +21,7 @@
 
 class AvatarMotionState : public ObjectMotionState {
 public:
-    AvatarMotionState(AvatarSharedPointer avatar, const btCollisionShape* shape);
+    AvatarMotionState(AvatarSharedPointer avatar, const btCollisionShape* shape, ShapeManager* shapeManager);
 
     virtual PhysicsMotionType getMotionType() const override { return _motionType; }
 
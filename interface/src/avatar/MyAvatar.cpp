@@ -169,41 +169,45 @@ MyAvatar::MyAvatar(QThread* thread) :
     connect(recorder.data(), &Recorder::recordingStateChanged, [=] {
         if (recorder->isRecording()) {
             setRecordingBasis();
+            _recordingFrameEncoder.reset();
         } else {
             clearRecordingBasis();
         }
     });
 
     static const recording::FrameType AVATAR_FRAME_TYPE = recording::Frame::registerFrameType(AvatarData::FRAME_NAME);
+    Frame::registerKeyFrameTest(AVATAR_FRAME_TYPE, &AvatarData::isKeyFrame);
+    // the player decodes into an avatar of its own, with the delta coding state of the clip it plays
+    auto playbackAvatar = std::make_shared<AvatarData>();
+    auto playbackFrameDecoder = std::make_shared<AvatarFrameDecoder>();
     Frame::registerFrameHandler(AVATAR_FRAME_TYPE, [=](Frame::ConstPointer frame) {
-        static AvatarData dummyAvatar;
-        AvatarData::fromFrame(frame->data, dummyAvatar);
+        AvatarData::fromFrame(frame->data, *playbackAvatar, *playbackFrameDecoder);
         if (getRecordingBasis()) {
-            dummyAvatar.setRecordingBasis(getRecordingBasis());
+            playbackAvatar->setRecordingBasis(getRecordingBasis());
         } else {
-            dummyAvatar.clearRecordingBasis();
+            playbackAvatar->clearRecordingBasis();
         }
 
         auto recordingInterface = DependencyManager::get<RecordingScriptingInterface>();
 
-        if (recordingInterface->getPlayerUseSkeletonModel() && dummyAvatar.getSkeletonModelURL().isValid() &&
-            (dummyAvatar.getSkeletonModelURL() != getSkeletonModelURL())) {
+        if (recordingInterface->getPlayerUseSkeletonModel() && playbackAvatar->getSkeletonModelURL().isValid() &&
+            (playbackAvatar->getSkeletonModelURL() != getSkeletonModelURL())) {
 
-            setSkeletonModelURL(dummyAvatar.getSkeletonModelURL());
+            setSkeletonModelURL(playbackAvatar->getSkeletonModelURL());
         }
 
-        if (recordingInterface->getPlayerUseDisplayName() && dummyAvatar.getDisplayName() != getDisplayName()) {
-            setDisplayName(dummyAvatar.getDisplayName());
+        if (recordingInterface->getPlayerUseDisplayName() && playbackAvatar->getDisplayName() != getDisplayName()) {
+            setDisplayName(playbackAvatar->getDisplayName());
         }
 
-        setPosition(dummyAvatar.getPosition());
-        setOrientation(dummyAvatar.getOrientation());
+        setPosition(playbackAvatar->getPosition());
+        setOrientation(playbackAvatar->getOrientation());
 
-        if (!dummyAvatar.getAttachmentData().isEmpty()) {
-            setAttachmentData(dummyAvatar.getAttachmentData());
+        if (!playbackAvatar->getAttachmentData().isEmpty()) {
+            setAttachmentData(playbackAvatar->getAttachmentData());
         }
 
-        auto headData = dummyAvatar.getHeadData();
+        auto headData = playbackAvatar->getHeadData();
         if (headData && _headData) {
             // blendshapes
             if (!headData->getBlendshapeCoefficients().isEmpty()) {
@@ -213,7 +217,7 @@ MyAvatar::MyAvatar(QThread* thread) :
             _headData->setLookAtPosition(headData->getLookAtPosition());
         }
 
-        auto jointData = dummyAvatar.getRawJointData();
+        auto jointData = playbackAvatar->getRawJointData();
         if (jointData.length() > 0) {
             _skeletonModel->getRig().copyJointsFromJointData(jointData);
         }
@@ -566,7 +570,7 @@ void MyAvatar::simulate(float deltaTime) {
     auto recorder = DependencyManager::get<recording::Recorder>();
     if (recorder->isRecording()) {
         static const recording::FrameType FRAME_TYPE = recording::Frame::registerFrameType(AvatarData::FRAME_NAME);
-        recorder->recordFrame(FRAME_TYPE, toFrame(*this));
+        recorder->recordFrame(FRAME_TYPE, toFrame(*this, _recordingFrameEncoder));
     }
 
     locationChanged();
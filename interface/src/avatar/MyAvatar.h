@@ -683,6 +683,8 @@ private:
     MyCharacterController _characterController;
     int16_t _previousCollisionGroup { BULLET_COLLISION_GROUP_MY_AVATAR };
 
+    AvatarFrameEncoder _recordingFrameEncoder;
+
     AvatarWeakPointer _lookAtTargetAvatar;
     glm::vec3 _targetAvatarPosition;
     bool _shouldRender { true };
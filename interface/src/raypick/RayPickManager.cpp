@@ -10,6 +10,8 @@
 //
 #include "RayPickManager.h"
 
+#include <algorithm>
+
 #include "Application.h"
 #include "EntityScriptingInterface.h"
 #include "ui/overlays/Overlays.h"
@@ -42,9 +44,22 @@ void RayPickManager::cacheResult(const bool intersects, const RayPickResult& res
     }
 }
 
+// the entity picks of an update that share their filters, which are traced as one batch
+class EntityRayBatch {
+public:
+    RayPickFilter::Flags mask;
+    QVector<EntityItemID> include;
+    QVector<EntityItemID> ignore;
+    QVector<PickRay> rays;
+};
+
 void RayPickManager::update() {
     QReadLocker lock(&_containsLock);
     RayPickCache results;
+
+    // gather the rays first, so that the entity picks can be traced in batches rather than one by one
+    std::vector<std::pair<std::shared_ptr<RayPick>, PickRay>> activePicks;
+    std::vector<EntityRayBatch> entityBatches;
     for (auto& uid : _rayPicks.keys()) {
         std::shared_ptr<RayPick> rayPick = _rayPicks[uid];
         QWriteLocker lock(rayPick->getLock());
@@ -58,6 +73,46 @@ void RayPickManager::update() {
         if (!valid) {
             continue;
         }
+        activePicks.push_back({ rayPick, ray });
+
+        QPair<glm::vec3, glm::vec3> rayKey = QPair<glm::vec3, glm::vec3>(ray.origin, ray.direction);
+        RayPickFilter::Flags entityMask = rayPick->getFilter().getEntityFlags();
+        if (rayPick->getFilter().doesPickEntities() && !(results.contains(rayKey) && results[rayKey].count(entityMask))) {
+            // hold the ray's place in the cache until its batch is traced
+            results[rayKey][entityMask] = RayPickResult(ray);
+
+            auto batch = std::find_if(entityBatches.begin(), entityBatches.end(), [&](const EntityRayBatch& other) {
+                return other.mask == entityMask && other.include == rayPick->getIncludeEntites() &&
+                    other.ignore == rayPick->getIgnoreEntites();
+            });
+            if (batch == entityBatches.end()) {
+                batch = entityBatches.insert(entityBatches.end(),
+                    { entityMask, rayPick->getIncludeEntites(), rayPick->getIgnoreEntites(), QVector<PickRay>() });
+            }
+            batch->rays.push_back(ray);
+        }
+    }
+
+    auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
+    for (const auto& batch : entityBatches) {
+        RayPickFilter filter(batch.mask);
+        QVector<RayToEntityIntersectionResult> entityResults = entityScriptingInterface->findRayIntersectionsVector(batch.rays,
+            !filter.doesPickCourse(), batch.include, batch.ignore, !filter.doesPickInvisible(), !filter.doesPickNonCollidable());
+        for (int i = 0; i < batch.rays.size(); i++) {
+            const PickRay& ray = batch.rays[i];
+            const RayToEntityIntersectionResult& entityRes = entityResults[i];
+            if (entityRes.intersects) {
+                QPair<glm::vec3, glm::vec3> rayKey = QPair<glm::vec3, glm::vec3>(ray.origin, ray.direction);
+                results[rayKey][batch.mask] = RayPickResult(IntersectionType::ENTITY, entityRes.entityID, entityRes.distance,
+                    entityRes.intersection, ray, entityRes.surfaceNormal);
+            }
+        }
+    }
+
+    for (auto& activePick : activePicks) {
+        std::shared_ptr<RayPick> rayPick = activePick.first;
+        const PickRay& ray = activePick.second;
+        QWriteLocker lock(rayPick->getLock());
 
         QPair<glm::vec3, glm::vec3> rayKey = QPair<glm::vec3, glm::vec3>(ray.origin, ray.direction);
         RayPickResult res = RayPickResult(ray);
@@ -68,8 +123,9 @@ void RayPickManager::update() {
             bool invisible = rayPick->getFilter().doesPickInvisible();
             bool nonCollidable = rayPick->getFilter().doesPickNonCollidable();
             RayPickFilter::Flags entityMask = rayPick->getFilter().getEntityFlags();
+            // the filter can have changed since the batches were gathered
             if (!checkAndCompareCachedResults(rayKey, results, res, entityMask)) {
-                entityRes = DependencyManager::get<EntityScriptingInterface>()->findRayIntersectionVector(ray, !rayPick->getFilter().doesPickCourse(),
+                entityRes = entityScriptingInterface->findRayIntersectionVector(ray, !rayPick->getFilter().doesPickCourse(),
                     rayPick->getIncludeEntites(), rayPick->getIgnoreEntites(), !invisible, !nonCollidable);
                 fromCache = false;
             }
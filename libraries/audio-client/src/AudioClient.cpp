@@ -1844,11 +1844,8 @@ qint64 AudioClient::AudioOutputIODevice::readData(char * data, qint64 maxSize) {
     if ((networkSamplesPopped = _receivedAudioStream.popSamples(samplesRequested, false)) > 0) {
         qCDebug(audiostream, "Read %d samples from buffer (%d available, %d requested)", networkSamplesPopped, _receivedAudioStream.getSamplesAvailable(), samplesRequested);
         AudioRingBuffer::ConstIterator lastPopOutput = _receivedAudioStream.getLastPopOutput();
-        lastPopOutput.readSamples(scratchBuffer, networkSamplesPopped);
-
-        for (int i = 0; i < networkSamplesPopped; i++) {
-            mixBuffer[i] = convertToFloat(scratchBuffer[i]);
-        }
+        // convert straight from the ring into the mix
+        lastPopOutput.readSamples(mixBuffer, networkSamplesPopped);
 
         samplesRequested = networkSamplesPopped;
     }
@@ -1037,20 +1037,30 @@ static void quatToMatrix_3x3(float w, float x, float y, float z, float m[3][3])
 // Ambisonic to binaural render
 void AudioFOA::render(int16_t* input, float* output, int index, float qw, float qx, float qy, float qz, float gain, int numFrames) {
 
-    assert(index >= 0);
-    assert(index < FOA_TABLES);
     assert(numFrames == FOA_BLOCK);
 
-    ALIGN32 float fftBuffer[FOA_NFFT];          // in-place FFT buffer
-    ALIGN32 float accBuffer[2][FOA_NFFT] = {};  // binaural accumulation buffers
     ALIGN32 float inBuffer[4][FOA_BLOCK];       // deinterleaved input buffers
 
     float* in[4] = { inBuffer[0], inBuffer[1], inBuffer[2], inBuffer[3] };
-    float rotation[3][3];
 
     // convert input to deinterleaved float
     convertInput(input, in, FOA_GAIN * gain, FOA_BLOCK);
 
+    render(in, output, index, qw, qx, qy, qz, numFrames);
+}
+
+// Ambisonic to binaural render, from deinterleaved float B-format
+void AudioFOA::render(float* in[4], float* output, int index, float qw, float qx, float qy, float qz, int numFrames) {
+
+    assert(index >= 0);
+    assert(index < FOA_TABLES);
+    assert(numFrames == FOA_BLOCK);
+
+    ALIGN32 float fftBuffer[FOA_NFFT];          // in-place FFT buffer
+    ALIGN32 float accBuffer[2][FOA_NFFT] = {};  // binaural accumulation buffers
+
+    float rotation[3][3];
+
     // convert quaternion to 3x3 rotation
     quatToMatrix_3x3(qw, qx, qy, qz, rotation);
 
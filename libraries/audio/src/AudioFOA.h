@@ -45,6 +45,15 @@ public:
     //
     void render(int16_t* input, float* output, int index, float qw, float qx, float qy, float qz, float gain, int numFrames);
 
+    //
+    // input: deinterleaved B-format source (W, X, Y, Z), in FuMa normalization, overwritten by the rotation
+    // output: interleaved stereo mix buffer (accumulates into existing output)
+    // index: HRTF subject index
+    // qw, qx, qy, qz: normalized quaternion for orientation
+    // numFrames: must be FOA_BLOCK in this version
+    //
+    void render(float* input[4], float* output, int index, float qw, float qx, float qy, float qz, int numFrames);
+
 private:
     AudioFOA(const AudioFOA&) = delete;
     AudioFOA& operator=(const AudioFOA&) = delete;
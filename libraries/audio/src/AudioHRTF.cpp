@@ -865,6 +865,14 @@ void AudioHRTF::render(int16_t* input, float* output, int index, float azimuth,
     // apply global and local gain adjustment
     gain *= _gainAdjust;
 
+    // coming out of silence there is no old output to crossfade from, and the source may have moved while its
+    // silent blocks were skipped, so start from the new parameters
+    if (_silentState) {
+        _azimuthState = azimuth;
+        _distanceState = distance;
+        _gainState = gain;
+    }
+
     // to avoid polluting the cache, old filters are recomputed instead of stored
     setFilters(firCoef, bqCoef, delay, index, _azimuthState, _distanceState, _gainState, L0);
 
@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <assert.h>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
@@ -36,8 +37,6 @@ AudioRingBufferTemplate<T>::AudioRingBufferTemplate(int numFrameSamples, int num
     if (numFrameSamples) {
         _buffer = new Sample[_bufferLength];
         memset(_buffer, 0, _bufferLength * SampleSize);
-        _nextOutput = _buffer;
-        _endOfLastWrite = _buffer;
     }
 
     static QString repeatedOverflowMessage = LogHandler::getInstance().addRepeatedMessageRegex(RING_BUFFER_OVERFLOW_DEBUG);
@@ -51,14 +50,14 @@ AudioRingBufferTemplate<T>::~AudioRingBufferTemplate() {
 
 template <class T>
 void AudioRingBufferTemplate<T>::clear() {
-    _endOfLastWrite = _buffer;
-    _nextOutput = _buffer;
+    _writeIndex.store(0, std::memory_order_relaxed);
+    _readIndex.store(0, std::memory_order_release);
 }
 
 template <class T>
 void AudioRingBufferTemplate<T>::reset() {
     clear();
-    _overflowCount = 0;
+    _overflowCount.store(0, std::memory_order_relaxed);
 }
 
 template <class T>
@@ -78,6 +77,45 @@ void AudioRingBufferTemplate<T>::resizeForFrameSize(int numFrameSamples) {
     reset();
 }
 
+template <class T>
+std::unique_ptr<T[]> AudioRingBufferTemplate<T>::resizeForChannelCount(int numFrameSamples) {
+    int oldFrameSamples = _numFrameSamples;
+    int oldBufferLength = _bufferLength;
+    assert(numFrameSamples == 2 * oldFrameSamples || 2 * numFrameSamples == oldFrameSamples);
+
+    std::unique_ptr<Sample[]> oldBuffer { _buffer };
+    int readIndex = _readIndex.load(std::memory_order_acquire);
+    int numQueuedSamples = (samplesAvailable(readIndex) / oldFrameSamples) * oldFrameSamples;
+
+    _numFrameSamples = numFrameSamples;
+    _sampleCapacity = numFrameSamples * _frameCapacity;
+    _bufferLength = numFrameSamples * (_frameCapacity + 1);
+    _buffer = new Sample[_bufferLength];
+    memset(_buffer, 0, _bufferLength * SampleSize);
+
+    // carry the queued frames over in the new channel count (they fit, as the frame capacity is unchanged)
+    const Sample* source = oldBuffer.get();
+    int writeIndex = 0;
+    if (numFrameSamples > oldFrameSamples) {
+        for (int i = 0; i < numQueuedSamples; ++i) {
+            Sample sample = source[(readIndex + i) % oldBufferLength];
+            _buffer[writeIndex++] = sample;
+            _buffer[writeIndex++] = sample;
+        }
+    } else {
+        for (int i = 0; i < numQueuedSamples; i += 2) {
+            Sample left = source[(readIndex + i) % oldBufferLength];
+            Sample right = source[(readIndex + i + 1) % oldBufferLength];
+            _buffer[writeIndex++] = (Sample)((left + right) / 2);
+        }
+    }
+
+    _writeIndex.store(writeIndex, std::memory_order_relaxed);
+    _readIndex.store(0, std::memory_order_release);
+
+    return oldBuffer;
+}
+
 template <class T>
 int AudioRingBufferTemplate<T>::readSamples(Sample* destination, int maxSamples) {
     return readData((char*)destination, maxSamples * SampleSize) / SampleSize;
@@ -101,22 +139,24 @@ template <class T>
 int AudioRingBufferTemplate<T>::readData(char *data, int maxSize) {
     // only copy up to the number of samples we have available
     int maxSamples = maxSize / SampleSize;
-    int numReadSamples = std::min(maxSamples, samplesAvailable());
+    int readIndex = _readIndex.load(std::memory_order_acquire);
+    int numReadSamples = std::min(maxSamples, samplesAvailable(readIndex));
+    Sample* nextOutput = _buffer + readIndex;
 
-    if (_nextOutput + numReadSamples > _buffer + _bufferLength) {
+    if (nextOutput + numReadSamples > _buffer + _bufferLength) {
         // we're going to need to do two reads to get this data, it wraps around the edge
-        int numSamplesToEnd = (_buffer + _bufferLength) - _nextOutput;
+        int numSamplesToEnd = (_buffer + _bufferLength) - nextOutput;
 
         // read to the end of the buffer
-        memcpy(data, _nextOutput, numSamplesToEnd * SampleSize);
+        memcpy(data, nextOutput, numSamplesToEnd * SampleSize);
 
         // read the rest from the beginning of the buffer
         memcpy(data + (numSamplesToEnd * SampleSize), _buffer, (numReadSamples - numSamplesToEnd) * SampleSize);
     } else {
-        memcpy(data, _nextOutput, numReadSamples * SampleSize);
+        memcpy(data, nextOutput, numReadSamples * SampleSize);
     }
 
-    shiftReadPosition(numReadSamples);
+    advanceReadIndex(readIndex, numReadSamples);
 
     return numReadSamples * SampleSize;
 }
@@ -125,13 +165,14 @@ template <class T>
 int AudioRingBufferTemplate<T>::appendData(char *data, int maxSize) {
     // only copy up to the number of samples we have available
     int maxSamples = maxSize / SampleSize;
-    int numReadSamples = std::min(maxSamples, samplesAvailable());
+    int readIndex = _readIndex.load(std::memory_order_acquire);
+    int numReadSamples = std::min(maxSamples, samplesAvailable(readIndex));
 
     Sample* dest = reinterpret_cast<Sample*>(data);
-    Sample* output = _nextOutput;
-    if (_nextOutput + numReadSamples > _buffer + _bufferLength) {
+    Sample* output = _buffer + readIndex;
+    if (output + numReadSamples > _buffer + _bufferLength) {
         // we're going to need to do two reads to get this data, it wraps around the edge
-        int numSamplesToEnd = (_buffer + _bufferLength) - _nextOutput;
+        int numSamplesToEnd = (_buffer + _bufferLength) - output;
 
         // read to the end of the buffer
         for (int i = 0; i < numSamplesToEnd; i++) {
@@ -149,7 +190,7 @@ int AudioRingBufferTemplate<T>::appendData(char *data, int maxSize) {
         }
     }
 
-    shiftReadPosition(numReadSamples);
+    advanceReadIndex(readIndex, numReadSamples);
 
     return numReadSamples * SampleSize;
 }
@@ -159,42 +200,63 @@ int AudioRingBufferTemplate<T>::writeData(const char* data, int maxSize) {
     // only copy up to the number of samples we have capacity for
     int maxSamples = maxSize / SampleSize;
     int numWriteSamples = std::min(maxSamples, _sampleCapacity);
-    int samplesRoomFor = _sampleCapacity - samplesAvailable();
 
-    if (numWriteSamples > samplesRoomFor) {
-        // there's not enough room for this write. erase old data to make room for this new data
-        int samplesToDelete = numWriteSamples - samplesRoomFor;
-        _nextOutput = shiftedPositionAccomodatingWrap(_nextOutput, samplesToDelete);
-        _overflowCount++;
-
-        qCDebug(audio) << qPrintable(RING_BUFFER_OVERFLOW_DEBUG);
-    }
+    // there may not be enough room for this write. erase old data to make room for this new data
+    makeRoomFor(numWriteSamples);
 
-    if (_endOfLastWrite + numWriteSamples > _buffer + _bufferLength) {
-        // we're going to need to do two writes to set this data, it wraps around the edge
-        int numSamplesToEnd = (_buffer + _bufferLength) - _endOfLastWrite;
+    int writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    copyToRing(writeIndex, reinterpret_cast<const Sample*>(data), numWriteSamples);
+    _writeIndex.store(wrapIndex(writeIndex + numWriteSamples), std::memory_order_release);
 
-        // write to the end of the buffer
-        memcpy(_endOfLastWrite, data, numSamplesToEnd * SampleSize);
+    return numWriteSamples * SampleSize;
+}
 
-        // write the rest to the beginning of the buffer
-        memcpy(_buffer, data + (numSamplesToEnd * SampleSize), (numWriteSamples - numSamplesToEnd) * SampleSize);
+template <class T>
+void AudioRingBufferTemplate<T>::copyToRing(int writeIndex, const Sample* source, int numSamples) {
+    int numSamplesToEnd = _bufferLength - writeIndex;
+    if (numSamples > numSamplesToEnd) {
+        // we're going to need to do two writes to set this data, it wraps around the edge
+        memcpy(_buffer + writeIndex, source, numSamplesToEnd * SampleSize);
+        memcpy(_buffer, source + numSamplesToEnd, (numSamples - numSamplesToEnd) * SampleSize);
     } else {
-        memcpy(_endOfLastWrite, data, numWriteSamples * SampleSize);
+        memcpy(_buffer + writeIndex, source, numSamples * SampleSize);
+    }
+}
+
+template <class T>
+void AudioRingBufferTemplate<T>::makeRoomFor(int numSamples) {
+    int readIndex = _readIndex.load(std::memory_order_acquire);
+    int samplesToDelete;
+    while ((samplesToDelete = numSamples - (_sampleCapacity - samplesAvailable(readIndex))) > 0) {
+        // on failure readIndex holds where the consumer has moved it to, and the room is recomputed
+        if (_readIndex.compare_exchange_weak(readIndex, wrapIndex(readIndex + samplesToDelete),
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+            _overflowCount.fetch_add(1, std::memory_order_relaxed);
+            qCDebug(audio) << qPrintable(RING_BUFFER_OVERFLOW_DEBUG);
+            break;
+        }
     }
+}
 
-    _endOfLastWrite = shiftedPositionAccomodatingWrap(_endOfLastWrite, numWriteSamples);
+template <class T>
+void AudioRingBufferTemplate<T>::advanceReadIndex(int readIndex, int numSamples) {
+    // if this fails, the producer has overflowed and already discarded these samples, so leave its index be
+    _readIndex.compare_exchange_strong(readIndex, wrapIndex(readIndex + numSamples),
+                                       std::memory_order_acq_rel, std::memory_order_relaxed);
+}
 
-    return numWriteSamples * SampleSize;
+template <class T>
+void AudioRingBufferTemplate<T>::shiftReadPosition(unsigned int numSamples) {
+    advanceReadIndex(_readIndex.load(std::memory_order_acquire), numSamples);
 }
 
 template <class T>
-int AudioRingBufferTemplate<T>::samplesAvailable() const {
-    if (!_endOfLastWrite) {
+int AudioRingBufferTemplate<T>::samplesAvailable(int readIndex) const {
+    if (!_buffer) {
         return 0;
     }
 
-    int sampleDifference = _endOfLastWrite - _nextOutput;
+    int sampleDifference = _writeIndex.load(std::memory_order_acquire) - readIndex;
     if (sampleDifference < 0) {
         sampleDifference += _bufferLength;
     }
@@ -227,15 +289,17 @@ int AudioRingBufferTemplate<T>::addSilentSamples(int silentSamples) {
         qCDebug(audio) << qPrintable(DROPPED_SILENT_DEBUG);
     }
 
-    if (_endOfLastWrite + numWriteSamples > _buffer + _bufferLength) {
-        int numSamplesToEnd = (_buffer + _bufferLength) - _endOfLastWrite;
-        memset(_endOfLastWrite, 0, numSamplesToEnd * SampleSize);
+    int writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    Sample* endOfLastWrite = _buffer + writeIndex;
+    if (endOfLastWrite + numWriteSamples > _buffer + _bufferLength) {
+        int numSamplesToEnd = (_buffer + _bufferLength) - endOfLastWrite;
+        memset(endOfLastWrite, 0, numSamplesToEnd * SampleSize);
         memset(_buffer, 0, (numWriteSamples - numSamplesToEnd) * SampleSize);
     } else {
-        memset(_endOfLastWrite, 0, numWriteSamples * SampleSize);
+        memset(endOfLastWrite, 0, numWriteSamples * SampleSize);
     }
 
-    _endOfLastWrite = shiftedPositionAccomodatingWrap(_endOfLastWrite, numWriteSamples);
+    _writeIndex.store(wrapIndex(writeIndex + numWriteSamples), std::memory_order_release);
 
     return numWriteSamples;
 }
@@ -269,21 +333,18 @@ float AudioRingBufferTemplate<T>::getFrameLoudness(ConstIterator frameStart) con
 template <class T>
 int AudioRingBufferTemplate<T>::writeSamples(ConstIterator source, int maxSamples) {
     int samplesToCopy = std::min(maxSamples, _sampleCapacity);
-    int samplesRoomFor = _sampleCapacity - samplesAvailable();
-    if (samplesToCopy > samplesRoomFor) {
-        // there's not enough room for this write.  erase old data to make room for this new data
-        int samplesToDelete = samplesToCopy - samplesRoomFor;
-        _nextOutput = shiftedPositionAccomodatingWrap(_nextOutput, samplesToDelete);
-        _overflowCount++;
-        qCDebug(audio) << qPrintable(RING_BUFFER_OVERFLOW_DEBUG);
-    }
+    // there may not be enough room for this write.  erase old data to make room for this new data
+    makeRoomFor(samplesToCopy);
 
+    int writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    Sample* endOfLastWrite = _buffer + writeIndex;
     Sample* bufferLast = _buffer + _bufferLength - 1;
     for (int i = 0; i < samplesToCopy; i++) {
-        *_endOfLastWrite = *source;
-        _endOfLastWrite = (_endOfLastWrite == bufferLast) ? _buffer : _endOfLastWrite + 1;
+        *endOfLastWrite = *source;
+        endOfLastWrite = (endOfLastWrite == bufferLast) ? _buffer : endOfLastWrite + 1;
         ++source;
     }
+    _writeIndex.store(wrapIndex(writeIndex + samplesToCopy), std::memory_order_release);
 
     return samplesToCopy;
 }
@@ -291,21 +352,18 @@ int AudioRingBufferTemplate<T>::writeSamples(ConstIterator source, int maxSample
 template <class T>
 int AudioRingBufferTemplate<T>::writeSamplesWithFade(ConstIterator source, int maxSamples, float fade) {
     int samplesToCopy = std::min(maxSamples, _sampleCapacity);
-    int samplesRoomFor = _sampleCapacity - samplesAvailable();
-    if (samplesToCopy > samplesRoomFor) {
-        // there's not enough room for this write.  erase old data to make room for this new data
-        int samplesToDelete = samplesToCopy - samplesRoomFor;
-        _nextOutput = shiftedPositionAccomodatingWrap(_nextOutput, samplesToDelete);
-        _overflowCount++;
-        qCDebug(audio) << qPrintable(RING_BUFFER_OVERFLOW_DEBUG);
-    }
+    // there may not be enough room for this write.  erase old data to make room for this new data
+    makeRoomFor(samplesToCopy);
 
+    int writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    Sample* endOfLastWrite = _buffer + writeIndex;
     Sample* bufferLast = _buffer + _bufferLength - 1;
     for (int i = 0; i < samplesToCopy; i++) {
-        *_endOfLastWrite = (Sample)((float)(*source) * fade);
-        _endOfLastWrite = (_endOfLastWrite == bufferLast) ? _buffer : _endOfLastWrite + 1;
+        *endOfLastWrite = (Sample)((float)(*source) * fade);
+        endOfLastWrite = (endOfLastWrite == bufferLast) ? _buffer : endOfLastWrite + 1;
         ++source;
     }
+    _writeIndex.store(wrapIndex(writeIndex + samplesToCopy), std::memory_order_release);
 
     return samplesToCopy;
 }
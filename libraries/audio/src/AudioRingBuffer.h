@@ -14,6 +14,9 @@
 
 #include "AudioConstants.h"
 
+#include <atomic>
+#include <memory>
+
 #include <QtCore/QIODevice>
 
 #include <SharedUtil.h>
@@ -45,11 +48,20 @@ public:
     // FIXME: discards any data in the buffer
     void resizeForFrameSize(int numFrameSamples);
 
-    // Reading and writing to the buffer uses minimal shared data, such that
-    // in cases that avoid overwriting the buffer, a single producer/consumer
-    // may use this as a lock-free pipe (see audio-client/src/AudioClient.cpp).
-    // IMPORTANT: Avoid changes to the implementation that touch shared data unless you can
-    // maintain this behavior.
+    /// Resize frame size for a change in channel count (mono to stereo, or back), keeping the queued frames:
+    /// mono samples are duplicated across both channels, stereo pairs are averaged.  The old buffer is handed back
+    /// rather than freed, so that iterators into it (e.g. a last popped frame still being mixed) stay valid until
+    /// the caller drops it.
+    std::unique_ptr<T[]> resizeForChannelCount(int numFrameSamples);
+
+    // Reading and writing to the buffer only share the read and write indices, such that a single producer
+    // and a single consumer may use this as a lock-free pipe without any external locking.
+    // The producer publishes samples by storing the write index with release semantics, and the consumer
+    // frees them the same way with the read index.  When the producer overflows the buffer, it discards the
+    // oldest samples by advancing the read index with a compare-and-swap, so a consumer racing it can at worst
+    // re-read a few samples of an overflowing stream.
+    // IMPORTANT: Avoid changes to the implementation that touch other shared data unless you can
+    // maintain this behavior.  clear(), reset() and the resizes are not safe to call concurrently.
 
     /// Read up to maxSamples into destination (will only read up to samplesAvailable())
     /// Returns number of read samples
@@ -85,24 +97,24 @@ public:
     int writeData(const char* source, int maxSize);
 
     /// Returns a reference to the index-th sample offset from the current read sample
-    Sample& operator[](const int index) { return *shiftedPositionAccomodatingWrap(_nextOutput, index); }
-    const Sample& operator[] (const int index) const { return *shiftedPositionAccomodatingWrap(_nextOutput, index); }
+    Sample& operator[](const int index) { return *shiftedPositionAccomodatingWrap(nextOutputPosition(), index); }
+    const Sample& operator[] (const int index) const { return *shiftedPositionAccomodatingWrap(nextOutputPosition(), index); }
 
     /// Essentially discards the next numSamples from the ring buffer
     /// NOTE: This is not checked - it is possible to shift past written data
     ///       Use samplesAvailable() to see the distance a valid shift can go
-    void shiftReadPosition(unsigned int numSamples) { _nextOutput = shiftedPositionAccomodatingWrap(_nextOutput, numSamples); }
+    void shiftReadPosition(unsigned int numSamples);
 
-    int samplesAvailable() const;
+    int samplesAvailable() const { return samplesAvailable(_readIndex.load(std::memory_order_acquire)); }
     int framesAvailable() const { return (_numFrameSamples == 0) ? 0 : samplesAvailable() / _numFrameSamples; }
-    float getNextOutputFrameLoudness() const { return getFrameLoudness(_nextOutput); }
+    float getNextOutputFrameLoudness() const { return getFrameLoudness(nextOutputPosition()); }
 
 
     int getNumFrameSamples() const { return _numFrameSamples; }
     int getFrameCapacity() const { return _frameCapacity; }
     int getSampleCapacity() const { return _sampleCapacity; }
     /// Return times the ring buffer has overwritten old data
-    int getOverflowCount() const { return _overflowCount; }
+    int getOverflowCount() const { return _overflowCount.load(std::memory_order_relaxed); }
 
     class ConstIterator {
     public:
@@ -159,6 +171,20 @@ public:
             return ConstIterator(_bufferFirst, _bufferLength, atShiftedBy(-i));
         }
 
+        // reads and converts in at most two contiguous spans, so the conversion loops vectorize
+        template <class U>
+        void readSamples(U* dest, int numSamples) {
+            auto samplesToEnd = (int)(_bufferLast - _at + 1);
+            auto samplesFromAt = std::min(samplesToEnd, numSamples);
+            convertSamples(_at, dest, samplesFromAt);
+            if (samplesFromAt < numSamples) {
+                convertSamples(_bufferFirst, dest + samplesFromAt, numSamples - samplesFromAt);
+                _at = _bufferFirst + (numSamples - samplesFromAt);
+            } else {
+                _at += numSamples;
+            }
+        }
+
         void readSamples(Sample* dest, int numSamples) {
             auto samplesToEnd = _bufferLast - _at + 1;
 
@@ -184,6 +210,12 @@ public:
 
 
     private:
+        static void convertSamples(const int16_t* source, float* dest, int numSamples) {
+            for (int i = 0; i < numSamples; i++) {
+                dest[i] = (float)source[i] * (1 / 32768.0f);
+            }
+        }
+
         Sample* atShiftedBy(int i) {
             i = (_at - _bufferFirst + i) % _bufferLength;
             if (i < 0) {
@@ -199,10 +231,10 @@ public:
     };
 
     ConstIterator nextOutput() const {
-        return ConstIterator(_buffer, _bufferLength, _nextOutput);
+        return ConstIterator(_buffer, _bufferLength, nextOutputPosition());
     }
     ConstIterator lastFrameWritten() const {
-        return ConstIterator(_buffer, _bufferLength, _endOfLastWrite) - _numFrameSamples;
+        return ConstIterator(_buffer, _bufferLength, _buffer + _writeIndex.load(std::memory_order_acquire)) - _numFrameSamples;
     }
 
     int writeSamples(ConstIterator source, int maxSamples);
@@ -214,15 +246,28 @@ protected:
     Sample* shiftedPositionAccomodatingWrap(Sample* position, int numSamplesShift) const;
     float getFrameLoudness(const Sample* frameStart) const;
 
+    Sample* nextOutputPosition() const { return _buffer + _readIndex.load(std::memory_order_acquire); }
+    int samplesAvailable(int readIndex) const;
+    int wrapIndex(int index) const { return (index >= _bufferLength) ? index - _bufferLength : index; }
+
+    // consumer side: frees samples read from readIndex, unless the producer has discarded them in the meantime
+    void advanceReadIndex(int readIndex, int numSamples);
+    // producer side: discards the oldest samples if numSamples would not fit
+    void makeRoomFor(int numSamples);
+    // producer side: copies numSamples to the ring from writeIndex, in at most two spans
+    void copyToRing(int writeIndex, const Sample* source, int numSamples);
+
     int _numFrameSamples;
     int _frameCapacity;
     int _sampleCapacity;
     int _bufferLength; // actual _buffer length (_sampleCapacity + 1)
-    int _overflowCount{ 0 }; // times the ring buffer has overwritten data
-
-    Sample* _nextOutput{ nullptr };
-    Sample* _endOfLastWrite{ nullptr };
     Sample* _buffer{ nullptr };
+
+    // the indices are on cache lines of their own, so the producer and consumer do not false-share
+    static const int CACHE_LINE_SIZE = 64;
+    alignas(CACHE_LINE_SIZE) std::atomic<int> _readIndex { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<int> _writeIndex { 0 };
+    std::atomic<int> _overflowCount { 0 }; // times the ring buffer has overwritten data, only written by the producer
 };
 
 // expose explicit instantiations for scratch/mix buffers
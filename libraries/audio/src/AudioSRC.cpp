@@ -793,7 +793,7 @@ int AudioSRC::multirateFilter4(const float* input0, const float* input1, const f
 #include <emmintrin.h>  // SSE2
 
 // convert int16_t to float, deinterleave stereo
-void AudioSRC::convertInput(const int16_t* input, float** outputs, int numFrames) {
+void AudioSRC::convertInput_SSE2(const int16_t* input, float** outputs, int numFrames) {
     __m128 scale = _mm_set1_ps(1/32768.0f);
 
     if (_numChannels == 1) {
@@ -919,7 +919,7 @@ static inline __m128 dither4() {
 }
 
 // convert float to int16_t with dither, interleave stereo
-void AudioSRC::convertOutput(float** inputs, int16_t* output, int numFrames) {
+void AudioSRC::convertOutput_SSE2(float** inputs, int16_t* output, int numFrames) {
     __m128 scale = _mm_set1_ps(32768.0f);
 
     if (_numChannels == 1) {
@@ -1051,6 +1051,20 @@ void AudioSRC::convertOutput(float** inputs, int16_t* output, int numFrames) {
     }
 }
 
+//
+// Runtime CPU dispatch
+//
+
+void AudioSRC::convertInput(const int16_t* input, float** outputs, int numFrames) {
+    static auto f = cpuSupportsAVX2() ? &AudioSRC::convertInput_AVX2 : &AudioSRC::convertInput_SSE2;
+    (this->*f)(input, outputs, numFrames);  // dispatch
+}
+
+void AudioSRC::convertOutput(float** inputs, int16_t* output, int numFrames) {
+    static auto f = cpuSupportsAVX2() ? &AudioSRC::convertOutput_AVX2 : &AudioSRC::convertOutput_SSE2;
+    (this->*f)(inputs, output, numFrames);  // dispatch
+}
+
 // deinterleave stereo
 void AudioSRC::convertInput(const float* input, float** outputs, int numFrames) {
 
@@ -1169,6 +1183,209 @@ void AudioSRC::convertOutput(float** inputs, float* output, int numFrames) {
     }
 }
 
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+// convert int16_t to float, deinterleave stereo
+void AudioSRC::convertInput(const int16_t* input, float** outputs, int numFrames) {
+    const float scale = 1/32768.0f;
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        for (; i < numFrames - 7; i += 8) {
+            int16x8_t a0 = vld1q_s16(&input[i]);
+
+            vst1q_f32(&outputs[0][i+0], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a0))), scale));
+            vst1q_f32(&outputs[0][i+4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(a0))), scale));
+        }
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 7; i += 8) {
+            int16x8x2_t a0 = vld2q_s16(&input[2*i]);   // deinterleave
+
+            vst1q_f32(&outputs[0][i+0], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a0.val[0]))), scale));
+            vst1q_f32(&outputs[0][i+4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(a0.val[0]))), scale));
+            vst1q_f32(&outputs[1][i+0], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a0.val[1]))), scale));
+            vst1q_f32(&outputs[1][i+4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(a0.val[1]))), scale));
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 3; i += 4) {
+            int16x4x4_t a0 = vld4_s16(&input[4*i]);    // deinterleave
+
+            vst1q_f32(&outputs[0][i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(a0.val[0])), scale));
+            vst1q_f32(&outputs[1][i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(a0.val[1])), scale));
+            vst1q_f32(&outputs[2][i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(a0.val[2])), scale));
+            vst1q_f32(&outputs[3][i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(a0.val[3])), scale));
+        }
+    }
+
+    // remaining frames
+    for (; i < numFrames; i++) {
+        for (int j = 0; j < _numChannels; j++) {
+            outputs[j][i] = (float)input[_numChannels*i + j] * scale;
+        }
+    }
+}
+
+// fast TPDF dither in [-1.0f, 1.0f]
+static inline float32x4_t dither4() {
+    static uint32_t rz[4] = { 0, 0x9e3779b9, 0x7f4a7c15, 0xf39cc060 };
+
+    // update the 4 LCGs, rz = rz * 69069 + 1
+    uint32x4_t r = vmlaq_n_u32(vdupq_n_u32(1), vld1q_u32(rz), 69069);
+    vst1q_u32(rz, r);
+
+    int32x4_t r0 = vreinterpretq_s32_u32(vandq_u32(r, vdupq_n_u32(0xffff)));
+    int32x4_t r1 = vreinterpretq_s32_u32(vshrq_n_u32(r, 16));
+    return vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(r0, r1)), 1/65536.0f);
+}
+
+// round half away from zero, then saturate
+static inline int16x4_t roundToInt16(float32x4_t f) {
+    uint32x4_t negative = vcltq_f32(f, vdupq_n_f32(0.0f));
+    f = vaddq_f32(f, vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(+0.5f)));
+    return vqmovn_s32(vcvtq_s32_f32(f));
+}
+
+// convert float to int16_t with dither, interleave stereo
+void AudioSRC::convertOutput(float** inputs, int16_t* output, int numFrames) {
+    const float scale = 32768.0f;
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4_t f0 = vmulq_n_f32(vld1q_f32(&inputs[0][i]), scale);
+
+            f0 = vaddq_f32(f0, dither4());
+
+            vst1_s16(&output[i], roundToInt16(f0));
+        }
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4_t d0 = dither4();
+
+            int16x4x2_t a0;
+            a0.val[0] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[0][i]), scale), d0));
+            a0.val[1] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[1][i]), scale), d0));
+
+            vst2_s16(&output[2*i], a0);     // interleave
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4_t d0 = dither4();
+
+            int16x4x4_t a0;
+            a0.val[0] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[0][i]), scale), d0));
+            a0.val[1] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[1][i]), scale), d0));
+            a0.val[2] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[2][i]), scale), d0));
+            a0.val[3] = roundToInt16(vaddq_f32(vmulq_n_f32(vld1q_f32(&inputs[3][i]), scale), d0));
+
+            vst4_s16(&output[4*i], a0);     // interleave
+        }
+    }
+
+    // remaining frames, through a zero-padded block
+    if (i < numFrames) {
+        float block[SRC_MAX_CHANNELS][4] = {};
+        float* blockInputs[SRC_MAX_CHANNELS];
+        int16_t blockOutput[SRC_MAX_CHANNELS * 4];
+        for (int j = 0; j < _numChannels; j++) {
+            memcpy(block[j], &inputs[j][i], (numFrames - i) * sizeof(float));
+            blockInputs[j] = block[j];
+        }
+        convertOutput(blockInputs, blockOutput, 4);
+        memcpy(&output[_numChannels*i], blockOutput, _numChannels * (numFrames - i) * sizeof(int16_t));
+    }
+}
+
+// deinterleave stereo
+void AudioSRC::convertInput(const float* input, float** outputs, int numFrames) {
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        memcpy(outputs[0], input, numFrames * sizeof(float));
+        i = numFrames;
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4x2_t f0 = vld2q_f32(&input[2*i]);  // deinterleave
+
+            vst1q_f32(&outputs[0][i], f0.val[0]);
+            vst1q_f32(&outputs[1][i], f0.val[1]);
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4x4_t f0 = vld4q_f32(&input[4*i]);  // deinterleave
+
+            vst1q_f32(&outputs[0][i], f0.val[0]);
+            vst1q_f32(&outputs[1][i], f0.val[1]);
+            vst1q_f32(&outputs[2][i], f0.val[2]);
+            vst1q_f32(&outputs[3][i], f0.val[3]);
+        }
+    }
+
+    // remaining frames
+    for (; i < numFrames; i++) {
+        for (int j = 0; j < _numChannels; j++) {
+            outputs[j][i] = input[_numChannels*i + j];
+        }
+    }
+}
+
+// interleave stereo
+void AudioSRC::convertOutput(float** inputs, float* output, int numFrames) {
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        memcpy(output, inputs[0], numFrames * sizeof(float));
+        i = numFrames;
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4x2_t f0;
+            f0.val[0] = vld1q_f32(&inputs[0][i]);
+            f0.val[1] = vld1q_f32(&inputs[1][i]);
+
+            vst2q_f32(&output[2*i], f0);    // interleave
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 3; i += 4) {
+            float32x4x4_t f0;
+            f0.val[0] = vld1q_f32(&inputs[0][i]);
+            f0.val[1] = vld1q_f32(&inputs[1][i]);
+            f0.val[2] = vld1q_f32(&inputs[2][i]);
+            f0.val[3] = vld1q_f32(&inputs[3][i]);
+
+            vst4q_f32(&output[4*i], f0);    // interleave
+        }
+    }
+
+    // remaining frames
+    for (; i < numFrames; i++) {
+        for (int j = 0; j < _numChannels; j++) {
+            output[_numChannels*i + j] = inputs[j][i];
+        }
+    }
+}
+
 #else   // portable reference code
 
 // convert int16_t to float, deinterleave stereo
@@ -97,6 +97,12 @@ private:
     void convertInput(const int16_t* input, float** outputs, int numFrames);
     void convertOutput(float** inputs, int16_t* output, int numFrames);
 
+    void convertInput_SSE2(const int16_t* input, float** outputs, int numFrames);
+    void convertOutput_SSE2(float** inputs, int16_t* output, int numFrames);
+
+    void convertInput_AVX2(const int16_t* input, float** outputs, int numFrames);
+    void convertOutput_AVX2(float** inputs, int16_t* output, int numFrames);
+
     void convertInput(const float* input, float** outputs, int numFrames);
     void convertOutput(float** inputs, float* output, int numFrames);
 };
@@ -154,6 +154,8 @@ int InboundAudioStream::parseData(ReceivedMessage& message) {
                 // some of the samples in order to catch up to our desired jitter buffer size.
                 writeDroppableSilentFrames(networkFrames);
             } else {
+                _silentFramesInRun = 0;
+
                 // note: PCM and no codec are identical
                 bool selectedPCM = _selectedCodecName == "pcm" || _selectedCodecName == "";
                 bool packetPCM = codecInPacket == "pcm" || codecInPacket == "";
@@ -191,20 +193,6 @@ int InboundAudioStream::parseData(ReceivedMessage& message) {
         qCInfo(audiostream, "Starve ended");
         _isStarved = false;
     }
-    // if the ringbuffer exceeds the desired size by more than the threshold specified,
-    // drop the oldest frames so the ringbuffer is down to the desired size.
-    if (framesAvailable > _desiredJitterBufferFrames + MAX_FRAMES_OVER_DESIRED) {
-        int framesToDrop = framesAvailable - (_desiredJitterBufferFrames + DESIRED_JITTER_BUFFER_FRAMES_PADDING);
-        _ringBuffer.shiftReadPosition(framesToDrop * _ringBuffer.getNumFrameSamples());
-        
-        _framesAvailableStat.reset();
-        _currentJitterBufferFrames = 0;
-
-        _oldFramesDropped += framesToDrop;
-
-        qCInfo(audiostream, "Dropped %d frames", framesToDrop);
-        qCInfo(audiostream, "Reset current jitter frames");
-    }
 
     framesAvailableChanged();
 
@@ -240,14 +228,12 @@ int InboundAudioStream::lostAudioData(int numPackets) {
 }
 
 int InboundAudioStream::parseAudioData(PacketType type, const QByteArray& packetAfterStreamProperties) {
-    QByteArray decodedBuffer;
-    if (_decoder) {
-        _decoder->decode(packetAfterStreamProperties, decodedBuffer);
-    } else {
-        decodedBuffer = packetAfterStreamProperties;
+    if (!_decoder) {
+        return _ringBuffer.writeData(packetAfterStreamProperties.constData(), packetAfterStreamProperties.size());
     }
-    auto actualSize = decodedBuffer.size();
-    return _ringBuffer.writeData(decodedBuffer.data(), actualSize);
+    // decode into the same buffer every time, so no allocation is made per packet
+    _decoder->decode(packetAfterStreamProperties, _decodedBuffer);
+    return _ringBuffer.writeData(_decodedBuffer.constData(), _decodedBuffer.size());
 }
 
 int InboundAudioStream::writeDroppableSilentFrames(int silentFrames) {
@@ -258,8 +244,13 @@ int InboundAudioStream::writeDroppableSilentFrames(int silentFrames) {
     // leave the decoder holding some unknown loud state. To handle this 
     // case we will call the decoder's lostFrame() method, which indicates
     // that it should interpolate from its last known state down toward 
-    // silence.
-    if (_decoder) {
+    // silence. Once the codec says its decoder has settled, the rest of
+    // the silent run is left alone so idle talkers cost no decoding.
+    bool flushDecoder = _dtxFlushFrames < 0 || _silentFramesInRun < _dtxFlushFrames;
+    if (_silentFramesInRun < _dtxFlushFrames) {
+        ++_silentFramesInRun;
+    }
+    if (_decoder && flushDecoder) {
         // FIXME - We could potentially use the output from the codec, in which 
         // case we might get a cleaner fade toward silence. NOTE: The below logic 
         // attempts to catch up in the event that the jitter buffers have grown. 
@@ -301,7 +292,28 @@ int InboundAudioStream::writeDroppableSilentFrames(int silentFrames) {
     return ret;
 }
 
+void InboundAudioStream::dropFramesOverDesired() {
+    // if the ringbuffer exceeds the desired size by more than the threshold specified,
+    // drop the oldest frames so the ringbuffer is down to the desired size.
+    // this is done by the consumer, so only the pop moves the ring buffer's read position
+    int framesAvailable = _ringBuffer.framesAvailable();
+    if (framesAvailable > _desiredJitterBufferFrames + MAX_FRAMES_OVER_DESIRED) {
+        int framesToDrop = framesAvailable - (_desiredJitterBufferFrames + DESIRED_JITTER_BUFFER_FRAMES_PADDING);
+        _ringBuffer.shiftReadPosition(framesToDrop * _ringBuffer.getNumFrameSamples());
+
+        _framesAvailableStat.reset();
+        _currentJitterBufferFrames = 0;
+
+        _oldFramesDropped += framesToDrop;
+
+        qCInfo(audiostream, "Dropped %d frames", framesToDrop);
+        qCInfo(audiostream, "Reset current jitter frames");
+    }
+}
+
 int InboundAudioStream::popSamples(int maxSamples, bool allOrNothing) {
+    dropFramesOverDesired();
+
     int samplesPopped = 0;
     int samplesAvailable = _ringBuffer.samplesAvailable();
     if (_isStarved) {
@@ -514,6 +526,7 @@ void InboundAudioStream::setupCodec(CodecPluginPointer codec, const QString& cod
     _selectedCodecName = codecName;
     if (_codec) {
         _decoder = codec->createDecoder(AudioConstants::SAMPLE_RATE, numChannels);
+        _dtxFlushFrames = _codec->getDTXFlushFrames();
     }
 }
 
@@ -526,4 +539,6 @@ void InboundAudioStream::cleanupCodec() {
         }
     }
     _selectedCodecName = "";
+    _dtxFlushFrames = -1;
+    _silentFramesInRun = 0;
 }
@@ -115,6 +115,7 @@ public slots:
 private:
     void packetReceivedUpdateTimingStats();
 
+    void dropFramesOverDesired();
     void popSamplesNoCheck(int samples);
     void framesAvailableChanged();
 
@@ -142,6 +143,7 @@ protected:
 
     AudioRingBuffer _ringBuffer;
     int _numChannels;
+    QByteArray _decodedBuffer; // reused by parseAudioData
 
     bool _lastPopSucceeded { false };
     AudioRingBuffer::ConstIterator _lastPopOutput;
@@ -186,6 +188,10 @@ protected:
     CodecPluginPointer _codec;
     QString _selectedCodecName;
     Decoder* _decoder { nullptr };
+
+    // discontinuous transmission state: the decoder is only flushed for the start of each silent run
+    int _dtxFlushFrames { -1 };
+    int _silentFramesInRun { 0 };
 };
 
 float calculateRepeatedFrameFadeFactor(int indexOfRepeat);
@@ -39,31 +39,24 @@ int InjectedAudioStream::parseStreamProperties(PacketType type,
     // read the channel flag
     bool isStereo;
     packetStream >> isStereo;
-    
-    // if isStereo value has changed, restart the ring buffer with new frame size
-    if (isStereo != _isStereo) {
-        _ringBuffer.resizeForFrameSize(isStereo
-                                       ? AudioConstants::NETWORK_FRAME_SAMPLES_STEREO
-                                       : AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-        _isStereo = isStereo;
-    }
+    parseChannelFlag(isStereo);
 
     // pull the loopback flag and set our boolean
     uchar shouldLoopback;
     packetStream >> shouldLoopback;
-    _shouldLoopbackForNode = (shouldLoopback == 1);
+    _parsedProperties.shouldLoopbackForNode = (shouldLoopback == 1);
 
     // use parsePositionalData in parent PostionalAudioRingBuffer class to pull common positional data
     packetStream.skipRawData(parsePositionalData(packetAfterSeqNum.mid(packetStream.device()->pos())));
 
     // pull out the radius for this injected source - if it's zero this is a point source
-    packetStream >> _radius;
+    packetStream >> _parsedRadius;
 
     quint8 attenuationByte = 0;
     packetStream >> attenuationByte;
-    _attenuationRatio = unpackFloatGainFromByte(attenuationByte);
+    _parsedAttenuationRatio = unpackFloatGainFromByte(attenuationByte);
     
-    packetStream >> _ignorePenumbra;
+    packetStream >> _parsedProperties.ignorePenumbra;
     
     int numAudioBytes = packetAfterSeqNum.size() - packetStream.device()->pos();
     numAudioSamples = numAudioBytes / sizeof(int16_t);
@@ -71,6 +64,12 @@ int InjectedAudioStream::parseStreamProperties(PacketType type,
     return packetStream.device()->pos();
 }
 
+void InjectedAudioStream::latchProperties() {
+    PositionalAudioStream::latchProperties();
+    _radius = _parsedRadius;
+    _attenuationRatio = _parsedAttenuationRatio;
+}
+
 AudioStreamStats InjectedAudioStream::getAudioStreamStats() const {
     AudioStreamStats streamStats = PositionalAudioStream::getAudioStreamStats();
     streamStats._streamIdentifier = _streamIdentifier;
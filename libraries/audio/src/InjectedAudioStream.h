@@ -25,6 +25,8 @@ public:
 
     virtual const QUuid& getStreamIdentifier() const override { return _streamIdentifier; }
 
+    virtual void latchProperties() override;
+
 private:
     // disallow copying of InjectedAudioStream objects
     InjectedAudioStream(const InjectedAudioStream&);
@@ -36,6 +38,10 @@ private:
     const QUuid _streamIdentifier;
     float _radius;
     float _attenuationRatio;
+
+    // as parsed from the latest packets, applied by latchProperties
+    float _parsedRadius { 0.0f };
+    float _parsedAttenuationRatio { 0.0f };
 };
 
 #endif // hifi_InjectedAudioStream_h
@@ -54,20 +54,19 @@ int MixedProcessedAudioStream::lostAudioData(int numPackets) {
 }
 
 int MixedProcessedAudioStream::parseAudioData(PacketType type, const QByteArray& packetAfterStreamProperties) {
-    QByteArray decodedBuffer;
     if (_decoder) {
-        _decoder->decode(packetAfterStreamProperties, decodedBuffer);
+        _decoder->decode(packetAfterStreamProperties, _decodedBuffer);
     } else {
-        decodedBuffer = packetAfterStreamProperties;
+        _decodedBuffer = packetAfterStreamProperties;
     }
 
-    emit addedStereoSamples(decodedBuffer);
+    emit addedStereoSamples(_decodedBuffer);
 
-    QByteArray outputBuffer;
-    emit processSamples(decodedBuffer, outputBuffer);
+    // the output buffer keeps its capacity from packet to packet
+    emit processSamples(_decodedBuffer, _outputBuffer);
 
-    _ringBuffer.writeData(outputBuffer.data(), outputBuffer.size());
-    qCDebug(audiostream, "Wrote %d samples to buffer (%d available)", outputBuffer.size() / (int)sizeof(int16_t), getSamplesAvailable());
+    _ringBuffer.writeData(_outputBuffer.constData(), _outputBuffer.size());
+    qCDebug(audiostream, "Wrote %d samples to buffer (%d available)", _outputBuffer.size() / (int)sizeof(int16_t), getSamplesAvailable());
 
     return packetAfterStreamProperties.size();
 }
@@ -44,6 +44,7 @@ private:
 private:
     quint64 _outputSampleRate;
     quint64 _outputChannelCount;
+    QByteArray _outputBuffer; // reused by parseAudioData
 };
 
 #endif // hifi_MixedProcessedAudioStream_h
@@ -36,15 +36,24 @@ PositionalAudioStream::PositionalAudioStream(PositionalAudioStream::Type type, b
     _lastPopOutputLoudness(0.0f),
     _quietestTrailingFrameLoudness(std::numeric_limits<float>::max()),
     _quietestFrameLoudness(0.0f),
-    _frameCounter(0) {}
+    _frameCounter(0)
+{
+    _parsedProperties.isStereo = isStereo;
+}
 
 void PositionalAudioStream::resetStats() {
     _lastPopOutputTrailingLoudness = 0.0f;
     _lastPopOutputLoudness = 0.0f;
+    _consecutiveSilentPops = 0;
 }
 
 void PositionalAudioStream::updateLastPopOutputLoudnessAndTrailingLoudness() {
     _lastPopOutputLoudness = _ringBuffer.getFrameLoudness(_lastPopOutput);
+    if (_lastPopOutputLoudness != 0.0f) {
+        _consecutiveSilentPops = 0;
+    } else if (_consecutiveSilentPops < 2) {
+        ++_consecutiveSilentPops;
+    }
 
     const int TRAILING_MUTE_THRESHOLD_FRAMES = 400;
     const int TRAILING_LOUDNESS_FRAMES = 200;
@@ -72,16 +81,46 @@ void PositionalAudioStream::updateLastPopOutputLoudnessAndTrailingLoudness() {
     }
 }
 
+void PositionalAudioStream::latchProperties() {
+    // the ring was resized when the new channel count was parsed, the last popped frame goes with the old buffers
+    if (!_retiredRingBuffers.empty()) {
+        _lastPopOutput = AudioRingBuffer::ConstIterator();
+        _lastPopSucceeded = false;
+        _retiredRingBuffers.clear();
+    }
+    _isStereo = _parsedProperties.isStereo;
+
+    _position = _parsedProperties.position;
+    _orientation = _parsedProperties.orientation;
+    _avatarBoundingBoxCorner = _parsedProperties.avatarBoundingBoxCorner;
+    _avatarBoundingBoxScale = _parsedProperties.avatarBoundingBoxScale;
+    _shouldLoopbackForNode = _parsedProperties.shouldLoopbackForNode;
+    _ignorePenumbra = _parsedProperties.ignorePenumbra;
+}
+
+void PositionalAudioStream::parseChannelFlag(bool isStereo) {
+    _parsedProperties.isStereo = isStereo;
+
+    int numFrameSamples = isStereo ? AudioConstants::NETWORK_FRAME_SAMPLES_STEREO
+                                   : AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+    if (_ringBuffer.getNumFrameSamples() != numFrameSamples) {
+        _retiredRingBuffers.push_back(_ringBuffer.resizeForChannelCount(numFrameSamples));
+    }
+}
+
 int PositionalAudioStream::parsePositionalData(const QByteArray& positionalByteArray) {
     QDataStream packetStream(positionalByteArray);
 
-    packetStream.readRawData(reinterpret_cast<char*>(&_position), sizeof(_position));
-    packetStream.readRawData(reinterpret_cast<char*>(&_orientation), sizeof(_orientation));
-    packetStream.readRawData(reinterpret_cast<char*>(&_avatarBoundingBoxCorner), sizeof(_avatarBoundingBoxCorner));
-    packetStream.readRawData(reinterpret_cast<char*>(&_avatarBoundingBoxScale), sizeof(_avatarBoundingBoxScale));
+    auto& properties = _parsedProperties;
+    packetStream.readRawData(reinterpret_cast<char*>(&properties.position), sizeof(properties.position));
+    packetStream.readRawData(reinterpret_cast<char*>(&properties.orientation), sizeof(properties.orientation));
+    packetStream.readRawData(reinterpret_cast<char*>(&properties.avatarBoundingBoxCorner),
+                             sizeof(properties.avatarBoundingBoxCorner));
+    packetStream.readRawData(reinterpret_cast<char*>(&properties.avatarBoundingBoxScale),
+                             sizeof(properties.avatarBoundingBoxScale));
 
     // if this node sent us a NaN for first float in orientation then don't consider this good audio and bail
-    if (glm::isnan(_orientation.x)) {
+    if (glm::isnan(properties.orientation.x)) {
         // NOTE: why would we reset the ring buffer here?
         _ringBuffer.reset();
         return 0;
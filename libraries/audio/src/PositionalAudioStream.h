@@ -12,6 +12,9 @@
 #ifndef hifi_PositionalAudioStream_h
 #define hifi_PositionalAudioStream_h
 
+#include <memory>
+#include <vector>
+
 #include <glm/gtx/quaternion.hpp>
 #include <AABox.h>
 
@@ -36,11 +39,19 @@ public:
 
     virtual AudioStreamStats getAudioStreamStats() const override;
 
+    // applies the properties parsed since the last call; called once per frame, before popping, so that
+    // the properties the mix reads change together with the frame it mixes
+    virtual void latchProperties();
+
     void updateLastPopOutputLoudnessAndTrailingLoudness();
     float getLastPopOutputTrailingLoudness() const { return _lastPopOutputTrailingLoudness; }
     float getLastPopOutputLoudness() const { return _lastPopOutputLoudness; }
     float getQuietestFrameLoudness() const { return _quietestFrameLoudness; }
 
+    // an idle stream has popped silence for more than one frame in a row: its first silent frame already flushed
+    // every listener's HRTF, so mixing can skip it entirely until it is audible again
+    bool isIdle() const { return _lastPopSucceeded && _consecutiveSilentPops > 1; }
+
     bool shouldLoopbackForNode() const { return _shouldLoopbackForNode; }
     bool isStereo() const { return _isStereo; }
     PositionalAudioStream::Type getType() const { return _type; }
@@ -57,7 +68,26 @@ protected:
 
     int parsePositionalData(const QByteArray& positionalByteArray);
 
+    // records the channel flag of a parsed packet; a change resizes the ring now, before the packet's audio is written
+    // to it, while isStereo() follows at the latch along with the frame the mix reads
+    void parseChannelFlag(bool isStereo);
+
 protected:
+    // the properties as parsed from the latest packets, applied by latchProperties
+    struct Properties {
+        glm::vec3 position { 0.0f };
+        glm::quat orientation { 0.0f, 0.0f, 0.0f, 0.0f };
+        glm::vec3 avatarBoundingBoxCorner;
+        glm::vec3 avatarBoundingBoxScale;
+        bool shouldLoopbackForNode { false };
+        bool isStereo { false };
+        bool ignorePenumbra { false };
+    };
+    Properties _parsedProperties;
+
+    // ring buffers replaced by a change in channel count since the last latch, which the mix may still be reading
+    std::vector<std::unique_ptr<int16_t[]>> _retiredRingBuffers;
+
     Type _type;
     glm::vec3 _position;
     glm::quat _orientation;
@@ -75,6 +105,7 @@ protected:
     float _quietestTrailingFrameLoudness;
     float _quietestFrameLoudness;
     int _frameCounter;
+    int _consecutiveSilentPops { 0 };
 };
 
 #endif // hifi_PositionalAudioStream_h
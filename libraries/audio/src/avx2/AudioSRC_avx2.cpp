@@ -299,4 +299,178 @@ int AudioSRC::multirateFilter4_AVX2(const float* input0, const float* input1, co
     return outputFrames;
 }
 
+// convert int16_t to float, deinterleave stereo
+void AudioSRC::convertInput_AVX2(const int16_t* input, float** outputs, int numFrames) {
+    __m256 scale = _mm256_set1_ps(1/32768.0f);
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256i a0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i*)&input[i]));
+
+            __m256 f0 = _mm256_mul_ps(_mm256_cvtepi32_ps(a0), scale);
+
+            _mm256_storeu_ps(&outputs[0][i], f0);
+        }
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256i a0 = _mm256_loadu_si256((__m256i*)&input[2*i]);
+
+            // deinterleave and sign-extend
+            __m256i a1 = _mm256_srai_epi32(a0, 16);
+            a0 = _mm256_srai_epi32(_mm256_slli_epi32(a0, 16), 16);
+
+            __m256 f0 = _mm256_mul_ps(_mm256_cvtepi32_ps(a0), scale);
+            __m256 f1 = _mm256_mul_ps(_mm256_cvtepi32_ps(a1), scale);
+
+            _mm256_storeu_ps(&outputs[0][i], f0);
+            _mm256_storeu_ps(&outputs[1][i], f1);
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256i a0 = _mm256_loadu_si256((__m256i*)&input[4*i+0]);
+            __m256i a2 = _mm256_loadu_si256((__m256i*)&input[4*i+16]);
+
+            // sign-extend channels 0,2 and 1,3
+            __m256i a1 = _mm256_srai_epi32(a0, 16);
+            __m256i a3 = _mm256_srai_epi32(a2, 16);
+            a0 = _mm256_srai_epi32(_mm256_slli_epi32(a0, 16), 16);
+            a2 = _mm256_srai_epi32(_mm256_slli_epi32(a2, 16), 16);
+
+            __m256 f0 = _mm256_mul_ps(_mm256_cvtepi32_ps(a0), scale);
+            __m256 f1 = _mm256_mul_ps(_mm256_cvtepi32_ps(a1), scale);
+            __m256 f2 = _mm256_mul_ps(_mm256_cvtepi32_ps(a2), scale);
+            __m256 f3 = _mm256_mul_ps(_mm256_cvtepi32_ps(a3), scale);
+
+            // deinterleave, then restore frame order across the 128-bit lanes
+            __m256 c0 = _mm256_shuffle_ps(f0, f2, _MM_SHUFFLE(2,0,2,0));
+            __m256 c1 = _mm256_shuffle_ps(f1, f3, _MM_SHUFFLE(2,0,2,0));
+            __m256 c2 = _mm256_shuffle_ps(f0, f2, _MM_SHUFFLE(3,1,3,1));
+            __m256 c3 = _mm256_shuffle_ps(f1, f3, _MM_SHUFFLE(3,1,3,1));
+
+            _mm256_storeu_ps(&outputs[0][i], _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(c0), _MM_SHUFFLE(3,1,2,0))));
+            _mm256_storeu_ps(&outputs[1][i], _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(c1), _MM_SHUFFLE(3,1,2,0))));
+            _mm256_storeu_ps(&outputs[2][i], _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(c2), _MM_SHUFFLE(3,1,2,0))));
+            _mm256_storeu_ps(&outputs[3][i], _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(c3), _MM_SHUFFLE(3,1,2,0))));
+        }
+    }
+
+    // remaining frames
+    if (i < numFrames) {
+        float* tails[SRC_MAX_CHANNELS];
+        for (int j = 0; j < _numChannels; j++) {
+            tails[j] = &outputs[j][i];
+        }
+        convertInput_SSE2(&input[_numChannels * i], tails, numFrames - i);
+    }
+}
+
+// fast TPDF dither in [-1.0f, 1.0f]
+static inline __m256 dither8() {
+    static __m256i rz = _mm256_set_epi16(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+
+    // update the 16 different maximum-length LCGs
+    rz = _mm256_mullo_epi16(rz, _mm256_set_epi16(25173, -25511, -5975, -23279, 19445, -27591, 30185, -3495,
+                                                  25173, -25511, -5975, -23279, 19445, -27591, 30185, -3495));
+    rz = _mm256_add_epi16(rz, _mm256_set_epi16(13849, -32767, 105, -19675, -7701, -32679, -13225, 28013,
+                                               13849, -32767, 105, -19675, -7701, -32679, -13225, 28013));
+
+    // promote to 32-bit
+    __m256i r0 = _mm256_unpacklo_epi16(rz, _mm256_setzero_si256());
+    __m256i r1 = _mm256_unpackhi_epi16(rz, _mm256_setzero_si256());
+
+    // return (r0 - r1) * (1/65536.0f);
+    __m256 d0 = _mm256_cvtepi32_ps(_mm256_sub_epi32(r0, r1));
+    return _mm256_mul_ps(d0, _mm256_set1_ps(1/65536.0f));
+}
+
+// convert float to int16_t with dither, interleave stereo
+void AudioSRC::convertOutput_AVX2(float** inputs, int16_t* output, int numFrames) {
+    __m256 scale = _mm256_set1_ps(32768.0f);
+
+    int i = 0;
+    if (_numChannels == 1) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256 f0 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[0][i]), scale);
+
+            f0 = _mm256_add_ps(f0, dither8());
+
+            // round and saturate
+            __m256i a0 = _mm256_cvtps_epi32(f0);
+            a0 = _mm256_packs_epi32(a0, a0);
+            a0 = _mm256_permute4x64_epi64(a0, _MM_SHUFFLE(3,1,2,0));
+
+            _mm_storeu_si128((__m128i*)&output[i], _mm256_castsi256_si128(a0));
+        }
+
+    } else if (_numChannels == 2) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256 f0 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[0][i]), scale);
+            __m256 f1 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[1][i]), scale);
+
+            __m256 d0 = dither8();
+            f0 = _mm256_add_ps(f0, d0);
+            f1 = _mm256_add_ps(f1, d0);
+
+            // round and saturate
+            __m256i a0 = _mm256_cvtps_epi32(f0);
+            __m256i a1 = _mm256_cvtps_epi32(f1);
+            a0 = _mm256_packs_epi32(a0, a0);
+            a1 = _mm256_packs_epi32(a1, a1);
+
+            // interleave, frames 0-3 land in the low lane and 4-7 in the high lane
+            a0 = _mm256_unpacklo_epi16(a0, a1);
+            _mm256_storeu_si256((__m256i*)&output[2*i], a0);
+        }
+
+    } else if (_numChannels == 4) {
+
+        for (; i < numFrames - 7; i += 8) {
+            __m256 f0 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[0][i]), scale);
+            __m256 f1 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[1][i]), scale);
+            __m256 f2 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[2][i]), scale);
+            __m256 f3 = _mm256_mul_ps(_mm256_loadu_ps(&inputs[3][i]), scale);
+
+            __m256 d0 = dither8();
+            f0 = _mm256_add_ps(f0, d0);
+            f1 = _mm256_add_ps(f1, d0);
+            f2 = _mm256_add_ps(f2, d0);
+            f3 = _mm256_add_ps(f3, d0);
+
+            // round and saturate
+            __m256i a0 = _mm256_cvtps_epi32(f0);
+            __m256i a1 = _mm256_cvtps_epi32(f1);
+            __m256i a2 = _mm256_cvtps_epi32(f2);
+            __m256i a3 = _mm256_cvtps_epi32(f3);
+            a0 = _mm256_packs_epi32(a0, a2);
+            a1 = _mm256_packs_epi32(a1, a3);
+
+            // interleave, each lane holds frames 0-1 and 2-3 of its half
+            a2 = _mm256_unpacklo_epi16(a0, a1);
+            a3 = _mm256_unpackhi_epi16(a0, a1);
+            a0 = _mm256_unpacklo_epi32(a2, a3);
+            a1 = _mm256_unpackhi_epi32(a2, a3);
+
+            _mm256_storeu_si256((__m256i*)&output[4*i+0], _mm256_permute2x128_si256(a0, a1, 0x20));
+            _mm256_storeu_si256((__m256i*)&output[4*i+16], _mm256_permute2x128_si256(a0, a1, 0x31));
+        }
+    }
+
+    // remaining frames
+    if (i < numFrames) {
+        float* tails[SRC_MAX_CHANNELS];
+        for (int j = 0; j < _numChannels; j++) {
+            tails[j] = &inputs[j][i];
+        }
+        convertOutput_SSE2(tails, &output[_numChannels * i], numFrames - i);
+    }
+}
+
 #endif
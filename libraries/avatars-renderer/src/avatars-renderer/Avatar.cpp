@@ -703,7 +703,7 @@ void Avatar::fixupModelsInScene(const render::ScenePointer& scene) {
     }
     _attachmentsToDelete.insert(_attachmentsToDelete.end(), _attachmentsToRemove.begin(), _attachmentsToRemove.end());
     _attachmentsToRemove.clear();
-    scene->enqueueTransaction(transaction);
+    scene->enqueueTransaction(std::move(transaction));
 }
 
 bool Avatar::shouldRenderHead(const RenderArgs* renderArgs) const {
@@ -14,6 +14,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <limits>
 #include <stdint.h>
 
 #include <QtCore/QDataStream>
@@ -37,6 +38,7 @@
 #include <shared/JSONHelpers.h>
 #include <ShapeInfo.h>
 #include <AudioHelpers.h>
+#include <FaceshiftConstants.h>
 #include <Profile.h>
 #include <VariantMapToScriptValue.h>
 
@@ -2126,7 +2128,7 @@ void AvatarData::fromJson(const QJsonObject& json, bool useFrameSkeleton) {
 // This allows the application to decide whether playback should be relative to an avatar's
 // transform at the start of playback, or relative to the transform of the recorded
 // avatar
-QByteArray AvatarData::toFrame(const AvatarData& avatar) {
+QByteArray AvatarData::toJsonFrame(const AvatarData& avatar) {
     QJsonObject root = avatar.toJson();
 #ifdef WANT_JSON_DEBUG
     {
@@ -2138,8 +2140,317 @@ QByteArray AvatarData::toFrame(const AvatarData& avatar) {
     return QJsonDocument(root).toBinaryData();
 }
 
+/*
+    Binary recording frames
+
+    struct AvatarFrame {
+        char tag[4];                        // AVATAR_FRAME_TAG, QJsonDocument binary data starts with "qbjs" instead
+        uint8_t version;                    // AVATAR_FRAME_VERSION
+        uint8_t flags;                      // AvatarFrameFlag
+        uint32_t sequence;                  // frame number within the recording, key frames are every AVATAR_KEY_FRAME_INTERVAL
+        String skeletonModelURL;            // if AVATAR_FRAME_HAS_SKELETON_MODEL, uint16_t length + utf8
+        String displayName;                 // if AVATAR_FRAME_HAS_DISPLAY_NAME, uint16_t length + utf8
+        Bytes attachments;                  // if AVATAR_FRAME_HAS_ATTACHMENTS, uint32_t length + QJsonDocument binary array
+        Transform basis;                    // if AVATAR_FRAME_HAS_BASIS, vec3 translation, quat rotation, vec3 scale
+        Transform relative;                 // if AVATAR_FRAME_HAS_RELATIVE
+        float scale;
+        uint8_t headFlags;                  // if AVATAR_FRAME_HAS_HEAD, AvatarFrameHeadFlag
+        SixByteQuat headRotation;           //   if HEAD_HAS_ROTATION
+        vec3 lookAt;                        //   if HEAD_HAS_LOOK_AT, relative to the avatar
+        uint8_t numBlendshapes;
+        { uint8_t index; float value; } blendshapes[numBlendshapes];
+        uint16_t numJoints;
+        {
+            uint8_t jointFlags;             // AvatarFrameJointFlag
+            SixByteQuat rotation;           // if JOINT_CHANGED and JOINT_ROTATION_SET
+            SixByteTrans translation;       // if JOINT_CHANGED and JOINT_TRANSLATION_SET
+        } joints[numJoints];
+    };
+
+    The rarely changing strings and attachments are only written in key frames and when they change.  A joint that is
+    unchanged since the previous frame keeps the value the reader last decoded for it, so a player that seeks has to
+    decode the frames from the key frame before the new position on, which recording::Deck::seek() replays.
+*/
+static const char AVATAR_FRAME_TAG[] = { 'h', 'f', 'a', 'v' };
+static const int AVATAR_FRAME_TAG_SIZE = sizeof(AVATAR_FRAME_TAG);
+static const quint8 AVATAR_FRAME_VERSION = 1;
+static const quint32 AVATAR_KEY_FRAME_INTERVAL = 60;
+
+enum AvatarFrameFlag : quint8 {
+    AVATAR_FRAME_KEY = 0x01,
+    AVATAR_FRAME_HAS_SKELETON_MODEL = 0x02,
+    AVATAR_FRAME_HAS_DISPLAY_NAME = 0x04,
+    AVATAR_FRAME_HAS_ATTACHMENTS = 0x08,
+    AVATAR_FRAME_HAS_BASIS = 0x10,
+    AVATAR_FRAME_HAS_RELATIVE = 0x20,
+    AVATAR_FRAME_HAS_HEAD = 0x40
+};
+
+enum AvatarFrameHeadFlag : quint8 {
+    HEAD_HAS_ROTATION = 0x01,
+    HEAD_HAS_LOOK_AT = 0x02
+};
+
+enum AvatarFrameJointFlag : quint8 {
+    JOINT_ROTATION_SET = 0x01,
+    JOINT_TRANSLATION_SET = 0x02,
+    JOINT_CHANGED = 0x04
+};
+
+static const int SIX_BYTE_QUAT_SIZE = 6;
+static const int SIX_BYTE_TRANS_SIZE = 6;
+static const int PACKED_JOINT_SIZE = 1 + SIX_BYTE_QUAT_SIZE + SIX_BYTE_TRANS_SIZE;
+
+template <typename T>
+static void appendPrimitive(QByteArray& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void appendString(QByteArray& buffer, const QString& string) {
+    QByteArray utf8 = string.toUtf8();
+    quint16 length = (quint16)std::min(utf8.size(), (int)std::numeric_limits<quint16>::max());
+    appendPrimitive(buffer, length);
+    buffer.append(utf8.constData(), length);
+}
+
+static void appendTransform(QByteArray& buffer, const Transform& transform) {
+    appendPrimitive(buffer, transform.getTranslation());
+    appendPrimitive(buffer, transform.getRotation());
+    appendPrimitive(buffer, transform.getScale());
+}
+
+class AvatarFrameReader {
+public:
+    AvatarFrameReader(const QByteArray& data) :
+        _cursor(reinterpret_cast<const unsigned char*>(data.constData())),
+        _end(_cursor + data.size()) {}
+
+    bool isValid() const { return _valid; }
+
+    template <typename T>
+    T read() {
+        T value {};
+        if (const unsigned char* bytes = skip(sizeof(T))) {
+            memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+
+    // returns the skipped bytes, or nullptr if the frame is too short
+    const unsigned char* skip(int size) {
+        if (!_valid || _end - _cursor < size) {
+            _valid = false;
+            return nullptr;
+        }
+        const unsigned char* bytes = _cursor;
+        _cursor += size;
+        return bytes;
+    }
+
+    QString readString() {
+        quint16 length = read<quint16>();
+        const unsigned char* bytes = skip(length);
+        return bytes ? QString::fromUtf8(reinterpret_cast<const char*>(bytes), length) : QString();
+    }
+
+    QByteArray readBytes() {
+        quint32 length = read<quint32>();
+        const unsigned char* bytes = skip((int)std::min(length, (quint32)std::numeric_limits<int>::max()));
+        return bytes ? QByteArray(reinterpret_cast<const char*>(bytes), length) : QByteArray();
+    }
+
+    Transform readTransform() {
+        Transform transform;
+        transform.setTranslation(read<glm::vec3>());
+        transform.setRotation(read<glm::quat>());
+        transform.setScale(read<glm::vec3>());
+        return transform;
+    }
+
+private:
+    const unsigned char* _cursor;
+    const unsigned char* _end;
+    bool _valid { true };
+};
+
+QByteArray AvatarData::toFrame(const AvatarData& avatar, AvatarFrameEncoder& encoder) {
+
+    // quantize the joints up front, so that we can tell which ones changed since the last frame
+    QByteArray packedJoints;
+    {
+        QReadLocker readLock(&avatar._jointDataLock);
+        packedJoints.fill(0, avatar._jointData.size() * PACKED_JOINT_SIZE);
+        unsigned char* packedJoint = reinterpret_cast<unsigned char*>(packedJoints.data());
+        for (const auto& joint : avatar._jointData) {
+            packedJoint[0] = (joint.rotationSet ? JOINT_ROTATION_SET : 0) | (joint.translationSet ? JOINT_TRANSLATION_SET : 0);
+            if (joint.rotationSet) {
+                packOrientationQuatToSixBytes(packedJoint + 1, joint.rotation);
+            }
+            if (joint.translationSet) {
+                packFloatVec3ToSignedTwoByteFixed(packedJoint + 1 + SIX_BYTE_QUAT_SIZE, joint.translation,
+                                                  TRANSLATION_COMPRESSION_RADIX);
+            }
+            packedJoint += PACKED_JOINT_SIZE;
+        }
+    }
+    int numJoints = std::min(packedJoints.size() / PACKED_JOINT_SIZE, (int)std::numeric_limits<quint16>::max());
+
+    encoder._sequence = encoder._valid ? encoder._sequence + 1 : 0;
+    bool isKeyFrame = !encoder._valid || (encoder._sequence % AVATAR_KEY_FRAME_INTERVAL) == 0 ||
+        encoder._packedJoints.size() != packedJoints.size();
+
+    quint8 flags = isKeyFrame ? AVATAR_FRAME_KEY : 0;
+
+    QString skeletonModelURL = avatar.getSkeletonModelURL().toString();
+    if (isKeyFrame || skeletonModelURL != encoder._skeletonModelURL) {
+        flags |= AVATAR_FRAME_HAS_SKELETON_MODEL;
+        encoder._skeletonModelURL = skeletonModelURL;
+    }
+    QString displayName = avatar.getDisplayName();
+    if (isKeyFrame || displayName != encoder._displayName) {
+        flags |= AVATAR_FRAME_HAS_DISPLAY_NAME;
+        encoder._displayName = displayName;
+    }
+    QVector<AttachmentData> attachments = avatar.getAttachmentData();
+    if (isKeyFrame || attachments != encoder._attachments) {
+        flags |= AVATAR_FRAME_HAS_ATTACHMENTS;
+        encoder._attachments = attachments;
+    }
+
+    auto recordingBasis = avatar.getRecordingBasis();
+    bool success;
+    Transform avatarTransform = avatar.getTransform(success);
+    if (!success) {
+        qCWarning(avatars) << "Warning -- AvatarData::toFrame couldn't get avatar transform";
+    }
+    avatarTransform.setScale(avatar.getDomainLimitedScale());
+    Transform relativeTransform;
+    if (recordingBasis) {
+        flags |= AVATAR_FRAME_HAS_BASIS;
+        relativeTransform = recordingBasis->relativeTransform(avatarTransform);
+        if (!relativeTransform.isIdentity()) {
+            flags |= AVATAR_FRAME_HAS_RELATIVE;
+        }
+    } else {
+        relativeTransform = avatarTransform;
+        flags |= AVATAR_FRAME_HAS_RELATIVE;
+    }
+
+    const HeadData* head = avatar.getHeadData();
+    if (head) {
+        flags |= AVATAR_FRAME_HAS_HEAD;
+    }
+
+    QByteArray frame;
+    frame.reserve(AVATAR_FRAME_TAG_SIZE + 128 + numJoints * PACKED_JOINT_SIZE);
+    frame.append(AVATAR_FRAME_TAG, AVATAR_FRAME_TAG_SIZE);
+    appendPrimitive(frame, AVATAR_FRAME_VERSION);
+    appendPrimitive(frame, flags);
+    appendPrimitive(frame, encoder._sequence);
+
+    if (flags & AVATAR_FRAME_HAS_SKELETON_MODEL) {
+        appendString(frame, skeletonModelURL);
+    }
+    if (flags & AVATAR_FRAME_HAS_DISPLAY_NAME) {
+        appendString(frame, displayName);
+    }
+    if (flags & AVATAR_FRAME_HAS_ATTACHMENTS) {
+        QJsonArray attachmentsJson;
+        for (auto attachment : attachments) {
+            attachmentsJson.push_back(attachment.toJson());
+        }
+        QByteArray attachmentsData = QJsonDocument(attachmentsJson).toBinaryData();
+        appendPrimitive(frame, (quint32)attachmentsData.size());
+        frame.append(attachmentsData);
+    }
+    if (flags & AVATAR_FRAME_HAS_BASIS) {
+        appendTransform(frame, *recordingBasis);
+    }
+    if (flags & AVATAR_FRAME_HAS_RELATIVE) {
+        appendTransform(frame, relativeTransform);
+    }
+    appendPrimitive(frame, avatar.getDomainLimitedScale());
+
+    if (head) {
+        glm::quat headRotation = head->getRawOrientation();
+        glm::vec3 lookAt = head->getLookAtPosition();
+        quint8 headFlags = (headRotation != glm::quat() ? HEAD_HAS_ROTATION : 0) | (lookAt != glm::vec3() ? HEAD_HAS_LOOK_AT : 0);
+        appendPrimitive(frame, headFlags);
+        if (headFlags & HEAD_HAS_ROTATION) {
+            unsigned char packedRotation[SIX_BYTE_QUAT_SIZE];
+            packOrientationQuatToSixBytes(packedRotation, headRotation);
+            frame.append(reinterpret_cast<const char*>(packedRotation), SIX_BYTE_QUAT_SIZE);
+        }
+        if (headFlags & HEAD_HAS_LOOK_AT) {
+            appendPrimitive(frame, glm::inverse(avatar.getOrientation()) * (lookAt - avatar.getPosition()));
+        }
+
+        // the same summed, non-zero coefficients HeadData::toJson() stores by name
+        int numBlendshapesOffset = frame.size();
+        quint8 numBlendshapes = 0;
+        appendPrimitive(frame, numBlendshapes);
+        for (int i = 0; i < NUM_FACESHIFT_BLENDSHAPES; i++) {
+            float value = 0.0f;
+            if (i < head->_blendshapeCoefficients.size()) {
+                value += head->_blendshapeCoefficients[i];
+            }
+            if (i < head->_transientBlendshapeCoefficients.size()) {
+                value += head->_transientBlendshapeCoefficients[i];
+            }
+            if (value != 0.0f) {
+                appendPrimitive(frame, (quint8)i);
+                appendPrimitive(frame, value);
+                numBlendshapes++;
+            }
+        }
+        frame[numBlendshapesOffset] = (char)numBlendshapes;
+    }
+
+    appendPrimitive(frame, (quint16)numJoints);
+    const unsigned char* packedJoint = reinterpret_cast<const unsigned char*>(packedJoints.constData());
+    const unsigned char* previousJoint = reinterpret_cast<const unsigned char*>(encoder._packedJoints.constData());
+    for (int i = 0; i < numJoints; i++) {
+        quint8 jointFlags = packedJoint[0];
+        if (isKeyFrame || memcmp(packedJoint, previousJoint, PACKED_JOINT_SIZE) != 0) {
+            jointFlags |= JOINT_CHANGED;
+        }
+        appendPrimitive(frame, jointFlags);
+        if (jointFlags & JOINT_CHANGED) {
+            if (jointFlags & JOINT_ROTATION_SET) {
+                frame.append(reinterpret_cast<const char*>(packedJoint + 1), SIX_BYTE_QUAT_SIZE);
+            }
+            if (jointFlags & JOINT_TRANSLATION_SET) {
+                frame.append(reinterpret_cast<const char*>(packedJoint + 1 + SIX_BYTE_QUAT_SIZE), SIX_BYTE_TRANS_SIZE);
+            }
+        }
+        packedJoint += PACKED_JOINT_SIZE;
+        previousJoint += PACKED_JOINT_SIZE;
+    }
+
+    encoder._packedJoints = packedJoints;
+    encoder._valid = true;
+    return frame;
+}
+
+static bool isBinaryFrame(const QByteArray& frameData) {
+    return frameData.size() > AVATAR_FRAME_TAG_SIZE && memcmp(frameData.constData(), AVATAR_FRAME_TAG, AVATAR_FRAME_TAG_SIZE) == 0;
+}
+
+bool AvatarData::isKeyFrame(const QByteArray& frameData) {
+    // JSON frames always carry the whole avatar
+    if (!isBinaryFrame(frameData)) {
+        return true;
+    }
+    const int FLAGS_OFFSET = AVATAR_FRAME_TAG_SIZE + sizeof(AVATAR_FRAME_VERSION);
+    return frameData.size() > FLAGS_OFFSET && (frameData[FLAGS_OFFSET] & AVATAR_FRAME_KEY) != 0;
+}
+
+void AvatarData::fromFrame(const QByteArray& frameData, AvatarData& result, AvatarFrameDecoder& decoder, bool useFrameSkeleton) {
+    if (isBinaryFrame(frameData)) {
+        result.fromBinaryFrame(frameData, decoder, useFrameSkeleton);
+        return;
+    }
 
-void AvatarData::fromFrame(const QByteArray& frameData, AvatarData& result, bool useFrameSkeleton) {
     QJsonDocument doc = QJsonDocument::fromBinaryData(frameData);
 
 #ifdef WANT_JSON_DEBUG
@@ -2152,6 +2463,177 @@ void AvatarData::fromFrame(const QByteArray& frameData, AvatarData& result, bool
     result.fromJson(doc.object(), useFrameSkeleton);
 }
 
+void AvatarData::fromBinaryFrame(const QByteArray& frameData, AvatarFrameDecoder& decoder, bool useFrameSkeleton) {
+    AvatarFrameReader reader(frameData);
+    reader.skip(AVATAR_FRAME_TAG_SIZE);
+    quint8 version = reader.read<quint8>();
+    if (version > AVATAR_FRAME_VERSION) {
+        quint64 now = usecTimestampNow();
+        if (shouldLogError(now)) {
+            qCWarning(avatars) << "Avatar recording frame version" << version << "not supported";
+        }
+        return;
+    }
+    quint8 flags = reader.read<quint8>();
+    quint32 sequence = reader.read<quint32>();
+
+    // everything is read before anything is applied, so a truncated frame leaves the avatar untouched
+    QString skeletonModelURL;
+    if (flags & AVATAR_FRAME_HAS_SKELETON_MODEL) {
+        skeletonModelURL = reader.readString();
+    }
+    QString displayName;
+    if (flags & AVATAR_FRAME_HAS_DISPLAY_NAME) {
+        displayName = reader.readString();
+    }
+    QVector<AttachmentData> attachments;
+    if (flags & AVATAR_FRAME_HAS_ATTACHMENTS) {
+        QJsonArray attachmentsJson = QJsonDocument::fromBinaryData(reader.readBytes()).array();
+        for (auto attachmentJson : attachmentsJson) {
+            AttachmentData attachment;
+            attachment.fromJson(attachmentJson.toObject());
+            attachments.push_back(attachment);
+        }
+    }
+    Transform basis;
+    if (flags & AVATAR_FRAME_HAS_BASIS) {
+        basis = reader.readTransform();
+    }
+    Transform relativeTransform;
+    if (flags & AVATAR_FRAME_HAS_RELATIVE) {
+        relativeTransform = reader.readTransform();
+    }
+    float scale = reader.read<float>();
+
+    quint8 headFlags = 0;
+    glm::quat headRotation;
+    glm::vec3 relativeLookAt;
+    quint8 blendshapeIndices[std::numeric_limits<quint8>::max()];
+    float blendshapeValues[std::numeric_limits<quint8>::max()];
+    quint8 numBlendshapes = 0;
+    if (flags & AVATAR_FRAME_HAS_HEAD) {
+        headFlags = reader.read<quint8>();
+        if (headFlags & HEAD_HAS_ROTATION) {
+            if (const unsigned char* packedRotation = reader.skip(SIX_BYTE_QUAT_SIZE)) {
+                unpackOrientationQuatFromSixBytes(packedRotation, headRotation);
+            }
+        }
+        if (headFlags & HEAD_HAS_LOOK_AT) {
+            relativeLookAt = reader.read<glm::vec3>();
+        }
+        numBlendshapes = reader.read<quint8>();
+        for (int i = 0; i < numBlendshapes; i++) {
+            blendshapeIndices[i] = reader.read<quint8>();
+            blendshapeValues[i] = reader.read<float>();
+        }
+    }
+
+    // joints decode in place over the previous frame; unchanged joints keep their last value
+    quint16 numJoints = reader.read<quint16>();
+    QVector<JointData> joints = decoder._joints;
+    joints.resize(numJoints);
+    for (int i = 0; i < numJoints && reader.isValid(); i++) {
+        quint8 jointFlags = reader.read<quint8>();
+        if (jointFlags & JOINT_CHANGED) {
+            JointData& joint = joints[i];
+            joint.rotationSet = (jointFlags & JOINT_ROTATION_SET) != 0;
+            if (joint.rotationSet) {
+                if (const unsigned char* packedRotation = reader.skip(SIX_BYTE_QUAT_SIZE)) {
+                    unpackOrientationQuatFromSixBytes(packedRotation, joint.rotation);
+                }
+            }
+            joint.translationSet = (jointFlags & JOINT_TRANSLATION_SET) != 0;
+            if (joint.translationSet) {
+                if (const unsigned char* packedTranslation = reader.skip(SIX_BYTE_TRANS_SIZE)) {
+                    unpackFloatVec3FromSignedTwoByteFixed(packedTranslation, joint.translation, TRANSLATION_COMPRESSION_RADIX);
+                }
+            }
+        }
+    }
+
+    if (!reader.isValid()) {
+        quint64 now = usecTimestampNow();
+        if (shouldLogError(now)) {
+            qCWarning(avatars) << "Truncated avatar recording frame" << sequence << "ignored";
+        }
+        return;
+    }
+
+    if (!(flags & AVATAR_FRAME_KEY) && (!decoder._valid || sequence != decoder._sequence + 1)) {
+        // the player skipped frames since the last key frame, so the joints this frame doesn't carry are stale
+        quint64 now = usecTimestampNow();
+        if (shouldLogError(now)) {
+            qCWarning(avatars) << "Avatar recording frame" << sequence << "decoded without the frames before it";
+        }
+    }
+    decoder._joints = joints;
+    decoder._sequence = sequence;
+    decoder._valid = true;
+
+    if (!skeletonModelURL.isEmpty() && useFrameSkeleton && skeletonModelURL != getSkeletonModelURL().toString()) {
+        setSkeletonModelURL(skeletonModelURL);
+    }
+    if ((flags & AVATAR_FRAME_HAS_DISPLAY_NAME) && displayName != getDisplayName()) {
+        setDisplayName(displayName);
+    }
+
+    auto currentBasis = getRecordingBasis();
+    if (!currentBasis) {
+        currentBasis = std::make_shared<Transform>(basis);
+    }
+
+    glm::quat orientation;
+    if (flags & AVATAR_FRAME_HAS_RELATIVE) {
+        // see fromJson() for how the basis is chosen
+        auto worldTransform = currentBasis->worldTransform(relativeTransform);
+        setPosition(worldTransform.getTranslation());
+        orientation = worldTransform.getRotation();
+    } else {
+        setPosition(currentBasis->getTranslation());
+        orientation = currentBasis->getRotation();
+    }
+    setOrientation(orientation);
+    updateAttitude(orientation);
+
+    // Do after avatar orientation because head look-at needs avatar orientation.
+    if (flags & AVATAR_FRAME_HAS_HEAD) {
+        if (!_headData) {
+            _headData = new HeadData(this);
+        }
+        QVector<float>& coefficients = _headData->_blendshapeCoefficients;
+        coefficients.fill(0.0f);
+        for (int i = 0; i < numBlendshapes; i++) {
+            int index = blendshapeIndices[i];
+            if (index >= NUM_FACESHIFT_BLENDSHAPES) {
+                continue;
+            }
+            if (coefficients.size() <= index) {
+                coefficients.resize(index + 1);
+            }
+            if (_headData->_transientBlendshapeCoefficients.size() <= index) {
+                _headData->_transientBlendshapeCoefficients.resize(index + 1);
+            }
+            coefficients[index] = blendshapeValues[i];
+        }
+        if ((headFlags & HEAD_HAS_LOOK_AT) && glm::length2(relativeLookAt) > 0.01f) {
+            _headData->setLookAtPosition((getOrientation() * relativeLookAt) + getPosition());
+        }
+        if (headFlags & HEAD_HAS_ROTATION) {
+            _headData->setHeadOrientation(headRotation);
+        }
+    }
+
+    if (scale != 1.0f) {
+        setTargetScale(scale);
+    }
+
+    if ((flags & AVATAR_FRAME_HAS_ATTACHMENTS) && attachments != getAttachmentData()) {
+        setAttachmentData(attachments);
+    }
+
+    setRawJointData(joints);
+}
+
 float AvatarData::getBodyYaw() const {
     glm::vec3 eulerAngles = glm::degrees(safeEulerAngles(getOrientation()));
     return eulerAngles.y;
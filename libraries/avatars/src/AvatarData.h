@@ -320,6 +320,8 @@ Q_DECLARE_METATYPE(KillAvatarReason);
 class QDataStream;
 
 class AttachmentData;
+class AvatarFrameDecoder;
+class AvatarFrameEncoder;
 class Transform;
 using TransformPointer = std::shared_ptr<Transform>;
 
@@ -395,8 +397,14 @@ public:
 
     static const QString FRAME_NAME;
 
-    static void fromFrame(const QByteArray& frameData, AvatarData& avatar, bool useFrameSkeleton = true);
-    static QByteArray toFrame(const AvatarData& avatar);
+    // toFrame() writes compact binary frames that are delta coded against the previous frame of the same recording.
+    // fromFrame() reads those as well as the JSON frames written by toJsonFrame() and by older recordings.
+    static void fromFrame(const QByteArray& frameData, AvatarData& avatar, AvatarFrameDecoder& decoder,
+                          bool useFrameSkeleton = true);
+    static QByteArray toFrame(const AvatarData& avatar, AvatarFrameEncoder& encoder);
+    static QByteArray toJsonFrame(const AvatarData& avatar);
+    // true for the frames that decode without the frames before them, see recording::Frame::registerKeyFrameTest()
+    static bool isKeyFrame(const QByteArray& frameData);
 
     AvatarData();
     virtual ~AvatarData();
@@ -730,6 +738,8 @@ protected:
     QVector<JointData> _lastSentJointData; ///< the state of the skeleton joints last time we transmitted
     mutable QReadWriteLock _jointDataLock;
 
+    void fromBinaryFrame(const QByteArray& frameData, AvatarFrameDecoder& decoder, bool useFrameSkeleton);
+
     // key state
     KeyState _keyState;
 
@@ -945,6 +955,38 @@ public:
 
 void registerAvatarTypes(QScriptEngine* engine);
 
+// The delta coding state of one recording of binary avatar frames, see AvatarData::toFrame().  The first frame written
+// after a reset() is a key frame.
+class AvatarFrameEncoder {
+public:
+    void reset() { *this = AvatarFrameEncoder(); }
+
+private:
+    friend class AvatarData;
+
+    bool _valid { false };
+    quint32 _sequence { 0 };
+    QByteArray _packedJoints; // the joints as last written
+    QString _skeletonModelURL;
+    QString _displayName;
+    QVector<AttachmentData> _attachments;
+};
+
+// The delta decoding state of one player of binary avatar frames, see AvatarData::fromFrame().  A delta frame only
+// carries the joints that changed since the frame before it, so every frame since the last key frame has to go through
+// the same decoder.
+class AvatarFrameDecoder {
+public:
+    void reset() { *this = AvatarFrameDecoder(); }
+
+private:
+    friend class AvatarData;
+
+    bool _valid { false };
+    quint32 _sequence { 0 };
+    QVector<JointData> _joints; // the joints as last read
+};
+
 class RayToAvatarIntersectionResult {
 public:
 RayToAvatarIntersectionResult() : intersects(false), avatarID(), distance(0) {}
@@ -159,7 +159,8 @@ void EntityTreeRenderer::shutdown() {
     clear(); // always clear() on shutdown
 }
 
-void EntityTreeRenderer::addPendingEntities(const render::ScenePointer& scene, render::Transaction& transaction) {
+void EntityTreeRenderer::addPendingEntities(const render::ScenePointer& scene, render::Transaction& transaction,
+        render::entities::AsynchronousRenderUpdates& updates) {
     // Clear any expired entities 
     // FIXME should be able to use std::remove_if, but it fails due to some 
     // weird compilation error related to EntityItemID assignment operators
@@ -187,7 +188,7 @@ void EntityTreeRenderer::addPendingEntities(const render::ScenePointer& scene, r
 
             auto entityID = entity->getEntityItemID();
             processedIds.insert(entityID);
-            auto renderable = EntityRenderer::addToScene(*this, entity, scene, transaction);
+            auto renderable = EntityRenderer::addToScene(*this, entity, scene, transaction, updates);
             if (renderable) {
                 _entitiesInScene.insert({ entityID, renderable });
             }
@@ -202,7 +203,8 @@ void EntityTreeRenderer::addPendingEntities(const render::ScenePointer& scene, r
     }
 }
 
-void EntityTreeRenderer::updateChangedEntities(const render::ScenePointer& scene, render::Transaction& transaction) {
+void EntityTreeRenderer::updateChangedEntities(const render::ScenePointer& scene, render::Transaction& transaction,
+        render::entities::AsynchronousRenderUpdates& updates) {
     std::unordered_set<EntityItemID> changedEntities;
     _changedEntitiesGuard.withWriteLock([&] {
 #if 0
@@ -214,20 +216,12 @@ void EntityTreeRenderer::updateChangedEntities(const render::ScenePointer& scene
 #endif
     });
 
+    // only the renderers of the entities that reported a change are visited
     for (const auto& entityId : changedEntities) {
         auto renderable = renderableForEntityId(entityId);
-        if (!renderable) {
-            continue;
+        if (renderable) {
+            renderable->updateInScene(scene, transaction, updates);
         }
-        _renderablesToUpdate.insert({ entityId, renderable });
-    }
-
-    if (!_renderablesToUpdate.empty()) {
-        for (const auto& entry : _renderablesToUpdate) {
-            const auto& renderable = entry.second;
-            renderable->updateInScene(scene, transaction);
-        }
-        _renderablesToUpdate.clear();
     }
 }
 
@@ -254,18 +248,25 @@ void EntityTreeRenderer::update(bool simulate) {
             PerformanceTimer sceneTimer("scene");
             auto scene = _viewState->getMain3DScene();
             if (scene) {
+                // the synchronous halves of the renderer updates run here, the asynchronous halves run together
+                // when the scene applies the transaction
                 render::Transaction transaction;
+                render::entities::AsynchronousRenderUpdates updates;
                 {
                     PerformanceTimer pt("add");
-                    addPendingEntities(scene, transaction);
+                    addPendingEntities(scene, transaction, updates);
                 }
                 {
                     PerformanceTimer pt("change");
-                    updateChangedEntities(scene, transaction);
+                    updateChangedEntities(scene, transaction, updates);
+                }
+                {
+                    PerformanceTimer pt("particles");
+                    _particleSimulations.start(usecTimestampNow(), transaction);
                 }
                 {
                     PerformanceTimer pt("enqueue");
-                    scene->enqueueTransaction(transaction);
+                    scene->enqueueTransaction(std::move(transaction));
                 }
             }
         }
@@ -275,20 +276,17 @@ void EntityTreeRenderer::update(bool simulate) {
 bool EntityTreeRenderer::findBestZoneAndMaybeContainingEntities(QVector<EntityItemID>* entitiesContainingAvatar) {
     bool didUpdate = false;
     float radius = 0.01f; // for now, assume 0.01 meter radius, because we actually check the point inside later
-    QVector<EntityItemPointer> foundEntities;
 
     // find the entities near us
     // don't let someone else change our tree while we search
     _tree->withReadLock([&] {
-
-        // FIXME - if EntityTree had a findEntitiesContainingPoint() this could theoretically be a little faster
-        std::static_pointer_cast<EntityTree>(_tree)->findEntities(_avatarPosition, radius, foundEntities);
-
         LayeredZones oldLayeredZones(std::move(_layeredZones));
         _layeredZones.clear();
 
+        // FIXME - if EntityTree had a findEntitiesContainingPoint() this could theoretically be a little faster
         // create a list of entities that actually contain the avatar's position
-        for (auto& entity : foundEntities) {
+        std::static_pointer_cast<EntityTree>(_tree)->forEachEntityInSphere(_avatarPosition, radius,
+                [&](const EntityItemPointer& entity) {
             auto isZone = entity->getType() == EntityTypes::Zone;
             auto hasScript = !entity->getScript().isEmpty();
 
@@ -306,12 +304,12 @@ bool EntityTreeRenderer::findBestZoneAndMaybeContainingEntities(QVector<EntityIt
 
                     // if this entity is a zone and visible, determine if it is the bestZone
                     if (isZone && entity->getVisible() && renderableForEntity(entity)) {
-                            auto zone = std::dynamic_pointer_cast<ZoneEntityItem>(entity);
-                            _layeredZones.insert(zone);
-                        }
+                        auto zone = std::dynamic_pointer_cast<ZoneEntityItem>(entity);
+                        _layeredZones.insert(zone);
                     }
                 }
             }
+        });
 
         // check if our layered zones have changed
         if (_layeredZones.empty()) {
@@ -786,7 +784,7 @@ void EntityTreeRenderer::deletingEntity(const EntityItemID& entityID) {
     // here's where we remove the entity payload from the scene
     render::Transaction transaction;
     renderable->removeFromScene(scene, transaction);
-    scene->enqueueTransaction(transaction);
+    scene->enqueueTransaction(std::move(transaction));
 }
 
 void EntityTreeRenderer::addingEntity(const EntityItemID& entityID) {
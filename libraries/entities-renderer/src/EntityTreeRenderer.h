@@ -25,6 +25,8 @@
 #include <OctreeProcessor.h>
 #include <render/Forward.h>
 
+#include "ParticleSimulation.h"
+
 class AbstractScriptingServicesInterface;
 class AbstractViewStateInterface;
 class Model;
@@ -33,6 +35,7 @@ class ZoneEntityItem;
 class EntityItem;
 
 namespace render { namespace entities {
+    class AsynchronousRenderUpdates;
     class EntityRenderer;
     using EntityRendererPointer = std::shared_ptr<EntityRenderer>;
     using EntityRendererWeakPointer = std::weak_ptr<EntityRenderer>;
@@ -150,6 +153,9 @@ public slots:
     EntityRendererPointer renderableForEntityId(const EntityItemID& id) const;
     render::ItemID renderableIdForEntityId(const EntityItemID& id) const;
 
+    // the particle emitters in the scene, stepped at the end of each update
+    render::entities::ParticleSimulationPool& getParticleSimulations() { return _particleSimulations; }
+
 protected:
     virtual OctreePointer createTree() override {
         EntityTreePointer newTree = EntityTreePointer(new EntityTree(true));
@@ -158,8 +164,10 @@ protected:
     }
 
 private:
-    void addPendingEntities(const render::ScenePointer& scene, render::Transaction& transaction);
-    void updateChangedEntities(const render::ScenePointer& scene, render::Transaction& transaction);
+    void addPendingEntities(const render::ScenePointer& scene, render::Transaction& transaction,
+        render::entities::AsynchronousRenderUpdates& updates);
+    void updateChangedEntities(const render::ScenePointer& scene, render::Transaction& transaction,
+        render::entities::AsynchronousRenderUpdates& updates);
     EntityRendererPointer renderableForEntity(const EntityItemPointer& entity) const { return renderableForEntityId(entity->getID()); }
     render::ItemID renderableIdForEntity(const EntityItemPointer& entity) const { return renderableIdForEntityId(entity->getID()); }
 
@@ -260,9 +268,9 @@ private:
     ReadWriteLockable _changedEntitiesGuard;
     std::unordered_set<EntityItemID> _changedEntities;
 
-    std::unordered_map<EntityItemID, EntityRendererPointer> _renderablesToUpdate;
     std::unordered_map<EntityItemID, EntityRendererPointer> _entitiesInScene;
     std::unordered_map<EntityItemID, EntityItemWeakPointer> _entitiesToAdd;
+    render::entities::ParticleSimulationPool _particleSimulations;
     // For Scene.shouldRenderEntities
     QList<EntityItemID> _entityIDsLastInScene;
 
@@ -0,0 +1,197 @@
+//
+//  HullPointCache.cpp
+//  libraries/entities-renderer/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HullPointCache.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+
+#include <FBX.h>
+#include <SettingHandle.h>
+
+#include "EntitiesRendererLogging.h"
+
+static const char* HULL_CACHE_DIRNAME = "hulls";
+static const char* HULL_CACHE_EXT = "hull";
+static const uint32_t HULL_CACHE_MAGIC = 0x4c4c5548; // "HULL"
+
+// Whenever a change is made to the serialized format for the hull cache that isn't backward compatible,
+// this value should be incremented.  This will force the hull cache to be wiped
+static const int HULL_CACHE_CURRENT_VERSION = 0x03;
+static const int HULL_CACHE_INVALID_VERSION = 0x00;
+static const char* HULL_CACHE_SETTING_VERSION_NAME = "hifi.hull.cache_version";
+
+class HullFileCache : public cache::FileCache {
+public:
+    HullFileCache(bool isCurrentVersion) : FileCache(HULL_CACHE_DIRNAME, HULL_CACHE_EXT), _isCurrentVersion(isCurrentVersion) {}
+
+    void initialize() override {
+        FileCache::initialize();
+        if (!_isCurrentVersion) {
+            wipe();
+        }
+    }
+
+private:
+    const bool _isCurrentVersion;
+};
+
+HullPointCache::HullPointCache() {
+    Setting::Handle<int> cacheVersionHandle(HULL_CACHE_SETTING_VERSION_NAME, HULL_CACHE_INVALID_VERSION);
+    bool isCurrentVersion = cacheVersionHandle.get() == HULL_CACHE_CURRENT_VERSION;
+    if (!isCurrentVersion) {
+        cacheVersionHandle.set(HULL_CACHE_CURRENT_VERSION);
+    }
+    _fileCache = std::make_shared<HullFileCache>(isCurrentVersion);
+
+    // one thread, so the files are read and written in the order they were asked for, after the cache is restored
+    _threadPool.setMaxThreadCount(1);
+    auto fileCache = _fileCache;
+    QtConcurrent::run(&_threadPool, [fileCache] {
+        fileCache->initialize();
+    });
+}
+
+HullPointCache::~HullPointCache() {
+    _threadPool.waitForDone();
+}
+
+static void addHashCount(QCryptographicHash& hash, int count) {
+    hash.addData((const char*)&count, sizeof(count));
+}
+
+// the count goes in ahead of the data, so that moving a vertex or index from one part to the next changes the hash
+template <typename T>
+static void addHashVector(QCryptographicHash& hash, const QVector<T>& vector) {
+    addHashCount(hash, vector.size());
+    hash.addData((const char*)vector.constData(), vector.size() * (int)sizeof(T));
+}
+
+HullPointCache::Key HullPointCache::getKey(const QUrl& url, const FBXGeometry& collisionGeometry) {
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(url.toEncoded());
+
+    addHashCount(hash, collisionGeometry.meshes.size());
+    foreach (const FBXMesh& mesh, collisionGeometry.meshes) {
+        addHashVector(hash, mesh.vertices);
+        addHashCount(hash, mesh.parts.size());
+        foreach (const FBXMeshPart& meshPart, mesh.parts) {
+            addHashVector(hash, meshPart.triangleIndices);
+            addHashVector(hash, meshPart.quadIndices);
+        }
+    }
+    return hash.result().toHex().toStdString();
+}
+
+HullPointCache::LookupPointer HullPointCache::lookUp(const Key& key) {
+    auto lookup = std::make_shared<Lookup>(key);
+    auto fileCache = _fileCache;
+    lookup->_future = QtConcurrent::run(&_threadPool, [fileCache, lookup] {
+        auto file = fileCache->getFile(lookup->getKey());
+        if (file) {
+            QFile input(QString::fromStdString(file->getFilepath()));
+            if (input.open(QIODevice::ReadOnly)) {
+                lookup->_isHit = deserialize(input.readAll(), lookup->_pointCollection);
+                if (!lookup->_isHit) {
+                    qCWarning(entitiesrenderer) << "Discarding corrupt hull cache entry" << lookup->getKey().c_str();
+                }
+            }
+        }
+        lookup->_finished.store(true, std::memory_order_release);
+    });
+    return lookup;
+}
+
+HullPointCache::LookupPointer HullPointCache::store(const Key& key, const ShapeInfo::PointCollection& pointCollection) {
+    auto lookup = std::make_shared<Lookup>(key);
+    lookup->_isHit = true;
+    lookup->_pointCollection = pointCollection;
+    lookup->_finished.store(true, std::memory_order_release);
+
+    auto fileCache = _fileCache;
+    QtConcurrent::run(&_threadPool, [fileCache, key, pointCollection] {
+        QByteArray data = serialize(pointCollection);
+        fileCache->writeFile(data.constData(), cache::FileCache::Metadata(key, data.size()), true);
+    });
+    return lookup;
+}
+
+// format: magic, part count, then for each part a point count followed by tightly packed xyz floats
+QByteArray HullPointCache::serialize(const ShapeInfo::PointCollection& pointCollection) {
+    size_t size = 2 * sizeof(uint32_t);
+    for (const auto& points : pointCollection) {
+        size += sizeof(uint32_t) + points.size() * sizeof(glm::vec3);
+    }
+
+    QByteArray data;
+    data.resize((int)size);
+    char* cursor = data.data();
+    auto writeUInt = [&](uint32_t value) {
+        memcpy(cursor, &value, sizeof(uint32_t));
+        cursor += sizeof(uint32_t);
+    };
+
+    writeUInt(HULL_CACHE_MAGIC);
+    writeUInt((uint32_t)pointCollection.size());
+    for (const auto& points : pointCollection) {
+        writeUInt((uint32_t)points.size());
+        size_t bytes = points.size() * sizeof(glm::vec3);
+        memcpy(cursor, points.constData(), bytes);
+        cursor += bytes;
+    }
+    return data;
+}
+
+bool HullPointCache::deserialize(const QByteArray& data, ShapeInfo::PointCollection& pointCollection) {
+    const char* cursor = data.constData();
+    const char* end = cursor + data.size();
+    auto readUInt = [&](uint32_t& value) {
+        if (end - cursor < (ptrdiff_t)sizeof(uint32_t)) {
+            return false;
+        }
+        memcpy(&value, cursor, sizeof(uint32_t));
+        cursor += sizeof(uint32_t);
+        return true;
+    };
+
+    uint32_t magic, numParts;
+    if (!readUInt(magic) || magic != HULL_CACHE_MAGIC || !readUInt(numParts)) {
+        return false;
+    }
+
+    // every part takes at least its point count, so a corrupt part count is caught before anything is allocated for it
+    if ((size_t)(end - cursor) / sizeof(uint32_t) < numParts) {
+        return false;
+    }
+
+    ShapeInfo::PointCollection result;
+    result.reserve(numParts);
+    for (uint32_t i = 0; i < numParts; ++i) {
+        uint32_t numPoints;
+        if (!readUInt(numPoints)) {
+            return false;
+        }
+        size_t bytes = (size_t)numPoints * sizeof(glm::vec3);
+        if ((size_t)(end - cursor) < bytes) {
+            return false;
+        }
+        ShapeInfo::PointList points;
+        points.resize(numPoints);
+        memcpy(points.data(), cursor, bytes);
+        cursor += bytes;
+        result.push_back(points);
+    }
+    if (cursor != end) {
+        return false;
+    }
+    pointCollection.swap(result);
+    return true;
+}
@@ -0,0 +1,85 @@
+//
+//  HullPointCache.h
+//  libraries/entities-renderer/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_HullPointCache_h
+#define hifi_HullPointCache_h
+
+#include <atomic>
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFuture>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+#include <QtCore/QUrl>
+
+#include <DependencyManager.h>
+#include <ShapeInfo.h>
+#include <shared/FileCache.h>
+
+class FBXGeometry;
+
+/// Disk backed cache of the convex hull point collections computed for compound collision shapes. Computing
+/// the hull points means walking every triangle and quad of the collision geometry, so for domains with many
+/// physical models it is much cheaper to load the result from a previous visit. The points are stored in the
+/// collision model's own frame, before the entity's scale and offsets are applied, and keyed by the collision
+/// model's URL and version. The cache reads and writes its files on a thread of its own.
+class HullPointCache : public QObject, public Dependency {
+    Q_OBJECT
+    SINGLETON_DEPENDENCY
+
+public:
+    using Key = cache::FileCache::Key;
+
+    /// The result of a lookup, filled in by the cache's thread: the points are only valid once it is finished, which
+    /// waitForFinished() blocks on.
+    class Lookup {
+    public:
+        Lookup(const Key& key) : _key(key) {}
+
+        const Key& getKey() const { return _key; }
+        bool isFinished() const { return _finished.load(std::memory_order_acquire); }
+        void waitForFinished() { _future.waitForFinished(); }
+        bool isHit() const { return _isHit; }
+        const ShapeInfo::PointCollection& getPointCollection() const { return _pointCollection; }
+
+    private:
+        friend class HullPointCache;
+
+        const Key _key;
+        std::atomic<bool> _finished { false };
+        QFuture<void> _future;
+        bool _isHit { false };
+        ShapeInfo::PointCollection _pointCollection;
+    };
+    using LookupPointer = std::shared_ptr<Lookup>;
+
+    /// Returns the key of the hull points of the collision geometry loaded from url.  The version of the geometry is
+    /// a hash of its vertices and indices, so compute it once per load.
+    static Key getKey(const QUrl& url, const FBXGeometry& collisionGeometry);
+
+    /// Starts reading the points stored for key on the cache's thread.
+    LookupPointer lookUp(const Key& key);
+
+    /// Starts writing points for key, and returns a finished lookup holding them.
+    LookupPointer store(const Key& key, const ShapeInfo::PointCollection& pointCollection);
+
+    static QByteArray serialize(const ShapeInfo::PointCollection& pointCollection);
+    static bool deserialize(const QByteArray& data, ShapeInfo::PointCollection& pointCollection);
+
+private:
+    HullPointCache();
+    virtual ~HullPointCache();
+
+    std::shared_ptr<cache::FileCache> _fileCache;
+    QThreadPool _threadPool;
+};
+
+#endif // hifi_HullPointCache_h
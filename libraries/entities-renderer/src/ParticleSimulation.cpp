@@ -0,0 +1,437 @@
+//
+//  ParticleSimulation.cpp
+//  libraries/entities-renderer/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ParticleSimulation.h"
+
+#include <algorithm>
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QThreadPool>
+
+#include <GLMHelpers.h>
+#include <NumericalConstants.h>
+
+using namespace render::entities;
+
+static inline void integrateParticle(float& position, float& velocity, float acceleration,
+                                     float deltaTime, float halfDeltaTimeSquared) {
+    position += velocity * deltaTime + acceleration * halfDeltaTimeSquared;
+    velocity += acceleration * deltaTime;
+}
+
+//
+// on x86 architecture, assume that SSE2 is present
+//
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#include <emmintrin.h>
+
+static void integrateAxis(float* positions, float* velocities, const float* accelerations, size_t count, float deltaTime) {
+    const float halfDeltaTimeSquared = 0.5f * deltaTime * deltaTime;
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 halfDt2 = _mm_set1_ps(halfDeltaTimeSquared);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(&positions[i]);
+        __m128 v = _mm_loadu_ps(&velocities[i]);
+        __m128 a = _mm_loadu_ps(&accelerations[i]);
+
+        p = _mm_add_ps(p, _mm_add_ps(_mm_mul_ps(v, dt), _mm_mul_ps(a, halfDt2)));
+        v = _mm_add_ps(v, _mm_mul_ps(a, dt));
+
+        _mm_storeu_ps(&positions[i], p);
+        _mm_storeu_ps(&velocities[i], v);
+    }
+    for (; i < count; i++) {
+        integrateParticle(positions[i], velocities[i], accelerations[i], deltaTime, halfDeltaTimeSquared);
+    }
+}
+
+static void advanceLifetimes(float* lifetimes, size_t count, float deltaTime) {
+    const __m128 dt = _mm_set1_ps(deltaTime);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(&lifetimes[i], _mm_add_ps(_mm_loadu_ps(&lifetimes[i]), dt));
+    }
+    for (; i < count; i++) {
+        lifetimes[i] += deltaTime;
+    }
+}
+
+#else
+
+static void integrateAxis(float* positions, float* velocities, const float* accelerations, size_t count, float deltaTime) {
+    const float halfDeltaTimeSquared = 0.5f * deltaTime * deltaTime;
+    for (size_t i = 0; i < count; i++) {
+        integrateParticle(positions[i], velocities[i], accelerations[i], deltaTime, halfDeltaTimeSquared);
+    }
+}
+
+static void advanceLifetimes(float* lifetimes, size_t count, float deltaTime) {
+    for (size_t i = 0; i < count; i++) {
+        lifetimes[i] += deltaTime;
+    }
+}
+
+#endif
+
+// copies the ring into newly allocated arrays, front first
+template <typename T>
+static void relinearize(std::vector<T>& values, size_t head, size_t size, size_t capacity) {
+    std::vector<T> result(capacity);
+    const size_t mask = values.size() - 1;
+    for (size_t i = 0; i < size; ++i) {
+        result[i] = values[(head + i) & mask];
+    }
+    values.swap(result);
+}
+
+void ParticleRing::grow() {
+    static const size_t MIN_CAPACITY = 16;
+    size_t capacity = std::max(MIN_CAPACITY, 2 * _capacity);
+
+    relinearize(_expirations, _head, _size, capacity);
+    relinearize(_seeds, _head, _size, capacity);
+    relinearize(_lifetimes, _head, _size, capacity);
+    for (int axis = 0; axis < 3; ++axis) {
+        relinearize(_positions[axis], _head, _size, capacity);
+        relinearize(_velocities[axis], _head, _size, capacity);
+        relinearize(_accelerations[axis], _head, _size, capacity);
+    }
+    _capacity = capacity;
+    _head = 0;
+}
+
+void ParticleRing::pushBack(const CpuParticle& particle) {
+    if (_size == _capacity) {
+        grow();
+    }
+
+    size_t index = (_head + _size) & (_capacity - 1);
+    _expirations[index] = particle.expiration;
+    _seeds[index] = particle.seed;
+    _lifetimes[index] = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        _positions[axis][index] = particle.position[axis];
+        _velocities[axis][index] = particle.velocity[axis];
+        _accelerations[axis][index] = particle.acceleration[axis];
+    }
+    ++_size;
+}
+
+void ParticleRing::popFront() {
+    _head = (_head + 1) & (_capacity - 1);
+    --_size;
+}
+
+void ParticleRing::integrateSpan(size_t begin, size_t count, float deltaTime) {
+    for (int axis = 0; axis < 3; ++axis) {
+        integrateAxis(&_positions[axis][begin], &_velocities[axis][begin], &_accelerations[axis][begin], count, deltaTime);
+    }
+    advanceLifetimes(&_lifetimes[begin], count, deltaTime);
+}
+
+void ParticleRing::integrate(float deltaTime) {
+    size_t first = std::min(_size, _capacity - _head);
+    if (first > 0) {
+        integrateSpan(_head, first, deltaTime);
+    }
+    if (_size > first) {
+        integrateSpan(0, _size - first, deltaTime);
+    }
+}
+
+void ParticleRing::writeSpan(size_t begin, size_t count, GpuParticle* destination) const {
+    const float* x = &_positions[0][begin];
+    const float* y = &_positions[1][begin];
+    const float* z = &_positions[2][begin];
+    const float* lifetimes = &_lifetimes[begin];
+    const float* seeds = &_seeds[begin];
+    for (size_t i = 0; i < count; ++i) {
+        destination[i].xyz = glm::vec3(x[i], y[i], z[i]);
+        destination[i].uv = glm::vec2(lifetimes[i], seeds[i]);
+    }
+}
+
+void ParticleRing::write(GpuParticle* destination) const {
+    size_t first = std::min(_size, _capacity - _head);
+    if (first > 0) {
+        writeSpan(_head, first, destination);
+    }
+    if (_size > first) {
+        writeSpan(0, _size - first, destination + first);
+    }
+}
+
+ParticleEmitterSimulation::ParticleEmitterSimulation() : _randomGenerator(std::random_device()()) {
+}
+
+void ParticleEmitterSimulation::setProperties(const particle::Properties& properties) {
+    std::lock_guard<std::mutex> lock(_stateMutex);
+    _pendingProperties = properties;
+    _propertiesChanged = true;
+}
+
+void ParticleEmitterSimulation::setEmitting(bool emitting) {
+    std::lock_guard<std::mutex> lock(_stateMutex);
+    _emitting = emitting;
+}
+
+void ParticleEmitterSimulation::setTransform(const Transform& transform) {
+    std::lock_guard<std::mutex> lock(_stateMutex);
+    _transform = transform;
+}
+
+void ParticleEmitterSimulation::setVisible(bool visible) {
+    std::lock_guard<std::mutex> lock(_stateMutex);
+    _visible = visible;
+}
+
+CpuParticle ParticleEmitterSimulation::createParticle(uint64_t now, const Transform& baseTransform) {
+    // the steps of different emitters run concurrently, so each draws from its own generator
+    const auto& particleProperties = _particleProperties;
+    CpuParticle particle;
+
+    const auto& accelerationSpread = particleProperties.emission.acceleration.spread;
+    const auto& azimuthStart = particleProperties.azimuth.start;
+    const auto& azimuthFinish = particleProperties.azimuth.finish;
+    const auto& emitDimensions = particleProperties.emission.dimensions;
+    const auto& emitAcceleration = particleProperties.emission.acceleration.target;
+    auto emitOrientation = particleProperties.emission.orientation;
+    const auto& emitRadiusStart = glm::max(particleProperties.radiusStart, EPSILON); // Avoid math complications at center
+    const auto& emitSpeed = particleProperties.emission.speed.target;
+    const auto& speedSpread = particleProperties.emission.speed.spread;
+    const auto& polarStart = particleProperties.polar.start;
+    const auto& polarFinish = particleProperties.polar.finish;
+
+    particle.seed = randomFloat(-1.0f, 1.0f);
+    particle.expiration = now + (uint64_t)(particleProperties.lifespan * USECS_PER_SECOND);
+    if (particleProperties.emission.shouldTrail) {
+        particle.position = baseTransform.getTranslation();
+        emitOrientation = baseTransform.getRotation() * emitOrientation;
+    }
+
+    // Position, velocity, and acceleration
+    if (polarStart == 0.0f && polarFinish == 0.0f && emitDimensions.z == 0.0f) {
+        // Emit along z-axis from position
+
+        particle.velocity = (emitSpeed + 0.2f * speedSpread) * (emitOrientation * Vectors::UNIT_Z);
+        particle.acceleration = emitAcceleration + randomFloat(-1.0f, 1.0f) * accelerationSpread;
+
+    } else {
+        // Emit around point or from ellipsoid
+        // - Distribute directions evenly around point
+        // - Distribute points relatively evenly over ellipsoid surface
+        // - Distribute points relatively evenly within ellipsoid volume
+
+        float elevationMinZ = sin(PI_OVER_TWO - polarFinish);
+        float elevationMaxZ = sin(PI_OVER_TWO - polarStart);
+        float elevation = asin(elevationMinZ + (elevationMaxZ - elevationMinZ) * randomFloat(0.0f, 1.0f));
+
+        float azimuth;
+        if (azimuthFinish >= azimuthStart) {
+            azimuth = azimuthStart + (azimuthFinish - azimuthStart) * randomFloat(0.0f, 1.0f);
+        } else {
+            azimuth = azimuthStart + (TWO_PI + azimuthFinish - azimuthStart) * randomFloat(0.0f, 1.0f);
+        }
+
+        glm::vec3 emitDirection;
+        if (emitDimensions == Vectors::ZERO) {
+            // Point
+            emitDirection = glm::quat(glm::vec3(PI_OVER_TWO - elevation, 0.0f, azimuth)) * Vectors::UNIT_Z;
+        } else {
+            // Ellipsoid
+            float radiusScale = 1.0f;
+            if (emitRadiusStart < 1.0f) {
+                float randRadius =
+                    emitRadiusStart + randomFloat(0.0f, particle::MAXIMUM_EMIT_RADIUS_START - emitRadiusStart);
+                radiusScale = 1.0f - std::pow(1.0f - randRadius, 3.0f);
+            }
+
+            glm::vec3 radii = radiusScale * 0.5f * emitDimensions;
+            float x = radii.x * glm::cos(elevation) * glm::cos(azimuth);
+            float y = radii.y * glm::cos(elevation) * glm::sin(azimuth);
+            float z = radii.z * glm::sin(elevation);
+            glm::vec3 emitPosition = glm::vec3(x, y, z);
+            emitDirection = glm::normalize(glm::vec3(
+                radii.x > 0.0f ? x / (radii.x * radii.x) : 0.0f,
+                radii.y > 0.0f ? y / (radii.y * radii.y) : 0.0f,
+                radii.z > 0.0f ? z / (radii.z * radii.z) : 0.0f
+            ));
+            particle.position += emitOrientation * emitPosition;
+        }
+
+        particle.velocity = (emitSpeed + randomFloat(-1.0f, 1.0f) * speedSpread) * (emitOrientation * emitDirection);
+        particle.acceleration = emitAcceleration + randomFloat(-1.0f, 1.0f) * accelerationSpread;
+    }
+
+    return particle;
+}
+
+void ParticleEmitterSimulation::step(uint64_t now) {
+    bool emitting;
+    Transform transform;
+    {
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        if (_propertiesChanged) {
+            _particleProperties = _pendingProperties;
+            _propertiesChanged = false;
+            _timeUntilNextEmit = 0;
+        }
+        // culled emitters keep their particles where they were until they are rendered again
+        if (!_visible || !_rendered.exchange(false)) {
+            return;
+        }
+        emitting = _emitting;
+        transform = _transform;
+    }
+
+    if (_lastSimulated == 0) {
+        _lastSimulated = now;
+        return;
+    }
+
+    const auto interval = std::min<uint64_t>(USECS_PER_SECOND / 60, now - _lastSimulated);
+    _lastSimulated = now;
+
+    if (emitting && _particleProperties.emitting()) {
+        uint64_t emitInterval = _particleProperties.emitIntervalUsecs();
+        if (emitInterval > 0 && interval >= _timeUntilNextEmit) {
+            auto timeRemaining = interval;
+            while (timeRemaining > _timeUntilNextEmit) {
+                // emit particle
+                _particles.pushBack(createParticle(now, transform));
+                _timeUntilNextEmit = emitInterval;
+                if (emitInterval < timeRemaining) {
+                    timeRemaining -= emitInterval;
+                }
+            }
+        } else {
+            _timeUntilNextEmit -= interval;
+        }
+    }
+
+    // Kill any particles that have expired or are over the max size
+    while (_particles.size() > _particleProperties.maxParticles || (!_particles.empty() && _particles.frontExpiration() <= now)) {
+        _particles.popFront();
+    }
+
+    const float deltaTime = (float)interval / (float)USECS_PER_SECOND;
+    _particles.integrate(deltaTime);
+
+    // Rewrite the last finished buffer if the render thread has not taken it yet, the spare one otherwise
+    gpu::BufferPointer buffer;
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        buffer = _finishedBuffer ? std::move(_finishedBuffer) : std::move(_spareBuffer);
+    }
+    if (!buffer) {
+        buffer = std::make_shared<gpu::Buffer>();
+    }
+
+    size_t numBytes = sizeof(GpuParticle) * _particles.size();
+    auto particles = reinterpret_cast<GpuParticle*>(buffer->overwrite(numBytes));
+    if (numBytes != 0) {
+        _particles.write(particles);
+    }
+
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    _finishedBuffer = std::move(buffer);
+}
+
+bool ParticleEmitterSimulation::hasFinishedBuffer() const {
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    return (bool)_finishedBuffer;
+}
+
+void ParticleEmitterSimulation::swapBuffers() {
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    if (_finishedBuffer) {
+        // the swaps are applied at the start of a frame, after the render thread has finished the last frame that drew
+        // the previous buffer, so the steps are free to rewrite it
+        _spareBuffer = std::move(_renderBuffer);
+        _renderBuffer = std::move(_finishedBuffer);
+    }
+}
+
+static const size_t MIN_EMITTERS_PER_JOB = 16;
+
+ParticleSimulationPool::~ParticleSimulationPool() {
+    wait();
+}
+
+void ParticleSimulationPool::addEmitter(const ParticleEmitterSimulation::Pointer& emitter, render::ItemID itemID) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    waitLocked();
+    _emitters.push_back({ emitter, itemID });
+}
+
+void ParticleSimulationPool::removeEmitter(const ParticleEmitterSimulation::Pointer& emitter) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    waitLocked();
+    _emitters.erase(std::remove_if(_emitters.begin(), _emitters.end(), [&](const Emitter& other) {
+        return other.simulation == emitter;
+    }), _emitters.end());
+}
+
+size_t ParticleSimulationPool::getNumEmitters() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _emitters.size();
+}
+
+void ParticleSimulationPool::start(uint64_t now, render::Transaction& transaction) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    waitLocked();
+
+    for (const auto& emitter : _emitters) {
+        if (emitter.simulation->hasFinishedBuffer()) {
+            auto simulation = emitter.simulation;
+            transaction.updateItem<render::PayloadProxyInterface>(emitter.itemID, [simulation](render::PayloadProxyInterface&) {
+                simulation->swapBuffers();
+            });
+        }
+    }
+
+    size_t numEmitters = _emitters.size();
+    if (numEmitters == 0) {
+        return;
+    }
+
+    // the emitters are split in contiguous runs, one per job, with enough emitters in each to be worth a job
+    auto threadPool = QThreadPool::globalInstance();
+    size_t maxJobs = (size_t)std::max(threadPool->maxThreadCount(), 1);
+    size_t numJobs = std::min(maxJobs, (numEmitters + MIN_EMITTERS_PER_JOB - 1) / MIN_EMITTERS_PER_JOB);
+    size_t emittersPerJob = (numEmitters + numJobs - 1) / numJobs;
+
+    // the emitters can not change until the jobs are waited on
+    const Emitter* emitters = _emitters.data();
+    for (size_t begin = 0; begin < numEmitters; begin += emittersPerJob) {
+        size_t end = std::min(begin + emittersPerJob, numEmitters);
+        _jobs.push_back(QtConcurrent::run(threadPool, [emitters, begin, end, now] {
+            for (size_t i = begin; i < end; ++i) {
+                emitters[i].simulation->step(now);
+            }
+        }));
+    }
+}
+
+void ParticleSimulationPool::wait() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    waitLocked();
+}
+
+void ParticleSimulationPool::waitLocked() {
+    for (auto& job : _jobs) {
+        job.waitForFinished();
+    }
+    _jobs.clear();
+}
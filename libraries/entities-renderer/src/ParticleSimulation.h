@@ -0,0 +1,165 @@
+//
+//  ParticleSimulation.h
+//  libraries/entities-renderer/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ParticleSimulation_h
+#define hifi_ParticleSimulation_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <QtCore/QFuture>
+
+#include <glm/glm.hpp>
+
+#include <Transform.h>
+#include <gpu/Buffer.h>
+#include <render/Scene.h>
+#include <ParticleEffectEntityItem.h>
+
+namespace render { namespace entities {
+
+// One particle as the particle shader reads it, one instance of the particle quad
+struct GpuParticle {
+    glm::vec3 xyz; // Position
+    glm::vec2 uv; // Lifetime + seed
+};
+
+// A particle as it is emitted, before it joins the ring
+struct CpuParticle {
+    float seed { 0.0f };
+    uint64_t expiration { 0 };
+    glm::vec3 position;
+    glm::vec3 velocity;
+    glm::vec3 acceleration;
+};
+
+// The live particles of one emitter, as a structure of arrays.  Particles are emitted at the back and expire from the
+// front, so the arrays are used as a ring, and integration runs over the (at most two) contiguous spans of the ring.
+class ParticleRing {
+public:
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    uint64_t frontExpiration() const { return _expirations[_head]; }
+    void popFront();
+    void pushBack(const CpuParticle& particle);
+    void clear() { _head = _size = 0; }
+
+    void integrate(float deltaTime);
+
+    // writes the particles in emission order, destination has room for size() of them
+    void write(GpuParticle* destination) const;
+
+private:
+    void grow();
+    void integrateSpan(size_t begin, size_t count, float deltaTime);
+    void writeSpan(size_t begin, size_t count, GpuParticle* destination) const;
+
+    size_t _capacity { 0 }; // always a power of two
+    size_t _head { 0 };
+    size_t _size { 0 };
+
+    std::vector<uint64_t> _expirations;
+    std::vector<float> _seeds;
+    std::vector<float> _lifetimes;
+    std::vector<float> _positions[3];
+    std::vector<float> _velocities[3];
+    std::vector<float> _accelerations[3];
+};
+
+// Simulates the particles of one emitter and writes them into a buffer the renderer is not drawing from.  The renderer
+// sets the emitter state on the main thread, the steps run on the workers of a ParticleSimulationPool, and the render
+// thread swaps the finished buffer in when the scene applies its transaction, so a step never touches a buffer that a
+// frame in flight reads.
+class ParticleEmitterSimulation {
+public:
+    using Pointer = std::shared_ptr<ParticleEmitterSimulation>;
+
+    ParticleEmitterSimulation();
+
+    void setProperties(const particle::Properties& properties);
+    void setEmitting(bool emitting);
+    void setTransform(const Transform& transform);
+    void setVisible(bool visible);
+    // called by every render of the emitter, an emitter that was culled since its last step is not stepped
+    void setRendered() { _rendered = true; }
+
+    // advances the particles to now, and writes them to the finished buffer
+    void step(uint64_t now);
+    bool hasFinishedBuffer() const;
+
+    // render thread only: makes the last finished buffer the one to draw, returns the previous one to the steps
+    void swapBuffers();
+    const gpu::BufferPointer& getParticleBuffer() const { return _renderBuffer; }
+    size_t getNumParticles() const { return _particles.size(); }
+
+private:
+    CpuParticle createParticle(uint64_t now, const Transform& baseTransform);
+    float randomFloat(float min, float max) { return std::uniform_real_distribution<float>(min, max)(_randomGenerator); }
+
+    // written by the renderer, read by the step
+    std::mutex _stateMutex;
+    particle::Properties _pendingProperties;
+    bool _propertiesChanged { false };
+    bool _emitting { false };
+    bool _visible { true };
+    Transform _transform;
+    std::atomic<bool> _rendered { false };
+
+    // owned by the step
+    particle::Properties _particleProperties;
+    ParticleRing _particles;
+    uint64_t _timeUntilNextEmit { 0 };
+    uint64_t _lastSimulated { 0 };
+    std::mt19937 _randomGenerator;
+
+    // the step writes a buffer it took from the spare or the finished slot, the render thread only draws _renderBuffer
+    mutable std::mutex _bufferMutex;
+    gpu::BufferPointer _finishedBuffer;
+    gpu::BufferPointer _spareBuffer;
+    gpu::BufferPointer _renderBuffer { std::make_shared<gpu::Buffer>() };
+};
+
+// Steps every particle emitter once a frame, in parallel on the global thread pool.  The entity update starts the
+// steps once it has updated the renderers, and the next update hands their buffers to the render thread, so the
+// simulation overlaps the rest of the frame and the render never waits on it.
+class ParticleSimulationPool {
+public:
+    ~ParticleSimulationPool();
+
+    void addEmitter(const ParticleEmitterSimulation::Pointer& emitter, render::ItemID itemID);
+    void removeEmitter(const ParticleEmitterSimulation::Pointer& emitter);
+    size_t getNumEmitters() const;
+
+    // waits for the previous steps, queues the swaps of the buffers they finished to the transaction, then starts the
+    // steps to now
+    void start(uint64_t now, render::Transaction& transaction);
+    // returns once every emitter has been stepped
+    void wait();
+
+private:
+    struct Emitter {
+        ParticleEmitterSimulation::Pointer simulation;
+        render::ItemID itemID;
+    };
+
+    void waitLocked();
+
+    mutable std::mutex _mutex;
+    std::vector<Emitter> _emitters;
+    std::vector<QFuture<void>> _jobs;
+};
+
+} } // namespace
+
+#endif // hifi_ParticleSimulation_h
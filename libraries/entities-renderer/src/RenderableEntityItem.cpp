@@ -12,6 +12,10 @@
 
 #include "RenderableEntityItem.h"
 
+#include <algorithm>
+
+#include <QtConcurrent/QtConcurrentRun>
+
 #include <ObjectMotionState.h>
 
 #include "EntityTreeRenderer.h"
@@ -187,7 +191,8 @@ void EntityRenderer::render(RenderArgs* args) {
 // Methods called by the EntityTreeRenderer
 //
 
-EntityRenderer::Pointer EntityRenderer::addToScene(EntityTreeRenderer& renderer, const EntityItemPointer& entity, const ScenePointer& scene, Transaction& transaction) {
+EntityRenderer::Pointer EntityRenderer::addToScene(EntityTreeRenderer& renderer, const EntityItemPointer& entity, const ScenePointer& scene,
+        Transaction& transaction, AsynchronousRenderUpdates& updates) {
     EntityRenderer::Pointer result;
     if (!entity) {
         return result;
@@ -245,13 +250,13 @@ EntityRenderer::Pointer EntityRenderer::addToScene(EntityTreeRenderer& renderer,
     }
 
     if (result) {
-        result->addToScene(scene, transaction);
+        result->addToScene(scene, transaction, updates);
     }
 
     return result;
 }
 
-bool EntityRenderer::addToScene(const ScenePointer& scene, Transaction& transaction) {
+bool EntityRenderer::addToScene(const ScenePointer& scene, Transaction& transaction, AsynchronousRenderUpdates& updates) {
     _renderItemID = scene->allocateID();
     // Complicated series of trusses
     auto renderPayload = std::make_shared<PayloadProxyInterface::ProxyPayload>(shared_from_this());
@@ -259,7 +264,7 @@ bool EntityRenderer::addToScene(const ScenePointer& scene, Transaction& transact
     makeStatusGetters(_entity, statusGetters);
     renderPayload->addStatusGetters(statusGetters);
     transaction.resetItem(_renderItemID, renderPayload);
-    updateInScene(scene, transaction);
+    updateInScene(scene, transaction, updates);
     onAddToScene(_entity);
     return true;
 }
@@ -270,7 +275,7 @@ void EntityRenderer::removeFromScene(const ScenePointer& scene, Transaction& tra
     Item::clearID(_renderItemID);
 }
 
-void EntityRenderer::updateInScene(const ScenePointer& scene, Transaction& transaction) {
+void EntityRenderer::updateInScene(const ScenePointer& scene, Transaction& transaction, AsynchronousRenderUpdates& updates) {
     if (!isValidRenderItem()) {
         return;
     }
@@ -281,16 +286,88 @@ void EntityRenderer::updateInScene(const ScenePointer& scene, Transaction& trans
     }
 
     doRenderUpdateSynchronous(scene, transaction, _entity);
-    transaction.updateItem<EntityRenderer>(_renderItemID, [this](EntityRenderer& self) {
-        if (!isValidRenderItem()) {
-            return;
-        }
-        // Happens on the render thread.  Classes should use
-        doRenderUpdateAsynchronous(_entity);
-        _renderUpdateQueued = false;
+    updates.queue(shared_from_this(), transaction);
+}
+
+void EntityRenderer::updateAsynchronous() {
+    if (!isValidRenderItem()) {
+        return;
+    }
+    // Happens while the scene applies the transaction.  Classes should use
+    doRenderUpdateAsynchronous(_entity);
+    _renderUpdateQueued = false;
+}
+
+//
+// Asynchronous updates
+//
+
+static const size_t MIN_RENDERERS_PER_JOB = 32;
+
+AsynchronousRenderUpdates::AsynchronousRenderUpdates() : _batch(std::make_shared<Batch>()) {
+    auto batch = _batch;
+    _functor = std::make_shared<UpdateFunctor<EntityRenderer>>([batch](EntityRenderer&) {
+        batch->apply();
     });
 }
 
+void AsynchronousRenderUpdates::queue(const std::shared_ptr<EntityRenderer>& renderer, Transaction& transaction) {
+    if (renderer->isAsynchronousUpdateParallel()) {
+        _batch->parallelRenderers.push_back(renderer);
+    } else {
+        _batch->serialRenderers.push_back(renderer);
+    }
+    transaction.updateItem(renderer->getRenderItemID(), _functor);
+}
+
+void AsynchronousRenderUpdates::updateAsynchronous(const std::shared_ptr<EntityRenderer>& renderer) {
+    renderer->updateAsynchronous();
+}
+
+void AsynchronousRenderUpdates::Batch::apply() {
+    if (applied) {
+        return;
+    }
+    applied = true;
+
+    // a renderer that was added and changed in the same frame is queued twice
+    std::sort(parallelRenderers.begin(), parallelRenderers.end());
+    parallelRenderers.erase(std::unique(parallelRenderers.begin(), parallelRenderers.end()), parallelRenderers.end());
+    std::sort(serialRenderers.begin(), serialRenderers.end());
+    serialRenderers.erase(std::unique(serialRenderers.begin(), serialRenderers.end()), serialRenderers.end());
+
+    // the renderers are split in contiguous runs, and the thread applying the transaction takes the first run itself
+    std::vector<QFuture<void>> jobs;
+    size_t numRenderers = parallelRenderers.size();
+    size_t renderersPerJob = numRenderers;
+    if (numRenderers > MIN_RENDERERS_PER_JOB) {
+        auto threadPool = QThreadPool::globalInstance();
+        size_t maxJobs = (size_t)std::max(threadPool->maxThreadCount(), 1) + 1;
+        size_t numJobs = std::min(maxJobs, (numRenderers + MIN_RENDERERS_PER_JOB - 1) / MIN_RENDERERS_PER_JOB);
+        renderersPerJob = (numRenderers + numJobs - 1) / numJobs;
+
+        const std::shared_ptr<EntityRenderer>* renderers = parallelRenderers.data();
+        for (size_t begin = renderersPerJob; begin < numRenderers; begin += renderersPerJob) {
+            size_t end = std::min(begin + renderersPerJob, numRenderers);
+            jobs.push_back(QtConcurrent::run(threadPool, [renderers, begin, end] {
+                for (size_t i = begin; i < end; ++i) {
+                    updateAsynchronous(renderers[i]);
+                }
+            }));
+        }
+    }
+    for (size_t i = 0; i < renderersPerJob; ++i) {
+        updateAsynchronous(parallelRenderers[i]);
+    }
+    for (const auto& renderer : serialRenderers) {
+        updateAsynchronous(renderer);
+    }
+
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+}
+
 //
 // Internal methods
 //
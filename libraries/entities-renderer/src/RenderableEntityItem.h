@@ -22,15 +22,44 @@ class EntityTreeRenderer;
 
 namespace render { namespace entities {
 
+class EntityRenderer;
+
+// The asynchronous halves of the renderer updates of one frame, collected while EntityTreeRenderer makes the synchronous
+// halves on the main thread.  Every item update of the batch shares one functor, and the first of them the scene applies
+// runs the whole batch, spread over the global thread pool, instead of one renderer at a time on the render thread.
+class AsynchronousRenderUpdates {
+public:
+    AsynchronousRenderUpdates();
+
+    // adds the asynchronous update of the renderer to the batch, and the update of its item to the transaction
+    void queue(const std::shared_ptr<EntityRenderer>& renderer, Transaction& transaction);
+
+private:
+    static void updateAsynchronous(const std::shared_ptr<EntityRenderer>& renderer);
+
+    struct Batch {
+        std::vector<std::shared_ptr<EntityRenderer>> parallelRenderers;
+        std::vector<std::shared_ptr<EntityRenderer>> serialRenderers;
+        bool applied { false }; // only touched on the thread that processes the transaction
+
+        void apply();
+    };
+
+    std::shared_ptr<Batch> _batch;
+    UpdateFunctorPointer _functor;
+};
+
 // Base class for all renderable entities
 class EntityRenderer : public QObject, public std::enable_shared_from_this<EntityRenderer>, public PayloadProxyInterface, protected ReadWriteLockable {
     Q_OBJECT
 
     using Pointer = std::shared_ptr<EntityRenderer>;
+    friend class AsynchronousRenderUpdates;
 
 public:
     static void initEntityRenderers();
-    static Pointer addToScene(EntityTreeRenderer& renderer, const EntityItemPointer& entity, const ScenePointer& scene, Transaction& transaction);
+    static Pointer addToScene(EntityTreeRenderer& renderer, const EntityItemPointer& entity, const ScenePointer& scene,
+        Transaction& transaction, AsynchronousRenderUpdates& updates);
 
     // Allow classes to override this to interact with the user
     virtual bool wantsHandControllerPointerEvents() const { return false; }
@@ -45,8 +74,8 @@ public:
 
     // Handlers for rendering events... executed on the main thread, only called by EntityTreeRenderer, 
     // cannot be overridden or accessed by subclasses
-    virtual void updateInScene(const ScenePointer& scene, Transaction& transaction) final;
-    virtual bool addToScene(const ScenePointer& scene, Transaction& transaction) final;
+    virtual void updateInScene(const ScenePointer& scene, Transaction& transaction, AsynchronousRenderUpdates& updates) final;
+    virtual bool addToScene(const ScenePointer& scene, Transaction& transaction, AsynchronousRenderUpdates& updates) final;
     virtual void removeFromScene(const ScenePointer& scene, Transaction& transaction);
 
 protected:
@@ -75,11 +104,15 @@ protected:
     // network textures or model geometry from resource caches
     virtual void doRenderUpdateSynchronous(const ScenePointer& scene, Transaction& transaction, const EntityItemPointer& entity);
 
-    // Will be called by the lambda posted to the scene in updateInScene.  
-    // This function will execute on the rendering thread, so you cannot use network caches to fetch
-    // data in this method if using multi-threaded rendering
+    // Will be called when the scene applies the update queued in updateInScene.
+    // This function will execute on the rendering thread, or on a worker of the global thread pool while the
+    // rendering thread waits, so you cannot use network caches to fetch data in this method
     virtual void doRenderUpdateAsynchronous(const EntityItemPointer& entity) { }
 
+    // Returns false if doRenderUpdateAsynchronous touches state shared with other renderers, so that it must not run
+    // at the same time as theirs
+    virtual bool isAsynchronousUpdateParallel() const { return true; }
+
     // Called by the `render` method after `needsRenderUpdate`
     virtual void doRender(RenderArgs* args) = 0;
 
@@ -122,6 +155,9 @@ protected:
 
 
 private:
+    // Runs the asynchronous half of a queued update
+    void updateAsynchronous();
+
     // The rendering code only gets access to the entity in very specific circumstances
     // i.e. to see if the rendering code needs to update because of a change in state of the 
     // entity.  This forces all the rendering code itself to be independent of the entity
@@ -30,6 +30,8 @@ protected:
     virtual void onRemoveFromSceneTyped(const TypedEntityPointer& entity) override;
     virtual bool needsRenderUpdateFromTypedEntity(const TypedEntityPointer& entity) const override;
     virtual void doRenderUpdateAsynchronousTyped(const TypedEntityPointer& entity) override;
+    // the geometry cache isn't thread safe
+    virtual bool isAsynchronousUpdateParallel() const override { return false; }
     virtual void doRender(RenderArgs* args) override;
 
 private:
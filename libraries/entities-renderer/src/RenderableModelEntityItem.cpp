@@ -12,6 +12,7 @@
 #include "RenderableModelEntityItem.h"
 
 #include <set>
+#include <unordered_set>
 
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
@@ -33,9 +34,20 @@
 
 #include "EntityTreeRenderer.h"
 #include "EntitiesRendererLogging.h"
+#include "HullPointCache.h"
 
 static CollisionRenderMeshCache collisionMeshCache;
 
+// hashes the bits of a point, with -0.0 folded into 0.0 so it agrees with operator==
+struct PointHash {
+    size_t operator()(const glm::vec3& point) const {
+        glm::vec3 folded = point + glm::vec3(0.0f);
+        uint32_t bits[3];
+        memcpy(bits, &folded, sizeof(bits));
+        return (size_t)((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+    }
+};
+
 void ModelEntityWrapper::setModel(const ModelPointer& model) {
     withWriteLock([&] {
         if (_model != model) {
@@ -235,12 +247,36 @@ bool RenderableModelEntityItem::findDetailedRayIntersection(const glm::vec3& ori
                                                        face, surfaceNormal, extraInfo, precisionPicking, false);
 }
 
+size_t RenderableModelEntityItem::findDetailedRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+                        std::vector<TriangleSet::RayHit>& hits, bool precisionPicking) const {
+    auto model = getModel();
+    if (!model) {
+        // like findDetailedRayIntersection, the hits against our box stand
+        return hits.size();
+    }
+    return model->findRayIntersectionsAgainstSubMeshes(rays, hits, precisionPicking, false);
+}
+
 void RenderableModelEntityItem::getCollisionGeometryResource() {
     QUrl hullURL(getCompoundShapeURL());
     QUrlQuery queryArgs(hullURL);
     queryArgs.addQueryItem("collision-hull", "");
     hullURL.setQuery(queryArgs);
     _compoundShapeResource = DependencyManager::get<ModelCache>()->getCollisionGeometryResource(hullURL);
+    _hullPointsLookup.reset();
+}
+
+void RenderableModelEntityItem::lookUpHullPoints() {
+    auto hullCache = DependencyManager::get<HullPointCache>();
+    if (!hullCache) {
+        // nothing to look up, the points will be computed
+        return;
+    }
+    if (!_hullPointsLookup) {
+        auto key = HullPointCache::getKey(_compoundShapeResource->getURL(), _compoundShapeResource->getFBXGeometry());
+        _hullPointsLookup = hullCache->lookUp(key);
+    }
+    _hullPointsLookup->waitForFinished();
 }
 
 void RenderableModelEntityItem::setShapeType(ShapeType type) {
@@ -252,6 +288,7 @@ void RenderableModelEntityItem::setShapeType(ShapeType type) {
     } else if (_compoundShapeResource && !getCompoundShapeURL().isEmpty()) {
         // the compoundURL has been set but the shapeType does not agree
         _compoundShapeResource.reset();
+        _hullPointsLookup.reset();
     }
 }
 
@@ -324,85 +361,85 @@ void RenderableModelEntityItem::computeShapeInfo(ShapeInfo& shapeInfo) {
 
         ShapeInfo::PointCollection& pointCollection = shapeInfo.getPointCollection();
         pointCollection.clear();
-        uint32_t i = 0;
-
-        // the way OBJ files get read, each section under a "g" line is its own meshPart.  We only expect
-        // to find one actual "mesh" (with one or more meshParts in it), but we loop over the meshes, just in case.
-        foreach (const FBXMesh& mesh, collisionGeometry.meshes) {
-            // each meshPart is a convex hull
-            foreach (const FBXMeshPart &meshPart, mesh.parts) {
-                pointCollection.push_back(QVector<glm::vec3>());
-                ShapeInfo::PointList& pointsInPart = pointCollection[i];
-
-                // run through all the triangles and (uniquely) add each point to the hull
-                uint32_t numIndices = (uint32_t)meshPart.triangleIndices.size();
-                // TODO: assert rather than workaround after we start sanitizing FBXMesh higher up
-                //assert(numIndices % TRIANGLE_STRIDE == 0);
-                numIndices -= numIndices % TRIANGLE_STRIDE; // WORKAROUND lack of sanity checking in FBXReader
-
-                for (uint32_t j = 0; j < numIndices; j += TRIANGLE_STRIDE) {
-                    glm::vec3 p0 = mesh.vertices[meshPart.triangleIndices[j]];
-                    glm::vec3 p1 = mesh.vertices[meshPart.triangleIndices[j + 1]];
-                    glm::vec3 p2 = mesh.vertices[meshPart.triangleIndices[j + 2]];
-                    if (!pointsInPart.contains(p0)) {
-                        pointsInPart << p0;
-                    }
-                    if (!pointsInPart.contains(p1)) {
-                        pointsInPart << p1;
-                    }
-                    if (!pointsInPart.contains(p2)) {
-                        pointsInPart << p2;
-                    }
-                }
 
-                // run through all the quads and (uniquely) add each point to the hull
-                numIndices = (uint32_t)meshPart.quadIndices.size();
-                // TODO: assert rather than workaround after we start sanitizing FBXMesh higher up
-                //assert(numIndices % QUAD_STRIDE == 0);
-                numIndices -= numIndices % QUAD_STRIDE; // WORKAROUND lack of sanity checking in FBXReader
-
-                for (uint32_t j = 0; j < numIndices; j += QUAD_STRIDE) {
-                    glm::vec3 p0 = mesh.vertices[meshPart.quadIndices[j]];
-                    glm::vec3 p1 = mesh.vertices[meshPart.quadIndices[j + 1]];
-                    glm::vec3 p2 = mesh.vertices[meshPart.quadIndices[j + 2]];
-                    glm::vec3 p3 = mesh.vertices[meshPart.quadIndices[j + 3]];
-                    if (!pointsInPart.contains(p0)) {
-                        pointsInPart << p0;
-                    }
-                    if (!pointsInPart.contains(p1)) {
-                        pointsInPart << p1;
+        // We expect that the collision model will have the same units and will be displaced
+        // from its origin in the same way the visual model is.  The visual model has
+        // been centered and probably scaled.  We take the scaling and offset which were applied
+        // to the visual model and apply them to the collision model (without regard for the
+        // collision model's extents).
+        const Extents unscaledExtents = model->getFBXGeometry().getUnscaledMeshExtents();
+        glm::vec3 scaleToFit = dimensions / unscaledExtents.size();
+        glm::vec3 registrationOffset = dimensions * (ENTITY_ITEM_DEFAULT_REGISTRATION_POINT - getRegistrationPoint());
+        glm::vec3 modelOffset = model->getOffset();
+
+        // the hull points only depend on the collision mesh, so the points of any earlier instance of the same
+        // model can be reused, including those stored on previous runs
+        lookUpHullPoints();
+        if (_hullPointsLookup && _hullPointsLookup->isHit()) {
+            pointCollection = _hullPointsLookup->getPointCollection();
+        } else {
+            std::vector<uint32_t> vertexStamps;
+            std::unordered_set<glm::vec3, PointHash> uniquePoints;
+            uint32_t partStamp = 0;
+
+            // the way OBJ files get read, each section under a "g" line is its own meshPart.  We only expect
+            // to find one actual "mesh" (with one or more meshParts in it), but we loop over the meshes, just in case.
+            foreach (const FBXMesh& mesh, collisionGeometry.meshes) {
+                vertexStamps.assign(mesh.vertices.size(), 0);
+
+                // each meshPart is a convex hull
+                foreach (const FBXMeshPart &meshPart, mesh.parts) {
+                    ShapeInfo::PointList pointsInPart;
+                    uniquePoints.clear();
+                    ++partStamp;
+
+                    // (uniquely) add a point to the hull, skipping indices we've already seen in this part
+                    auto addPoint = [&](int32_t index) {
+                        if (vertexStamps[index] != partStamp) {
+                            vertexStamps[index] = partStamp;
+                            const glm::vec3& point = mesh.vertices[index];
+                            if (uniquePoints.insert(point).second) {
+                                pointsInPart << point;
+                            }
+                        }
+                    };
+
+                    // run through all the triangles and add each point to the hull
+                    uint32_t numIndices = (uint32_t)meshPart.triangleIndices.size();
+                    // TODO: assert rather than workaround after we start sanitizing FBXMesh higher up
+                    //assert(numIndices % TRIANGLE_STRIDE == 0);
+                    numIndices -= numIndices % TRIANGLE_STRIDE; // WORKAROUND lack of sanity checking in FBXReader
+                    for (uint32_t j = 0; j < numIndices; ++j) {
+                        addPoint(meshPart.triangleIndices[j]);
                     }
-                    if (!pointsInPart.contains(p2)) {
-                        pointsInPart << p2;
+
+                    // run through all the quads and add each point to the hull
+                    numIndices = (uint32_t)meshPart.quadIndices.size();
+                    // TODO: assert rather than workaround after we start sanitizing FBXMesh higher up
+                    //assert(numIndices % QUAD_STRIDE == 0);
+                    numIndices -= numIndices % QUAD_STRIDE; // WORKAROUND lack of sanity checking in FBXReader
+                    for (uint32_t j = 0; j < numIndices; ++j) {
+                        addPoint(meshPart.quadIndices[j]);
                     }
-                    if (!pointsInPart.contains(p3)) {
-                        pointsInPart << p3;
+
+                    if (pointsInPart.size() == 0) {
+                        qCDebug(entitiesrenderer) << "Warning -- meshPart has no faces";
+                        continue;
                     }
+                    pointCollection.push_back(pointsInPart);
                 }
+            }
 
-                if (pointsInPart.size() == 0) {
-                    qCDebug(entitiesrenderer) << "Warning -- meshPart has no faces";
-                    pointCollection.pop_back();
-                    continue;
-                }
-                ++i;
+            if (_hullPointsLookup && pointCollection.size() > 0) {
+                _hullPointsLookup = DependencyManager::get<HullPointCache>()->store(_hullPointsLookup->getKey(), pointCollection);
             }
         }
 
-        // We expect that the collision model will have the same units and will be displaced
-        // from its origin in the same way the visual model is.  The visual model has
-        // been centered and probably scaled.  We take the scaling and offset which were applied
-        // to the visual model and apply them to the collision model (without regard for the
-        // collision model's extents).
-
-        glm::vec3 scaleToFit = dimensions / model->getFBXGeometry().getUnscaledMeshExtents().size();
         // multiply each point by scale before handing the point-set off to the physics engine.
-        // also determine the extents of the collision model.
-        glm::vec3 registrationOffset = dimensions * (ENTITY_ITEM_DEFAULT_REGISTRATION_POINT - getRegistrationPoint());
-        for (int32_t i = 0; i < pointCollection.size(); i++) {
-            for (int32_t j = 0; j < pointCollection[i].size(); j++) {
+        for (auto& pointsInPart : pointCollection) {
+            for (auto& point : pointsInPart) {
                 // back compensate for registration so we can apply that offset to the shapeInfo later
-                pointCollection[i][j] = scaleToFit * (pointCollection[i][j] + model->getOffset()) - registrationOffset;
+                point = scaleToFit * (point + modelOffset) - registrationOffset;
             }
         }
         shapeInfo.setParams(type, dimensions, getCompoundShapeURL());
@@ -22,6 +22,7 @@
 #include <Model.h>
 #include <model-networking/ModelCache.h>
 
+#include "HullPointCache.h"
 #include "RenderableEntityItem.h"
 
 
@@ -69,6 +70,8 @@ public:
                         bool& keepSearching, OctreeElementPointer& element, float& distance,
                         BoxFace& face, glm::vec3& surfaceNormal,
                         void** intersectedObject, bool precisionPicking) const override;
+    virtual size_t findDetailedRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+                        std::vector<TriangleSet::RayHit>& hits, bool precisionPicking) const override;
 
     virtual void setShapeType(ShapeType type) override;
     virtual void setCompoundShapeURL(const QString& url) override;
@@ -113,7 +116,10 @@ private:
     void copyAnimationJointDataToModel();
 
     void getCollisionGeometryResource();
+    // reads the cached hull points of the collision geometry, if it has not been read since it was loaded
+    void lookUpHullPoints();
     GeometryResource::Pointer _compoundShapeResource;
+    HullPointCache::LookupPointer _hullPointsLookup;
     bool _originalTexturesRead { false };
     QVariantMap _originalTextures;
     bool _dimensionsInitialized { true };
@@ -14,6 +14,8 @@
 
 #include <GeometryCache.h>
 
+#include "EntityTreeRenderer.h"
+
 #include "textured_particle_vert.h"
 #include "textured_particle_frag.h"
 
@@ -44,14 +46,6 @@ static ShapePipelinePointer shapePipelineFactory(const ShapePlumber& plumber, co
     return std::make_shared<render::ShapePipeline>(texturedPipeline, nullptr, nullptr, nullptr);
 }
 
-struct GpuParticle {
-    GpuParticle(const glm::vec3& xyzIn, const glm::vec2& uvIn) : xyz(xyzIn), uv(uvIn) {}
-    glm::vec3 xyz; // Position
-    glm::vec2 uv; // Lifetime + seed
-};
-
-using GpuParticles = std::vector<GpuParticle>;
-
 ParticleEffectEntityRenderer::ParticleEffectEntityRenderer(const EntityItemPointer& entity) : Parent(entity) {
     ParticleUniforms uniforms;
     _uniformBuffer = std::make_shared<Buffer>(sizeof(ParticleUniforms), (const gpu::Byte*) &uniforms);
@@ -93,12 +87,15 @@ void ParticleEffectEntityRenderer::doRenderUpdateSynchronousTyped(const ScenePoi
     }
     
     if (resultWithReadLock<bool>([&]{ return _particleProperties != newParticleProperties; })) {
-        _timeUntilNextEmit = 0;
         withWriteLock([&]{
             _particleProperties = newParticleProperties;
         });
+        _simulation->setProperties(newParticleProperties);
     }
     _emitting = entity->getIsEmitting();
+    _simulation->setEmitting(_emitting);
+    _simulation->setTransform(_modelTransform);
+    _simulation->setVisible(_visible);
 
     bool hasTexture = resultWithReadLock<bool>([&]{ return _particleProperties.textures.isEmpty(); });
     if (hasTexture) {
@@ -137,6 +134,20 @@ void ParticleEffectEntityRenderer::doRenderUpdateAsynchronousTyped(const TypedEn
     memcpy(&_uniformBuffer.edit<ParticleUniforms>(), &particleUniforms, sizeof(ParticleUniforms));
 }
 
+void ParticleEffectEntityRenderer::onAddToSceneTyped(const TypedEntityPointer& entity) {
+    auto renderer = DependencyManager::get<EntityTreeRenderer>();
+    if (renderer) {
+        renderer->getParticleSimulations().addEmitter(_simulation, getRenderItemID());
+    }
+}
+
+void ParticleEffectEntityRenderer::onRemoveFromSceneTyped(const TypedEntityPointer& entity) {
+    auto renderer = DependencyManager::get<EntityTreeRenderer>();
+    if (renderer) {
+        renderer->getParticleSimulations().removeEmitter(_simulation);
+    }
+}
+
 ItemKey ParticleEffectEntityRenderer::getKey() {
     if (_visible) {
         return ItemKey::Builder::transparentShape();
@@ -155,154 +166,13 @@ Item::Bound ParticleEffectEntityRenderer::getBound() {
 
 static const size_t VERTEX_PER_PARTICLE = 4;
 
-ParticleEffectEntityRenderer::CpuParticle ParticleEffectEntityRenderer::createParticle(uint64_t now, const Transform& baseTransform, const particle::Properties& particleProperties) {
-    CpuParticle particle;
-
-    const auto& accelerationSpread = particleProperties.emission.acceleration.spread;
-    const auto& azimuthStart = particleProperties.azimuth.start;
-    const auto& azimuthFinish = particleProperties.azimuth.finish;
-    const auto& emitDimensions = particleProperties.emission.dimensions;
-    const auto& emitAcceleration = particleProperties.emission.acceleration.target;
-    auto emitOrientation = particleProperties.emission.orientation;
-    const auto& emitRadiusStart = glm::max(particleProperties.radiusStart, EPSILON); // Avoid math complications at center
-    const auto& emitSpeed = particleProperties.emission.speed.target;
-    const auto& speedSpread = particleProperties.emission.speed.spread;
-    const auto& polarStart = particleProperties.polar.start;
-    const auto& polarFinish = particleProperties.polar.finish;
-
-    particle.seed = randFloatInRange(-1.0f, 1.0f);
-    particle.expiration = now + (uint64_t)(particleProperties.lifespan * USECS_PER_SECOND);
-    if (particleProperties.emission.shouldTrail) {
-        particle.position = baseTransform.getTranslation();
-        emitOrientation = baseTransform.getRotation() * emitOrientation;
-    }
-
-    // Position, velocity, and acceleration
-    if (polarStart == 0.0f && polarFinish == 0.0f && emitDimensions.z == 0.0f) {
-        // Emit along z-axis from position
-
-        particle.velocity = (emitSpeed + 0.2f * speedSpread) * (emitOrientation * Vectors::UNIT_Z);
-        particle.acceleration = emitAcceleration + randFloatInRange(-1.0f, 1.0f) * accelerationSpread;
-
-    } else {
-        // Emit around point or from ellipsoid
-        // - Distribute directions evenly around point
-        // - Distribute points relatively evenly over ellipsoid surface
-        // - Distribute points relatively evenly within ellipsoid volume
-
-        float elevationMinZ = sin(PI_OVER_TWO - polarFinish);
-        float elevationMaxZ = sin(PI_OVER_TWO - polarStart);
-        //  float elevation = asin(elevationMinZ + (elevationMaxZ - elevationMinZ) * randFloat());
-        float elevation = asin(elevationMinZ + (elevationMaxZ - elevationMinZ) *randFloat());
-
-        float azimuth;
-        if (azimuthFinish >= azimuthStart) {
-            azimuth = azimuthStart + (azimuthFinish - azimuthStart) *  randFloat();
-        } else {
-            azimuth = azimuthStart + (TWO_PI + azimuthFinish - azimuthStart) * randFloat();
-        }
-
-        glm::vec3 emitDirection;
-        if (emitDimensions == Vectors::ZERO) {
-            // Point
-            emitDirection = glm::quat(glm::vec3(PI_OVER_TWO - elevation, 0.0f, azimuth)) * Vectors::UNIT_Z;
-        } else {
-            // Ellipsoid
-            float radiusScale = 1.0f;
-            if (emitRadiusStart < 1.0f) {
-                float randRadius =
-                    emitRadiusStart + randFloatInRange(0.0f, particle::MAXIMUM_EMIT_RADIUS_START - emitRadiusStart);
-                radiusScale = 1.0f - std::pow(1.0f - randRadius, 3.0f);
-            }
-
-            glm::vec3 radii = radiusScale * 0.5f * emitDimensions;
-            float x = radii.x * glm::cos(elevation) * glm::cos(azimuth);
-            float y = radii.y * glm::cos(elevation) * glm::sin(azimuth);
-            float z = radii.z * glm::sin(elevation);
-            glm::vec3 emitPosition = glm::vec3(x, y, z);
-            emitDirection = glm::normalize(glm::vec3(
-                radii.x > 0.0f ? x / (radii.x * radii.x) : 0.0f,
-                radii.y > 0.0f ? y / (radii.y * radii.y) : 0.0f,
-                radii.z > 0.0f ? z / (radii.z * radii.z) : 0.0f
-            ));
-            particle.position += emitOrientation * emitPosition;
-        }
-
-        particle.velocity = (emitSpeed + randFloatInRange(-1.0f, 1.0f) * speedSpread) * (emitOrientation * emitDirection);
-        particle.acceleration = emitAcceleration + randFloatInRange(-1.0f, 1.0f) * accelerationSpread;
-    }
-
-    return particle;
-}
-
-void ParticleEffectEntityRenderer::stepSimulation() {
-    if (_lastSimulated == 0) {
-        _lastSimulated = usecTimestampNow();
-        return;
-    }
-
-    const auto now = usecTimestampNow();
-    const auto interval = std::min<uint64_t>(USECS_PER_SECOND / 60, now - _lastSimulated);
-    _lastSimulated = now;
-    
-    particle::Properties particleProperties;
-    withReadLock([&]{
-        particleProperties = _particleProperties;
-    });
-
-    if (_emitting && particleProperties.emitting()) {
-        uint64_t emitInterval = particleProperties.emitIntervalUsecs();
-        if (emitInterval > 0 && interval >= _timeUntilNextEmit) {
-            auto timeRemaining = interval;
-            while (timeRemaining > _timeUntilNextEmit) {
-                // emit particle
-                _cpuParticles.push_back(createParticle(now, _modelTransform, particleProperties));
-                _timeUntilNextEmit = emitInterval;
-                if (emitInterval < timeRemaining) {
-                    timeRemaining -= emitInterval;
-                }
-            }
-        } else {
-            _timeUntilNextEmit -= interval;
-        }
-    }
-
-    // Kill any particles that have expired or are over the max size
-    while (_cpuParticles.size() > particleProperties.maxParticles || (!_cpuParticles.empty() && _cpuParticles.front().expiration <= now)) {
-        _cpuParticles.pop_front();
-    }
-
-    const float deltaTime = (float)interval / (float)USECS_PER_SECOND;
-    // update the particles 
-    for (auto& particle : _cpuParticles) {
-        particle.integrate(deltaTime);
-    }
-
-    // Build particle primitives
-    static GpuParticles gpuParticles;
-    gpuParticles.clear();
-    gpuParticles.reserve(_cpuParticles.size()); // Reserve space
-    std::transform(_cpuParticles.begin(), _cpuParticles.end(), std::back_inserter(gpuParticles), [](const CpuParticle& particle) {
-        return GpuParticle(particle.position, glm::vec2(particle.lifetime, particle.seed));
-    });
-
-    // Update particle buffer
-    auto& particleBuffer = _particleBuffer;
-    size_t numBytes = sizeof(GpuParticle) * gpuParticles.size();
-    particleBuffer->resize(numBytes);
-    if (numBytes != 0) {
-        particleBuffer->setData(numBytes, (const gpu::Byte*)gpuParticles.data());
-    }
-}
-
 void ParticleEffectEntityRenderer::doRender(RenderArgs* args) {
     if (!_visible) {
         return;
     }
 
-
-    // FIXME migrate simulation to a compute stage
-    stepSimulation();
+    // the buffer drawn here was swapped in with the scene transaction, the workers only step the emitters that render
+    _simulation->setRendered();
 
     gpu::Batch& batch = *args->_batch;
     if (_networkTexture && _networkTexture->isLoaded()) {
@@ -321,9 +191,10 @@ void ParticleEffectEntityRenderer::doRender(RenderArgs* args) {
     batch.setModelTransform(transform);
     batch.setUniformBuffer(0, _uniformBuffer);
     batch.setInputFormat(_vertexFormat);
-    batch.setInputBuffer(0, _particleBuffer, 0, sizeof(GpuParticle));
+    const auto& particleBuffer = _simulation->getParticleBuffer();
+    batch.setInputBuffer(0, particleBuffer, 0, sizeof(GpuParticle));
 
-    auto numParticles = _particleBuffer->getSize() / sizeof(GpuParticle);
+    auto numParticles = particleBuffer->getSize() / sizeof(GpuParticle);
     batch.drawInstanced((gpu::uint32)numParticles, gpu::TRIANGLE_STRIP, (gpu::uint32)VERTEX_PER_PARTICLE);
 }
 
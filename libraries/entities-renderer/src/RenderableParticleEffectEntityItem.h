@@ -15,6 +15,8 @@
 #include <ParticleEffectEntityItem.h>
 #include <TextureCache.h>
 
+#include "ParticleSimulation.h"
+
 namespace render { namespace entities {
 
 class ParticleEffectEntityRenderer : public TypedEntityRenderer<ParticleEffectEntityItem> {
@@ -29,6 +31,8 @@ protected:
 
     virtual void doRenderUpdateSynchronousTyped(const ScenePointer& scene, Transaction& transaction, const TypedEntityPointer& entity) override;
     virtual void doRenderUpdateAsynchronousTyped(const TypedEntityPointer& entity) override;
+    virtual void onAddToSceneTyped(const TypedEntityPointer& entity) override;
+    virtual void onRemoveFromSceneTyped(const TypedEntityPointer& entity) override;
 
     virtual ItemKey getKey() override;
     virtual ShapeKey getShapeKey() override;
@@ -43,40 +47,6 @@ private:
     using Buffer = gpu::Buffer;
     using BufferView = gpu::BufferView;
 
-    // CPU particles
-    // FIXME either switch to GPU compute particles or switch to simd updating of the particles
-#if 1
-    struct CpuParticle {
-        float seed{ 0.0f };
-        uint64_t expiration { 0 };
-        float lifetime { 0.0f };
-        glm::vec3 position;
-        glm::vec3 velocity;
-        glm::vec3 acceleration;
-
-        void integrate(float deltaTime) {
-            glm::vec3 atSquared = (0.5f * deltaTime * deltaTime) * acceleration;
-            position += velocity * deltaTime + atSquared;
-            velocity += acceleration * deltaTime;
-            lifetime += deltaTime;
-        }
-    };
-    using CpuParticles = std::deque<CpuParticle>;
-#else
-    struct CpuParticles {
-        std::vector<float> seeds;
-        std::vector<float> lifetimes;
-        std::vector<vec4> positions;
-        std::vector<vec4> velocities;
-        std::vector<vec4> accelerations;
-
-        size_t size() const;
-        void resize(size_t size);
-        void integrate(float deltaTime);
-    };
-#endif
-
-
     template<typename T>
     struct InterpolationData {
         T start;
@@ -92,17 +62,11 @@ private:
         glm::vec3 spare;
     };
 
-
-    static CpuParticle createParticle(uint64_t now, const Transform& baseTransform, const particle::Properties& particleProperties);
-    void stepSimulation();
-
     particle::Properties _particleProperties;
-    CpuParticles _cpuParticles;
     bool _emitting { false };
-    uint64_t _timeUntilNextEmit { 0 };
-    BufferPointer _particleBuffer{ std::make_shared<Buffer>() };
+    // stepped by the EntityTreeRenderer's ParticleSimulationPool, its buffers are swapped in by the scene transaction
+    ParticleEmitterSimulation::Pointer _simulation { std::make_shared<ParticleEmitterSimulation>() };
     BufferView _uniformBuffer;
-    quint64 _lastSimulated { 0 };
 
     NetworkTexturePointer _networkTexture;
     ScenePointer _scene;
@@ -18,7 +18,9 @@
 
 #include <QObject>
 #include <QByteArray>
-#include <QtConcurrent/QtConcurrentRun>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 #include <model-networking/SimpleMeshProxy.h>
 #include <ModelScriptingInterface.h>
@@ -103,12 +105,20 @@ const float MARCHING_CUBE_COLLISION_HULL_OFFSET = 0.5;
   is set, isReadyToComputeShape() gets called and _shape is created either from _volData or _shape, depending on
   the surface style.
 
-  When a script changes _volData, compressVolumeDataAndSendEditPacket is called to update _voxelData and to
-  send a packet to the entity-server.
+  When a script changes _volData, the changed voxels are remembered and queueVoxelEdits is called.  sendVoxelEdits
+  updates _voxelData and sends the changes to the entity-server as a delta (see PolyVoxEntityItem::makeVoxelDelta).
+  The edits of a stroke that arrive while a packet is waiting to go out are sent with it.
 
-  decompressVolumeData, recomputeMesh, computeShapeInfoWorker, and compressVolumeDataAndSendEditPacket are too expensive
-  to run on a thread that has other things to do.  These use QtConcurrent::run to spawn a thread.  As each thread
-  finishes, it adjusts the dirty flags so that the next call to render() will kick off the next step.
+  _volData is split into chunks of CHUNK_SIZE cells on a side.  Changing a voxel marks the chunks it touches, and
+  recomputeMesh and computeShapeInfoWorker only extract the marked chunks again.  The chunks are then put together
+  into one _mesh and one collision shape.
+
+  decompressVolumeData, recomputeMesh, computeShapeInfoWorker, and sendVoxelEdits are too expensive to run on a
+  thread that has other things to do.  These are run on a small pool of threads shared by every polyvox entity, so
+  that a domain full of voxels doesn't take over the global thread pool.  Meshing runs ahead of edits, which run
+  ahead of collision shapes, which run ahead of decompressing newly arrived volumes, so that someone sculpting sees
+  their changes before the rest of the domain finishes loading.  As each job finishes, it adjusts the dirty flags so
+  that the next call to render() will kick off the next step.
 
   polyvoxes are designed to seemlessly fit up against neighbors.  If voxels go right up to the edge of polyvox,
   the resulting mesh wont be closed -- the library assumes you'll have another polyvox next to it to continue the
@@ -137,6 +147,38 @@ void loop3(const T& start, const T& end, F f) {
     }
 }
 
+enum PolyVoxJobPriority {
+    DECOMPRESS_PRIORITY = 0,
+    SHAPE_PRIORITY,
+    EDIT_PRIORITY,
+    MESH_PRIORITY
+};
+
+class PolyVoxJob : public QRunnable {
+public:
+    PolyVoxJob(std::function<void()> job) : _job(job) { }
+    void run() override { _job(); }
+
+private:
+    std::function<void()> _job;
+};
+
+static void startPolyVoxJob(PolyVoxJobPriority priority, std::function<void()> job) {
+    // the pool is never deleted, because jobs may still be running when the statics are destroyed
+    static QThreadPool* pool = [] {
+        QThreadPool* result = new QThreadPool();
+        result->setMaxThreadCount(std::max(QThread::idealThreadCount() / 2, 1));
+        return result;
+    }();
+    pool->start(new PolyVoxJob(job), priority);
+}
+
+static const int CHUNK_SIZE = 16;
+
+static glm::vec3 polyVoxToGlm(const PolyVox::Vector3DFloat& v) {
+    return glm::vec3(v.getX(), v.getY(), v.getZ());
+}
+
 EntityItemPointer RenderablePolyVoxEntityItem::factory(const EntityItemID& entityID, const EntityItemProperties& properties) {
     std::shared_ptr<RenderablePolyVoxEntityItem> entity{ new RenderablePolyVoxEntityItem(entityID) };
     entity->setProperties(properties);
@@ -171,7 +213,17 @@ bool isEdged(PolyVoxEntityItem::PolyVoxSurfaceStyle surfaceStyle) {
 void RenderablePolyVoxEntityItem::setVoxelData(const QByteArray& voxelData) {
     // compressed voxel information from the entity-server
     withWriteLock([&] {
-        if (_voxelData != voxelData) {
+        if (isVoxelDelta(voxelData)) {
+            QByteArray newVoxelData;
+            if (!applyVoxelDelta(_voxelData, voxelData, newVoxelData)) {
+                qCDebug(entitiesrenderer) << "Ignoring voxel edit that does not apply to" << getID();
+                return;
+            }
+            if (_voxelData != newVoxelData) {
+                _voxelData = newVoxelData;
+                _voxelDataDirty = true;
+            }
+        } else if (_voxelData != voxelData) {
             _voxelData = voxelData;
             _voxelDataDirty = true;
         }
@@ -201,6 +253,7 @@ void RenderablePolyVoxEntityItem::setVoxelSurfaceStyle(PolyVoxSurfaceStyle voxel
         } else {
             _volDataDirty = true;
             _voxelSurfaceStyle = voxelSurfaceStyle;
+            markAllChunksChanged();
         }
     });
 
@@ -264,10 +317,10 @@ bool RenderablePolyVoxEntityItem::setVoxel(const ivec3& v, uint8_t toValue) {
 
     bool result = false;
     withWriteLock([&] {
-        result = setVoxelInternal(v, toValue);
+        result = editVoxelInternal(v, toValue);
     });
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
 
     return result;
@@ -312,11 +365,11 @@ bool RenderablePolyVoxEntityItem::setAll(uint8_t toValue) {
 
     withWriteLock([&] {
         loop3(ivec3(0), ivec3(_voxelVolumeSize), [&](const ivec3& v) {
-            result |= setVoxelInternal(v, toValue);
+            result |= editVoxelInternal(v, toValue);
         });
     });
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
     return result;
 }
@@ -337,11 +390,11 @@ bool RenderablePolyVoxEntityItem::setCuboid(const glm::vec3& lowPosition, const
 
     withWriteLock([&] {
         loop3(low, high, [&] (const ivec3& v){
-            result |= setVoxelInternal(v, toValue);
+            result |= editVoxelInternal(v, toValue);
         });
     });
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
     return result;
 }
@@ -373,13 +426,13 @@ bool RenderablePolyVoxEntityItem::setSphereInVolume(const vec3& center, float ra
             float fDistToCenterSquared = glm::distance2(pos, center);
             // If the current voxel is less than 'radius' units from the center then we set its value
             if (fDistToCenterSquared <= radiusSquared) {
-                result |= setVoxelInternal(v, toValue);
+                result |= editVoxelInternal(v, toValue);
             }
         });
     });
 
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
     return result;
 }
@@ -421,7 +474,7 @@ bool RenderablePolyVoxEntityItem::setSphere(const vec3& centerWorldCoords, float
             // set voxels whose bounding-box touches the sphere
             AABox voxelBox(glm::vec3(v) - 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
             if (voxelBox.touchesAAEllipsoid(centerInVoxelCoords, radials)) {
-                result |= setVoxelInternal(v, toValue);
+                result |= editVoxelInternal(v, toValue);
             }
 
             // TODO -- this version only sets voxels which have centers inside the sphere.  which is best?
@@ -439,7 +492,7 @@ bool RenderablePolyVoxEntityItem::setSphere(const vec3& centerWorldCoords, float
     });
 
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
     return result;
 }
@@ -481,13 +534,13 @@ bool RenderablePolyVoxEntityItem::setCapsule(const vec3& startWorldCoords, const
             // convert to world coordinates
             glm::vec3 worldPos = glm::vec3(vtwMatrix * pos);
             if (pointInCapsule(worldPos, startWorldCoords, endWorldCoords, radiusWorldCoords)) {
-                result |= setVoxelInternal(v, toValue);
+                result |= editVoxelInternal(v, toValue);
             }
         });
     });
 
     if (result) {
-        compressVolumeDataAndSendEditPacket();
+        queueVoxelEdits();
     }
     return result;
 }
@@ -738,6 +791,10 @@ void RenderablePolyVoxEntityItem::setVoxelVolumeSize(const glm::vec3& voxelVolum
         _volData.reset(new PolyVox::SimpleVolume<uint8_t>(PolyVox::Region(lowCorner, highCorner)));
         // having the "outside of voxel-space" value be 255 has helped me notice some problems.
         _volData->setBorderValue(255);
+        allocateChunks();
+
+        // the changes were made to a volume of another size, the new voxelData replaces them
+        _pendingVoxelChanges.clear();
     });
 }
 
@@ -794,23 +851,73 @@ bool RenderablePolyVoxEntityItem::setVoxelInternal(const ivec3& v, uint8_t toVal
         return result;
     }
 
+    bool changed = getVoxelInternal(v) != toValue;
     result = updateOnCount(v, toValue);
 
-    if (isEdged()) {
-        _volData->setVoxelAt(v.x + 1, v.y + 1, v.z + 1, toValue);
-    } else {
-        _volData->setVoxelAt(v.x, v.y, v.z, toValue);
+    ivec3 volDataCoords = isEdged() ? v + 1 : v;
+    _volData->setVoxelAt(volDataCoords.x, volDataCoords.y, volDataCoords.z, toValue);
+
+    if (changed) {
+        markVoxelChanged(volDataCoords);
     }
 
     if (glm::any(glm::equal(ivec3(0), v))) {
         _neighborsNeedUpdate = true;
     }
 
-    _volDataDirty |= result;
+    _volDataDirty |= changed;
 
     return result;
 }
 
+bool RenderablePolyVoxEntityItem::editVoxelInternal(const ivec3& v, uint8_t toValue) {
+    // set a voxel for a script, and remember the change for the next edit packet.  This assumes that the
+    // caller has write-locked the entity.
+    if (!inUserBounds(_volData, _voxelSurfaceStyle, v) || getVoxelInternal(v) == toValue) {
+        return false;
+    }
+
+    setVoxelInternal(v, toValue);
+    ivec3 voxelSize { _voxelVolumeSize };
+    _pendingVoxelChanges[(v.z * voxelSize.y + v.y) * voxelSize.x + v.x] = toValue;
+    return true;
+}
+
+void RenderablePolyVoxEntityItem::allocateChunks() {
+    // the chunks split up the cells of _volData, which run from its lower corner up to its upper corner
+    auto upperCorner = _volData->getEnclosingRegion().getUpperCorner();
+    ivec3 numCells { upperCorner.getX(), upperCorner.getY(), upperCorner.getZ() };
+    _numChunks = glm::max((numCells + CHUNK_SIZE - 1) / CHUNK_SIZE, ivec3(1));
+    _chunks.clear();
+    _chunks.resize(_numChunks.x * _numChunks.y * _numChunks.z);
+    _chunksGeneration++;
+}
+
+void RenderablePolyVoxEntityItem::chunkBounds(int index, ivec3& low, ivec3& high) const {
+    // low and high are the corners of the PolyVox region of the chunk.  Neighboring chunks share the voxels on
+    // the faces between them.
+    ivec3 chunk { index % _numChunks.x, (index / _numChunks.x) % _numChunks.y, index / (_numChunks.x * _numChunks.y) };
+    auto upperCorner = _volData->getEnclosingRegion().getUpperCorner();
+    low = chunk * CHUNK_SIZE;
+    high = glm::min(low + CHUNK_SIZE, ivec3(upperCorner.getX(), upperCorner.getY(), upperCorner.getZ()));
+}
+
+void RenderablePolyVoxEntityItem::markVoxelChanged(const ivec3& volDataCoords) {
+    // a voxel is a corner of the cells on both sides of it, and the marching-cubes normals are gradients that
+    // reach one voxel further, so the change can show up in the cells from v - 2 to v + 1.
+    ivec3 low = glm::clamp((volDataCoords - 2) / CHUNK_SIZE, ivec3(0), _numChunks - 1);
+    ivec3 high = glm::clamp((volDataCoords + 1) / CHUNK_SIZE, ivec3(0), _numChunks - 1);
+    loop3(low, high + 1, [&](const ivec3& chunk) {
+        _chunks[chunkIndex(chunk)].version++;
+    });
+}
+
+void RenderablePolyVoxEntityItem::markAllChunksChanged() {
+    for (auto& chunk : _chunks) {
+        chunk.version++;
+    }
+}
+
 
 bool RenderablePolyVoxEntityItem::updateOnCount(const ivec3& v, uint8_t toValue) {
     // keep _onCount up to date
@@ -844,7 +951,7 @@ void RenderablePolyVoxEntityItem::decompressVolumeData() {
         voxelData = _voxelData;
     });
 
-    QtConcurrent::run([=] {
+    startPolyVoxJob(DECOMPRESS_PRIORITY, [=] {
         QDataStream reader(voxelData);
         quint16 voxelXSize, voxelYSize, voxelZSize;
         reader >> voxelXSize;
@@ -880,73 +987,108 @@ void RenderablePolyVoxEntityItem::decompressVolumeData() {
 
 void RenderablePolyVoxEntityItem::setVoxelsFromData(QByteArray uncompressedData,
                                                     quint16 voxelXSize, quint16 voxelYSize, quint16 voxelZSize) {
-    // this accepts the payload from decompressVolumeData
+    // this accepts the payload from decompressVolumeData.  Only the chunks with voxels that differ from
+    // _volData are marked, so an echo of our own edit doesn't cause any meshing.
     withWriteLock([&] {
         loop3(ivec3(0), ivec3(voxelXSize, voxelYSize, voxelZSize), [&](const ivec3& v) {
-            int uncompressedIndex = (v.z * voxelYSize * voxelXSize) + (v.y * voxelZSize) + v.x;
+            int uncompressedIndex = (v.z * voxelYSize * voxelXSize) + (v.y * voxelXSize) + v.x;
             setVoxelInternal(v, uncompressedData[uncompressedIndex]);
         });
         _volDataDirty = true;
     });
 }
 
-void RenderablePolyVoxEntityItem::compressVolumeDataAndSendEditPacket() {
-    // compress the data in _volData and save the results.  The compressed form is used during
-    // saves to disk and for transmission over the wire to the entity-server
-
-    EntityItemPointer entity = getThisPointer();
-
-    quint16 voxelXSize;
-    quint16 voxelYSize;
-    quint16 voxelZSize;
-    withReadLock([&] {
-        voxelXSize = _voxelVolumeSize.x;
-        voxelYSize = _voxelVolumeSize.y;
-        voxelZSize = _voxelVolumeSize.z;
+void RenderablePolyVoxEntityItem::queueVoxelEdits() {
+    // the changed voxels are sent by a job on the polyvox pool.  While a job is queued or running, later edits
+    // are left for it to pick up, which keeps the edits of this entity in order and coalesces a stroke into as
+    // few packets as the pool can keep up with.
+    bool alreadyQueued = false;
+    withWriteLock([&] {
+        alreadyQueued = _voxelEditsQueued;
+        _voxelEditsQueued = true;
     });
+    if (alreadyQueued) {
+        return;
+    }
 
+    auto entity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(getThisPointer());
     EntityTreeElementPointer element = getElement();
     EntityTreePointer tree = element ? element->getTree() : nullptr;
 
-    QtConcurrent::run([voxelXSize, voxelYSize, voxelZSize, entity, tree] {
-        auto polyVoxEntity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity);
-        QByteArray uncompressedData = polyVoxEntity->volDataToArray(voxelXSize, voxelYSize, voxelZSize);
-
-        QByteArray newVoxelData;
-        QDataStream writer(&newVoxelData, QIODevice::WriteOnly | QIODevice::Truncate);
+    startPolyVoxJob(EDIT_PRIORITY, [entity, tree] {
+        entity->sendVoxelEdits(tree);
+    });
+}
 
-        writer << voxelXSize << voxelYSize << voxelZSize;
+void RenderablePolyVoxEntityItem::sendVoxelEdits(EntityTreePointer tree) {
+    // compress the data in _volData and save the results.  The compressed form is used during saves to disk,
+    // and to recognize the voxelData the entity-server sends back.  The entity-server is only sent the voxels
+    // that changed.
+    while (true) {
+        quint16 voxelXSize;
+        quint16 voxelYSize;
+        quint16 voxelZSize;
+        VoxelChanges changes;
+        withWriteLock([&] {
+            voxelXSize = _voxelVolumeSize.x;
+            voxelYSize = _voxelVolumeSize.y;
+            voxelZSize = _voxelVolumeSize.z;
+            changes.swap(_pendingVoxelChanges);
+            if (changes.empty()) {
+                _voxelEditsQueued = false;
+            }
+        });
+        if (changes.empty()) {
+            return;
+        }
 
-        QByteArray compressedData = qCompress(uncompressedData, 9);
-        writer << compressedData;
+        QByteArray uncompressedData = volDataToArray(voxelXSize, voxelYSize, voxelZSize);
+        QByteArray newVoxelData = compressVoxelData(voxelXSize, voxelYSize, voxelZSize, uncompressedData);
 
         // make sure the compressed data can be sent over the wire-protocol
-        if (newVoxelData.size() > 1150) {
+        if (newVoxelData.size() > MAX_VOXEL_DATA_SIZE) {
             // HACK -- until we have a way to allow for properties larger than MTU, don't update.
             // revert the active voxel-space to the last version that fit.
-            qCDebug(entitiesrenderer) << "compressed voxel data is too large" << entity->getName() << entity->getID();
-            return;
+            qCDebug(entitiesrenderer) << "compressed voxel data is too large" << getName() << getID();
+            continue;
+        }
+
+        // changes scattered all over the volume can take more room than the whole volume
+        QByteArray voxelDelta = makeVoxelDelta(voxelXSize, voxelYSize, voxelZSize, changes);
+        if (voxelDelta.size() > newVoxelData.size()) {
+            voxelDelta = newVoxelData;
         }
 
         auto now = usecTimestampNow();
-        entity->setLastEdited(now);
-        entity->setLastBroadcast(now);
+        setLastEdited(now);
+        setLastBroadcast(now);
 
-        std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity)->setVoxelData(newVoxelData);
+        // _volData already has these voxels, so this doesn't go through setVoxelData, which would have them
+        // decompressed into _volData again.
+        withWriteLock([&] {
+            _voxelData = newVoxelData;
+        });
 
+        if (!tree) {
+            continue;
+        }
         tree->withReadLock([&] {
-            EntityItemProperties properties = entity->getProperties();
+            EntityItemProperties properties = getProperties();
+            if (!getClientOnly()) {
+                // avatar-entities travel whole, with the avatar, so they keep the whole volume
+                properties.setVoxelData(voxelDelta);
+            }
             properties.setVoxelDataDirty();
             properties.setLastEdited(now);
 
-            EntitySimulationPointer simulation = tree ? tree->getSimulation() : nullptr;
+            EntitySimulationPointer simulation = tree->getSimulation();
             PhysicalEntitySimulationPointer peSimulation = std::static_pointer_cast<PhysicalEntitySimulation>(simulation);
             EntityEditPacketSender* packetSender = peSimulation ? peSimulation->getPacketSender() : nullptr;
             if (packetSender) {
-                packetSender->queueEditEntityMessage(PacketType::EntityEdit, tree, entity->getID(), properties);
+                packetSender->queueEditEntityMessage(PacketType::EntityEdit, tree, getID(), properties);
             }
         });
-    });
+    }
 }
 
 EntityItemPointer lookUpNeighbor(EntityTreePointer tree, EntityItemID neighborID, EntityItemWeakPointer& currentWP) {
@@ -1006,6 +1148,9 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
             for (int y = 0; y < _volData->getHeight(); y++) {
                 for (int z = 0; z < _volData->getDepth(); z++) {
                     uint8_t neighborValue = currentXPNeighbor->getVoxel({ 0, y, z });
+                    if (_volData->getVoxelAt(_volData->getWidth() - 1, y, z) != neighborValue) {
+                        markVoxelChanged({ _volData->getWidth() - 1, y, z });
+                    }
                     if ((y == 0 || z == 0) && _volData->getVoxelAt(_volData->getWidth() - 1, y, z) != neighborValue) {
                         bonkNeighbors();
                     }
@@ -1021,6 +1166,9 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
             for (int x = 0; x < _volData->getWidth(); x++) {
                 for (int z = 0; z < _volData->getDepth(); z++) {
                     uint8_t neighborValue = currentYPNeighbor->getVoxel({ x, 0, z });
+                    if (_volData->getVoxelAt(x, _volData->getHeight() - 1, z) != neighborValue) {
+                        markVoxelChanged({ x, _volData->getHeight() - 1, z });
+                    }
                     if ((x == 0 || z == 0) && _volData->getVoxelAt(x, _volData->getHeight() - 1, z) != neighborValue) {
                         bonkNeighbors();
                     }
@@ -1036,6 +1184,9 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
             for (int x = 0; x < _volData->getWidth(); x++) {
                 for (int y = 0; y < _volData->getHeight(); y++) {
                     uint8_t neighborValue = currentZPNeighbor->getVoxel({ x, y, 0 });
+                    if (_volData->getVoxelAt(x, y, _volData->getDepth() - 1) != neighborValue) {
+                        markVoxelChanged({ x, y, _volData->getDepth() - 1 });
+                    }
                     _volData->setVoxelAt(x, y, _volData->getDepth() - 1, neighborValue);
                     if ((x == 0 || y == 0) && _volData->getVoxelAt(x, y, _volData->getDepth() - 1) != neighborValue) {
                         bonkNeighbors();
@@ -1059,78 +1210,154 @@ void RenderablePolyVoxEntityItem::recomputeMesh() {
 
     auto entity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(getThisPointer());
 
-    QtConcurrent::run([entity, voxelSurfaceStyle] {
-        model::MeshPointer mesh(new model::Mesh());
+    startPolyVoxJob(MESH_PRIORITY, [entity, voxelSurfaceStyle] {
+        entity->extractChangedChunks(voxelSurfaceStyle);
+    });
+}
+
+static void extractSurface(PolyVox::SimpleVolume<uint8_t>* volData, const PolyVox::Region& region,
+                           PolyVoxEntityItem::PolyVoxSurfaceStyle voxelSurfaceStyle,
+                           PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal>& polyVoxMesh) {
+    switch (voxelSurfaceStyle) {
+        case PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES:
+        case PolyVoxEntityItem::SURFACE_MARCHING_CUBES: {
+            PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
+                (volData, region, &polyVoxMesh);
+            surfaceExtractor.execute();
+            break;
+        }
+        case PolyVoxEntityItem::SURFACE_EDGED_CUBIC:
+        case PolyVoxEntityItem::SURFACE_CUBIC: {
+            PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
+                (volData, region, &polyVoxMesh);
+            surfaceExtractor.execute();
+            break;
+        }
+    }
+}
+
+void RenderablePolyVoxEntityItem::extractChangedChunks(PolyVoxSurfaceStyle voxelSurfaceStyle) {
+    // this runs on the polyvox pool.  Each chunk is extracted under its own read-lock, so that scripts editing the
+    // volume aren't held up for the whole volume.
+    std::vector<std::pair<int, uint32_t>> changedChunks;
+    uint32_t generation;
+    withReadLock([&] {
+        generation = _chunksGeneration;
+        for (int i = 0; i < (int)_chunks.size(); ++i) {
+            if (_chunks[i].meshVersion != _chunks[i].version) {
+                changedChunks.push_back({ i, _chunks[i].version });
+            }
+        }
+    });
+
+    if (changedChunks.empty()) {
+        // nothing visible changed, e.g. the entity-server echoed our own edit
+        withWriteLock([&] {
+            _meshReady = true;
+        });
+        return;
+    }
 
-        // A mesh object to hold the result of surface extraction
+    for (const auto& changedChunk : changedChunks) {
         PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> polyVoxMesh;
+        ivec3 low;
+        ivec3 high;
+        bool extracted = false;
+        withReadLock([&] {
+            if (_chunksGeneration != generation) {
+                return;
+            }
+            chunkBounds(changedChunk.first, low, high);
+            PolyVox::Region region(PolyVox::Vector3DInt32(low.x, low.y, low.z), PolyVox::Vector3DInt32(high.x, high.y, high.z));
+            extractSurface(_volData.get(), region, voxelSurfaceStyle, polyVoxMesh);
+            extracted = true;
+        });
+        if (!extracted) {
+            // _volData was reallocated, and will be meshed again once it has been filled in
+            return;
+        }
 
-        entity->withReadLock([&] {
-            PolyVox::SimpleVolume<uint8_t>* volData = entity->getVolData();
-            switch (voxelSurfaceStyle) {
-                case PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES: {
-                    PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
-                case PolyVoxEntityItem::SURFACE_MARCHING_CUBES: {
-                    PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
-                case PolyVoxEntityItem::SURFACE_EDGED_CUBIC: {
-                    PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
-                case PolyVoxEntityItem::SURFACE_CUBIC: {
-                    PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
+        // the surface extractors place vertices relative to the lower corner of the region
+        std::vector<PolyVox::PositionMaterialNormal> vertices = polyVoxMesh.getRawVertexData();
+        PolyVox::Vector3DFloat regionOffset((float)low.x, (float)low.y, (float)low.z);
+        for (auto& vertex : vertices) {
+            vertex.setPosition(vertex.getPosition() + regionOffset);
+        }
+
+        withWriteLock([&] {
+            auto& chunk = _chunks[changedChunk.first];
+            // a later job may have already stored a newer version of this chunk
+            if (_chunksGeneration == generation && chunk.meshVersion < changedChunk.second) {
+                chunk.vertices.swap(vertices);
+                chunk.indices = polyVoxMesh.getIndices();
+                chunk.meshVersion = changedChunk.second;
             }
         });
+    }
 
-        // convert PolyVox mesh to a Sam mesh
-        const std::vector<uint32_t>& vecIndices = polyVoxMesh.getIndices();
-        auto indexBuffer = std::make_shared<gpu::Buffer>(vecIndices.size() * sizeof(uint32_t),
-                                                         (gpu::Byte*)vecIndices.data());
-        auto indexBufferPtr = gpu::BufferPointer(indexBuffer);
-        gpu::BufferView indexBufferView(indexBufferPtr, gpu::Element(gpu::SCALAR, gpu::UINT32, gpu::INDEX));
-        mesh->setIndexBuffer(indexBufferView);
-
-        const std::vector<PolyVox::PositionMaterialNormal>& vecVertices = polyVoxMesh.getRawVertexData();
-        auto vertexBuffer = std::make_shared<gpu::Buffer>(vecVertices.size() * sizeof(PolyVox::PositionMaterialNormal),
-                                                          (gpu::Byte*)vecVertices.data());
-        auto vertexBufferPtr = gpu::BufferPointer(vertexBuffer);
-        gpu::BufferView vertexBufferView(vertexBufferPtr, 0,
-                                         vertexBufferPtr->getSize(),
-                                         sizeof(PolyVox::PositionMaterialNormal),
-                                         gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
-        mesh->setVertexBuffer(vertexBufferView);
-
-
-        // TODO -- use 3-byte normals rather than 3-float normals
-        mesh->addAttribute(gpu::Stream::NORMAL,
-                           gpu::BufferView(vertexBufferPtr,
-                                           sizeof(float) * 3, // polyvox mesh is packed: position, normal, material
-                                           vertexBufferPtr->getSize(),
-                                           sizeof(PolyVox::PositionMaterialNormal),
-                                           gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ)));
-
-        std::vector<model::Mesh::Part> parts;
-        parts.emplace_back(model::Mesh::Part((model::Index)0, // startIndex
-                                             (model::Index)vecIndices.size(), // numIndices
-                                             (model::Index)0, // baseVertex
-                                             model::Mesh::TRIANGLES)); // topology
-        mesh->setPartBuffer(gpu::BufferView(new gpu::Buffer(parts.size() * sizeof(model::Mesh::Part),
-                                                            (gpu::Byte*) parts.data()), gpu::Element::PART_DRAWCALL));
-        entity->setMesh(mesh);
+    model::MeshPointer mesh;
+    withReadLock([&] {
+        if (_chunksGeneration == generation) {
+            mesh = assembleMesh();
+        }
     });
+    if (mesh) {
+        setMesh(mesh);
+    }
+}
+
+model::MeshPointer RenderablePolyVoxEntityItem::assembleMesh() const {
+    // put the chunks together into one mesh, so the entity is still drawn with a single draw call.  This assumes
+    // that the caller has read-locked the entity.
+    size_t numVertices = 0;
+    size_t numIndices = 0;
+    for (const auto& chunk : _chunks) {
+        numVertices += chunk.vertices.size();
+        numIndices += chunk.indices.size();
+    }
+
+    auto vertexBufferPtr = std::make_shared<gpu::Buffer>();
+    auto indexBufferPtr = std::make_shared<gpu::Buffer>();
+    auto vertices = reinterpret_cast<PolyVox::PositionMaterialNormal*>(
+        vertexBufferPtr->overwrite(numVertices * sizeof(PolyVox::PositionMaterialNormal)));
+    auto indices = reinterpret_cast<uint32_t*>(indexBufferPtr->overwrite(numIndices * sizeof(uint32_t)));
+
+    uint32_t baseVertex = 0;
+    for (const auto& chunk : _chunks) {
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices + baseVertex);
+        for (uint32_t index : chunk.indices) {
+            *indices++ = baseVertex + index;
+        }
+        baseVertex += (uint32_t)chunk.vertices.size();
+    }
+
+    // convert PolyVox mesh to a Sam mesh
+    model::MeshPointer mesh(new model::Mesh());
+    gpu::BufferView indexBufferView(indexBufferPtr, gpu::Element(gpu::SCALAR, gpu::UINT32, gpu::INDEX));
+    mesh->setIndexBuffer(indexBufferView);
+
+    gpu::BufferView vertexBufferView(vertexBufferPtr, 0,
+                                     vertexBufferPtr->getSize(),
+                                     sizeof(PolyVox::PositionMaterialNormal),
+                                     gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
+    mesh->setVertexBuffer(vertexBufferView);
+
+    // TODO -- use 3-byte normals rather than 3-float normals
+    mesh->addAttribute(gpu::Stream::NORMAL,
+                       gpu::BufferView(vertexBufferPtr,
+                                       sizeof(float) * 3, // polyvox mesh is packed: position, normal, material
+                                       vertexBufferPtr->getSize(),
+                                       sizeof(PolyVox::PositionMaterialNormal),
+                                       gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ)));
+
+    std::vector<model::Mesh::Part> parts;
+    parts.emplace_back(model::Mesh::Part((model::Index)0, // startIndex
+                                         (model::Index)numIndices, // numIndices
+                                         (model::Index)0, // baseVertex
+                                         model::Mesh::TRIANGLES)); // topology
+    mesh->setPartBuffer(gpu::BufferView(new gpu::Buffer(parts.size() * sizeof(model::Mesh::Part),
+                                                        (gpu::Byte*) parts.data()), gpu::Element::PART_DRAWCALL));
+    return mesh;
 }
 
 void RenderablePolyVoxEntityItem::setMesh(model::MeshPointer mesh) {
@@ -1160,133 +1387,193 @@ void RenderablePolyVoxEntityItem::computeShapeInfoWorker() {
         return;
     }
 
-    EntityItemPointer entity = getThisPointer();
+    auto entity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(getThisPointer());
 
     PolyVoxSurfaceStyle voxelSurfaceStyle;
     glm::vec3 voxelVolumeSize;
-    model::MeshPointer mesh;
 
     withReadLock([&] {
         voxelSurfaceStyle = _voxelSurfaceStyle;
         voxelVolumeSize = _voxelVolumeSize;
-        mesh = _mesh;
     });
 
-    QtConcurrent::run([entity, voxelSurfaceStyle, voxelVolumeSize, mesh] {
-        auto polyVoxEntity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity);
-        QVector<QVector<glm::vec3>> pointCollection;
-        AABox box;
-        glm::mat4 vtoM = std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity)->voxelToLocalMatrix();
-
-        if (voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_MARCHING_CUBES ||
-            voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES) {
-            // pull each triangle in the mesh into a polyhedron which can be collided with
-            unsigned int i = 0;
+    startPolyVoxJob(SHAPE_PRIORITY, [entity, voxelSurfaceStyle, voxelVolumeSize] {
+        entity->buildChangedChunkHulls(voxelSurfaceStyle, voxelVolumeSize);
+    });
+}
 
-            const gpu::BufferView& vertexBufferView = mesh->getVertexBuffer();
-            const gpu::BufferView& indexBufferView = mesh->getIndexBuffer();
+static void addMarchingCubesHulls(const std::vector<PolyVox::PositionMaterialNormal>& vertices,
+                                  const std::vector<uint32_t>& indices, const glm::mat4& vtoM,
+                                  ShapeInfo::PointCollection& pointCollection, AABox& box) {
+    // pull each triangle in the mesh into a polyhedron which can be collided with
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::vec3 p0 = polyVoxToGlm(vertices[indices[i]].getPosition());
+        glm::vec3 p1 = polyVoxToGlm(vertices[indices[i + 1]].getPosition());
+        glm::vec3 p2 = polyVoxToGlm(vertices[indices[i + 2]].getPosition());
+
+        glm::vec3 av = (p0 + p1 + p2) / 3.0f; // center of the triangular face
+        glm::vec3 normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
+        glm::vec3 p3 = av - normal * MARCHING_CUBE_COLLISION_HULL_OFFSET;
+
+        glm::vec3 p0Model = glm::vec3(vtoM * glm::vec4(p0, 1.0f));
+        glm::vec3 p1Model = glm::vec3(vtoM * glm::vec4(p1, 1.0f));
+        glm::vec3 p2Model = glm::vec3(vtoM * glm::vec4(p2, 1.0f));
+        glm::vec3 p3Model = glm::vec3(vtoM * glm::vec4(p3, 1.0f));
+
+        box += p0Model;
+        box += p1Model;
+        box += p2Model;
+        box += p3Model;
+
+        // add next convex hull
+        QVector<glm::vec3> pointsInPart;
+        pointsInPart << p0Model;
+        pointsInPart << p1Model;
+        pointsInPart << p2Model;
+        pointsInPart << p3Model;
+        pointCollection << pointsInPart;
+    }
+}
+
+void RenderablePolyVoxEntityItem::buildChangedChunkHulls(PolyVoxSurfaceStyle voxelSurfaceStyle,
+                                                         const glm::vec3& voxelVolumeSize) {
+    // this runs on the polyvox pool.  Marching-cubes hulls are rebuilt for the chunks whose mesh changed, cubic
+    // hulls for the chunks whose voxels changed.  The hulls are in model-space, so they are all rebuilt when
+    // the registration-point or dimensions change.
+    bool marchingCubes = voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_MARCHING_CUBES ||
+        voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES;
+    glm::mat4 vtoM = voxelToLocalMatrix();
+
+    std::vector<std::pair<int, uint32_t>> changedChunks;
+    uint32_t generation;
+    withReadLock([&] {
+        generation = _chunksGeneration;
+        bool rebuildAll = vtoM != _chunkHullMatrix;
+        for (int i = 0; i < (int)_chunks.size(); ++i) {
+            const auto& chunk = _chunks[i];
+            uint32_t version = marchingCubes ? chunk.meshVersion : chunk.version;
+            if (rebuildAll || chunk.shapeVersion != version) {
+                changedChunks.push_back({ i, version });
+            }
+        }
+    });
 
-            gpu::BufferView::Iterator<const uint32_t> it = indexBufferView.cbegin<uint32_t>();
-            while (it != indexBufferView.cend<uint32_t>()) {
-                uint32_t p0Index = *(it++);
-                uint32_t p1Index = *(it++);
-                uint32_t p2Index = *(it++);
+    // with _EDGED_ the user's voxels start one voxel into _volData
+    ivec3 edgeOffset { voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_CUBIC ? 1 : 0 };
+    float offL = -0.5f;
+    float offH = 0.5f;
+    if (voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_CUBIC) {
+        offL += 1.0f;
+        offH += 1.0f;
+    }
 
-                const glm::vec3& p0 = vertexBufferView.get<const glm::vec3>(p0Index);
-                const glm::vec3& p1 = vertexBufferView.get<const glm::vec3>(p1Index);
-                const glm::vec3& p2 = vertexBufferView.get<const glm::vec3>(p2Index);
+    for (const auto& changedChunk : changedChunks) {
+        ShapeInfo::PointCollection pointCollection;
+        AABox box;
+        bool built = false;
+        withReadLock([&] {
+            if (_chunksGeneration != generation) {
+                return;
+            }
+            built = true;
 
-                glm::vec3 av = (p0 + p1 + p2) / 3.0f; // center of the triangular face
-                glm::vec3 normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
-                glm::vec3 p3 = av - normal * MARCHING_CUBE_COLLISION_HULL_OFFSET;
+            const auto& chunk = _chunks[changedChunk.first];
+            if (marchingCubes) {
+                addMarchingCubesHulls(chunk.vertices, chunk.indices, vtoM, pointCollection, box);
+                return;
+            }
 
-                glm::vec3 p0Model = glm::vec3(vtoM * glm::vec4(p0, 1.0f));
-                glm::vec3 p1Model = glm::vec3(vtoM * glm::vec4(p1, 1.0f));
-                glm::vec3 p2Model = glm::vec3(vtoM * glm::vec4(p2, 1.0f));
-                glm::vec3 p3Model = glm::vec3(vtoM * glm::vec4(p3, 1.0f));
+            // each voxel belongs to the chunk that has it as the lower corner of a cell
+            ivec3 low;
+            ivec3 high;
+            chunkBounds(changedChunk.first, low, high);
+            low = glm::max(low - edgeOffset, ivec3(0));
+            high = glm::min(high - edgeOffset, ivec3(voxelVolumeSize));
+            loop3(low, high, [&](const ivec3& v) {
+                if (getVoxelInternal(v) == 0) {
+                    return;
+                }
+                const auto& x = v.x;
+                const auto& y = v.y;
+                const auto& z = v.z;
+                if (glm::all(glm::greaterThan(v, ivec3(0))) &&
+                    glm::all(glm::lessThan(v, ivec3(voxelVolumeSize) - 1)) &&
+                    (getVoxelInternal({ x - 1, y, z }) > 0) &&
+                    (getVoxelInternal({ x, y - 1, z }) > 0) &&
+                    (getVoxelInternal({ x, y, z - 1 }) > 0) &&
+                    (getVoxelInternal({ x + 1, y, z }) > 0) &&
+                    (getVoxelInternal({ x, y + 1, z }) > 0) &&
+                    (getVoxelInternal({ x, y, z + 1 }) > 0)) {
+                    // this voxel has neighbors in every cardinal direction, so there's no need
+                    // to include it in the collision hull.
+                    return;
+                }
 
-                box += p0Model;
-                box += p1Model;
-                box += p2Model;
-                box += p3Model;
+                glm::vec3 p000 = glm::vec3(vtoM * glm::vec4(x + offL, y + offL, z + offL, 1.0f));
+                glm::vec3 p001 = glm::vec3(vtoM * glm::vec4(x + offL, y + offL, z + offH, 1.0f));
+                glm::vec3 p010 = glm::vec3(vtoM * glm::vec4(x + offL, y + offH, z + offL, 1.0f));
+                glm::vec3 p011 = glm::vec3(vtoM * glm::vec4(x + offL, y + offH, z + offH, 1.0f));
+                glm::vec3 p100 = glm::vec3(vtoM * glm::vec4(x + offH, y + offL, z + offL, 1.0f));
+                glm::vec3 p101 = glm::vec3(vtoM * glm::vec4(x + offH, y + offL, z + offH, 1.0f));
+                glm::vec3 p110 = glm::vec3(vtoM * glm::vec4(x + offH, y + offH, z + offL, 1.0f));
+                glm::vec3 p111 = glm::vec3(vtoM * glm::vec4(x + offH, y + offH, z + offH, 1.0f));
+
+                box += p000;
+                box += p001;
+                box += p010;
+                box += p011;
+                box += p100;
+                box += p101;
+                box += p110;
+                box += p111;
 
-                QVector<glm::vec3> pointsInPart;
-                pointsInPart << p0Model;
-                pointsInPart << p1Model;
-                pointsInPart << p2Model;
-                pointsInPart << p3Model;
                 // add next convex hull
-                QVector<glm::vec3> newMeshPoints;
-                pointCollection << newMeshPoints;
-                // add points to the new convex hull
-                pointCollection[i++] << pointsInPart;
-            }
-        } else {
-            unsigned int i = 0;
-            polyVoxEntity->forEachVoxelValue(voxelVolumeSize, [&](const ivec3& v, uint8_t value) {
-                if (value > 0) {
-                    const auto& x = v.x;
-                    const auto& y = v.y;
-                    const auto& z = v.z;
-                    if (glm::all(glm::greaterThan(v, ivec3(0))) && 
-                        glm::all(glm::lessThan(v, ivec3(voxelVolumeSize) - 1)) && 
-                        (polyVoxEntity->getVoxelInternal({ x - 1, y, z }) > 0) &&
-                        (polyVoxEntity->getVoxelInternal({ x, y - 1, z }) > 0) &&
-                        (polyVoxEntity->getVoxelInternal({ x, y, z - 1 }) > 0) &&
-                        (polyVoxEntity->getVoxelInternal({ x + 1, y, z }) > 0) &&
-                        (polyVoxEntity->getVoxelInternal({ x, y + 1, z }) > 0) &&
-                        (polyVoxEntity->getVoxelInternal({ x, y, z + 1 }) > 0)) {
-                        // this voxel has neighbors in every cardinal direction, so there's no need
-                        // to include it in the collision hull.
-                        return;
-                    }
-
-                    QVector<glm::vec3> pointsInPart;
+                QVector<glm::vec3> pointsInPart;
+                pointsInPart << p000;
+                pointsInPart << p001;
+                pointsInPart << p010;
+                pointsInPart << p011;
+                pointsInPart << p100;
+                pointsInPart << p101;
+                pointsInPart << p110;
+                pointsInPart << p111;
+                pointCollection << pointsInPart;
+            });
+        });
+        if (!built) {
+            return;
+        }
 
-                    float offL = -0.5f;
-                    float offH = 0.5f;
-                    if (voxelSurfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_CUBIC) {
-                        offL += 1.0f;
-                        offH += 1.0f;
-                    }
+        withWriteLock([&] {
+            if (_chunksGeneration == generation) {
+                auto& chunk = _chunks[changedChunk.first];
+                chunk.hulls.swap(pointCollection);
+                chunk.hullBox = box;
+                chunk.shapeVersion = changedChunk.second;
+            }
+        });
+    }
 
-                    glm::vec3 p000 = glm::vec3(vtoM * glm::vec4(x + offL, y + offL, z + offL, 1.0f));
-                    glm::vec3 p001 = glm::vec3(vtoM * glm::vec4(x + offL, y + offL, z + offH, 1.0f));
-                    glm::vec3 p010 = glm::vec3(vtoM * glm::vec4(x + offL, y + offH, z + offL, 1.0f));
-                    glm::vec3 p011 = glm::vec3(vtoM * glm::vec4(x + offL, y + offH, z + offH, 1.0f));
-                    glm::vec3 p100 = glm::vec3(vtoM * glm::vec4(x + offH, y + offL, z + offL, 1.0f));
-                    glm::vec3 p101 = glm::vec3(vtoM * glm::vec4(x + offH, y + offL, z + offH, 1.0f));
-                    glm::vec3 p110 = glm::vec3(vtoM * glm::vec4(x + offH, y + offH, z + offL, 1.0f));
-                    glm::vec3 p111 = glm::vec3(vtoM * glm::vec4(x + offH, y + offH, z + offH, 1.0f));
-
-                    box += p000;
-                    box += p001;
-                    box += p010;
-                    box += p011;
-                    box += p100;
-                    box += p101;
-                    box += p110;
-                    box += p111;
-
-                    pointsInPart << p000;
-                    pointsInPart << p001;
-                    pointsInPart << p010;
-                    pointsInPart << p011;
-                    pointsInPart << p100;
-                    pointsInPart << p101;
-                    pointsInPart << p110;
-                    pointsInPart << p111;
-
-                    // add next convex hull
-                    QVector<glm::vec3> newMeshPoints;
-                    pointCollection << newMeshPoints;
-                    // add points to the new convex hull
-                    pointCollection[i++] << pointsInPart;
-                }
-            });
+    // Bullet is still handed the whole compound shape, but only the changed chunks were rebuilt
+    ShapeInfo::PointCollection pointCollection;
+    AABox box;
+    bool current = false;
+    withWriteLock([&] {
+        if (_chunksGeneration != generation) {
+            return;
+        }
+        current = true;
+        _chunkHullMatrix = vtoM;
+        for (const auto& chunk : _chunks) {
+            if (!chunk.hulls.isEmpty()) {
+                pointCollection += chunk.hulls;
+                box += chunk.hullBox;
+            }
         }
-        polyVoxEntity->setCollisionPoints(pointCollection, box);
     });
+    if (current) {
+        setCollisionPoints(pointCollection, box);
+    }
 }
 
 void RenderablePolyVoxEntityItem::setCollisionPoints(ShapeInfo::PointCollection pointCollection, AABox box) {
@@ -1547,6 +1834,11 @@ bool PolyVoxEntityRenderer::needsRenderUpdateFromTypedEntity(const TypedEntityPo
         return true;
     }
 
+    // voxels changed by a script are meshed from doRenderUpdateSynchronousTyped
+    if (entity->_voxelDataDirty || entity->_volDataDirty) {
+        return true;
+    }
+
     return false;
 }
 
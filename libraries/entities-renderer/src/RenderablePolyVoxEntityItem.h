@@ -13,11 +13,13 @@
 #define hifi_RenderablePolyVoxEntityItem_h
 
 #include <atomic>
+#include <vector>
 
 #include <QSemaphore>
 
 #include <PolyVoxCore/SimpleVolume.h>
 #include <PolyVoxCore/Raycast.h>
+#include <PolyVoxCore/VertexTypes.h>
 
 #include <gpu/Forward.h>
 #include <gpu/Context.h>
@@ -111,7 +113,7 @@ public:
     uint8_t getVoxelInternal(const ivec3& v) const;
     bool setVoxelInternal(const ivec3& v, uint8_t toValue);
 
-    void setVolDataDirty() { withWriteLock([&] { _volDataDirty = true; _meshReady = false; }); }
+    void setVolDataDirty() { withWriteLock([&] { _volDataDirty = true; _meshReady = false; markAllChunksChanged(); }); }
 
     bool getMeshes(MeshProxyList& result) override;
 
@@ -120,15 +122,28 @@ private:
     PolyVox::RaycastResult doRayCast(glm::vec4 originInVoxel, glm::vec4 farInVoxel, glm::vec4& result) const;
 
     void recomputeMesh();
+    void extractChangedChunks(PolyVoxSurfaceStyle voxelSurfaceStyle);
+    model::MeshPointer assembleMesh() const;
     void cacheNeighbors();
     void copyUpperEdgesFromNeighbors();
     void bonkNeighbors();
     bool updateDependents();
 
+    // the volume is meshed, and its collision hulls are built, a chunk at a time.  These assume that the caller has
+    // locked the entity.
+    void allocateChunks();
+    int chunkIndex(const ivec3& chunk) const { return (chunk.z * _numChunks.y + chunk.y) * _numChunks.x + chunk.x; }
+    void chunkBounds(int index, ivec3& low, ivec3& high) const;
+    void markVoxelChanged(const ivec3& volDataCoords);
+    void markAllChunksChanged();
+    bool editVoxelInternal(const ivec3& v, uint8_t toValue);
+
     // these are run off the main thread
     void decompressVolumeData();
-    void compressVolumeDataAndSendEditPacket();
+    void queueVoxelEdits();
+    void sendVoxelEdits(EntityTreePointer tree);
     void computeShapeInfoWorker();
+    void buildChangedChunkHulls(PolyVoxSurfaceStyle voxelSurfaceStyle, const glm::vec3& voxelVolumeSize);
 
     // The PolyVoxEntityItem class has _voxelData which contains dimensions and compressed voxel data.  The dimensions
     // may not match _voxelVolumeSize.
@@ -145,6 +160,27 @@ private:
 
     bool _neighborsNeedUpdate { false };
 
+    // A chunk is CHUNK_SIZE cells on a side, where a cell is the cube between 8 neighboring voxels of _volData.
+    // Changing a voxel bumps the version of the chunks it touches, and only chunks whose mesh or hulls are older
+    // than their version are extracted again.
+    struct VoxelChunk {
+        uint32_t version { 1 };
+        uint32_t meshVersion { 0 };
+        uint32_t shapeVersion { 0 };
+        std::vector<PolyVox::PositionMaterialNormal> vertices; // in voxel-space
+        std::vector<uint32_t> indices;
+        ShapeInfo::PointCollection hulls; // in model-space
+        AABox hullBox;
+    };
+    std::vector<VoxelChunk> _chunks;
+    ivec3 _numChunks { 0 };
+    uint32_t _chunksGeneration { 0 }; // bumped whenever _volData is reallocated, to discard results for the old one
+    glm::mat4 _chunkHullMatrix; // the voxelToLocalMatrix the hulls were built with
+
+    // voxels changed by scripts since the last edit packet, keyed by their offset in the uncompressed voxel data
+    VoxelChanges _pendingVoxelChanges;
+    bool _voxelEditsQueued { false };
+
     // these are cached lookups of _xNNeighborID, _yNNeighborID, _zNNeighborID, _xPNeighborID, _yPNeighborID, _zPNeighborID
     EntityItemWeakPointer _xNNeighbor; // neighbor found by going along negative X axis
     EntityItemWeakPointer _yNNeighbor;
@@ -14,6 +14,7 @@
 
 #include <OctreeEditPacketSender.h>
 
+#include <functional>
 #include <mutex>
 
 #include "EntityItem.h"
@@ -39,6 +40,12 @@ public:
 
     void queueEraseEntityMessage(const EntityItemID& entityItemID);
 
+    /// When set, edits are handed to this callback instead of being encoded and sent.  The entity-server uses this to
+    /// feed the results of its own physics simulation back into its tree.
+    using LocalEditHandler = std::function<void(PacketType type, const EntityItemID& entityItemID,
+                                                const EntityItemProperties& properties)>;
+    void setLocalEditHandler(LocalEditHandler handler) { _localEditHandler = handler; }
+
     // My server type is the model server
     virtual char getMyNodeType() const override { return NodeType::EntityServer; }
     virtual void adjustEditPacketForClockSkew(PacketType type, QByteArray& buffer, qint64 clockSkew) override;
@@ -54,5 +61,6 @@ private:
     std::mutex _mutex;
     AvatarData* _myAvatar { nullptr };
     QScriptEngine _scriptEngine;
+    LocalEditHandler _localEditHandler;
 };
 #endif // hifi_EntityEditPacketSender_h
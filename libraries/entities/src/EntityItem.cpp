@@ -894,6 +894,21 @@ int EntityItem::readEntityDataFromBuffer(const unsigned char* data, int bytesLef
     return bytesRead;
 }
 
+size_t EntityItem::findDetailedRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+                                                std::vector<TriangleSet::RayHit>& hits, bool precisionPicking) const {
+    size_t numHits = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        bool keepSearching = true;
+        OctreeElementPointer element;
+        void* intersectedObject = nullptr;
+        TriangleSet::RayHit& hit = hits[i];
+        hit.intersects = findDetailedRayIntersection(rays[i].origin, rays[i].direction, keepSearching, element,
+            hit.distance, hit.face, hit.surfaceNormal, &intersectedObject, precisionPicking);
+        numHits += hit.intersects ? 1 : 0;
+    }
+    return numHits;
+}
+
 void EntityItem::debugDump() const {
     auto position = getPosition();
     qCDebug(entities) << "EntityItem id:" << getEntityItemID();
@@ -2453,20 +2468,30 @@ QList<EntityDynamicPointer> EntityItem::getActionsOfType(EntityDynamicType typeT
 
 void EntityItem::locationChanged(bool tellPhysics) {
     requiresRecalcBoxes();
+    EntityTreePointer tree = getTree();
     if (tellPhysics) {
         _dirtyFlags |= Simulation::DIRTY_TRANSFORM;
-        EntityTreePointer tree = getTree();
         if (tree) {
             tree->entityChanged(getThisPointer());
         }
     }
     SpatiallyNestable::locationChanged(tellPhysics); // tell all the children, also
+    if (tree) {
+        tree->entityMoved(getThisPointer());
+        if (!setWorldTransformQueued(true)) {
+            tree->worldTransformChanged(getThisPointer());
+        }
+    }
     somethingChangedNotification();
 }
 
 void EntityItem::dimensionsChanged() {
     requiresRecalcBoxes();
     SpatiallyNestable::dimensionsChanged(); // Do what you have to do
+    EntityTreePointer tree = getTree();
+    if (tree) {
+        tree->entityMoved(getThisPointer());
+    }
     somethingChangedNotification();
 }
 
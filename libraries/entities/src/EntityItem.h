@@ -27,6 +27,7 @@
 #include <Transform.h>
 #include <SpatiallyNestable.h>
 #include <Interpolate.h>
+#include <TriangleSet.h>
 
 #include "EntityItemID.h"
 #include "EntityItemPropertiesDefaults.h"
@@ -164,6 +165,10 @@ public:
                          bool& keepSearching, OctreeElementPointer& element, float& distance,
                          BoxFace& face, glm::vec3& surfaceNormal,
                          void** intersectedObject, bool precisionPicking) const { return true; }
+    // batched findDetailedRayIntersection, the hits come in holding each ray's intersection with the entity's box and
+    // go out holding the detailed results. Returns the number of rays that hit.
+    virtual size_t findDetailedRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+                         std::vector<TriangleSet::RayHit>& hits, bool precisionPicking) const;
 
     // attributes applicable to all entity types
     EntityTypes::EntityType getType() const { return _type; }
@@ -479,6 +484,11 @@ public:
 
     virtual void locationChanged(bool tellPhysics = true) override;
 
+    // set while the entity waits for EntityTree::updateWorldTransforms, returns the previous value
+    bool setWorldTransformQueued(bool queued) { return _worldTransformQueued.exchange(queued); }
+    // set while the entity waits to be re-binned in the spatial index of its tree, returns the previous value
+    bool setSpatialIndexQueued(bool queued) { return _spatialIndexQueued.exchange(queued); }
+
     using ChangeHandlerCallback = std::function<void(const EntityItemID&)>;
     using ChangeHandlerId = QUuid;
     ChangeHandlerId registerChangeHandler(const ChangeHandlerCallback& handler);
@@ -593,6 +603,8 @@ protected:
     EntityTreeElementPointer _element; // set by EntityTreeElement
     void* _physicsInfo { nullptr }; // set by EntitySimulation
     bool _simulated { false }; // set by EntitySimulation
+    std::atomic<bool> _worldTransformQueued { false };
+    std::atomic<bool> _spatialIndexQueued { false };
 
     bool addActionInternal(EntitySimulationPointer simulation, EntityDynamicPointer action);
     bool removeActionInternal(const QUuid& actionID, EntitySimulationPointer simulation = nullptr);
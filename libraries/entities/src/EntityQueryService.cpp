@@ -0,0 +1,242 @@
+//
+//  EntityQueryService.cpp
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityQueryService.h"
+
+#include <algorithm>
+
+#include <Profile.h>
+#include <SharedUtil.h>
+
+#include "EntityTree.h"
+
+EntityQueryService::EntityQueryService() {
+    setObjectName("Entity Query Service");
+}
+
+void EntityQueryService::setEntityTree(EntityTreePointer tree) {
+    lock();
+    _entityTree = tree;
+    unlock();
+}
+
+void EntityQueryService::queueRequest(EntityQueryRequest* request, QObject* context) {
+    request->_queuedAt = usecTimestampNow();
+
+    lock();
+    request->_context = context;
+    _pendingRequests.push_back(request);
+    _requestsByContext.insert(context, request);
+    int queueDepth = ++_queueDepth;
+    unlock();
+
+    // the context goes away on its own thread, drop its requests right then rather than run them for nobody
+    connect(context, &QObject::destroyed, this, &EntityQueryService::dropRequests,
+            Qt::ConnectionType(Qt::DirectConnection | Qt::UniqueConnection));
+
+    int maxQueueDepth = _maxQueueDepth;
+    while (queueDepth > maxQueueDepth && !_maxQueueDepth.compare_exchange_weak(maxQueueDepth, queueDepth)) {
+    }
+
+    // Make sure to wake our actual processing thread because we now have requests for it to process.
+    _hasRequests.wakeAll();
+}
+
+void EntityQueryService::releaseRequest(EntityQueryRequest* request) {
+    lock();
+    _requestsByContext.remove(request->_context, request);
+    unlock();
+    delete request;
+}
+
+void EntityQueryService::dropRequests(QObject* context) {
+    lock();
+    for (auto request : _requestsByContext.values(context)) {
+        if (request->_state == EntityQueryRequest::Running) {
+            // the worker has it, it deletes the request instead of delivering it once the batch is done
+            request->_dropped = true;
+            continue;
+        }
+        if (request->_state == EntityQueryRequest::Pending) {
+            _pendingRequests.erase(std::find(_pendingRequests.begin(), _pendingRequests.end(), request));
+            --_queueDepth;
+        }
+        delete request;
+    }
+    _requestsByContext.remove(context);
+    unlock();
+}
+
+void EntityQueryService::terminating() {
+    _hasRequests.wakeAll();
+}
+
+bool EntityQueryService::process() {
+    lock();
+    bool hasRequests = !_pendingRequests.empty();
+    unlock();
+
+    if (!hasRequests) {
+        _waitingOnRequestsMutex.lock();
+        _hasRequests.wait(&_waitingOnRequestsMutex, MAX_WAIT_TIME);
+        _waitingOnRequestsMutex.unlock();
+    }
+
+    lock();
+    std::vector<EntityQueryRequest*> currentRequests;
+    currentRequests.swap(_pendingRequests);
+    for (auto request : currentRequests) {
+        request->_state = EntityQueryRequest::Running;
+    }
+    EntityTreePointer tree = _entityTree;
+    unlock();
+
+    if (currentRequests.empty()) {
+        return isStillRunning();
+    }
+
+    PROFILE_RANGE(script_entities, "EntityQueryBatch");
+
+    // ray queries with the same filters are traced together, the others are run one at a time.  Take the read lock per
+    // group of queries, so that edits get in between the queries of a long batch
+    quint64 batchStart = usecTimestampNow();
+    if (tree) {
+        std::vector<bool> processed(currentRequests.size(), false);
+        std::vector<EntityQueryRequest*> rayRequests;
+        for (size_t i = 0; i < currentRequests.size(); i++) {
+            if (processed[i]) {
+                continue; // traced with an earlier request of the same filters
+            }
+            EntityQueryRequest* request = currentRequests[i];
+            if (request->getType() != EntityQueryRequest::Ray) {
+                tree->withReadLock([&] {
+                    processRequest(tree, *request);
+                });
+                continue;
+            }
+            rayRequests.clear();
+            rayRequests.push_back(request);
+            for (size_t j = i + 1; j < currentRequests.size(); j++) {
+                EntityQueryRequest* other = currentRequests[j];
+                if (!processed[j] && other->getType() == EntityQueryRequest::Ray && haveSameRayFilters(*request, *other)) {
+                    processed[j] = true;
+                    rayRequests.push_back(other);
+                }
+            }
+            tree->withReadLock([&] {
+                processRayRequests(tree, rayRequests);
+            });
+        }
+    }
+    quint64 batchEnd = usecTimestampNow();
+
+    _queueDepth -= (int)currentRequests.size();
+    _totalQueries += currentRequests.size();
+    _totalBatches++;
+
+    {
+        QMutexLocker locker(&_averagesMutex);
+        _batchSizeAverage.updateAverage((float)currentRequests.size());
+        _batchTimeAverage.updateAverage((float)(batchEnd - batchStart));
+        for (auto request : currentRequests) {
+            _latencyAverage.updateAverage((float)(batchEnd - request->_queuedAt));
+        }
+    }
+
+    lock();
+    for (auto request : currentRequests) {
+        if (request->_dropped) {
+            delete request;
+            continue;
+        }
+        request->_state = EntityQueryRequest::Delivered;
+        request->_finishedAt = batchEnd;
+        emit request->finished(request);
+    }
+    unlock();
+
+    return isStillRunning();  // keep running till they terminate us
+}
+
+bool EntityQueryService::haveSameRayFilters(const EntityQueryRequest& first, const EntityQueryRequest& second) {
+    return first.precisionPicking == second.precisionPicking && first.visibleOnly == second.visibleOnly &&
+        first.collidableOnly == second.collidableOnly && first.entityIdsToInclude == second.entityIdsToInclude &&
+        first.entityIdsToDiscard == second.entityIdsToDiscard;
+}
+
+void EntityQueryService::processRayRequests(const EntityTreePointer& tree, const std::vector<EntityQueryRequest*>& requests) {
+    std::vector<TriangleSet::Ray> rays(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        rays[i].origin = requests[i]->ray.origin;
+        rays[i].direction = requests[i]->ray.direction;
+    }
+
+    // the requests share their filters, so the first one stands for all of them
+    const EntityQueryRequest& filters = *requests.front();
+    std::vector<TriangleSet::RayHit> hits;
+    std::vector<EntityItemPointer> intersectedEntities;
+    bool accurate = true;
+    tree->findRayIntersections(rays, filters.entityIdsToInclude, filters.entityIdsToDiscard, filters.visibleOnly,
+        filters.collidableOnly, filters.precisionPicking, hits, intersectedEntities, Octree::NoLock, &accurate);
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        EntityQueryRequest& request = *requests[i];
+        request.accurate = accurate;
+        request.intersects = hits[i].intersects && intersectedEntities[i];
+        if (request.intersects) {
+            request.entityID = intersectedEntities[i]->getEntityItemID();
+            request.distance = hits[i].distance;
+            request.face = hits[i].face;
+            request.surfaceNormal = hits[i].surfaceNormal;
+            request.intersection = request.ray.origin + (request.ray.direction * request.distance);
+        }
+    }
+}
+
+void EntityQueryService::processRequest(const EntityTreePointer& tree, EntityQueryRequest& request) {
+    switch (request.getType()) {
+        case EntityQueryRequest::Ray: {
+            processRayRequests(tree, { &request });
+            break;
+        }
+        case EntityQueryRequest::Sphere: {
+            QVector<EntityItemPointer> entities;
+            tree->findEntities(request.center, request.radius, entities);
+            request.entityIDs.reserve(entities.size());
+            foreach (EntityItemPointer entity, entities) {
+                request.entityIDs << entity->getEntityItemID();
+            }
+            break;
+        }
+        case EntityQueryRequest::Box: {
+            QVector<EntityItemPointer> entities;
+            tree->findEntities(AABox(request.corner, request.dimensions), entities);
+            request.entityIDs.reserve(entities.size());
+            foreach (EntityItemPointer entity, entities) {
+                request.entityIDs << entity->getEntityItemID();
+            }
+            break;
+        }
+    }
+}
+
+QVariantMap EntityQueryService::getStats() const {
+    QVariantMap stats;
+    stats["queueDepth"] = (int)_queueDepth;
+    stats["maxQueueDepth"] = (int)_maxQueueDepth;
+    stats["totalQueries"] = (qulonglong)_totalQueries;
+    stats["totalBatches"] = (qulonglong)_totalBatches;
+
+    QMutexLocker locker(&_averagesMutex);
+    stats["averageBatchSize"] = _batchSizeAverage.getAverage();
+    stats["averageBatchTimeUsecs"] = _batchTimeAverage.getAverage();
+    stats["averageLatencyUsecs"] = _latencyAverage.getAverage();
+    return stats;
+}
@@ -0,0 +1,157 @@
+//
+//  EntityQueryService.h
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityQueryService_h
+#define hifi_EntityQueryService_h
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QMultiHash>
+#include <QtCore/QMutex>
+#include <QtCore/QUuid>
+#include <QtCore/QVariantMap>
+#include <QtCore/QVector>
+#include <QWaitCondition>
+
+#include <BoxBase.h>
+#include <GenericThread.h>
+#include <RegisteredMetaTypes.h>
+#include <SimpleMovingAverage.h>
+
+#include "EntityItemID.h"
+
+class EntityTree;
+using EntityTreePointer = std::shared_ptr<EntityTree>;
+
+/// A single spatial query against the entity tree, filled in by the EntityQueryService worker. The finished()
+/// signal is emitted from the worker thread, so connecting to it with a receiver delivers the results on
+/// the receiver's thread.
+class EntityQueryRequest : public QObject {
+    Q_OBJECT
+public:
+    enum Type {
+        Ray,
+        Sphere,
+        Box
+    };
+
+    EntityQueryRequest(Type type) : _type(type) {}
+
+    Type getType() const { return _type; }
+
+    // ray query inputs
+    PickRay ray;
+    bool precisionPicking { false };
+    QVector<EntityItemID> entityIdsToInclude;
+    QVector<EntityItemID> entityIdsToDiscard;
+    bool visibleOnly { false };
+    bool collidableOnly { false };
+
+    // sphere and box query inputs
+    glm::vec3 center;
+    float radius { 0.0f };
+    glm::vec3 corner;
+    glm::vec3 dimensions;
+
+    // ray query results
+    bool intersects { false };
+    bool accurate { true };
+    QUuid entityID;
+    float distance { 0.0f };
+    BoxFace face { UNKNOWN_FACE };
+    glm::vec3 intersection;
+    glm::vec3 surfaceNormal;
+
+    // sphere and box query results
+    QVector<QUuid> entityIDs;
+
+    quint64 getQueuedAt() const { return _queuedAt; }
+    quint64 getFinishedAt() const { return _finishedAt; }
+
+signals:
+    void finished(EntityQueryRequest* request);
+
+private:
+    enum State {
+        Pending,
+        Running,
+        Delivered
+    };
+
+    Type _type;
+    quint64 _queuedAt { 0 };
+    quint64 _finishedAt { 0 };
+
+    // guarded by the EntityQueryService lock
+    QObject* _context { nullptr };
+    State _state { Pending };
+    bool _dropped { false };
+
+    friend class EntityQueryService;
+};
+
+/// Runs ray, sphere and box queries against the entity tree on a dedicated thread, so that callers (typically
+/// scripts) don't take the tree lock or do the work on their own thread. Queries that arrive while a batch is
+/// being processed are collected and run together as the next batch. The ray queries of a batch that share their
+/// filters are traced together, and each group of queries runs under a tree read lock of its own so that a slow
+/// precision pick doesn't hold off writers for the whole batch.
+class EntityQueryService : public GenericThread {
+    Q_OBJECT
+public:
+    static const uint64_t MAX_WAIT_TIME { 100 }; // Max wait time in ms
+
+    EntityQueryService();
+
+    void setEntityTree(EntityTreePointer tree);
+
+    /// Queue a request on behalf of context, typically the script engine that asked for it. The service owns the
+    /// request from here on: the receiver of finished() hands it back with releaseRequest(), and if context is
+    /// destroyed first its requests are dropped, whether or not they were run.
+    void queueRequest(EntityQueryRequest* request, QObject* context);
+    void releaseRequest(EntityQueryRequest* request);
+
+    int getQueueDepth() const { return _queueDepth; }
+    QVariantMap getStats() const;
+
+protected:
+    virtual bool process() override;
+    virtual void terminating() override;
+
+private slots:
+    void dropRequests(QObject* context);
+
+private:
+    static bool haveSameRayFilters(const EntityQueryRequest& first, const EntityQueryRequest& second);
+    // runs ray requests that share their filters as one batch, the caller holds the tree's read lock
+    void processRayRequests(const EntityTreePointer& tree, const std::vector<EntityQueryRequest*>& requests);
+    void processRequest(const EntityTreePointer& tree, EntityQueryRequest& request);
+
+    EntityTreePointer _entityTree;
+
+    // guarded by lock()
+    std::vector<EntityQueryRequest*> _pendingRequests;
+    QMultiHash<QObject*, EntityQueryRequest*> _requestsByContext;
+
+    QWaitCondition _hasRequests;
+    QMutex _waitingOnRequestsMutex;
+
+    std::atomic<int> _queueDepth { 0 };
+    std::atomic<int> _maxQueueDepth { 0 };
+    std::atomic<uint64_t> _totalQueries { 0 };
+    std::atomic<uint64_t> _totalBatches { 0 };
+
+    mutable QMutex _averagesMutex;
+    SimpleMovingAverage _latencyAverage; // usecs from queueRequest() to finished()
+    SimpleMovingAverage _batchSizeAverage;
+    SimpleMovingAverage _batchTimeAverage; // usecs spent running the queries of a batch
+};
+
+#endif // hifi_EntityQueryService_h
@@ -52,6 +52,14 @@ EntityScriptingInterface::EntityScriptingInterface(bool bidOnSimulationOwnership
     connect(nodeList.data(), &NodeList::canWriteAssetsChanged, this, &EntityScriptingInterface::canWriteAssetsChanged);
 }
 
+EntityScriptingInterface::~EntityScriptingInterface() {
+    if (_queryService) {
+        _queryService->terminate();
+        delete _queryService;
+        _queryService = nullptr;
+    }
+}
+
 void EntityScriptingInterface::queueEntityMessage(PacketType packetType,
                                                   EntityItemID entityID, const EntityItemProperties& properties) {
     getEntityPacketSender()->queueEditEntityMessage(packetType, _entityTree, entityID, properties);
@@ -102,6 +110,10 @@ void EntityScriptingInterface::setEntityTree(EntityTreePointer elementTree) {
 
     _entityTree = elementTree;
 
+    if (_queryService) {
+        _queryService->setEntityTree(_entityTree);
+    }
+
     if (_entityTree) {
         connect(_entityTree.get(), &EntityTree::addingEntity, this, &EntityScriptingInterface::addingEntity);
         connect(_entityTree.get(), &EntityTree::deletingEntity, this, &EntityScriptingInterface::deletingEntity);
@@ -704,6 +716,41 @@ RayToEntityIntersectionResult EntityScriptingInterface::findRayIntersectionVecto
     return findRayIntersectionWorker(ray, Octree::Lock, precisionPicking, entityIdsToInclude, entityIdsToDiscard, visibleOnly, collidableOnly);
 }
 
+QVector<RayToEntityIntersectionResult> EntityScriptingInterface::findRayIntersectionsVector(const QVector<PickRay>& rays,
+                bool precisionPicking, const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+                bool visibleOnly, bool collidableOnly) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    QVector<RayToEntityIntersectionResult> results(rays.size());
+    if (_entityTree) {
+        std::vector<TriangleSet::Ray> treeRays(rays.size());
+        for (int i = 0; i < rays.size(); i++) {
+            treeRays[i].origin = rays[i].origin;
+            treeRays[i].direction = rays[i].direction;
+        }
+
+        std::vector<TriangleSet::RayHit> hits;
+        std::vector<EntityItemPointer> intersectedEntities;
+        bool accurate = true;
+        _entityTree->findRayIntersections(treeRays, entityIdsToInclude, entityIdsToDiscard, visibleOnly, collidableOnly,
+            precisionPicking, hits, intersectedEntities, Octree::Lock, &accurate);
+
+        for (int i = 0; i < rays.size(); i++) {
+            RayToEntityIntersectionResult& result = results[i];
+            result.accurate = accurate;
+            if (hits[i].intersects && intersectedEntities[i]) {
+                result.intersects = true;
+                result.entityID = intersectedEntities[i]->getEntityItemID();
+                result.distance = hits[i].distance;
+                result.face = hits[i].face;
+                result.surfaceNormal = hits[i].surfaceNormal;
+                result.intersection = rays[i].origin + (rays[i].direction * result.distance);
+            }
+        }
+    }
+    return results;
+}
+
 // FIXME - we should remove this API and encourage all users to use findRayIntersection() instead. We've changed
 //         findRayIntersection() to be blocking because it never makes sense for a script to get back a non-answer
 RayToEntityIntersectionResult EntityScriptingInterface::findRayIntersectionBlocking(const PickRay& ray, bool precisionPicking, 
@@ -736,6 +783,80 @@ RayToEntityIntersectionResult EntityScriptingInterface::findRayIntersectionWorke
     return result;
 }
 
+EntityQueryService* EntityScriptingInterface::getQueryService() {
+    // most clients never make an async query, so only spin up the thread on first use
+    std::call_once(_queryServiceStarted, [this] {
+        _queryService = new EntityQueryService();
+        _queryService->setEntityTree(_entityTree);
+        _queryService->initialize();
+    });
+    return _queryService;
+}
+
+bool EntityScriptingInterface::queueQueryRequest(EntityQueryRequest* request, QScriptValue callback) {
+    QScriptEngine* engine = callback.engine();
+    if (!engine || !callback.isFunction()) {
+        qCDebug(entities) << "async entity query without a callback function";
+        delete request;
+        return false;
+    }
+
+    // finished() is emitted on the query thread, connecting with the engine as context delivers it on the script's thread
+    auto queryService = getQueryService();
+    connect(request, &EntityQueryRequest::finished, engine, [callback, queryService](EntityQueryRequest* request) mutable {
+        QScriptEngine* engine = callback.engine();
+        QScriptValue result;
+        if (request->getType() == EntityQueryRequest::Ray) {
+            RayToEntityIntersectionResult rayResult;
+            rayResult.intersects = request->intersects;
+            rayResult.accurate = request->accurate;
+            rayResult.entityID = request->entityID;
+            rayResult.distance = request->distance;
+            rayResult.face = request->face;
+            rayResult.intersection = request->intersection;
+            rayResult.surfaceNormal = request->surfaceNormal;
+            result = RayToEntityIntersectionResultToScriptValue(engine, rayResult);
+        } else {
+            result = engine->toScriptValue(request->entityIDs);
+        }
+        callback.call(QScriptValue(), QScriptValueList { result });
+        queryService->releaseRequest(request);
+    });
+    // if the engine goes away before the results come back, the service drops the request
+    queryService->queueRequest(request, engine);
+    return true;
+}
+
+bool EntityScriptingInterface::findRayIntersectionAsync(const PickRay& ray, QScriptValue callback, bool precisionPicking,
+        const QScriptValue& entityIdsToInclude, const QScriptValue& entityIdsToDiscard, bool visibleOnly, bool collidableOnly) {
+    auto request = new EntityQueryRequest(EntityQueryRequest::Ray);
+    request->ray = ray;
+    request->precisionPicking = precisionPicking;
+    request->entityIdsToInclude = qVectorEntityItemIDFromScriptValue(entityIdsToInclude);
+    request->entityIdsToDiscard = qVectorEntityItemIDFromScriptValue(entityIdsToDiscard);
+    request->visibleOnly = visibleOnly;
+    request->collidableOnly = collidableOnly;
+    return queueQueryRequest(request, callback);
+}
+
+bool EntityScriptingInterface::findEntitiesAsync(const glm::vec3& center, float radius, QScriptValue callback) {
+    auto request = new EntityQueryRequest(EntityQueryRequest::Sphere);
+    request->center = center;
+    request->radius = radius;
+    return queueQueryRequest(request, callback);
+}
+
+bool EntityScriptingInterface::findEntitiesInBoxAsync(const glm::vec3& corner, const glm::vec3& dimensions, QScriptValue callback) {
+    auto request = new EntityQueryRequest(EntityQueryRequest::Box);
+    request->corner = corner;
+    request->dimensions = dimensions;
+    return queueQueryRequest(request, callback);
+}
+
+QVariantMap EntityScriptingInterface::getQueryStats() const {
+    return _queryService ? _queryService->getStats() : QVariantMap();
+}
+
 bool EntityScriptingInterface::reloadServerScripts(QUuid entityID) {
     auto client = DependencyManager::get<EntityScriptClient>();
     return client->reloadServerScript(entityID);
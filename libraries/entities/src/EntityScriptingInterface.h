@@ -33,6 +33,7 @@
 #include "EntityEditPacketSender.h"
 #include "EntitiesScriptEngineProvider.h"
 #include "EntityItemProperties.h"
+#include "EntityQueryService.h"
 
 #include "BaseScriptEngine.h"
 
@@ -85,6 +86,7 @@ class EntityScriptingInterface : public OctreeScriptingInterface, public Depende
     friend EntityPropertyMetadataRequest;
 public:
     EntityScriptingInterface(bool bidOnSimulationOwnership);
+    ~EntityScriptingInterface();
 
     class ActivityTracking {
     public:
@@ -246,10 +248,66 @@ public slots:
         const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
         bool visibleOnly, bool collidableOnly);
 
+    /// Same as above for a batch of rays sharing the same filters, which are tested against each entity together
+    QVector<RayToEntityIntersectionResult> findRayIntersectionsVector(const QVector<PickRay>& rays, bool precisionPicking,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        bool visibleOnly, bool collidableOnly);
+
     /// If the scripting context has visible entities, this will determine a ray intersection, and will block in
     /// order to return an accurate result
     Q_INVOKABLE RayToEntityIntersectionResult findRayIntersectionBlocking(const PickRay& ray, bool precisionPicking = false, const QScriptValue& entityIdsToInclude = QScriptValue(), const QScriptValue& entityIdsToDiscard = QScriptValue());
 
+    /**jsdoc
+     * Find the closest entity intersected by a ray without blocking the calling script. The query is run on a
+     * shared worker thread together with any other queued queries, and the callback is called on the script's
+     * thread with the same result object {@link Entities.findRayIntersection} returns.
+     *
+     * @function Entities.findRayIntersectionAsync
+     * @param {PickRay} pickRay The PickRay to use for finding entities.
+     * @param {function} callback Called as <code>callback(result)</code> when the query completes.
+     * @param {boolean} [precisionPicking=false] Test against the entity's mesh rather than its bounding box.
+     * @param {Uuid[]} [entitiesToInclude=[]] If not empty then the search is restricted to these entities.
+     * @param {Uuid[]} [entitiesToDiscard=[]] Entities to ignore during the search.
+     * @param {boolean} [visibleOnly=false] Only consider visible entities.
+     * @param {boolean} [collidableOnly=false] Only consider collidable entities.
+     * @returns {boolean} <code>true</code> if the query was queued, otherwise <code>false</code>.
+     */
+    Q_INVOKABLE bool findRayIntersectionAsync(const PickRay& ray, QScriptValue callback, bool precisionPicking = false,
+        const QScriptValue& entityIdsToInclude = QScriptValue(), const QScriptValue& entityIdsToDiscard = QScriptValue(),
+        bool visibleOnly = false, bool collidableOnly = false);
+
+    /**jsdoc
+     * Asynchronous version of {@link Entities.findEntities}, the callback is called as <code>callback(entityIDs)</code>.
+     *
+     * @function Entities.findEntitiesAsync
+     * @param {Vec3} center The point about which to search.
+     * @param {number} radius The radius within which to search.
+     * @param {function} callback Called with the array of found entity IDs when the query completes.
+     * @returns {boolean} <code>true</code> if the query was queued, otherwise <code>false</code>.
+     */
+    Q_INVOKABLE bool findEntitiesAsync(const glm::vec3& center, float radius, QScriptValue callback);
+
+    /**jsdoc
+     * Asynchronous version of {@link Entities.findEntitiesInBox}, the callback is called as
+     * <code>callback(entityIDs)</code>.
+     *
+     * @function Entities.findEntitiesInBoxAsync
+     * @param {Vec3} corner The corner of the box with the minimum x, y and z coordinates.
+     * @param {Vec3} dimensions The dimensions of the box.
+     * @param {function} callback Called with the array of found entity IDs when the query completes.
+     * @returns {boolean} <code>true</code> if the query was queued, otherwise <code>false</code>.
+     */
+    Q_INVOKABLE bool findEntitiesInBoxAsync(const glm::vec3& corner, const glm::vec3& dimensions, QScriptValue callback);
+
+    /**jsdoc
+     * Statistics for the asynchronous query service: queue depth, batch sizes, and latency.
+     *
+     * @function Entities.getQueryStats
+     * @returns {object} <code>{ queueDepth, maxQueueDepth, totalQueries, totalBatches, averageBatchSize,
+     *     averageBatchTimeUsecs, averageLatencyUsecs }</code>
+     */
+    Q_INVOKABLE QVariantMap getQueryStats() const;
+
     Q_INVOKABLE bool reloadServerScripts(QUuid entityID);
 
     /**jsdoc
@@ -443,8 +501,14 @@ private:
         bool precisionPicking, const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
         bool visibleOnly = false, bool collidableOnly = false);
 
+    EntityQueryService* getQueryService();
+    bool queueQueryRequest(EntityQueryRequest* request, QScriptValue callback);
+
     EntityTreePointer _entityTree;
 
+    std::once_flag _queryServiceStarted;
+    EntityQueryService* _queryService { nullptr };
+
     std::recursive_mutex _entitiesScriptEngineLock;
     QSharedPointer<EntitiesScriptEngineProvider> _entitiesScriptEngine;
 
@@ -0,0 +1,181 @@
+//
+//  EntitySpatialIndex.cpp
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySpatialIndex.h"
+
+#include <OctreeConstants.h>
+
+#include "EntityItem.h"
+
+const float EntitySpatialIndex::CELL_SIZE = 16.0f;
+const uint64_t EntitySpatialIndex::LARGE_ENTITIES = (uint64_t)-1;
+const uint64_t EntitySpatialIndex::UNBOUNDED_ENTITIES = (uint64_t)-2;
+
+// cell coordinates are clamped to just outside the tree, so that they fit in 21 bits each
+static const int MAX_CELL_COORDINATE = (int)(HALF_TREE_SCALE / EntitySpatialIndex::CELL_SIZE) + 1;
+static const int CELL_COORDINATE_BITS = 21;
+static const uint64_t CELL_COORDINATE_MASK = (1 << CELL_COORDINATE_BITS) - 1;
+
+glm::ivec3 EntitySpatialIndex::cellCoordinates(const glm::vec3& position) {
+    glm::vec3 clamped = glm::clamp(position / CELL_SIZE, glm::vec3((float)-MAX_CELL_COORDINATE),
+        glm::vec3((float)MAX_CELL_COORDINATE));
+    return glm::ivec3(glm::floor(clamped));
+}
+
+uint64_t EntitySpatialIndex::cellKey(const glm::ivec3& coordinates) {
+    glm::ivec3 biased = coordinates + glm::ivec3(MAX_CELL_COORDINATE);
+    return ((uint64_t)biased.x & CELL_COORDINATE_MASK) |
+        (((uint64_t)biased.y & CELL_COORDINATE_MASK) << CELL_COORDINATE_BITS) |
+        (((uint64_t)biased.z & CELL_COORDINATE_MASK) << (2 * CELL_COORDINATE_BITS));
+}
+
+void EntitySpatialIndex::addEntity(const EntityItemPointer& entity) {
+    withWriteLock([&] {
+        removeLocked(entity->getEntityItemID());
+        insertLocked(entity);
+    });
+}
+
+void EntitySpatialIndex::removeEntity(const EntityItemID& entityID) {
+    withWriteLock([&] {
+        removeLocked(entityID);
+    });
+}
+
+void EntitySpatialIndex::clear() {
+    {
+        std::lock_guard<std::mutex> lock(_movedMutex);
+        for (const auto& weakEntity : _movedEntities) {
+            EntityItemPointer entity = weakEntity.lock();
+            if (entity) {
+                entity->setSpatialIndexQueued(false);
+            }
+        }
+        _movedEntities.clear();
+        _hasMovedEntities = false;
+    }
+    withWriteLock([&] {
+        _cells.clear();
+        _largeEntities.clear();
+        _unboundedEntities.clear();
+        _locations.clear();
+    });
+}
+
+void EntitySpatialIndex::entityMoved(const EntityItemPointer& entity) {
+    if (entity->setSpatialIndexQueued(true)) {
+        return; // already waiting for the next query
+    }
+    std::lock_guard<std::mutex> lock(_movedMutex);
+    _movedEntities.push_back(entity);
+    _hasMovedEntities = true;
+}
+
+int EntitySpatialIndex::size() const {
+    return resultWithReadLock<int>([&] {
+        return _locations.size();
+    });
+}
+
+void EntitySpatialIndex::updateMovedEntities() {
+    std::vector<EntityItemWeakPointer> movedEntities;
+    {
+        std::lock_guard<std::mutex> lock(_movedMutex);
+        movedEntities.swap(_movedEntities);
+        _hasMovedEntities = false;
+    }
+
+    withWriteLock([&] {
+        for (const auto& weakEntity : movedEntities) {
+            EntityItemPointer entity = weakEntity.lock();
+            if (!entity) {
+                continue;
+            }
+            // cleared first, so a move while we read the bounds queues the entity again
+            entity->setSpatialIndexQueued(false);
+            // entities that were deleted while they were queued stay out of the index
+            if (removeLocked(entity->getEntityItemID())) {
+                insertLocked(entity);
+            }
+        }
+    });
+}
+
+void EntitySpatialIndex::insertLocked(const EntityItemPointer& entity) {
+    Entry entry;
+    entry.entity = entity;
+
+    bool queryAACubeSuccess { false };
+    bool maxAACubeSuccess { false };
+    AACube bounds = entity->getQueryAACube(queryAACubeSuccess);
+    AACube maxAACube = entity->getMaximumAACube(maxAACubeSuccess);
+    if (queryAACubeSuccess && maxAACubeSuccess) {
+        bounds += maxAACube.getMinimumPoint();
+        bounds += maxAACube.getMaximumPoint();
+    } else if (maxAACubeSuccess) {
+        bounds = maxAACube;
+    }
+
+    Location location;
+    if (!queryAACubeSuccess && !maxAACubeSuccess) {
+        // an entity whose parent isn't known yet has no bounds to test, so no query finds it until it moves
+        location.cell = UNBOUNDED_ENTITIES;
+        location.index = (int)_unboundedEntities.size();
+        _unboundedEntities.push_back(std::move(entry));
+        _locations.insert(entity->getEntityItemID(), location);
+        return;
+    }
+
+    entry.minimum = bounds.getMinimumPoint();
+    entry.maximum = bounds.getMaximumPoint();
+    if (bounds.getScale() <= CELL_SIZE) {
+        location.cell = cellKey(cellCoordinates(bounds.calcCenter()));
+        auto& entries = _cells[location.cell];
+        location.index = (int)entries.size();
+        entries.push_back(std::move(entry));
+    } else {
+        location.cell = LARGE_ENTITIES;
+        location.index = (int)_largeEntities.size();
+        _largeEntities.push_back(std::move(entry));
+    }
+    _locations.insert(entity->getEntityItemID(), location);
+}
+
+bool EntitySpatialIndex::removeLocked(const EntityItemID& entityID) {
+    auto itr = _locations.find(entityID);
+    if (itr == _locations.end()) {
+        return false;
+    }
+    Location location = itr.value();
+    _locations.erase(itr);
+
+    auto cell = _cells.end();
+    std::vector<Entry>* entries = &_largeEntities;
+    if (location.cell == UNBOUNDED_ENTITIES) {
+        entries = &_unboundedEntities;
+    } else if (location.cell != LARGE_ENTITIES) {
+        cell = _cells.find(location.cell);
+        assert(cell != _cells.end());
+        entries = &cell->second;
+    }
+
+    // swap the last entry of the cell into the hole
+    int lastIndex = (int)entries->size() - 1;
+    if (location.index != lastIndex) {
+        (*entries)[location.index] = std::move((*entries)[lastIndex]);
+        _locations[(*entries)[location.index].entity->getEntityItemID()].index = location.index;
+    }
+    entries->pop_back();
+
+    if (cell != _cells.end() && entries->empty()) {
+        _cells.erase(cell);
+    }
+    return true;
+}
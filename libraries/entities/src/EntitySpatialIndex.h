@@ -0,0 +1,130 @@
+//
+//  EntitySpatialIndex.h
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySpatialIndex_h
+#define hifi_EntitySpatialIndex_h
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QHash>
+
+#include <glm/glm.hpp>
+
+#include <shared/ReadWriteLockable.h>
+
+#include "EntityItemID.h"
+#include "EntityTypes.h"
+
+// A flat index of the entities of an EntityTree, for the spatial queries the tree answers every frame.  It is a loose
+// grid: an entity is binned in the one cell that holds the center of its bounds, and since only entities no wider than
+// a cell are binned, a query only has to widen itself by half a cell to find every entity it might touch.  Entities
+// that are wider than a cell are kept in a list that every query visits.  Entities that have no bounds yet, because
+// their parent isn't known, are tracked but never found: they are binned once their parent turns up and they move.
+//
+// The bounds of an entity are its query cube, grown to contain its maximum cube, so they always contain the box that
+// the queries test.  Entities are added and removed with the entity map of the tree, and entities that moved are
+// queued and re-binned by the next query.
+class EntitySpatialIndex : public ReadWriteLockable {
+public:
+    static const float CELL_SIZE; // meters
+
+    void addEntity(const EntityItemPointer& entity);
+    void removeEntity(const EntityItemID& entityID);
+    void clear();
+
+    // the entity, or something it is relative to, moved or changed size.  Thread safe.
+    void entityMoved(const EntityItemPointer& entity);
+
+    int size() const;
+
+    // calls visitor with every entity whose bounds touch the box between minimum and maximum, without allocating.  The
+    // visitor does the exact test, and must not add, move or delete entities.
+    template <typename F>
+    void forEachEntityTouching(const glm::vec3& minimum, const glm::vec3& maximum, F visitor);
+
+private:
+    struct Entry {
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        EntityItemPointer entity;
+    };
+
+    struct Location {
+        uint64_t cell;
+        int index;
+    };
+
+    static const uint64_t LARGE_ENTITIES;
+    static const uint64_t UNBOUNDED_ENTITIES;
+
+    static glm::ivec3 cellCoordinates(const glm::vec3& position);
+    static uint64_t cellKey(const glm::ivec3& coordinates);
+
+    void updateMovedEntities();
+    void insertLocked(const EntityItemPointer& entity);
+    bool removeLocked(const EntityItemID& entityID);
+
+    std::unordered_map<uint64_t, std::vector<Entry>> _cells;
+    std::vector<Entry> _largeEntities;
+    std::vector<Entry> _unboundedEntities; // not visited by queries
+    QHash<EntityItemID, Location> _locations;
+
+    std::mutex _movedMutex;
+    std::vector<EntityItemWeakPointer> _movedEntities;
+    std::atomic<bool> _hasMovedEntities { false };
+};
+
+template <typename F>
+void EntitySpatialIndex::forEachEntityTouching(const glm::vec3& minimum, const glm::vec3& maximum, F visitor) {
+    if (_hasMovedEntities) {
+        updateMovedEntities();
+    }
+
+    withReadLock([&] {
+        auto visitEntries = [&](const std::vector<Entry>& entries) {
+            for (const auto& entry : entries) {
+                if (glm::all(glm::lessThanEqual(entry.minimum, maximum)) &&
+                    glm::all(glm::lessThanEqual(minimum, entry.maximum))) {
+                    visitor(entry.entity);
+                }
+            }
+        };
+
+        visitEntries(_largeEntities);
+
+        // binned entities overhang their cell by at most half a cell
+        glm::vec3 overhang(0.5f * CELL_SIZE);
+        glm::ivec3 low = cellCoordinates(minimum - overhang);
+        glm::ivec3 high = cellCoordinates(maximum + overhang);
+        int64_t numCells = (int64_t)(high.x - low.x + 1) * (int64_t)(high.y - low.y + 1) * (int64_t)(high.z - low.z + 1);
+        if (numCells > (int64_t)_cells.size()) {
+            // the query covers more cells than there are occupied cells, so visit the occupied ones
+            for (const auto& cell : _cells) {
+                visitEntries(cell.second);
+            }
+            return;
+        }
+        for (int z = low.z; z <= high.z; ++z) {
+            for (int y = low.y; y <= high.y; ++y) {
+                for (int x = low.x; x <= high.x; ++x) {
+                    auto cell = _cells.find(cellKey(glm::ivec3(x, y, z)));
+                    if (cell != _cells.end()) {
+                        visitEntries(cell->second);
+                    }
+                }
+            }
+        }
+    });
+}
+
+#endif // hifi_EntitySpatialIndex_h
@@ -56,6 +56,30 @@ public:
     bool found;
 };
 
+// the rays of a batch that might hit one entity, with their hits against it
+class RayCandidate {
+public:
+    EntityItemPointer entity;
+    std::vector<TriangleSet::Ray> rays;
+    std::vector<TriangleSet::RayHit> hits;
+    std::vector<size_t> rayIndices;
+};
+
+// combines the arguments for gathering the entities one ray of a batch might hit
+class RayCandidatesArgs {
+public:
+    // Inputs
+    TriangleSet::Ray ray;
+    size_t rayIndex;
+    const QVector<EntityItemID>& entityIdsToInclude;
+    const QVector<EntityItemID>& entityIdsToDiscard;
+    bool visibleOnly;
+    bool collidableOnly;
+
+    // Outputs
+    std::unordered_map<EntityItem*, RayCandidate>& candidates;
+};
+
 
 EntityTree::EntityTree(bool shouldReaverage) :
     Octree(shouldReaverage)
@@ -91,6 +115,7 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
     }
     QHash<EntityItemID, EntityItemPointer> localMap;
     localMap.swap(_entityMap);
+    _spatialIndex.clear();
     this->withWriteLock([&] {
         foreach(EntityItemPointer entity, localMap) {
             EntityTreeElementPointer element = entity->getElement();
@@ -737,6 +762,90 @@ bool EntityTree::findRayIntersection(const glm::vec3& origin, const glm::vec3& d
     return args.found;
 }
 
+bool findRayCandidatesOp(const OctreeElementPointer& element, void* extraData) {
+    RayCandidatesArgs* args = static_cast<RayCandidatesArgs*>(extraData);
+    float distance;
+    BoxFace face;
+    glm::vec3 surfaceNormal;
+    if (!element->getAACube().findRayIntersection(args->ray.origin, args->ray.direction, distance, face, surfaceNormal)) {
+        return false;
+    }
+    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
+    if (entityTreeElementPointer->canRayIntersect()) {
+        entityTreeElementPointer->findRayIntersectionCandidates(args->ray.origin, args->ray.direction,
+            args->entityIdsToInclude, args->entityIdsToDiscard, args->visibleOnly, args->collidableOnly,
+            [&](const EntityItemPointer& entity, const TriangleSet::RayHit& hit) {
+                RayCandidate& candidate = args->candidates[entity.get()];
+                candidate.entity = entity;
+                candidate.rays.push_back(args->ray);
+                candidate.hits.push_back(hit);
+                candidate.rayIndices.push_back(args->rayIndex);
+            });
+    }
+    return true;
+}
+
+size_t EntityTree::findRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+                                        const QVector<EntityItemID>& entityIdsToInclude,
+                                        const QVector<EntityItemID>& entityIdsToDiscard,
+                                        bool visibleOnly, bool collidableOnly, bool precisionPicking,
+                                        std::vector<TriangleSet::RayHit>& hits,
+                                        std::vector<EntityItemPointer>& intersectedEntities,
+                                        Octree::lockType lockType, bool* accurateResult) {
+    hits.clear();
+    hits.resize(rays.size());
+    intersectedEntities.clear();
+    intersectedEntities.resize(rays.size());
+
+    bool requireLock = lockType == Octree::Lock;
+    bool lockResult = withReadLock([&]{
+        // gather the entities each ray might hit first, so that an entity is tested against all of its rays at once
+        std::unordered_map<EntityItem*, RayCandidate> candidates;
+        RayCandidatesArgs args = { TriangleSet::Ray(), 0, entityIdsToInclude, entityIdsToDiscard,
+            visibleOnly, collidableOnly, candidates };
+        for (size_t i = 0; i < rays.size(); i++) {
+            args.ray = rays[i];
+            args.rayIndex = i;
+            recurseTreeWithOperation(findRayCandidatesOp, &args);
+        }
+
+        for (auto& entry : candidates) {
+            RayCandidate& candidate = entry.second;
+            const EntityItemPointer& entity = candidate.entity;
+            if (entity->supportsDetailedRayIntersection()) {
+                entity->findDetailedRayIntersections(candidate.rays, candidate.hits, precisionPicking);
+            } else if (entity->getType() == EntityTypes::ParticleEffect) {
+                // Never intersect with particle entities
+                continue;
+            } else {
+                // if the entity type doesn't support a detailed intersection, then just return the non-AABox results
+                glm::quat rotation = entity->getRotation();
+                for (auto& hit : candidate.hits) {
+                    hit.surfaceNormal = rotation * hit.surfaceNormal;
+                }
+            }
+
+            for (size_t i = 0; i < candidate.hits.size(); i++) {
+                const TriangleSet::RayHit& hit = candidate.hits[i];
+                size_t rayIndex = candidate.rayIndices[i];
+                if (hit.intersects && hit.distance < hits[rayIndex].distance) {
+                    hits[rayIndex] = hit;
+                    intersectedEntities[rayIndex] = entity;
+                }
+            }
+        }
+    }, requireLock);
+
+    if (accurateResult) {
+        *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
+    }
+
+    size_t numHits = 0;
+    for (const auto& hit : hits) {
+        numHits += hit.intersects ? 1 : 0;
+    }
+    return numHits;
+}
 
 EntityItemPointer EntityTree::findClosestEntity(const glm::vec3& position, float targetRadius) {
     FindNearPointArgs args = { position, targetRadius, false, NULL, FLT_MAX };
@@ -747,121 +856,52 @@ EntityItemPointer EntityTree::findClosestEntity(const glm::vec3& position, float
     return args.closestEntity;
 }
 
-class FindAllNearPointArgs {
-public:
-    glm::vec3 position;
-    float targetRadius;
-    QVector<EntityItemPointer> entities;
-};
-
-
-bool EntityTree::findInSphereOperation(const OctreeElementPointer& element, void* extraData) {
-    FindAllNearPointArgs* args = static_cast<FindAllNearPointArgs*>(extraData);
-    glm::vec3 penetration;
-    bool sphereIntersection = element->getAACube().findSpherePenetration(args->position, args->targetRadius, penetration);
-
-    // If this element contains the point, then search it...
-    if (sphereIntersection) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->getEntities(args->position, args->targetRadius, args->entities);
-        return true; // keep searching in case children have closer entities
-    }
-
-    // if this element doesn't contain the point, then none of it's children can contain the point, so stop searching
-    return false;
-}
-
 // NOTE: assumes caller has handled locking
 void EntityTree::findEntities(const glm::vec3& center, float radius, QVector<EntityItemPointer>& foundEntities) {
-    FindAllNearPointArgs args = { center, radius, QVector<EntityItemPointer>() };
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInSphereOperation, &args);
-
-    // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInCubeArgs {
-public:
-    FindEntitiesInCubeArgs(const AACube& cube)
-        : _cube(cube), _foundEntities() {
-    }
-
-    AACube _cube;
-    QVector<EntityItemPointer> _foundEntities;
-};
-
-bool EntityTree::findInCubeOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInCubeArgs* args = static_cast<FindEntitiesInCubeArgs*>(extraData);
-    if (element->getAACube().touches(args->_cube)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->getEntities(args->_cube, args->_foundEntities);
-        return true;
-    }
-    return false;
+    foundEntities.clear();
+    forEachEntityInSphere(center, radius, [&](const EntityItemPointer& entity) {
+        foundEntities.push_back(entity);
+    });
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::findEntities(const AACube& cube, QVector<EntityItemPointer>& foundEntities) {
-    FindEntitiesInCubeArgs args(cube);
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInCubeOperation, &args);
-    // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args._foundEntities);
-}
-
-class FindEntitiesInBoxArgs {
-public:
-    FindEntitiesInBoxArgs(const AABox& box)
-    : _box(box), _foundEntities() {
-    }
-
-    AABox _box;
-    QVector<EntityItemPointer> _foundEntities;
-};
-
-bool EntityTree::findInBoxOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInBoxArgs* args = static_cast<FindEntitiesInBoxArgs*>(extraData);
-    if (element->getAACube().touches(args->_box)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->getEntities(args->_box, args->_foundEntities);
-        return true;
-    }
-    return false;
+    foundEntities.clear();
+    forEachEntityInCube(cube, [&](const EntityItemPointer& entity) {
+        foundEntities.push_back(entity);
+    });
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::findEntities(const AABox& box, QVector<EntityItemPointer>& foundEntities) {
-    FindEntitiesInBoxArgs args(box);
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInBoxOperation, &args);
-    // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args._foundEntities);
-}
-
-class FindInFrustumArgs {
-public:
-    ViewFrustum frustum;
-    QVector<EntityItemPointer> entities;
-};
-
-bool EntityTree::findInFrustumOperation(const OctreeElementPointer& element, void* extraData) {
-    FindInFrustumArgs* args = static_cast<FindInFrustumArgs*>(extraData);
-    if (element->isInView(args->frustum)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->getEntities(args->frustum, args->entities);
-        return true;
-    }
-    return false;
+    foundEntities.clear();
+    forEachEntityInBox(box, [&](const EntityItemPointer& entity) {
+        foundEntities.push_back(entity);
+    });
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::findEntities(const ViewFrustum& frustum, QVector<EntityItemPointer>& foundEntities) {
-    FindInFrustumArgs args = { frustum, QVector<EntityItemPointer>() };
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInFrustumOperation, &args);
-    // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args.entities);
+    foundEntities.clear();
+    forEachEntityInFrustum(frustum, [&](const EntityItemPointer& entity) {
+        foundEntities.push_back(entity);
+    });
+}
+
+void EntityTree::getFrustumBounds(const ViewFrustum& frustum, glm::vec3& minimum, glm::vec3& maximum) {
+    // the keyhole is a sphere around the eye, and the frustum is the hull of its corners
+    const glm::vec3& position = frustum.getPosition();
+    float keyholeRadius = frustum.getCenterRadius();
+    minimum = position - glm::vec3(keyholeRadius);
+    maximum = position + glm::vec3(keyholeRadius);
+    const glm::vec3 corners[] = {
+        frustum.getNearTopLeft(), frustum.getNearTopRight(), frustum.getNearBottomLeft(), frustum.getNearBottomRight(),
+        frustum.getFarTopLeft(), frustum.getFarTopRight(), frustum.getFarBottomLeft(), frustum.getFarBottomRight()
+    };
+    for (const auto& corner : corners) {
+        minimum = glm::min(minimum, corner);
+        maximum = glm::max(maximum, corner);
+    }
 }
 
 EntityItemPointer EntityTree::findEntityByID(const QUuid& id) {
@@ -1362,6 +1402,33 @@ void EntityTree::entityChanged(EntityItemPointer entity) {
     }
 }
 
+void EntityTree::worldTransformChanged(const EntityItemPointer& entity) {
+    std::lock_guard<std::mutex> lock(_worldTransformChangesMutex);
+    _worldTransformChanges.push_back(entity);
+}
+
+void EntityTree::updateWorldTransforms() {
+    std::vector<EntityItemWeakPointer> changes;
+    {
+        std::lock_guard<std::mutex> lock(_worldTransformChangesMutex);
+        changes.swap(_worldTransformChanges);
+    }
+
+    std::vector<SpatiallyNestablePointer> nestables;
+    nestables.reserve(changes.size());
+    for (const auto& weakEntity : changes) {
+        EntityItemPointer entity = weakEntity.lock();
+        if (entity) {
+            // cleared first, so a move during the update queues the entity again
+            entity->setWorldTransformQueued(false);
+            nestables.push_back(entity);
+        }
+    }
+    if (!nestables.empty()) {
+        SpatiallyNestable::updateWorldTransforms(nestables);
+    }
+}
+
 
 void EntityTree::fixupNeedsParentFixups() {
     MovingEntitiesOperator moveOperator;
@@ -1473,6 +1540,9 @@ void EntityTree::update(bool simulate) {
             }
         });
     }
+
+    // outside of the write-lock, because finding parents takes the read-lock
+    updateWorldTransforms();
 }
 
 quint64 EntityTree::getAdjustedConsiderSince(quint64 sinceTime) {
@@ -1634,19 +1704,26 @@ EntityTreeElementPointer EntityTree::getContainingElement(const EntityItemID& en
 
 void EntityTree::addEntityMapEntry(EntityItemPointer entity) {
     EntityItemID id = entity->getEntityItemID();
-    QWriteLocker locker(&_entityMapLock);
-    EntityItemPointer otherEntity = _entityMap.value(id);
-    if (otherEntity) {
-        qCWarning(entities) << "EntityTree::addEntityMapEntry() found pre-existing id " << id;
-        assert(false);
-        return;
+    {
+        QWriteLocker locker(&_entityMapLock);
+        EntityItemPointer otherEntity = _entityMap.value(id);
+        if (otherEntity) {
+            qCWarning(entities) << "EntityTree::addEntityMapEntry() found pre-existing id " << id;
+            assert(false);
+            return;
+        }
+        _entityMap.insert(id, entity);
     }
-    _entityMap.insert(id, entity);
+    // outside the map lock, finding the bounds of the entity may look up its parent
+    _spatialIndex.addEntity(entity);
 }
 
 void EntityTree::clearEntityMapEntry(const EntityItemID& id) {
-    QWriteLocker locker(&_entityMapLock);
-    _entityMap.remove(id);
+    {
+        QWriteLocker locker(&_entityMapLock);
+        _entityMap.remove(id);
+    }
+    _spatialIndex.removeEntity(id);
 }
 
 void EntityTree::debugDumpMap() {
@@ -12,6 +12,8 @@
 #ifndef hifi_EntityTree_h
 #define hifi_EntityTree_h
 
+#include <mutex>
+
 #include <QSet>
 #include <QVector>
 
@@ -22,6 +24,7 @@ class EntityTree;
 using EntityTreePointer = std::shared_ptr<EntityTree>;
 
 #include "AddEntityOperator.h"
+#include "EntitySpatialIndex.h"
 #include "EntityTreeElement.h"
 #include "DeleteEntityOperator.h"
 #include "MovingEntitiesOperator.h"
@@ -103,6 +106,15 @@ public:
         BoxFace& face, glm::vec3& surfaceNormal, void** intersectedObject = NULL,
         Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
 
+    // finds the closest entity hit by each ray of a batch, with the same filters for every ray.  Each entity is tested
+    // against all the rays that might hit it together, which lets models trace them through their meshes as a batch.
+    // hits and intersectedEntities are resized to match rays, and the number of rays that hit something is returned.
+    size_t findRayIntersections(const std::vector<TriangleSet::Ray>& rays,
+        const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+        bool visibleOnly, bool collidableOnly, bool precisionPicking,
+        std::vector<TriangleSet::RayHit>& hits, std::vector<EntityItemPointer>& intersectedEntities,
+        Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
+
     virtual bool rootElementHasData() const override { return true; }
 
     // the root at least needs to store the number of entities in the packet/buffer
@@ -165,6 +177,13 @@ public:
     /// \param foundEntities[out] vector of EntityItemPointer
     void findEntities(const ViewFrustum& frustum, QVector<EntityItemPointer>& foundEntities);
 
+    /// calls visitor with each entity that findEntities would find, without building a list of them
+    /// \remark the visitor must not add, move or delete entities
+    template <typename F> void forEachEntityInSphere(const glm::vec3& center, float radius, F visitor);
+    template <typename F> void forEachEntityInCube(const AACube& cube, F visitor);
+    template <typename F> void forEachEntityInBox(const AABox& box, F visitor);
+    template <typename F> void forEachEntityInFrustum(const ViewFrustum& frustum, F visitor);
+
     void addNewlyCreatedHook(NewlyCreatedEntityHook* hook);
     void removeNewlyCreatedHook(NewlyCreatedEntityHook* hook);
 
@@ -200,6 +219,11 @@ public:
 
     void entityChanged(EntityItemPointer entity);
 
+    // the entity, or something it is relative to, moved.  Its cached world transform is refreshed in update.
+    void worldTransformChanged(const EntityItemPointer& entity);
+    // the entity moved or changed size, and is re-binned in the spatial index by the next query
+    void entityMoved(const EntityItemPointer& entity) { _spatialIndex.entityMoved(entity); }
+
     void emitEntityScriptChanging(const EntityItemID& entityItemID, bool reload);
     void emitEntityServerScriptChanging(const EntityItemID& entityItemID, bool reload);
 
@@ -283,10 +307,6 @@ protected:
     bool updateEntity(EntityItemPointer entity, const EntityItemProperties& properties,
             const SharedNodePointer& senderNode = SharedNodePointer(nullptr));
     static bool findNearPointOperation(const OctreeElementPointer& element, void* extraData);
-    static bool findInSphereOperation(const OctreeElementPointer& element, void* extraData);
-    static bool findInCubeOperation(const OctreeElementPointer& element, void* extraData);
-    static bool findInBoxOperation(const OctreeElementPointer& element, void* extraData);
-    static bool findInFrustumOperation(const OctreeElementPointer& element, void* extraData);
     static bool sendEntitiesOperation(const OctreeElementPointer& element, void* extraData);
     static void bumpTimestamp(EntityItemProperties& properties);
 
@@ -315,6 +335,7 @@ protected:
 
     mutable QReadWriteLock _entityMapLock;
     QHash<EntityItemID, EntityItemPointer> _entityMap;
+    EntitySpatialIndex _spatialIndex; // holds the entities of _entityMap
 
     EntitySimulationPointer _simulation;
 
@@ -342,6 +363,10 @@ protected:
     quint64 _treeResetTime = 0;
 
     void fixupNeedsParentFixups(); // try to hook members of _needsParentFixup to parent instances
+    void updateWorldTransforms(); // refresh the cached world transforms of the entities that moved
+
+    std::mutex _worldTransformChangesMutex;
+    std::vector<EntityItemWeakPointer> _worldTransformChanges;
     QVector<EntityItemWeakPointer> _needsParentFixup; // entites with a parentID but no (yet) known parent instance
     mutable QReadWriteLock _needsParentFixupLock;
 
@@ -357,6 +382,51 @@ protected:
 
     MovingEntitiesOperator _entityMover;
     QHash<EntityItemID, EntityItemPointer> _entitiesToAdd;
+
+    static void getFrustumBounds(const ViewFrustum& frustum, glm::vec3& minimum, glm::vec3& maximum);
 };
 
+// NOTE: the visitor queries assume caller has handled locking, like findEntities
+template <typename F>
+void EntityTree::forEachEntityInSphere(const glm::vec3& center, float radius, F visitor) {
+    _spatialIndex.forEachEntityTouching(center - glm::vec3(radius), center + glm::vec3(radius),
+        [&](const EntityItemPointer& entity) {
+            if (EntityTreeElement::entityTouchesSphere(entity, center, radius)) {
+                visitor(entity);
+            }
+        });
+}
+
+template <typename F>
+void EntityTree::forEachEntityInCube(const AACube& cube, F visitor) {
+    _spatialIndex.forEachEntityTouching(cube.getMinimumPoint(), cube.getMaximumPoint(),
+        [&](const EntityItemPointer& entity) {
+            if (EntityTreeElement::entityTouchesCube(entity, cube)) {
+                visitor(entity);
+            }
+        });
+}
+
+template <typename F>
+void EntityTree::forEachEntityInBox(const AABox& box, F visitor) {
+    _spatialIndex.forEachEntityTouching(box.getMinimumPoint(), box.getMaximumPoint(),
+        [&](const EntityItemPointer& entity) {
+            if (EntityTreeElement::entityTouchesBox(entity, box)) {
+                visitor(entity);
+            }
+        });
+}
+
+template <typename F>
+void EntityTree::forEachEntityInFrustum(const ViewFrustum& frustum, F visitor) {
+    glm::vec3 minimum;
+    glm::vec3 maximum;
+    getFrustumBounds(frustum, minimum, maximum);
+    _spatialIndex.forEachEntityTouching(minimum, maximum, [&](const EntityItemPointer& entity) {
+        if (EntityTreeElement::entityTouchesFrustum(entity, frustum)) {
+            visitor(entity);
+        }
+    });
+}
+
 #endif // hifi_EntityTree_h
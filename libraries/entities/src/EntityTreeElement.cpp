@@ -712,6 +712,48 @@ bool EntityTreeElement::findDetailedRayIntersection(const glm::vec3& origin, con
     return somethingIntersected;
 }
 
+void EntityTreeElement::findRayIntersectionCandidates(const glm::vec3& origin, const glm::vec3& direction,
+                                    const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIDsToDiscard,
+                                    bool visibleOnly, bool collidableOnly,
+                                    std::function<void(const EntityItemPointer&, const TriangleSet::RayHit&)> candidate) {
+    forEachEntity([&](EntityItemPointer entity) {
+        if ( (visibleOnly && !entity->isVisible()) || (collidableOnly && (entity->getCollisionless() || entity->getShapeType() == SHAPE_TYPE_NONE))
+            || (entityIdsToInclude.size() > 0 && !entityIdsToInclude.contains(entity->getID()))
+            || (entityIDsToDiscard.size() > 0 && entityIDsToDiscard.contains(entity->getID())) ) {
+            return;
+        }
+
+        bool success;
+        AABox entityBox = entity->getAABox(success);
+        if (!success) {
+            return;
+        }
+
+        TriangleSet::RayHit hit;
+        if (!entityBox.findRayIntersection(origin, direction, hit.distance, hit.face, hit.surfaceNormal)) {
+            return;
+        }
+
+        // same as findDetailedRayIntersection, test the box of the entity in its own frame
+        glm::mat4 rotation = glm::mat4_cast(entity->getRotation());
+        glm::mat4 translation = glm::translate(entity->getPosition());
+        glm::mat4 entityToWorldMatrix = translation * rotation;
+        glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
+
+        glm::vec3 dimensions = entity->getDimensions();
+        glm::vec3 corner = -(dimensions * entity->getRegistrationPoint());
+        AABox entityFrameBox(corner, dimensions);
+
+        glm::vec3 entityFrameOrigin = glm::vec3(worldToEntityMatrix * glm::vec4(origin, 1.0f));
+        glm::vec3 entityFrameDirection = glm::vec3(worldToEntityMatrix * glm::vec4(direction, 0.0f));
+        if (entityFrameBox.findRayIntersection(entityFrameOrigin, entityFrameDirection, hit.distance,
+                                               hit.face, hit.surfaceNormal)) {
+            hit.intersects = true;
+            candidate(entity, hit);
+        }
+    });
+}
+
 // TODO: change this to use better bounding shape for entity than sphere
 bool EntityTreeElement::findSpherePenetration(const glm::vec3& center, float radius,
                                     glm::vec3& penetration, void** penetratedObject) const {
@@ -753,80 +795,102 @@ EntityItemPointer EntityTreeElement::getClosestEntity(glm::vec3 position) const
 }
 
 // TODO: change this to use better bounding shape for entity than sphere
-void EntityTreeElement::getEntities(const glm::vec3& searchPosition, float searchRadius, QVector<EntityItemPointer>& foundEntities) const {
-    forEachEntity([&](EntityItemPointer entity) {
+bool EntityTreeElement::entityTouchesSphere(const EntityItemPointer& entity, const glm::vec3& searchPosition, float searchRadius) {
+    bool success;
+    AABox entityBox = entity->getAABox(success);
+
+    // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case.  An
+    // entity without a box, whose parent isn't known yet, is nowhere
+    glm::vec3 penetration;
+    if (!success || !entityBox.findSpherePenetration(searchPosition, searchRadius, penetration)) {
+        return false;
+    }
+
+    glm::vec3 dimensions = entity->getDimensions();
+
+    // FIXME - consider allowing the entity to determine penetration so that
+    //         entities could presumably dull actuall hull testing if they wanted to
+    // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
+    //         can we handle the ellipsoid case better? We only currently handle perfect spheres
+    //         with centered registration points
+    if (entity->getShapeType() == SHAPE_TYPE_SPHERE &&
+        (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
+
+        // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
+        //       maximum bounding sphere, which is actually larger than our actual radius
+        float entityTrueRadius = dimensions.x / 2.0f;
 
         bool success;
-        AABox entityBox = entity->getAABox(success);
+        if (findSphereSpherePenetration(searchPosition, searchRadius,
+                entity->getCenterPosition(success), entityTrueRadius, penetration)) {
+            return success;
+        }
+        return false;
+    }
 
-        // if the sphere doesn't intersect with our world frame AABox, we don't need to consider the more complex case
-        glm::vec3 penetration;
-        if (!success || entityBox.findSpherePenetration(searchPosition, searchRadius, penetration)) {
-
-            glm::vec3 dimensions = entity->getDimensions();
-
-            // FIXME - consider allowing the entity to determine penetration so that
-            //         entities could presumably dull actuall hull testing if they wanted to
-            // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better in particular
-            //         can we handle the ellipsoid case better? We only currently handle perfect spheres
-            //         with centered registration points
-            if (entity->getShapeType() == SHAPE_TYPE_SPHERE &&
-                (dimensions.x == dimensions.y && dimensions.y == dimensions.z)) {
-
-                // NOTE: entity->getRadius() doesn't return the true radius, it returns the radius of the
-                //       maximum bounding sphere, which is actually larger than our actual radius
-                float entityTrueRadius = dimensions.x / 2.0f;
-
-                bool success;
-                if (findSphereSpherePenetration(searchPosition, searchRadius,
-                        entity->getCenterPosition(success), entityTrueRadius, penetration)) {
-                    if (success) {
-                        foundEntities.push_back(entity);
-                    }
-                }
-            } else {
-                // determine the worldToEntityMatrix that doesn't include scale because
-                // we're going to use the registration aware aa box in the entity frame
-                glm::mat4 rotation = glm::mat4_cast(entity->getRotation());
-                glm::mat4 translation = glm::translate(entity->getPosition());
-                glm::mat4 entityToWorldMatrix = translation * rotation;
-                glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
+    // determine the worldToEntityMatrix that doesn't include scale because
+    // we're going to use the registration aware aa box in the entity frame
+    glm::mat4 rotation = glm::mat4_cast(entity->getRotation());
+    glm::mat4 translation = glm::translate(entity->getPosition());
+    glm::mat4 entityToWorldMatrix = translation * rotation;
+    glm::mat4 worldToEntityMatrix = glm::inverse(entityToWorldMatrix);
 
-                glm::vec3 registrationPoint = entity->getRegistrationPoint();
-                glm::vec3 corner = -(dimensions * registrationPoint);
+    glm::vec3 registrationPoint = entity->getRegistrationPoint();
+    glm::vec3 corner = -(dimensions * registrationPoint);
 
-                AABox entityFrameBox(corner, dimensions);
+    AABox entityFrameBox(corner, dimensions);
 
-                glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(searchPosition, 1.0f));
-                if (entityFrameBox.findSpherePenetration(entityFrameSearchPosition, searchRadius, penetration)) {
-                    foundEntities.push_back(entity);
-                }
-            }
+    glm::vec3 entityFrameSearchPosition = glm::vec3(worldToEntityMatrix * glm::vec4(searchPosition, 1.0f));
+    return entityFrameBox.findSpherePenetration(entityFrameSearchPosition, searchRadius, penetration);
+}
+
+bool EntityTreeElement::entityTouchesCube(const EntityItemPointer& entity, const AACube& cube) {
+    bool success;
+    AABox entityBox = entity->getAABox(success);
+    // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better
+    // FIXME - consider allowing the entity to determine penetration so that
+    //         entities could presumably dull actuall hull testing if they wanted to
+    // FIXME - is there an easy way to translate the search cube into something in the
+    //         entity frame that can be easily tested against?
+    //         simple algorithm is probably:
+    //             if target box is fully inside search box == yes
+    //             if search box is fully inside target box == yes
+    //             for each face of search box:
+    //                 translate the triangles of the face into the box frame
+    //                 test the triangles of the face against the box?
+    //                 if translated search face triangle intersect target box
+    //                     add to result
+    //
+
+    // If the entities AABox touches the search cube then consider it to be found
+    return success && entityBox.touches(cube);
+}
+
+bool EntityTreeElement::entityTouchesBox(const EntityItemPointer& entity, const AABox& box) {
+    bool success;
+    AABox entityBox = entity->getAABox(success);
+    // FIXME - See FIXMEs for similar methods above.
+    return success && entityBox.touches(box);
+}
+
+bool EntityTreeElement::entityTouchesFrustum(const EntityItemPointer& entity, const ViewFrustum& frustum) {
+    bool success;
+    AABox entityBox = entity->getAABox(success);
+    // FIXME - See FIXMEs for similar methods above.
+    return success && (frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox));
+}
+
+void EntityTreeElement::getEntities(const glm::vec3& searchPosition, float searchRadius, QVector<EntityItemPointer>& foundEntities) const {
+    forEachEntity([&](EntityItemPointer entity) {
+        if (entityTouchesSphere(entity, searchPosition, searchRadius)) {
+            foundEntities.push_back(entity);
         }
     });
 }
 
 void EntityTreeElement::getEntities(const AACube& cube, QVector<EntityItemPointer>& foundEntities) {
     forEachEntity([&](EntityItemPointer entity) {
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-        // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better
-        // FIXME - consider allowing the entity to determine penetration so that
-        //         entities could presumably dull actuall hull testing if they wanted to
-        // FIXME - is there an easy way to translate the search cube into something in the
-        //         entity frame that can be easily tested against?
-        //         simple algorithm is probably:
-        //             if target box is fully inside search box == yes
-        //             if search box is fully inside target box == yes
-        //             for each face of search box:
-        //                 translate the triangles of the face into the box frame
-        //                 test the triangles of the face against the box?
-        //                 if translated search face triangle intersect target box
-        //                     add to result
-        //
-
-        // If the entities AABox touches the search cube then consider it to be found
-        if (!success || entityBox.touches(cube)) {
+        if (entityTouchesCube(entity, cube)) {
             foundEntities.push_back(entity);
         }
     });
@@ -834,25 +898,7 @@ void EntityTreeElement::getEntities(const AACube& cube, QVector<EntityItemPointe
 
 void EntityTreeElement::getEntities(const AABox& box, QVector<EntityItemPointer>& foundEntities) {
     forEachEntity([&](EntityItemPointer entity) {
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-        // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better
-        // FIXME - consider allowing the entity to determine penetration so that
-        //         entities could presumably dull actuall hull testing if they wanted to
-        // FIXME - is there an easy way to translate the search cube into something in the
-        //         entity frame that can be easily tested against?
-        //         simple algorithm is probably:
-        //             if target box is fully inside search box == yes
-        //             if search box is fully inside target box == yes
-        //             for each face of search box:
-        //                 translate the triangles of the face into the box frame
-        //                 test the triangles of the face against the box?
-        //                 if translated search face triangle intersect target box
-        //                     add to result
-        //
-
-        // If the entities AABox touches the search cube then consider it to be found
-        if (!success || entityBox.touches(box)) {
+        if (entityTouchesBox(entity, box)) {
             foundEntities.push_back(entity);
         }
     });
@@ -860,10 +906,7 @@ void EntityTreeElement::getEntities(const AABox& box, QVector<EntityItemPointer>
 
 void EntityTreeElement::getEntities(const ViewFrustum& frustum, QVector<EntityItemPointer>& foundEntities) {
     forEachEntity([&](EntityItemPointer entity) {
-        bool success;
-        AABox entityBox = entity->getAABox(success);
-        // FIXME - See FIXMEs for similar methods above.
-        if (!success || frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox)) {
+        if (entityTouchesFrustum(entity, frustum)) {
             foundEntities.push_back(entity);
         }
     });
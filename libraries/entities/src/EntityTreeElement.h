@@ -12,6 +12,7 @@
 #ifndef hifi_EntityTreeElement_h
 #define hifi_EntityTreeElement_h
 
+#include <functional>
 #include <memory>
 
 #include <OctreeElement.h>
@@ -155,6 +156,12 @@ public:
                          BoxFace& face, glm::vec3& surfaceNormal, const QVector<EntityItemID>& entityIdsToInclude,
                          const QVector<EntityItemID>& entityIdsToDiscard, bool visibleOnly, bool collidableOnly,
                          void** intersectedObject, bool precisionPicking, float distanceToElementCube);
+    // calls candidate with each entity that passes the filters and whose box the ray enters, along with the ray's
+    // intersection with the entity's own box, which is where the entity's detailed intersection starts from
+    void findRayIntersectionCandidates(const glm::vec3& origin, const glm::vec3& direction,
+                         const QVector<EntityItemID>& entityIdsToInclude, const QVector<EntityItemID>& entityIdsToDiscard,
+                         bool visibleOnly, bool collidableOnly,
+                         std::function<void(const EntityItemPointer&, const TriangleSet::RayHit&)> candidate);
     virtual bool findSpherePenetration(const glm::vec3& center, float radius,
                         glm::vec3& penetration, void** penetratedObject) const override;
 
@@ -178,6 +185,12 @@ public:
 
     EntityItemPointer getClosestEntity(glm::vec3 position) const;
 
+    /// the tests getEntities makes of each entity, also used by the visitor queries of EntityTree
+    static bool entityTouchesSphere(const EntityItemPointer& entity, const glm::vec3& position, float radius);
+    static bool entityTouchesCube(const EntityItemPointer& entity, const AACube& cube);
+    static bool entityTouchesBox(const EntityItemPointer& entity, const AABox& box);
+    static bool entityTouchesFrustum(const EntityItemPointer& entity, const ViewFrustum& frustum);
+
     /// finds all entities that touch a sphere
     /// \param position the center of the query sphere
     /// \param radius the radius of the query sphere
@@ -11,6 +11,9 @@
 
 #include "PolyVoxEntityItem.h"
 
+#include <cstring>
+#include <limits>
+
 #include <glm/gtx/transform.hpp>
 
 #include <QByteArray>
@@ -39,6 +42,8 @@ bool PolyVoxEntityItem::isEdged(PolyVoxSurfaceStyle surfaceStyle) {
 
 const glm::vec3 PolyVoxEntityItem::DEFAULT_VOXEL_VOLUME_SIZE = glm::vec3(32, 32, 32);
 const float PolyVoxEntityItem::MAX_VOXEL_DIMENSION = 128.0f;
+const int PolyVoxEntityItem::MAX_VOXEL_DATA_SIZE = 1150;
+const quint16 PolyVoxEntityItem::VOXEL_DELTA_MARKER = 0xffff;
 const QByteArray PolyVoxEntityItem::DEFAULT_VOXEL_DATA(PolyVoxEntityItem::makeEmptyVoxelData());
 const PolyVoxEntityItem::PolyVoxSurfaceStyle PolyVoxEntityItem::DEFAULT_VOXEL_SURFACE_STYLE =
     PolyVoxEntityItem::SURFACE_EDGED_CUBIC;
@@ -56,6 +61,11 @@ QByteArray PolyVoxEntityItem::makeEmptyVoxelData(quint16 voxelXSize, quint16 vox
     int rawSize = voxelXSize * voxelYSize * voxelZSize;
 
     QByteArray uncompressedData = QByteArray(rawSize, '\0');
+    return compressVoxelData(voxelXSize, voxelYSize, voxelZSize, uncompressedData);
+}
+
+QByteArray PolyVoxEntityItem::compressVoxelData(quint16 voxelXSize, quint16 voxelYSize, quint16 voxelZSize,
+                                                const QByteArray& uncompressedData) {
     QByteArray newVoxelData;
     QDataStream writer(&newVoxelData, QIODevice::WriteOnly | QIODevice::Truncate);
     writer << voxelXSize << voxelYSize << voxelZSize;
@@ -66,6 +76,77 @@ QByteArray PolyVoxEntityItem::makeEmptyVoxelData(quint16 voxelXSize, quint16 vox
     return newVoxelData;
 }
 
+bool PolyVoxEntityItem::isVoxelDelta(const QByteArray& voxelData) {
+    QDataStream reader(voxelData);
+    quint16 marker { 0 };
+    reader >> marker;
+    return reader.status() == QDataStream::Ok && marker == VOXEL_DELTA_MARKER;
+}
+
+QByteArray PolyVoxEntityItem::makeVoxelDelta(quint16 voxelXSize, quint16 voxelYSize, quint16 voxelZSize,
+                                             const VoxelChanges& changes) {
+    // neighboring voxels set to the same value, as by a sphere or a cuboid, go out as one run
+    QByteArray runs;
+    QDataStream runWriter(&runs, QIODevice::WriteOnly);
+    auto itr = changes.begin();
+    while (itr != changes.end()) {
+        quint32 start = itr->first;
+        quint8 value = itr->second;
+        quint16 length = 1;
+        for (++itr; itr != changes.end() && itr->first == start + length && itr->second == value &&
+             length < std::numeric_limits<quint16>::max(); ++itr) {
+            ++length;
+        }
+        runWriter << start << length << value;
+    }
+
+    QByteArray voxelDelta;
+    QDataStream writer(&voxelDelta, QIODevice::WriteOnly | QIODevice::Truncate);
+    writer << VOXEL_DELTA_MARKER << voxelXSize << voxelYSize << voxelZSize;
+    writer << qCompress(runs, 9);
+    return voxelDelta;
+}
+
+bool PolyVoxEntityItem::applyVoxelDelta(const QByteArray& voxelData, const QByteArray& voxelDelta, QByteArray& result) {
+    QDataStream deltaReader(voxelDelta);
+    quint16 marker, deltaXSize, deltaYSize, deltaZSize;
+    QByteArray compressedRuns;
+    deltaReader >> marker >> deltaXSize >> deltaYSize >> deltaZSize >> compressedRuns;
+    if (deltaReader.status() != QDataStream::Ok || marker != VOXEL_DELTA_MARKER) {
+        return false;
+    }
+
+    QDataStream reader(voxelData);
+    quint16 voxelXSize, voxelYSize, voxelZSize;
+    QByteArray compressedData;
+    reader >> voxelXSize >> voxelYSize >> voxelZSize >> compressedData;
+    if (reader.status() != QDataStream::Ok ||
+        voxelXSize != deltaXSize || voxelYSize != deltaYSize || voxelZSize != deltaZSize) {
+        return false;
+    }
+
+    QByteArray uncompressedData = qUncompress(compressedData);
+    quint32 rawSize = voxelXSize * voxelYSize * voxelZSize;
+    if ((quint32)uncompressedData.size() != rawSize) {
+        return false;
+    }
+
+    QDataStream runReader(qUncompress(compressedRuns));
+    while (!runReader.atEnd()) {
+        quint32 start;
+        quint16 length;
+        quint8 value;
+        runReader >> start >> length >> value;
+        if (runReader.status() != QDataStream::Ok || start >= rawSize || length > rawSize - start) {
+            return false;
+        }
+        memset(uncompressedData.data() + start, value, length);
+    }
+
+    result = compressVoxelData(voxelXSize, voxelYSize, voxelZSize, uncompressedData);
+    return result.size() <= MAX_VOXEL_DATA_SIZE;
+}
+
 PolyVoxEntityItem::PolyVoxEntityItem(const EntityItemID& entityItemID) : EntityItem(entityItemID) {
     _type = EntityTypes::PolyVox;
 }
@@ -235,7 +316,17 @@ void PolyVoxEntityItem::debugDump() const {
 
 void PolyVoxEntityItem::setVoxelData(const QByteArray& voxelData) {
     withWriteLock([&] {
-        _voxelData = voxelData;
+        if (isVoxelDelta(voxelData)) {
+            // an edit, apply it to the volume we already have
+            QByteArray newVoxelData;
+            if (!applyVoxelDelta(_voxelData, voxelData, newVoxelData)) {
+                qCDebug(entities) << "Ignoring voxel edit that does not apply to" << getID();
+                return;
+            }
+            _voxelData = newVoxelData;
+        } else {
+            _voxelData = voxelData;
+        }
         _voxelDataDirty = true;
     });
 }
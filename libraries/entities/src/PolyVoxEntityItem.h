@@ -12,6 +12,8 @@
 #ifndef hifi_PolyVoxEntityItem_h
 #define hifi_PolyVoxEntityItem_h
 
+#include <map>
+
 #include "EntityItem.h"
 
 class PolyVoxEntityItem : public EntityItem {
@@ -101,6 +103,21 @@ class PolyVoxEntityItem : public EntityItem {
     virtual bool setVoxel(const ivec3& v, uint8_t toValue) { return false; }
 
     static QByteArray makeEmptyVoxelData(quint16 voxelXSize = 16, quint16 voxelYSize = 16, quint16 voxelZSize = 16);
+    static QByteArray compressVoxelData(quint16 voxelXSize, quint16 voxelYSize, quint16 voxelZSize,
+                                        const QByteArray& uncompressedData);
+
+    // the largest voxelData that fits in an edit packet
+    static const int MAX_VOXEL_DATA_SIZE;
+
+    // Voxel edits are sent to the entity-server as sparse deltas rather than as the whole volume.  A delta is a
+    // voxelData value that starts with VOXEL_DELTA_MARKER, where a volume starts with its x size, followed by runs of
+    // changed voxels.  Voxels are indexed by their offset in the uncompressed voxel data.
+    using VoxelChanges = std::map<quint32, uint8_t>;
+    static const quint16 VOXEL_DELTA_MARKER;
+    static bool isVoxelDelta(const QByteArray& voxelData);
+    static QByteArray makeVoxelDelta(quint16 voxelXSize, quint16 voxelYSize, quint16 voxelZSize, const VoxelChanges& changes);
+    // returns false if the delta is damaged, is for a volume of another size, or makes the volume too large to send
+    static bool applyVoxelDelta(const QByteArray& voxelData, const QByteArray& voxelDelta, QByteArray& result);
 
     static const QString DEFAULT_X_TEXTURE_URL;
     void setXTextureURL(const QString& xTextureURL);
@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <atomic>
 #include <iostream>
 #include <QBuffer>
 #include <QDataStream>
@@ -18,6 +19,8 @@
 #include <QtDebug>
 #include <QtEndian>
 #include <QFileInfo>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -303,6 +306,51 @@ FBXBlendshape extractBlendshape(const FBXNode& object) {
     return blendshape;
 }
 
+// Meshes only depend on their own geometry nodes, so all the mesh geometries of the objects are extracted up front by
+// jobs of the thread pool, in the order and with the mesh indices the object loop hands out.  Models that are meshes as
+// well, in old files, keep their place in the count and are still extracted by the loop.
+QVector<ExtractedMesh> extractMeshes(const FBXNodeList& objects, unsigned int meshIndex) {
+    QVector<const FBXNode*> meshObjects;
+    QVector<unsigned int> meshIndices;
+    for (const FBXNode& object : objects) {
+        if (object.name == "Geometry") {
+            if (object.properties.at(2) == "Mesh") {
+                meshObjects.append(&object);
+                meshIndices.append(meshIndex++);
+            }
+        } else if (object.name == "Model") {
+            for (const FBXNode& subobject : object.children) {
+                if (subobject.name == "Vertices") {
+                    meshIndex++;
+                }
+            }
+        }
+    }
+
+    // meshes vary too much in size for even runs, so every job takes the next mesh nobody has started on
+    QVector<ExtractedMesh> extractedMeshes(meshObjects.size());
+    ExtractedMesh* extracted = extractedMeshes.data();
+    std::atomic<int> nextMesh { 0 };
+    auto extract = [&] {
+        for (int i = nextMesh++; i < meshObjects.size(); i = nextMesh++) {
+            unsigned int index = meshIndices.at(i);
+            extracted[i] = FBXReader::extractMesh(*meshObjects.at(i), index);
+        }
+    };
+
+    auto threadPool = QThreadPool::globalInstance();
+    int numJobs = std::min(threadPool->maxThreadCount() + 1, meshObjects.size());
+    std::vector<QFuture<void>> jobs;
+    for (int i = 1; i < numJobs; i++) {
+        jobs.push_back(QtConcurrent::run(threadPool, extract));
+    }
+    extract();
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+    return extractedMeshes;
+}
+
 
 void setTangents(FBXMesh& mesh, int firstIndex, int secondIndex) {
     const glm::vec3& normal = mesh.normals.at(firstIndex);
@@ -594,10 +642,13 @@ FBXGeometry* FBXReader::extractFBXGeometry(const QVariantHash& mapping, const QS
                 }
             }
         } else if (child.name == "Objects") {
+            QVector<ExtractedMesh> extractedMeshes = extractMeshes(child.children, meshIndex);
+            int nextExtractedMesh = 0;
             foreach (const FBXNode& object, child.children) {
                 if (object.name == "Geometry") {
                     if (object.properties.at(2) == "Mesh") {
-                        meshes.insert(getID(object.properties), extractMesh(object, meshIndex));
+                        meshes.insert(getID(object.properties), extractedMeshes.at(nextExtractedMesh++));
+                        meshIndex++;
                     } else { // object.properties.at(2) == "Shape"
                         ExtractedBlendshape extracted = { getID(object.properties), extractBlendshape(object) };
                         blendshapes.append(extracted);
@@ -1756,6 +1807,9 @@ FBXGeometry* FBXReader::extractFBXGeometry(const QVariantHash& mapping, const QS
             }
         }
         buildModelMesh(extracted.mesh, url);
+        if (!_keepRenderAttributes) {
+            releaseRenderAttributes(extracted.mesh);
+        }
 
         geometry.meshes.append(extracted.mesh);
         int meshIndex = geometry.meshes.size() - 1;
@@ -1831,17 +1885,20 @@ FBXGeometry* FBXReader::extractFBXGeometry(const QVariantHash& mapping, const QS
     return geometryPtr;
 }
 
-FBXGeometry* readFBX(const QByteArray& model, const QVariantHash& mapping, const QString& url, bool loadLightmaps, float lightmapLevel) {
+FBXGeometry* readFBX(const QByteArray& model, const QVariantHash& mapping, const QString& url, bool loadLightmaps, float lightmapLevel,
+        bool keepRenderAttributes) {
     QBuffer buffer(const_cast<QByteArray*>(&model));
     buffer.open(QIODevice::ReadOnly);
-    return readFBX(&buffer, mapping, url, loadLightmaps, lightmapLevel);
+    return readFBX(&buffer, mapping, url, loadLightmaps, lightmapLevel, keepRenderAttributes);
 }
 
-FBXGeometry* readFBX(QIODevice* device, const QVariantHash& mapping, const QString& url, bool loadLightmaps, float lightmapLevel) {
+FBXGeometry* readFBX(QIODevice* device, const QVariantHash& mapping, const QString& url, bool loadLightmaps, float lightmapLevel,
+        bool keepRenderAttributes) {
     FBXReader reader;
     reader._rootNode = FBXReader::parseFBX(device);
     reader._loadLightmaps = loadLightmaps;
     reader._lightmapLevel = lightmapLevel;
+    reader._keepRenderAttributes = keepRenderAttributes;
 
     qDebug() << "Reading FBX: " << url;
 
@@ -35,12 +35,14 @@ class FBXNode;
 
 
 /// Reads FBX geometry from the supplied model and mapping data.
+/// Unless keepRenderAttributes is set, the meshes only keep the attributes that are used on the CPU once their gpu
+/// buffers are built: see FBXReader::releaseRenderAttributes.
 /// \exception QString if an error occurs in parsing
-FBXGeometry* readFBX(const QByteArray& model, const QVariantHash& mapping, const QString& url = "", bool loadLightmaps = true, float lightmapLevel = 1.0f);
+FBXGeometry* readFBX(const QByteArray& model, const QVariantHash& mapping, const QString& url = "", bool loadLightmaps = true, float lightmapLevel = 1.0f, bool keepRenderAttributes = true);
 
 /// Reads FBX geometry from the supplied model and mapping data.
 /// \exception QString if an error occurs in parsing
-FBXGeometry* readFBX(QIODevice* device, const QVariantHash& mapping, const QString& url = "", bool loadLightmaps = true, float lightmapLevel = 1.0f);
+FBXGeometry* readFBX(QIODevice* device, const QVariantHash& mapping, const QString& url = "", bool loadLightmaps = true, float lightmapLevel = 1.0f, bool keepRenderAttributes = true);
 
 class TextureParam {
 public:
@@ -113,6 +115,8 @@ public:
     static ExtractedMesh extractMesh(const FBXNode& object, unsigned int& meshIndex, bool deduplicate = true);
     QHash<QString, ExtractedMesh> meshes;
     static void buildModelMesh(FBXMesh& extractedMesh, const QString& url);
+    // drops the attributes only the gpu buffers of a built mesh need, like the texture coordinates and skinning weights
+    static void releaseRenderAttributes(FBXMesh& mesh);
 
     FBXTexture getTexture(const QString& textureID);
 
@@ -145,6 +149,7 @@ public:
     void consolidateFBXMaterials(const QVariantHash& mapping);
 
     bool _loadLightmaps = true;
+    bool _keepRenderAttributes = true;
     float _lightmapOffset = 0.0f;
     float _lightmapLevel;
 
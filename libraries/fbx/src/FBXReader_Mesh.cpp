@@ -53,6 +53,28 @@ bool operator==(const Vertex& v1, const Vertex& v2) {
     return v1.originalIndex == v2.originalIndex && v1.texCoord == v2.texCoord && v1.texCoord1 == v2.texCoord1;
 }
 
+// Copies a decoded draco attribute to the vertices of an extracted mesh.  Floats of the right size, which is what the
+// baker writes, are copied as they are, in one go when every point has its own value; anything else goes through draco's
+// conversion one value at a time.
+template <typename T, int N>
+void copyDracoAttribute(const draco::PointAttribute* attribute, int numVertices, T* output) {
+    static_assert(sizeof(T) == N * sizeof(float), "draco attributes are copied to vectors of floats");
+    if (attribute->data_type() == draco::DT_FLOAT32 && attribute->num_components() == N &&
+            attribute->byte_stride() == (int64_t)sizeof(T)) {
+        if (attribute->is_mapping_identity() && attribute->size() >= (size_t)numVertices) {
+            memcpy(output, attribute->GetAddress(draco::AttributeValueIndex(0)), numVertices * sizeof(T));
+        } else {
+            for (int i = 0; i < numVertices; ++i) {
+                memcpy(&output[i], attribute->GetAddress(attribute->mapped_index(draco::PointIndex(i))), sizeof(T));
+            }
+        }
+        return;
+    }
+    for (int i = 0; i < numVertices; ++i) {
+        attribute->ConvertValue<float, N>(attribute->mapped_index(draco::PointIndex(i)), reinterpret_cast<float*>(&output[i]));
+    }
+}
+
 class AttributeData {
 public:
     QVector<glm::vec2> texCoords;
@@ -341,11 +363,11 @@ ExtractedMesh FBXReader::extractMesh(const FBXNode& object, unsigned int& meshIn
             isDracoMesh = true;
             data.extracted.mesh.wasCompressed = true;
 
-            // load the draco mesh from the FBX and create a draco::Mesh
+            // load the draco mesh from the FBX and create a draco::Mesh, decoding straight from the node's bytes
             draco::Decoder decoder;
             draco::DecoderBuffer decodedBuffer;
             QByteArray dracoArray = child.properties.at(0).value<QByteArray>();
-            decodedBuffer.Init(dracoArray.data(), dracoArray.size());
+            decodedBuffer.Init(dracoArray.constData(), dracoArray.size());
 
             std::unique_ptr<draco::Mesh> dracoMesh(new draco::Mesh());
             decoder.DecodeBufferToGeometry(&decodedBuffer, dracoMesh.get());
@@ -360,74 +382,43 @@ ExtractedMesh FBXReader::extractMesh(const FBXNode& object, unsigned int& meshIn
             auto originalIndexAttribute = dracoMesh->GetAttributeByUniqueId(DRACO_ATTRIBUTE_ORIGINAL_INDEX);
 
             // setup extracted mesh data structures given number of points
-            auto numVertices = dracoMesh->num_points();
+            int numVertices = (int)dracoMesh->num_points();
 
             QHash<QPair<int, int>, int> materialTextureParts;
 
             data.extracted.mesh.vertices.resize(numVertices);
 
+            // copy each attribute to the extracted mesh in one pass
+            if (positionAttribute) {
+                copyDracoAttribute<glm::vec3, 3>(positionAttribute, numVertices, data.extracted.mesh.vertices.data());
+            }
+
             if (normalAttribute) {
                 data.extracted.mesh.normals.resize(numVertices);
+                copyDracoAttribute<glm::vec3, 3>(normalAttribute, numVertices, data.extracted.mesh.normals.data());
             }
 
             if (texCoordAttribute) {
                 data.extracted.mesh.texCoords.resize(numVertices);
+                copyDracoAttribute<glm::vec2, 2>(texCoordAttribute, numVertices, data.extracted.mesh.texCoords.data());
             }
 
             if (extraTexCoordAttribute) {
+                // some meshes have a second set of UVs
                 data.extracted.mesh.texCoords1.resize(numVertices);
+                copyDracoAttribute<glm::vec2, 2>(extraTexCoordAttribute, numVertices,
+                                                 data.extracted.mesh.texCoords1.data());
             }
 
             if (colorAttribute) {
                 data.extracted.mesh.colors.resize(numVertices);
+                copyDracoAttribute<glm::vec3, 3>(colorAttribute, numVertices, data.extracted.mesh.colors.data());
             }
 
-            // enumerate the vertices and construct the extracted mesh
+            data.extracted.newIndices.reserve(numVertices);
             for (int i = 0; i < numVertices; ++i) {
-                draco::PointIndex vertexIndex(i);
-
-                if (positionAttribute) {
-                    // read position from draco mesh to extracted mesh
-                    auto mappedIndex = positionAttribute->mapped_index(vertexIndex);
-
-                    positionAttribute->ConvertValue<float, 3>(mappedIndex,
-                                                              reinterpret_cast<float*>(&data.extracted.mesh.vertices[i]));
-                }
-
-                if (normalAttribute) {
-                    // read normals from draco mesh to extracted mesh
-                    auto mappedIndex = normalAttribute->mapped_index(vertexIndex);
-
-                    normalAttribute->ConvertValue<float, 3>(mappedIndex,
-                                                            reinterpret_cast<float*>(&data.extracted.mesh.normals[i]));
-                }
-
-                if (texCoordAttribute) {
-                    // read UVs from draco mesh to extracted mesh
-                    auto mappedIndex = texCoordAttribute->mapped_index(vertexIndex);
-
-                    texCoordAttribute->ConvertValue<float, 2>(mappedIndex,
-                                                              reinterpret_cast<float*>(&data.extracted.mesh.texCoords[i]));
-                }
-
-                if (extraTexCoordAttribute) {
-                    // some meshes have a second set of UVs, read those to extracted mesh
-                    auto mappedIndex = extraTexCoordAttribute->mapped_index(vertexIndex);
-
-                    extraTexCoordAttribute->ConvertValue<float, 2>(mappedIndex,
-                                                                   reinterpret_cast<float*>(&data.extracted.mesh.texCoords1[i]));
-                }
-
-                if (colorAttribute) {
-                    // read vertex colors from draco mesh to extracted mesh
-                    auto mappedIndex = colorAttribute->mapped_index(vertexIndex);
-
-                    colorAttribute->ConvertValue<float, 3>(mappedIndex,
-                                                           reinterpret_cast<float*>(&data.extracted.mesh.colors[i]));
-                }
-
                 if (originalIndexAttribute) {
-                    auto mappedIndex = originalIndexAttribute->mapped_index(vertexIndex);
+                    auto mappedIndex = originalIndexAttribute->mapped_index(draco::PointIndex(i));
 
                     int32_t originalIndex;
 
@@ -439,7 +430,11 @@ ExtractedMesh FBXReader::extractMesh(const FBXNode& object, unsigned int& meshIn
                 }
             }
 
-            for (int i = 0; i < dracoMesh->num_faces(); ++i) {
+            // faces come grouped by material, so the part is only looked up again when the material changes
+            int numFaces = (int)dracoMesh->num_faces();
+            int partIndex = -1;
+            uint16_t partMaterialID { 0 };
+            for (int i = 0; i < numFaces; ++i) {
                 // grab the material ID and texture ID for this face, if we have it
                 auto& dracoFace = dracoMesh->face(draco::FaceIndex(i));
                 auto& firstCorner = dracoFace[0];
@@ -453,18 +448,26 @@ ExtractedMesh FBXReader::extractMesh(const FBXNode& object, unsigned int& meshIn
                     materialIDAttribute->ConvertValue<uint16_t, 1>(mappedIndex, &materialID);
                 }
 
-                QPair<int, int> materialTexture(materialID, 0);
-
-                // grab or setup the FBXMeshPart for the part this face belongs to
-                int& partIndexPlusOne = materialTextureParts[materialTexture];
-                if (partIndexPlusOne == 0) {
-                    data.extracted.partMaterialTextures.append(materialTexture);
-                    data.extracted.mesh.parts.resize(data.extracted.mesh.parts.size() + 1);
-                    partIndexPlusOne = data.extracted.mesh.parts.size();
+                if (partIndex == -1 || materialID != partMaterialID) {
+                    QPair<int, int> materialTexture(materialID, 0);
+
+                    // grab or setup the FBXMeshPart for the part this face belongs to
+                    int& partIndexPlusOne = materialTextureParts[materialTexture];
+                    if (partIndexPlusOne == 0) {
+                        data.extracted.partMaterialTextures.append(materialTexture);
+                        data.extracted.mesh.parts.resize(data.extracted.mesh.parts.size() + 1);
+                        partIndexPlusOne = data.extracted.mesh.parts.size();
+                        if (!materialIDAttribute) {
+                            // every face goes to this one part
+                            data.extracted.mesh.parts.last().triangleIndices.reserve(numFaces * 3);
+                        }
+                    }
+                    partIndex = partIndexPlusOne - 1;
+                    partMaterialID = materialID;
                 }
 
                 // give the mesh part this index
-                FBXMeshPart& part = data.extracted.mesh.parts[partIndexPlusOne - 1];
+                FBXMeshPart& part = data.extracted.mesh.parts[partIndex];
                 part.triangleIndices.append(firstCorner.value());
                 part.triangleIndices.append(dracoFace[1].value());
                 part.triangleIndices.append(dracoFace[2].value());
@@ -594,29 +597,32 @@ void FBXReader::buildModelMesh(FBXMesh& extractedMesh, const QString& url) {
     int clusterWeightsOffset = clusterIndicesOffset + clusterIndicesSize;
     int totalAttributeSize = clusterWeightsOffset + clusterWeightsSize;
 
-    // Copy all attribute data in a single attribute buffer
+    // Copy all attribute data in a single attribute buffer, written in place
     auto attribBuffer = std::make_shared<gpu::Buffer>();
-    attribBuffer->resize(totalAttributeSize);
-    attribBuffer->setSubData(normalsOffset, normalsSize, (gpu::Byte*) fbxMesh.normals.constData());
-    attribBuffer->setSubData(tangentsOffset, tangentsSize, (gpu::Byte*) fbxMesh.tangents.constData());
-    attribBuffer->setSubData(colorsOffset, colorsSize, (gpu::Byte*) fbxMesh.colors.constData());
-    attribBuffer->setSubData(texCoordsOffset, texCoordsSize, (gpu::Byte*) fbxMesh.texCoords.constData());
-    attribBuffer->setSubData(texCoords1Offset, texCoords1Size, (gpu::Byte*) fbxMesh.texCoords1.constData());
+    gpu::Byte* attribData = attribBuffer->overwrite(totalAttributeSize);
+    auto copyAttribute = [attribData](int offset, int size, const void* data) {
+        if (size) {
+            memcpy(attribData + offset, data, size);
+        }
+    };
+    copyAttribute(normalsOffset, normalsSize, fbxMesh.normals.constData());
+    copyAttribute(tangentsOffset, tangentsSize, fbxMesh.tangents.constData());
+    copyAttribute(colorsOffset, colorsSize, fbxMesh.colors.constData());
+    copyAttribute(texCoordsOffset, texCoordsSize, fbxMesh.texCoords.constData());
+    copyAttribute(texCoords1Offset, texCoords1Size, fbxMesh.texCoords1.constData());
 
     if (fbxMesh.clusters.size() < UINT8_MAX) {
         // yay! we can fit the clusterIndices within 8-bits
         int32_t numIndices = fbxMesh.clusterIndices.size();
-        QVector<uint8_t> clusterIndices;
-        clusterIndices.resize(numIndices);
+        uint8_t* clusterIndices = attribData + clusterIndicesOffset;
         for (int32_t i = 0; i < numIndices; ++i) {
             assert(fbxMesh.clusterIndices[i] <= UINT8_MAX);
             clusterIndices[i] = (uint8_t)(fbxMesh.clusterIndices[i]);
         }
-        attribBuffer->setSubData(clusterIndicesOffset, clusterIndicesSize, (gpu::Byte*) clusterIndices.constData());
     } else {
-        attribBuffer->setSubData(clusterIndicesOffset, clusterIndicesSize, (gpu::Byte*) fbxMesh.clusterIndices.constData());
+        copyAttribute(clusterIndicesOffset, clusterIndicesSize, fbxMesh.clusterIndices.constData());
     }
-    attribBuffer->setSubData(clusterWeightsOffset, clusterWeightsSize, (gpu::Byte*) fbxMesh.clusterWeights.constData());
+    copyAttribute(clusterWeightsOffset, clusterWeightsSize, fbxMesh.clusterWeights.constData());
 
     if (normalsSize) {
         mesh->addAttribute(gpu::Stream::NORMAL,
@@ -728,3 +734,20 @@ void FBXReader::buildModelMesh(FBXMesh& extractedMesh, const QString& url) {
 
     extractedMesh._mesh = mesh;
 }
+
+void FBXReader::releaseRenderAttributes(FBXMesh& mesh) {
+    if (!mesh._mesh) {
+        return;
+    }
+
+    // the vertices and the parts stay for picking and physics, the normals for blending the blendshapes, and the
+    // tangents because the render items pick their shaders by them
+    if (mesh.blendshapes.isEmpty()) {
+        mesh.normals = QVector<glm::vec3>();
+    }
+    mesh.colors = QVector<glm::vec3>();
+    mesh.texCoords = QVector<glm::vec2>();
+    mesh.texCoords1 = QVector<glm::vec2>();
+    mesh.clusterIndices = QVector<uint16_t>();
+    mesh.clusterWeights = QVector<uint8_t>();
+}
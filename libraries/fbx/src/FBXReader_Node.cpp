@@ -11,215 +11,297 @@
 
 #include "FBXReader.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+
+#include <zlib.h>
+
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QBuffer>
-#include <QtCore/QDataStream>
 #include <QtCore/QIODevice>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 #include <QtCore/QDebug>
 #include <QtCore/QtEndian>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
 
 #include <shared/NsightHelpers.h>
 #include "ModelFormatLogging.h"
 
-template<class T>
-int streamSize() {
-    return sizeof(T);
-}
+// Reads the little endian values of a binary FBX file from memory, checking every read against the end of the file.
+class BinaryReader {
+public:
+    BinaryReader(const char* data, qint64 size) : _data(data), _size(size) { }
 
-template<bool>
-int streamSize() {
-    return 1;
-}
+    qint64 position { 0 };
 
-template<class T>
-QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
-
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-    position += sizeof(quint32) * 3;
-
-    QVector<T> values;
-    if ((int)QSysInfo::ByteOrder == (int)in.byteOrder()) {
-        values.resize(arrayLength);
-        QByteArray arrayData;
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            arrayData = qUncompress(compressed);
-            if (arrayData.isEmpty() ||
-                (unsigned int)arrayData.size() != (sizeof(T) * arrayLength)) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-        } else {
-            arrayData.resize(sizeof(T) * arrayLength);
-            position += sizeof(T) * arrayLength;
-            in.readRawData(arrayData.data(), arrayData.size());
+    const char* readRaw(qint64 length) {
+        if (length < 0 || length > _size - position) {
+            throw QString("corrupt fbx file");
         }
+        const char* data = _data + position;
+        position += length;
+        return data;
+    }
 
-        if (arrayData.size() > 0) {
-            memcpy(&values[0], arrayData.constData(), arrayData.size());
+    template<class T>
+    T read() {
+        T value;
+        memcpy(&value, readRaw(sizeof(T)), sizeof(T));
+        fromLittleEndian(&value, 1);
+        return value;
+    }
+
+    template<class T>
+    static void fromLittleEndian(T* values, qint64 count) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        for (qint64 i = 0; i < count; i++) {
+            char* bytes = reinterpret_cast<char*>(values + i);
+            std::reverse(bytes, bytes + sizeof(T));
         }
-    } else {
-        values.reserve(arrayLength);
-        if (encoding == FBX_PROPERTY_COMPRESSED_FLAG) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            QByteArray uncompressed = qUncompress(compressed);
-            if (uncompressed.isEmpty()) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-            QDataStream uncompressedIn(uncompressed);
-            uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-            uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                uncompressedIn >> value;
-                values.append(value);
-            }
+#else
+        Q_UNUSED(values);
+        Q_UNUSED(count);
+#endif
+    }
+
+private:
+    const char* _data;
+    qint64 _size;
+};
+
+// deflate can't do better than about 1032:1, so a compressed array claiming more is corrupt
+static const quint64 MAX_DEFLATE_RATIO = 1032;
+static const quint64 MAX_ARRAY_BYTES = std::numeric_limits<int>::max();
+
+// inflates the zlib stream of a compressed array straight into the storage of the array, which it has to fill exactly
+static void inflateArray(const char* compressed, quint32 compressedLength, char* output, quint64 outputLength) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) {
+        throw QString("corrupt fbx file");
+    }
+    stream.next_in = (Bytef*)compressed;
+    stream.avail_in = compressedLength;
+    stream.next_out = (Bytef*)output;
+    stream.avail_out = (uInt)outputLength;
+    bool complete = inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.avail_out == 0;
+    inflateEnd(&stream);
+    if (!complete) {
+        throw QString("corrupt fbx file");
+    }
+}
+
+template<class T>
+QVariant readBinaryArray(BinaryReader& in) {
+    quint32 arrayLength = in.read<quint32>();
+    quint32 encoding = in.read<quint32>();
+    quint32 compressedLength = in.read<quint32>();
+
+    bool compressed = (encoding == FBX_PROPERTY_COMPRESSED_FLAG);
+    quint64 byteLength = (quint64)arrayLength * sizeof(T);
+    const char* data = in.readRaw(compressed ? compressedLength : byteLength);
+    if (byteLength > MAX_ARRAY_BYTES || (compressed && byteLength > compressedLength * MAX_DEFLATE_RATIO)) {
+        throw QString("corrupt fbx file");
+    }
+
+    QVector<T> values(arrayLength);
+    if (arrayLength > 0) {
+        char* output = reinterpret_cast<char*>(values.data());
+        if (compressed) {
+            inflateArray(data, compressedLength, output, byteLength);
         } else {
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                in >> value;
-                position += streamSize<T>();
-                values.append(value);
-            }
+            memcpy(output, data, byteLength);
         }
+        BinaryReader::fromLittleEndian(values.data(), arrayLength);
     }
     return QVariant::fromValue(values);
 }
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+QVariant parseBinaryFBXProperty(BinaryReader& in) {
+    char ch = in.read<char>();
     switch (ch) {
         case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint16>());
         }
         case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<quint8>() != 0);
         }
         case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint32>());
         }
         case 'F': {
-            float value;
-            in >> value;
-            position += sizeof(float);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<float>());
         }
         case 'D': {
-            double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<double>());
         }
         case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint64>());
         }
         case 'f': {
-            return readBinaryArray<float>(in, position);
+            return readBinaryArray<float>(in);
         }
         case 'd': {
-            return readBinaryArray<double>(in, position);
+            return readBinaryArray<double>(in);
         }
         case 'l': {
-            return readBinaryArray<qint64>(in, position);
+            return readBinaryArray<qint64>(in);
         }
         case 'i': {
-            return readBinaryArray<qint32>(in, position);
+            return readBinaryArray<qint32>(in);
         }
         case 'b': {
-            return readBinaryArray<bool>(in, position);
+            return readBinaryArray<bool>(in);
         }
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = in.read<quint32>();
+            return QVariant::fromValue(QByteArray(in.readRaw(length), (int)length));
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPositions = false) {
+class BinaryNodeHeader {
+public:
     qint64 endOffset;
     quint64 propertyCount;
     quint64 propertyListLength;
     quint8 nameLength;
 
+    bool isNull() const {
+        const int MIN_VALID_OFFSET = 40;
+        return endOffset < MIN_VALID_OFFSET || nameLength == 0;
+    }
+};
+
+BinaryNodeHeader readBinaryFBXNodeHeader(BinaryReader& in, bool has64BitPositions) {
+    BinaryNodeHeader header;
+
     // FBX 2016 and beyond uses 64bit positions in the node headers, pre-2016 used 32bit values
     // our code generally doesn't care about the size that much, so we will use 64bit values
     // from here on out, but if the file is an older format we read the stream into temp 32bit 
     // values and then assign to our actual 64bit values.
     if (has64BitPositions) {
-        in >> endOffset;
-        in >> propertyCount;
-        in >> propertyListLength;
-        position += sizeof(quint64) * 3;
+        header.endOffset = in.read<qint64>();
+        header.propertyCount = in.read<quint64>();
+        header.propertyListLength = in.read<quint64>();
     } else {
-        qint32 tempEndOffset;
-        quint32 tempPropertyCount;
-        quint32 tempPropertyListLength;
-        in >> tempEndOffset;
-        in >> tempPropertyCount;
-        in >> tempPropertyListLength;
-        position += sizeof(quint32) * 3;
-        endOffset = tempEndOffset;
-        propertyCount = tempPropertyCount;
-        propertyListLength = tempPropertyListLength;
-    }
-    in >> nameLength;
-    position += sizeof(quint8);
+        header.endOffset = in.read<qint32>();
+        header.propertyCount = in.read<quint32>();
+        header.propertyListLength = in.read<quint32>();
+    }
+    header.nameLength = in.read<quint8>();
+    return header;
+}
+
+FBXNode parseBinaryFBXNode(BinaryReader& in, bool has64BitPositions, bool isTopLevel = false);
+
+void parseBinaryFBXChildren(BinaryReader& in, qint64 endOffset, bool has64BitPositions, FBXNodeList& children) {
+    while (endOffset > in.position) {
+        FBXNode child = parseBinaryFBXNode(in, has64BitPositions);
+        if (child.name.isNull()) {
+            return;
+
+        } else {
+            children.append(child);
+        }
+    }
+}
+
+static const qint64 MIN_BYTES_PER_JOB = 1024 * 1024;
+
+// The children of a top level node, like the Objects or the Connections, are independent of each other in the file, so
+// the children of a big one are split in contiguous runs of about the same size, found by hopping from header to header,
+// and each run is parsed by a job of the thread pool, the calling thread taking the first one.
+void parseBinaryFBXChildrenInParallel(BinaryReader& in, qint64 endOffset, bool has64BitPositions, FBXNodeList& children) {
+    qint64 numBytes = endOffset - in.position;
+    qint64 maxJobs = QThreadPool::globalInstance()->maxThreadCount() + 1;
+    qint64 numJobs = std::min(maxJobs, numBytes / MIN_BYTES_PER_JOB);
+    if (numJobs < 2) {
+        parseBinaryFBXChildren(in, endOffset, has64BitPositions, children);
+        return;
+    }
+
+    std::vector<qint64> runOffsets { in.position };
+    qint64 bytesPerJob = numBytes / numJobs;
+    BinaryReader scanner(in);
+    while (endOffset > scanner.position) {
+        qint64 childOffset = scanner.position;
+        BinaryNodeHeader header = readBinaryFBXNodeHeader(scanner, has64BitPositions);
+        if (header.isNull()) {
+            break;
+        }
+        if (header.endOffset <= scanner.position) {
+            throw QString("corrupt fbx file");
+        }
+        if (childOffset - runOffsets.back() >= bytesPerJob) {
+            runOffsets.push_back(childOffset);
+        }
+        scanner.position = header.endOffset;
+    }
+
+    size_t numRuns = runOffsets.size();
+    std::vector<FBXNodeList> runChildren(numRuns);
+    std::vector<QString> runErrors(numRuns);
+    qint64 lastRunEnd = in.position;
+    auto parseRun = [&](size_t run) {
+        BinaryReader reader(in);
+        reader.position = runOffsets[run];
+        qint64 runEnd = (run + 1 < numRuns) ? runOffsets[run + 1] : endOffset;
+        try {
+            parseBinaryFBXChildren(reader, runEnd, has64BitPositions, runChildren[run]);
+        } catch (const QString& error) {
+            runErrors[run] = error;
+        }
+        if (run + 1 == numRuns) {
+            lastRunEnd = reader.position;
+        }
+    };
+
+    auto threadPool = QThreadPool::globalInstance();
+    std::vector<QFuture<void>> jobs;
+    for (size_t run = 1; run < numRuns; run++) {
+        jobs.push_back(QtConcurrent::run(threadPool, [&parseRun, run] {
+            parseRun(run);
+        }));
+    }
+    parseRun(0);
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+
+    for (size_t run = 0; run < numRuns; run++) {
+        if (!runErrors[run].isNull()) {
+            throw runErrors[run];
+        }
+        children.append(runChildren[run]);
+    }
+    in.position = lastRunEnd;
+}
+
+FBXNode parseBinaryFBXNode(BinaryReader& in, bool has64BitPositions, bool isTopLevel) {
+    BinaryNodeHeader header = readBinaryFBXNodeHeader(in, has64BitPositions);
 
     FBXNode node;
-    const int MIN_VALID_OFFSET = 40;
-    if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
+    if (header.isNull()) {
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
+    node.name = QByteArray(in.readRaw(header.nameLength), header.nameLength);
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    for (quint64 i = 0; i < header.propertyCount; i++) {
+        node.properties.append(parseBinaryFBXProperty(in));
     }
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position, has64BitPositions);
-        if (child.name.isNull()) {
-            return node;
-
-        } else {
-            node.children.append(child);
-        }
+    if (isTopLevel) {
+        parseBinaryFBXChildrenInParallel(in, header.endOffset, has64BitPositions, node.children);
+    } else {
+        parseBinaryFBXChildren(in, header.endOffset, has64BitPositions, node.children);
     }
 
     return node;
@@ -366,9 +448,17 @@ FBXNode FBXReader::parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+    // parse the whole file from memory, without copying it if it is already there
+    QByteArray data;
+    qint64 dataOffset = 0;
+    auto buffer = qobject_cast<QBuffer*>(device);
+    if (buffer) {
+        data = buffer->data();
+        dataOffset = buffer->pos();
+    } else {
+        data = device->readAll();
+    }
+    BinaryReader in(data.constData() + dataOffset, data.size() - dataOffset);
 
     // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
     // of the FBX binary format
@@ -377,25 +467,25 @@ FBXNode FBXReader::parseFBX(QIODevice* device) {
     //   Bytes 0 - 20: Kaydara FBX Binary  \x00(file - magic, with 2 spaces at the end, then a NULL terminator).
     //   Bytes 21 - 22: [0x1A, 0x00](unknown but all observed files show these bytes).
     //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
-    in.skipRawData(FBX_HEADER_BYTES_BEFORE_VERSION);
-    int position = FBX_HEADER_BYTES_BEFORE_VERSION;
-    quint32 fileVersion;
-    in >> fileVersion;
-    position += sizeof(fileVersion);
+    in.readRaw(FBX_HEADER_BYTES_BEFORE_VERSION);
+    quint32 fileVersion = in.read<quint32>();
     qCDebug(modelformat) << "fileVersion:" << fileVersion;
     bool has64BitPositions = (fileVersion >= FBX_VERSION_2016);
 
     // parse the top-level node
     FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position, has64BitPositions);
+    while (in.position < data.size() - dataOffset) {
+        FBXNode next = parseBinaryFBXNode(in, has64BitPositions, true);
         if (next.name.isNull()) {
-            return top;
+            break;
 
         } else {
             top.children.append(next);
         }
     }
+    if (buffer) {
+        buffer->seek(dataOffset + in.position);
+    }
 
     return top;
 }
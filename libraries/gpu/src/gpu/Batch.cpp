@@ -12,6 +12,8 @@
 
 #include <string.h>
 
+#include <algorithm>
+
 #include <QDebug>
 
 #if defined(NSIGHT_FOUND)
@@ -30,12 +32,12 @@ ProfileRangeBatch::~ProfileRangeBatch() {
 
 using namespace gpu;
 
-size_t Batch::_commandsMax { BATCH_PREALLOCATE_MIN };
-size_t Batch::_commandOffsetsMax { BATCH_PREALLOCATE_MIN };
-size_t Batch::_paramsMax { BATCH_PREALLOCATE_MIN };
-size_t Batch::_dataMax { BATCH_PREALLOCATE_MIN };
-size_t Batch::_objectsMax { BATCH_PREALLOCATE_MIN };
-size_t Batch::_drawCallInfosMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_commandsMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_commandOffsetsMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_paramsMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_dataMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_objectsMax { BATCH_PREALLOCATE_MIN };
+std::atomic<size_t> Batch::_drawCallInfosMax { BATCH_PREALLOCATE_MIN };
 
 Batch::Batch() {
     _commands.reserve(_commandsMax);
@@ -48,14 +50,59 @@ Batch::Batch() {
 
 Batch::Batch(const Batch& batch_) {
     Batch& batch = *const_cast<Batch*>(&batch_);
+    swap(batch);
+}
+
+Batch::~Batch() {
+    raiseMax(_commandsMax, _commands.size());
+    raiseMax(_commandOffsetsMax, _commandOffsets.size());
+    raiseMax(_paramsMax, _params.size());
+    raiseMax(_dataMax, _data.size());
+    raiseMax(_objectsMax, _objects.size());
+    raiseMax(_drawCallInfosMax, _drawCallInfos.size());
+}
+
+void Batch::clear() {
+    raiseMax(_commandsMax, _commands.size());
+    raiseMax(_commandOffsetsMax, _commandOffsets.size());
+    raiseMax(_paramsMax, _params.size());
+    raiseMax(_dataMax, _data.size());
+    raiseMax(_objectsMax, _objects.size());
+    raiseMax(_drawCallInfosMax, _drawCallInfos.size());
+
+    _commands.clear();
+    _commandOffsets.clear();
+    _params.clear();
+    _data.clear();
+    _invalidModel = true;
+    _currentModel = Transform();
+    _objects.clear();
+    _currentNamedCall.clear();
+    _buffers.clear();
+    _textures.clear();
+    _streamFormats.clear();
+    _transforms.clear();
+    _pipelines.clear();
+    _framebuffers.clear();
+    _drawCallInfos.clear();
+    _queries.clear();
+    _lambdas.clear();
+    _profileRanges.clear();
+    _names.clear();
+    _namedData.clear();
+    _enableStereo = true;
+    _enableSkybox = false;
+}
+
+void Batch::swap(Batch& batch) {
     _commands.swap(batch._commands);
     _commandOffsets.swap(batch._commandOffsets);
     _params.swap(batch._params);
     _data.swap(batch._data);
-    _invalidModel = batch._invalidModel;
-    _currentModel = batch._currentModel;
+    std::swap(_invalidModel, batch._invalidModel);
+    std::swap(_currentModel, batch._currentModel);
     _objects.swap(batch._objects);
-    _currentNamedCall = batch._currentNamedCall;
+    _currentNamedCall.swap(batch._currentNamedCall);
 
     _buffers._items.swap(batch._buffers._items);
     _textures._items.swap(batch._textures._items);
@@ -69,39 +116,51 @@ Batch::Batch(const Batch& batch_) {
     _profileRanges._items.swap(batch._profileRanges._items);
     _names._items.swap(batch._names._items);
     _namedData.swap(batch._namedData);
-    _enableStereo = batch._enableStereo;
-    _enableSkybox = batch._enableSkybox;
+    std::swap(_enableStereo, batch._enableStereo);
+    std::swap(_enableSkybox, batch._enableSkybox);
 }
 
-Batch::~Batch() {
-    _commandsMax = std::max(_commands.size(), _commandsMax);
-    _commandOffsetsMax = std::max(_commandOffsets.size(), _commandOffsetsMax);
-    _paramsMax = std::max(_params.size(), _paramsMax);
-    _dataMax = std::max(_data.size(), _dataMax);
-    _objectsMax = std::max(_objects.size(), _objectsMax);
-    _drawCallInfosMax = std::max(_drawCallInfos.size(), _drawCallInfosMax);
+// Enough batches for a few frames of the render task, beyond that released batches are freed
+static const size_t MAX_POOLED_BATCHES = 256;
+
+struct BatchPool {
+    std::mutex mutex;
+    std::vector<Batch*> batches;
+};
+
+static BatchPool& getBatchPool() {
+    // never destroyed, since frames can be released by other statics on the way out
+    static BatchPool* pool = new BatchPool();
+    return *pool;
 }
 
-void Batch::clear() {
-    _commandsMax = std::max(_commands.size(), _commandsMax);
-    _commandOffsetsMax = std::max(_commandOffsets.size(), _commandOffsetsMax);
-    _paramsMax = std::max(_params.size(), _paramsMax);
-    _dataMax = std::max(_data.size(), _dataMax);
-    _objectsMax = std::max(_objects.size(), _objectsMax);
-    _drawCallInfosMax = std::max(_drawCallInfos.size(), _drawCallInfosMax);
+BatchPointer Batch::acquire() {
+    auto& pool = getBatchPool();
+    Batch* batch = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.batches.empty()) {
+            batch = pool.batches.back();
+            pool.batches.pop_back();
+        }
+    }
+    if (!batch) {
+        batch = new Batch();
+    }
 
-    _commands.clear();
-    _commandOffsets.clear();
-    _params.clear();
-    _data.clear();
-    _buffers.clear();
-    _textures.clear();
-    _streamFormats.clear();
-    _transforms.clear();
-    _pipelines.clear();
-    _framebuffers.clear();
-    _objects.clear();
-    _drawCallInfos.clear();
+    return BatchPointer(batch, [](Batch* released) {
+        // cleared on the releasing thread, so what the commands hold on to is freed outside of the pool lock
+        released->clear();
+        auto& pool = getBatchPool();
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.batches.size() < MAX_POOLED_BATCHES) {
+                pool.batches.push_back(released);
+                return;
+            }
+        }
+        delete released;
+    });
 }
 
 size_t Batch::cacheData(size_t size, const void* data) {
@@ -11,6 +11,7 @@
 #ifndef hifi_gpu_Batch_h
 #define hifi_gpu_Batch_h
 
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <functional>
@@ -81,7 +82,7 @@ public:
     using NamedBatchDataMap = std::map<std::string, NamedBatchData>;
 
     DrawCallInfoBuffer _drawCallInfos;
-    static size_t _drawCallInfosMax;
+    static std::atomic<size_t> _drawCallInfosMax;
 
     mutable std::string _currentNamedCall;
 
@@ -95,7 +96,14 @@ public:
     explicit Batch(const Batch& batch);
     ~Batch();
 
+    // Forget everything recorded, keeping the memory to record the next commands
     void clear();
+    void swap(Batch& batch);
+
+    // A cleared batch, from the batches of the frames that have been executed when there are some.  The batch goes
+    // back to the pool once it is released, so its storage is reused instead of reallocated every frame.  Thread
+    // safe: a batch can be recorded on any thread, as long as one thread at a time records it.
+    static BatchPointer acquire();
 
     // Batches may need to override the context level stereo settings
     // if they're performing framebuffer copy operations, like the 
@@ -367,6 +375,13 @@ public:
 
     const Params& getParams() const { return _params; }
 
+    // The sizes batches grow to are kept to preallocate the next ones, from whichever thread records them
+    static void raiseMax(std::atomic<size_t>& max, size_t size) {
+        size_t current = max.load();
+        while (size > current && !max.compare_exchange_weak(current, size)) {
+        }
+    }
+
     // The template cache mechanism for the gpu::Object passed to the gpu::Batch
     // this allow us to have one cache container for each different types and eventually
     // be smarter how we manage them
@@ -376,7 +391,7 @@ public:
         typedef T Data;
         Data _data;
         Cache<T>(const Data& data) : _data(data) {}
-        static size_t _max;
+        static std::atomic<size_t> _max;
 
         class Vector {
         public:
@@ -387,7 +402,7 @@ public:
             }
 
             ~Vector() {
-                _max = std::max(_items.size(), _max);
+                raiseMax(_max, _items.size());
             }
 
 
@@ -441,16 +456,16 @@ public:
     }
 
     Commands _commands;
-    static size_t _commandsMax;
+    static std::atomic<size_t> _commandsMax;
 
     CommandOffsets _commandOffsets;
-    static size_t _commandOffsetsMax;
+    static std::atomic<size_t> _commandOffsetsMax;
 
     Params _params;
-    static size_t _paramsMax;
+    static std::atomic<size_t> _paramsMax;
 
     Bytes _data;
-    static size_t _dataMax;
+    static std::atomic<size_t> _dataMax;
 
     // SSBO class... layout MUST match the layout in Transform.slh
     class TransformObject {
@@ -463,7 +478,7 @@ public:
     bool _invalidModel { true };
     Transform _currentModel;
     TransformObjects _objects;
-    static size_t _objectsMax;
+    static std::atomic<size_t> _objectsMax;
 
     BufferCaches _buffers;
     TextureCaches _textures;
@@ -504,7 +519,7 @@ protected:
 };
 
 template <typename T>
-size_t Batch::Cache<T>::_max = BATCH_PREALLOCATE_MIN;
+std::atomic<size_t> Batch::Cache<T>::_max { BATCH_PREALLOCATE_MIN };
 
 }
 
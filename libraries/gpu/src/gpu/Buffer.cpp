@@ -148,6 +148,12 @@ Buffer::Size Buffer::setSubData(Size offset, Size size, const Byte* data) {
     return changedBytes;
 }
 
+Byte* Buffer::overwrite(Size size) {
+    resize(size);
+    markDirty(0, size);
+    return editData();
+}
+
 Buffer::Size Buffer::append(Size size, const Byte* data) {
     auto offset = _end;
     resize(_end + size);
@@ -90,6 +90,10 @@ public:
         return setSubData(offset, size, reinterpret_cast<const Byte*>(&t[0]));
     }
 
+    // Resize the buffer, mark all of it dirty and return its data for the caller to fill in place
+    // Saves staging the data and copying it with setData, for buffers that are rewritten every frame
+    Byte* overwrite(Size size);
+
     // Append new data at the end of the current buffer
     // do a resize( size + getSize) and copy the new data
     // \return the number of bytes copied
@@ -10,6 +10,9 @@
 //
 #include "Context.h"
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QThreadPool>
+
 #include <shared/GlobalAppProperties.h>
 
 #include "Frame.h"
@@ -65,6 +68,16 @@ void Context::beginFrame(const glm::mat4& renderPose) {
 }
 
 void Context::appendFrameBatch(Batch& batch) {
+    if (!_frameActive) {
+        qWarning() << "Batch executed outside of frame boundaries";
+        return;
+    }
+    auto frameBatch = Batch::acquire();
+    frameBatch->swap(batch);
+    _currentFrame->batches.push_back(frameBatch);
+}
+
+void Context::appendFrameBatch(const BatchPointer& batch) {
     if (!_frameActive) {
         qWarning() << "Batch executed outside of frame boundaries";
         return;
@@ -72,6 +85,37 @@ void Context::appendFrameBatch(Batch& batch) {
     _currentFrame->batches.push_back(batch);
 }
 
+void Context::recordFrameBatches(size_t numBatches, const std::function<void(Batch&, size_t)>& record) {
+    if (!_frameActive) {
+        qWarning() << "Batches recorded outside of frame boundaries";
+        return;
+    }
+
+    std::vector<BatchPointer> batches(numBatches);
+    auto recordBatch = [&batches, &record](size_t index) {
+        batches[index] = Batch::acquire();
+        record(*batches[index], index);
+    };
+
+    // the calling thread records the first batch while the pool records the others
+    auto threadPool = QThreadPool::globalInstance();
+    std::vector<QFuture<void>> jobs;
+    for (size_t index = 1; index < numBatches; ++index) {
+        jobs.push_back(QtConcurrent::run(threadPool, [&recordBatch, index] {
+            recordBatch(index);
+        }));
+    }
+    if (numBatches > 0) {
+        recordBatch(0);
+    }
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+
+    // merge in index order, so the backend sees the commands as if they were recorded in one batch
+    _currentFrame->batches.insert(_currentFrame->batches.end(), batches.begin(), batches.end());
+}
+
 FramePointer Context::endFrame() {
     assert(_frameActive);
     auto result = _currentFrame;
@@ -114,7 +158,7 @@ void Context::executeFrame(const FramePointer& frame) const {
 
         // Execute the frame rendering commands
         for (auto& batch : frame->batches) {
-            _backend->render(batch);
+            _backend->render(*batch);
         }
 
         Batch endBatch;
@@ -163,6 +163,12 @@ public:
 
     void beginFrame(const glm::mat4& renderPose = glm::mat4());
     void appendFrameBatch(Batch& batch);
+    void appendFrameBatch(const BatchPointer& batch);
+
+    // Records numBatches batches at the same time, each with record(batch, index) on the global thread pool, and
+    // appends them to the frame in the order of their index.  record must only touch what belongs to its batch.
+    void recordFrameBatches(size_t numBatches, const std::function<void(Batch&, size_t)>& record);
+
     FramePointer endFrame();
 
     // MUST only be called on the rendering thread
@@ -275,11 +281,16 @@ typedef std::shared_ptr<Context> ContextPointer;
 
 template<typename F>
 void doInBatch(std::shared_ptr<gpu::Context> context, F f) {
-    gpu::Batch batch;
-    f(batch);
+    auto batch = gpu::Batch::acquire();
+    f(*batch);
     context->appendFrameBatch(batch);
 }
 
+template<typename F>
+void doInParallelBatches(std::shared_ptr<gpu::Context> context, size_t numBatches, F f) {
+    context->recordFrameBatches(numBatches, f);
+}
+
 };
 
 
@@ -28,8 +28,8 @@ Frame::~Frame() {
 }
 
 void Frame::finish() {
-    for (Batch& batch : batches) {
-        batch.finishFrame(bufferUpdates);
+    for (auto& batch : batches) {
+        batch->finishFrame(bufferUpdates);
     }
 }
 
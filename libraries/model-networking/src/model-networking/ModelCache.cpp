@@ -181,7 +181,9 @@ void GeometryReader::run() {
             FBXGeometry::Pointer fbxGeometry;
 
             if (_url.path().toLower().endsWith(".fbx")) {
-                fbxGeometry.reset(readFBX(_data, _mapping, _url.path()));
+                // the models only draw their texture coordinates, colors and skinning weights from the gpu buffers
+                const bool KEEP_RENDER_ATTRIBUTES = false;
+                fbxGeometry.reset(readFBX(_data, _mapping, _url.path(), true, 1.0f, KEEP_RENDER_ATTRIBUTES));
                 if (fbxGeometry->meshes.size() == 0 && fbxGeometry->joints.size() == 0) {
                     throw QString("empty geometry, possibly due to an unsupported FBX version");
                 }
@@ -268,6 +268,7 @@ const PacketVersion VERSION_ENTITIES_HAS_SHOULD_HIGHLIGHT = 71;
 const PacketVersion VERSION_ENTITIES_HAS_HIGHLIGHT_SCRIPTING_INTERFACE = 72;
 const PacketVersion VERSION_ENTITIES_ANIMATION_ALLOW_TRANSLATION_PROPERTIES = 73;
 const PacketVersion VERSION_ENTITIES_HAS_CERTIFICATE_PROPERTIES = 74;
+const PacketVersion VERSION_ENTITIES_POLYVOX_DELTAS = 75;
 
 enum class EntityQueryPacketVersion: PacketVersion {
     JSONFilter = 18,
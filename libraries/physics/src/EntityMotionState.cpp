@@ -46,8 +46,8 @@ bool entityTreeIsLocked() {
 #endif
 
 
-EntityMotionState::EntityMotionState(btCollisionShape* shape, EntityItemPointer entity) :
-    ObjectMotionState(nullptr),
+EntityMotionState::EntityMotionState(btCollisionShape* shape, EntityItemPointer entity, ShapeManager* shapeManager) :
+    ObjectMotionState(nullptr, shapeManager),
     _entityPtr(entity),
     _entity(entity.get()),
     _serverPosition(0.0f),
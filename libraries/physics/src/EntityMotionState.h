@@ -25,7 +25,7 @@
 class EntityMotionState : public ObjectMotionState {
 public:
 
-    EntityMotionState(btCollisionShape* shape, EntityItemPointer item);
+    EntityMotionState(btCollisionShape* shape, EntityItemPointer item, ShapeManager* shapeManager);
     virtual ~EntityMotionState();
 
     void updateServerPhysicsVariables();
@@ -50,22 +50,12 @@ uint32_t ObjectMotionState::getWorldSimulationStep() {
     return worldSimulationStep;
 }
 
-// static
-ShapeManager* shapeManager = nullptr;
-void ObjectMotionState::setShapeManager(ShapeManager* manager) {
-    assert(manager);
-    shapeManager = manager;
-}
-
-ShapeManager* ObjectMotionState::getShapeManager() {
-    assert(shapeManager); // you must properly set shapeManager before calling getShapeManager()
-    return shapeManager;
-}
-
-ObjectMotionState::ObjectMotionState(const btCollisionShape* shape) :
+ObjectMotionState::ObjectMotionState(const btCollisionShape* shape, ShapeManager* shapeManager) :
     _shape(shape),
+    _shapeManager(shapeManager),
     _lastKinematicStep(worldSimulationStep)
 {
+    assert(_shapeManager);
 }
 
 ObjectMotionState::~ObjectMotionState() {
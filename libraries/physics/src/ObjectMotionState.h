@@ -75,10 +75,7 @@ public:
     static void setWorldSimulationStep(uint32_t step);
     static uint32_t getWorldSimulationStep();
 
-    static void setShapeManager(ShapeManager* manager);
-    static ShapeManager* getShapeManager();
-
-    ObjectMotionState(const btCollisionShape* shape);
+    ObjectMotionState(const btCollisionShape* shape, ShapeManager* shapeManager);
     virtual ~ObjectMotionState();
 
     virtual void handleEasyChanges(uint32_t& flags);
@@ -149,6 +146,9 @@ public:
     virtual bool isLocallyOwned() const { return false; }
     virtual bool shouldBeLocallyOwned() const { return false; }
 
+    // the ShapeManager that hands out (and takes back) our shapes, shared by all objects of one simulation
+    ShapeManager* getShapeManager() const { return _shapeManager; }
+
     friend class PhysicsEngine;
 
 protected:
@@ -164,6 +164,7 @@ protected:
     PhysicsMotionType _motionType { MOTION_TYPE_STATIC }; // type of motion: KINEMATIC, DYNAMIC, or STATIC
 
     const btCollisionShape* _shape;
+    ShapeManager* _shapeManager;
     btRigidBody* _body { nullptr };
     float _density { 1.0f };
 
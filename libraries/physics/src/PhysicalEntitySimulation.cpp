@@ -26,6 +26,7 @@ PhysicalEntitySimulation::~PhysicalEntitySimulation() {
 void PhysicalEntitySimulation::init(
         EntityTreePointer tree,
         PhysicsEnginePointer physicsEngine,
+        ShapeManager* shapeManager,
         EntityEditPacketSender* packetSender) {
     assert(tree);
     setEntityTree(tree);
@@ -33,6 +34,9 @@ void PhysicalEntitySimulation::init(
     assert(physicsEngine);
     _physicsEngine = physicsEngine;
 
+    assert(shapeManager);
+    _shapeManager = shapeManager;
+
     assert(packetSender);
     _entityPacketSender = packetSender;
 }
@@ -226,9 +230,9 @@ void PhysicalEntitySimulation::getObjectsToAddToPhysics(VectorOfMotionStates& re
                         << "at" << entity->getPosition() << " will be reduced";
                 }
             }
-            btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+            btCollisionShape* shape = const_cast<btCollisionShape*>(_shapeManager->getShape(shapeInfo));
             if (shape) {
-                EntityMotionState* motionState = new EntityMotionState(shape, entity);
+                EntityMotionState* motionState = new EntityMotionState(shape, entity, _shapeManager);
                 entity->setPhysicsInfo(static_cast<void*>(motionState));
                 _physicalObjects.insert(motionState);
                 result.push_back(motionState);
@@ -32,7 +32,8 @@ public:
     PhysicalEntitySimulation();
     ~PhysicalEntitySimulation();
 
-    void init(EntityTreePointer tree, PhysicsEnginePointer engine, EntityEditPacketSender* packetSender);
+    void init(EntityTreePointer tree, PhysicsEnginePointer engine, ShapeManager* shapeManager,
+              EntityEditPacketSender* packetSender);
 
     virtual void addDynamic(EntityDynamicPointer dynamic) override;
     virtual void applyDynamicChanges() override;
@@ -62,7 +63,7 @@ public:
 
     EntityEditPacketSender* getPacketSender() { return _entityPacketSender; }
 
-private:
+protected:
     SetOfEntities _entitiesToRemoveFromPhysics;
     SetOfEntities _entitiesToRelease;
     SetOfEntities _entitiesToAddToPhysics;
@@ -73,6 +74,7 @@ private:
     SetOfMotionStates _physicalObjects; // MotionStates of entities in PhysicsEngine
 
     PhysicsEnginePointer _physicsEngine = nullptr;
+    ShapeManager* _shapeManager = nullptr;
     EntityEditPacketSender* _entityPacketSender = nullptr;
 
     uint32_t _lastStepSendPackets { 0 };
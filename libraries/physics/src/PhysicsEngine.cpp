@@ -61,6 +61,15 @@ void PhysicsEngine::init() {
     }
 }
 
+void PhysicsEngine::setNumSolverThreads(int numThreads) {
+    assert(_dynamicsWorld);
+    _dynamicsWorld->setNumSolverThreads(numThreads);
+}
+
+int PhysicsEngine::getNumSolverThreads() const {
+    return _dynamicsWorld ? _dynamicsWorld->getNumSolverThreads() : 1;
+}
+
 uint32_t PhysicsEngine::getNumSubsteps() {
     return _numSubsteps;
 }
@@ -369,33 +378,32 @@ void PhysicsEngine::recursivelyHarvestPerformanceStats(CProfileIterator* profile
     profileIterator->Enter_Parent();
 }
 
-void PhysicsEngine::doOwnershipInfection(const btCollisionObject* objectA, const btCollisionObject* objectB) {
-    BT_PROFILE("ownershipInfection");
-
-    const btCollisionObject* characterObject = _myAvatarController ? _myAvatarController->getCollisionObject() : nullptr;
-
+ObjectMotionState* PhysicsEngine::findOwnershipInfection(const btCollisionObject* objectA, const btCollisionObject* objectB,
+                                                        const btCollisionObject* characterObject, const QUuid& sessionID,
+                                                        quint8& priority) const {
     ObjectMotionState* motionStateA = static_cast<ObjectMotionState*>(objectA->getUserPointer());
     ObjectMotionState* motionStateB = static_cast<ObjectMotionState*>(objectB->getUserPointer());
 
     if (motionStateB &&
-        ((motionStateA && motionStateA->getSimulatorID() == Physics::getSessionUUID() && !objectA->isStaticObject()) ||
+        ((motionStateA && motionStateA->getSimulatorID() == sessionID && !objectA->isStaticObject()) ||
          (objectA == characterObject))) {
         // NOTE: we might own the simulation of a kinematic object (A)
         // but we don't claim ownership of kinematic objects (B) based on collisions here.
-        if (!objectB->isStaticOrKinematicObject() && motionStateB->getSimulatorID() != Physics::getSessionUUID()) {
-            quint8 priorityA = motionStateA ? motionStateA->getSimulationPriority() : PERSONAL_SIMULATION_PRIORITY;
-            motionStateB->bump(priorityA);
+        if (!objectB->isStaticOrKinematicObject() && motionStateB->getSimulatorID() != sessionID) {
+            priority = motionStateA ? motionStateA->getSimulationPriority() : PERSONAL_SIMULATION_PRIORITY;
+            return motionStateB;
         }
     } else if (motionStateA &&
-               ((motionStateB && motionStateB->getSimulatorID() == Physics::getSessionUUID() && !objectB->isStaticObject()) ||
+               ((motionStateB && motionStateB->getSimulatorID() == sessionID && !objectB->isStaticObject()) ||
                 (objectB == characterObject))) {
         // SIMILARLY: we might own the simulation of a kinematic object (B)
         // but we don't claim ownership of kinematic objects (A) based on collisions here.
-        if (!objectA->isStaticOrKinematicObject() && motionStateA->getSimulatorID() != Physics::getSessionUUID()) {
-            quint8 priorityB = motionStateB ? motionStateB->getSimulationPriority() : PERSONAL_SIMULATION_PRIORITY;
-            motionStateA->bump(priorityB);
+        if (!objectA->isStaticOrKinematicObject() && motionStateA->getSimulatorID() != sessionID) {
+            priority = motionStateB ? motionStateB->getSimulationPriority() : PERSONAL_SIMULATION_PRIORITY;
+            return motionStateA;
         }
     }
+    return nullptr;
 }
 
 void PhysicsEngine::updateContactMap() {
@@ -404,30 +412,49 @@ void PhysicsEngine::updateContactMap() {
 
     // update all contacts every frame
     int numManifolds = _collisionDispatcher->getNumManifolds();
-    for (int i = 0; i < numManifolds; ++i) {
-        btPersistentManifold* contactManifold =  _collisionDispatcher->getManifoldByIndexInternal(i);
-        if (contactManifold->getNumContacts() > 0) {
-            // TODO: require scripts to register interest in callbacks for specific objects
-            // so we can filter out most collision events right here.
-            const btCollisionObject* objectA = static_cast<const btCollisionObject*>(contactManifold->getBody0());
-            const btCollisionObject* objectB = static_cast<const btCollisionObject*>(contactManifold->getBody1());
+    _manifoldContacts.assign(numManifolds, ManifoldContact());
 
-            if (!(objectA->isActive() || objectB->isActive())) {
-                // both objects are inactive so stop tracking this contact,
-                // which will eventually trigger a CONTACT_EVENT_TYPE_END
-                continue;
-            }
+    // The per-manifold work only reads from the simulation so it is spread across the solver threads.
+    // Writes to the contact map and the bumps of simulation ownership are applied serially below.
+    QUuid sessionID = Physics::getSessionUUID();
+    const btCollisionObject* characterObject = _myAvatarController ? _myAvatarController->getCollisionObject() : nullptr;
+    const int CONTACT_GRAIN_SIZE = 128;
+    _dynamicsWorld->parallelFor(numManifolds, CONTACT_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            btPersistentManifold* contactManifold =  _collisionDispatcher->getManifoldByIndexInternal(i);
+            if (contactManifold->getNumContacts() > 0) {
+                // TODO: require scripts to register interest in callbacks for specific objects
+                // so we can filter out most collision events right here.
+                const btCollisionObject* objectA = static_cast<const btCollisionObject*>(contactManifold->getBody0());
+                const btCollisionObject* objectB = static_cast<const btCollisionObject*>(contactManifold->getBody1());
+
+                if (!(objectA->isActive() || objectB->isActive())) {
+                    // both objects are inactive so stop tracking this contact,
+                    // which will eventually trigger a CONTACT_EVENT_TYPE_END
+                    continue;
+                }
 
-            ObjectMotionState* a = static_cast<ObjectMotionState*>(objectA->getUserPointer());
-            ObjectMotionState* b = static_cast<ObjectMotionState*>(objectB->getUserPointer());
-            if (a || b) {
-                // the manifold has up to 4 distinct points, but only extract info from the first
-                _contactMap[ContactKey(a, b)].update(_numContactFrames, contactManifold->getContactPoint(0));
+                ManifoldContact& contact = _manifoldContacts[i];
+                contact.isTracked = objectA->getUserPointer() || objectB->getUserPointer();
+                if (!sessionID.isNull()) {
+                    contact.bumpedMotionState = findOwnershipInfection(objectA, objectB, characterObject,
+                                                                       sessionID, contact.bumpPriority);
+                }
             }
+        }
+    });
 
-            if (!Physics::getSessionUUID().isNull()) {
-                doOwnershipInfection(objectA, objectB);
-            }
+    for (int i = 0; i < numManifolds; ++i) {
+        const ManifoldContact& contact = _manifoldContacts[i];
+        if (contact.isTracked) {
+            btPersistentManifold* contactManifold =  _collisionDispatcher->getManifoldByIndexInternal(i);
+            ObjectMotionState* a = static_cast<ObjectMotionState*>(contactManifold->getBody0()->getUserPointer());
+            ObjectMotionState* b = static_cast<ObjectMotionState*>(contactManifold->getBody1()->getUserPointer());
+            // the manifold has up to 4 distinct points, but only extract info from the first
+            _contactMap[ContactKey(a, b)].update(_numContactFrames, contactManifold->getContactPoint(0));
+        }
+        if (contact.bumpedMotionState) {
+            contact.bumpedMotionState->bump(contact.bumpPriority);
         }
     }
 }
@@ -13,6 +13,7 @@
 #define hifi_PhysicsEngine_h
 
 #include <stdint.h>
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -86,6 +87,10 @@ public:
 
     void dumpNextStats() { _dumpNextStats = true; }
 
+    /// \brief independent simulation islands and contact processing are spread over this many threads
+    void setNumSolverThreads(int numThreads);
+    int getNumSolverThreads() const;
+
     EntityDynamicPointer getDynamicByID(const QUuid& dynamicID) const;
     bool addDynamic(EntityDynamicPointer dynamic);
     void removeDynamic(const QUuid dynamicID);
@@ -101,7 +106,18 @@ private:
 
     void removeContacts(ObjectMotionState* motionState);
 
-    void doOwnershipInfection(const btCollisionObject* objectA, const btCollisionObject* objectB);
+    // \return the motion state that should be bumped because of contact between objectA and objectB, or nullptr
+    ObjectMotionState* findOwnershipInfection(const btCollisionObject* objectA, const btCollisionObject* objectB,
+                                              const btCollisionObject* characterObject, const QUuid& sessionID,
+                                              quint8& priority) const;
+
+    // per-manifold results of the parallel pass in updateContactMap()
+    class ManifoldContact {
+    public:
+        ObjectMotionState* bumpedMotionState { nullptr };
+        quint8 bumpPriority { 0 };
+        bool isTracked { false };
+    };
 
     btClock _clock;
     btDefaultCollisionConfiguration* _collisionConfig = NULL;
@@ -112,6 +128,7 @@ private:
     btGhostPairCallback* _ghostPairCallback = NULL;
 
     ContactMap _contactMap;
+    std::vector<ManifoldContact> _manifoldContacts;
     CollisionEvents _collisionEvents;
     QHash<QUuid, EntityDynamicPointer> _objectDynamics;
     QHash<btRigidBody*, QSet<QUuid>> _objectDynamicsByBody;
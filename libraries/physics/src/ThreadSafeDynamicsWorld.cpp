@@ -15,10 +15,181 @@
  * Copied and modified from btDiscreteDynamicsWorld.cpp by AndrewMeadows on 2014.11.12.
  * */
 
+#include <algorithm>
+
+#include <BulletCollision/CollisionDispatch/btSimulationIslandManager.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <LinearMath/btQuickprof.h>
 
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include "ThreadSafeDynamicsWorld.h"
 
+static int getConstraintIslandId(const btTypedConstraint* constraint) {
+    const btCollisionObject& objectA = constraint->getRigidBodyA();
+    const btCollisionObject& objectB = constraint->getRigidBodyB();
+    return objectA.getIslandTag() >= 0 ? objectA.getIslandTag() : objectB.getIslandTag();
+}
+
+class SortConstraintOnIslandPredicate {
+public:
+    bool operator()(const btTypedConstraint* lhs, const btTypedConstraint* rhs) const {
+        return getConstraintIslandId(lhs) < getConstraintIslandId(rhs);
+    }
+};
+
+// Collects the simulation islands found by btSimulationIslandManager into solver groups and then solves
+// the groups concurrently, each thread with its own btSequentialImpulseConstraintSolver.
+//
+// The solver writes btCollisionObject::m_companionId of every dynamic or kinematic body it touches.
+// Dynamic bodies belong to exactly one island, but kinematic bodies are shared by every island that
+// touches them, so islands with a kinematic body in any manifold or constraint go into a single group
+// that is solved serially by the world's own solver. Static bodies are only ever read.
+class ParallelIslandSolver : public btSimulationIslandManager::IslandCallback {
+public:
+    class Group {
+    public:
+        void clear() {
+            bodies.resize(0);
+            manifolds.resize(0);
+            constraints.resize(0);
+        }
+        int getWork() const { return manifolds.size() + constraints.size(); }
+        void solve(btConstraintSolver* solver, const btContactSolverInfo& info,
+                   btIDebugDraw* debugDrawer, btDispatcher* dispatcher) {
+            if (getWork() == 0) {
+                return;
+            }
+            solver->solveGroup(bodies.size() ? &bodies[0] : nullptr, bodies.size(),
+                               manifolds.size() ? &manifolds[0] : nullptr, manifolds.size(),
+                               constraints.size() ? &constraints[0] : nullptr, constraints.size(),
+                               info, debugDrawer, dispatcher);
+        }
+
+        btAlignedObjectArray<btCollisionObject*> bodies;
+        btAlignedObjectArray<btPersistentManifold*> manifolds;
+        btAlignedObjectArray<btTypedConstraint*> constraints;
+    };
+
+    ParallelIslandSolver(int numThreads) : _arena(numThreads) {}
+
+    void setup(btTypedConstraint** sortedConstraints, int numConstraints, int minBatchWork) {
+        _sortedConstraints = sortedConstraints;
+        _numConstraints = numConstraints;
+        _minBatchWork = std::max(minBatchWork, 1);
+        _serialGroup.clear();
+        _numGroups = 0;
+        _openGroup = -1;
+    }
+
+    virtual void processIsland(btCollisionObject** bodies, int numBodies,
+                               btPersistentManifold** manifolds, int numManifolds, int islandId) override {
+        // find this island's range in the sorted constraints
+        btTypedConstraint** constraintsBegin = _sortedConstraints;
+        btTypedConstraint** constraintsEnd = _sortedConstraints + _numConstraints;
+        if (islandId >= 0) {
+            constraintsBegin = std::lower_bound(constraintsBegin, constraintsEnd, islandId,
+                [](const btTypedConstraint* constraint, int id) { return getConstraintIslandId(constraint) < id; });
+            constraintsEnd = std::upper_bound(constraintsBegin, constraintsEnd, islandId,
+                [](int id, const btTypedConstraint* constraint) { return id < getConstraintIslandId(constraint); });
+        }
+        int numConstraints = (int)(constraintsEnd - constraintsBegin);
+        if (numManifolds == 0 && numConstraints == 0) {
+            // nothing for the solver to do: the bodies will simply be integrated
+            return;
+        }
+
+        // islands that touch kinematic objects (or the lone island reported when splitting is
+        // disabled) cannot safely be solved alongside others
+        bool solveSerially = islandId < 0;
+        for (int i = 0; i < numManifolds && !solveSerially; ++i) {
+            solveSerially = manifolds[i]->getBody0()->isKinematicObject() || manifolds[i]->getBody1()->isKinematicObject();
+        }
+        for (btTypedConstraint** itr = constraintsBegin; itr != constraintsEnd && !solveSerially; ++itr) {
+            solveSerially = (*itr)->getRigidBodyA().isKinematicObject() || (*itr)->getRigidBodyB().isKinematicObject();
+        }
+
+        Group* group;
+        if (solveSerially) {
+            group = &_serialGroup;
+        } else {
+            if (_openGroup < 0) {
+                _openGroup = _numGroups++;
+                if (_openGroup == (int)_groups.size()) {
+                    _groups.emplace_back(new Group());
+                }
+                _groups[_openGroup]->clear();
+            }
+            group = _groups[_openGroup].get();
+        }
+
+        // the island manager reuses its body array between islands, so everything is copied out
+        for (int i = 0; i < numBodies; ++i) {
+            group->bodies.push_back(bodies[i]);
+        }
+        for (int i = 0; i < numManifolds; ++i) {
+            group->manifolds.push_back(manifolds[i]);
+        }
+        for (btTypedConstraint** itr = constraintsBegin; itr != constraintsEnd; ++itr) {
+            group->constraints.push_back(*itr);
+        }
+
+        // small islands are batched together, as btDiscreteDynamicsWorld does, so the per-group overhead
+        // of solveGroup() doesn't dominate scenes made of many tiny piles
+        if (!solveSerially && group->getWork() >= _minBatchWork) {
+            _openGroup = -1;
+        }
+    }
+
+    void solve(const btContactSolverInfo& info, btConstraintSolver* serialSolver,
+               btIDebugDraw* debugDrawer, btDispatcher* dispatcher) {
+        {
+            BT_PROFILE("solveSerialIslands");
+            _serialGroup.solve(serialSolver, info, debugDrawer, dispatcher);
+        }
+        if (_numGroups == 0) {
+            return;
+        }
+        BT_PROFILE("solveParallelIslands");
+        // put the biggest groups first so a straggler doesn't start last
+        std::sort(_groups.begin(), _groups.begin() + _numGroups,
+            [](const std::unique_ptr<Group>& a, const std::unique_ptr<Group>& b) { return a->getWork() > b->getWork(); });
+        _arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<int>(0, _numGroups, 1), [&](const tbb::blocked_range<int>& range) {
+                std::unique_ptr<btSequentialImpulseConstraintSolver>& solver = _solvers.local();
+                if (!solver) {
+                    solver.reset(new btSequentialImpulseConstraintSolver());
+                }
+                for (int i = range.begin(); i < range.end(); ++i) {
+                    // debug drawing is not thread safe
+                    _groups[i]->solve(solver.get(), info, nullptr, dispatcher);
+                }
+            });
+        });
+    }
+
+    void parallelFor(int count, int grainSize, const std::function<void(int begin, int end)>& callback) {
+        _arena.execute([&] {
+            tbb::parallel_for(tbb::blocked_range<int>(0, count, std::max(grainSize, 1)), [&](const tbb::blocked_range<int>& range) {
+                callback(range.begin(), range.end());
+            });
+        });
+    }
+
+private:
+    tbb::task_arena _arena;
+    tbb::enumerable_thread_specific<std::unique_ptr<btSequentialImpulseConstraintSolver>> _solvers;
+    std::vector<std::unique_ptr<Group>> _groups;
+    Group _serialGroup;
+    btTypedConstraint** _sortedConstraints { nullptr };
+    int _numConstraints { 0 };
+    int _minBatchWork { 1 };
+    int _numGroups { 0 };
+    int _openGroup { -1 };
+};
+
 ThreadSafeDynamicsWorld::ThreadSafeDynamicsWorld(
         btDispatcher* dispatcher,
         btBroadphaseInterface* pairCache,
@@ -27,6 +198,58 @@ ThreadSafeDynamicsWorld::ThreadSafeDynamicsWorld(
     :   btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration) {
 }
 
+ThreadSafeDynamicsWorld::~ThreadSafeDynamicsWorld() {
+}
+
+void ThreadSafeDynamicsWorld::setNumSolverThreads(int numThreads) {
+    numThreads = std::max(numThreads, 1);
+    if (numThreads != _numSolverThreads) {
+        _numSolverThreads = numThreads;
+        if (_numSolverThreads > 1) {
+            _islandSolver.reset(new ParallelIslandSolver(_numSolverThreads));
+        } else {
+            _islandSolver.reset();
+        }
+    }
+}
+
+void ThreadSafeDynamicsWorld::parallelFor(int count, int grainSize,
+                                          const std::function<void(int begin, int end)>& callback) {
+    if (count <= 0) {
+        return;
+    }
+    if (!_islandSolver || count <= grainSize) {
+        callback(0, count);
+        return;
+    }
+    _islandSolver->parallelFor(count, grainSize, callback);
+}
+
+void ThreadSafeDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo) {
+    if (!_islandSolver) {
+        btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+        return;
+    }
+    BT_PROFILE("solveConstraints");
+
+    // same ordering as btDiscreteDynamicsWorld so each island's constraints are contiguous
+    m_sortedConstraints.resize(m_constraints.size());
+    for (int i = 0; i < getNumConstraints(); ++i) {
+        m_sortedConstraints[i] = m_constraints[i];
+    }
+    m_sortedConstraints.quickSort(SortConstraintOnIslandPredicate());
+    btTypedConstraint** constraints = getNumConstraints() ? &m_sortedConstraints[0] : nullptr;
+
+    _islandSolver->setup(constraints, m_sortedConstraints.size(), solverInfo.m_minimumSolverBatchSize);
+    m_constraintSolver->prepareSolve(getNumCollisionObjects(), getDispatcher()->getNumManifolds());
+    {
+        BT_PROFILE("collectIslands");
+        m_islandManager->buildAndProcessIslands(getDispatcher(), this, _islandSolver.get());
+    }
+    _islandSolver->solve(solverInfo, m_constraintSolver, getDebugDrawer(), getDispatcher());
+    m_constraintSolver->allSolved(solverInfo, m_debugDrawer);
+}
+
 int ThreadSafeDynamicsWorld::stepSimulationWithSubstepCallback(btScalar timeStep, int maxSubSteps,
                                                                btScalar fixedTimeStep, SubStepCallback onSubStep) {
     BT_PROFILE("stepSimulationWithSubstepCallback");
@@ -108,15 +331,19 @@ void ThreadSafeDynamicsWorld::synchronizeMotionState(btRigidBody* body) {
                 return;
             }
             btTransform interpolatedTransform;
-            btTransformUtil::integrateTransform(body->getInterpolationWorldTransform(),
-                body->getInterpolationLinearVelocity(),body->getInterpolationAngularVelocity(),
-                (m_latencyMotionStateInterpolation && m_fixedTimeStep) ? m_localTime - m_fixedTimeStep : m_localTime*body->getHitFraction(),
-                interpolatedTransform);
+            interpolateTransform(body, interpolatedTransform);
             body->getMotionState()->setWorldTransform(interpolatedTransform);
         }
     }
 }
 
+void ThreadSafeDynamicsWorld::interpolateTransform(const btRigidBody* body, btTransform& interpolatedTransform) const {
+    btTransformUtil::integrateTransform(body->getInterpolationWorldTransform(),
+        body->getInterpolationLinearVelocity(),body->getInterpolationAngularVelocity(),
+        (m_latencyMotionStateInterpolation && m_fixedTimeStep) ? m_localTime - m_fixedTimeStep : m_localTime*body->getHitFraction(),
+        interpolatedTransform);
+}
+
 void ThreadSafeDynamicsWorld::synchronizeMotionStates() {
     BT_PROFILE("synchronizeMotionStates");
     _changedMotionStates.clear();
@@ -139,12 +366,13 @@ void ThreadSafeDynamicsWorld::synchronizeMotionStates() {
         // that remembers a list of objects deactivated last step
         _activeStates.clear();
         _deactivatedStates.clear();
+        _bodiesToSynchronize.clear();
         for (int i=0;i<m_nonStaticRigidBodies.size();i++) {
             btRigidBody* body = m_nonStaticRigidBodies[i];
             ObjectMotionState* motionState = static_cast<ObjectMotionState*>(body->getMotionState());
             if (motionState) {
                 if (body->isActive()) {
-                    synchronizeMotionState(body);
+                    _bodiesToSynchronize.push_back(body);
                     _changedMotionStates.push_back(motionState);
                     _activeStates.insert(motionState);
                 } else if (_lastActiveStates.find(motionState) != _lastActiveStates.end()) {
@@ -153,6 +381,28 @@ void ThreadSafeDynamicsWorld::synchronizeMotionStates() {
                 }
             }
         }
+
+        // The interpolated transforms only depend on the body so they are computed in parallel, but
+        // MotionState::setWorldTransform() writes into the entity tree and must stay on this thread.
+        int numBodies = (int)_bodiesToSynchronize.size();
+        _synchronizedTransforms.resize(numBodies);
+        const int SYNCHRONIZE_GRAIN_SIZE = 256;
+        parallelFor(numBodies, SYNCHRONIZE_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                btRigidBody* body = _bodiesToSynchronize[i];
+                if (!body->isKinematicObject()) {
+                    interpolateTransform(body, _synchronizedTransforms[i]);
+                }
+            }
+        });
+        for (int i = 0; i < numBodies; ++i) {
+            btRigidBody* body = _bodiesToSynchronize[i];
+            if (body->isKinematicObject()) {
+                synchronizeMotionState(body);
+            } else {
+                body->getMotionState()->setWorldTransform(_synchronizedTransforms[i]);
+            }
+        }
     }
     _activeStates.swap(_lastActiveStates);
 }
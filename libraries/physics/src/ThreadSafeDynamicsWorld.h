@@ -20,13 +20,18 @@
 
 #include <BulletDynamics/Dynamics/btRigidBody.h>
 #include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <LinearMath/btAlignedObjectArray.h>
 
 #include "ObjectMotionState.h"
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 using SubStepCallback = std::function<void()>;
 
+class ParallelIslandSolver;
+
 ATTRIBUTE_ALIGNED16(class) ThreadSafeDynamicsWorld : public btDiscreteDynamicsWorld {
 public:
     BT_DECLARE_ALIGNED_ALLOCATOR();
@@ -36,6 +41,7 @@ public:
             btBroadphaseInterface* pairCache,
             btConstraintSolver* constraintSolver,
             btCollisionConfiguration* collisionConfiguration);
+    ~ThreadSafeDynamicsWorld();
 
     int stepSimulationWithSubstepCallback(btScalar timeStep, int maxSubSteps = 1,
                                           btScalar fixedTimeStep = btScalar(1.)/btScalar(60.),
@@ -53,14 +59,32 @@ public:
 
     void addChangedMotionState(ObjectMotionState* motionState) { _changedMotionStates.push_back(motionState); }
 
+    // Independent simulation islands are solved concurrently on up to this many threads.
+    // A value of 1 restores the stock single-threaded btDiscreteDynamicsWorld solver path.
+    void setNumSolverThreads(int numThreads);
+    int getNumSolverThreads() const { return _numSolverThreads; }
+
+    // Split [0, count) into ranges and run them on the solver threads, or inline when single-threaded.
+    // The callback must not touch Bullet state that is shared between islands.
+    void parallelFor(int count, int grainSize, const std::function<void(int begin, int end)>& callback);
+
+protected:
+    virtual void solveConstraints(btContactSolverInfo& solverInfo) override;
+
 private:
     // call this instead of non-virtual btDiscreteDynamicsWorld::synchronizeSingleMotionState()
     void synchronizeMotionState(btRigidBody* body);
+    void interpolateTransform(const btRigidBody* body, btTransform& interpolatedTransform) const;
 
     VectorOfMotionStates _changedMotionStates;
     VectorOfMotionStates _deactivatedStates;
     SetOfMotionStates _activeStates;
     SetOfMotionStates _lastActiveStates;
+
+    std::vector<btRigidBody*> _bodiesToSynchronize;
+    btAlignedObjectArray<btTransform> _synchronizedTransforms;
+    std::unique_ptr<ParallelIslandSolver> _islandSolver;
+    int _numSolverThreads { 1 };
 };
 
 #endif // hifi_ThreadSafeDynamicsWorld_h
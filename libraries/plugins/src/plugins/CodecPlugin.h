@@ -32,4 +32,9 @@ public:
     virtual Decoder* createDecoder(int sampleRate, int numChannels) = 0;
     virtual void releaseEncoder(Encoder* encoder) = 0;
     virtual void releaseDecoder(Decoder* decoder) = 0;
+
+    // Discontinuous transmission: a gated sender sends SilentAudioFrames in place of encoded audio.  Receivers
+    // flush their decoder toward silence with lostFrame() for the first getDTXFlushFrames() silent frames of a run,
+    // then leave it untouched until audio resumes.  A negative count flushes on every silent frame.
+    virtual int getDTXFlushFrames() const { return -1; }
 };
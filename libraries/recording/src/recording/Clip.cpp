@@ -13,6 +13,7 @@
 
 #include "impl/FileClip.h"
 #include "impl/BufferClip.h"
+#include "impl/ClipIndex.h"
 
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
@@ -30,13 +31,13 @@ Clip::Pointer Clip::fromFile(const QString& filePath) {
 }
 
 void Clip::toFile(const QString& filePath, const Clip::ConstPointer& clip) {
-    FileClip::write(filePath, clip->duplicate());
+    FileClip::write(filePath, clip->share());
 }
 
 QByteArray Clip::toBuffer(const Clip::ConstPointer& clip) {
     QBuffer buffer;
     if (buffer.open(QFile::Truncate | QFile::WriteOnly)) {
-        clip->duplicate()->write(buffer);
+        clip->share()->write(buffer);
         buffer.close();
     }
     return buffer.data();
@@ -54,46 +55,56 @@ float Clip::position() const {
     return Frame::frameTimeToSeconds(positionFrameTime());
 }
 
-// FIXME move to frame?
-bool writeFrame(QIODevice& output, const Frame& frame, bool compressed = true) {
-    if (frame.type == Frame::TYPE_INVALID) {
-        qWarning() << "Attempting to write invalid frame";
-        return true;
-    }
+namespace {
 
-    auto written = output.write((char*)&(frame.type), sizeof(FrameType));
-    if (written != sizeof(FrameType)) {
-        return false;
-    }
-    //qDebug(recordingLog) << "Writing frame with time offset " << frame.timeOffset;
-    written = output.write((char*)&(frame.timeOffset), sizeof(Frame::Time));
-    if (written != sizeof(Frame::Time)) {
-        return false;
-    }
-    QByteArray frameData = frame.data;
-    if (compressed) {
-        frameData = qCompress(frameData);
-    }
+// Buffers frames and writes them out in chunks, keeping track of where each frame lands for the index
+class ClipWriter {
+public:
+    ClipWriter(QIODevice& output) : _output(output) {}
 
-    uint16_t dataSize = frameData.size();
-    written = output.write((char*)&dataSize, sizeof(FrameSize));
-    if (written != sizeof(uint16_t)) {
-        return false;
+    quint64 offset() const { return _offset; }
+
+    // FIXME move to frame?
+    bool writeFrame(FrameType type, Frame::Time timeOffset, const QByteArray& frameData) {
+        if (frameData.size() > std::numeric_limits<FrameSize>::max()) {
+            qWarning() << "Frame data too large to write:" << frameData.size();
+            return false;
+        }
+        FrameSize dataSize = frameData.size();
+        //qDebug(recordingLog) << "Writing frame with time offset " << timeOffset;
+        _buffer.append((const char*)&type, sizeof(FrameType));
+        _buffer.append((const char*)&timeOffset, sizeof(Frame::Time));
+        _buffer.append((const char*)&dataSize, sizeof(FrameSize));
+        _buffer.append(frameData);
+        _offset += index::FRAME_HEADER_SIZE + dataSize;
+
+        static const int WRITE_CHUNK_SIZE = 256 * 1024;
+        return _buffer.size() < WRITE_CHUNK_SIZE || flush();
     }
 
-    if (dataSize != 0) {
-        written = output.write(frameData);
-        if (written != dataSize) {
+    bool flush() {
+        auto written = _output.write(_buffer);
+        if (written != _buffer.size()) {
             return false;
         }
+        _buffer.clear();
+        return true;
     }
-    return true;
+
+private:
+    QIODevice& _output;
+    QByteArray _buffer;
+    quint64 _offset { 0 };
+};
+
 }
 
 const QString Clip::FRAME_TYPE_MAP = QStringLiteral("frameTypes");
 const QString Clip::FRAME_COMREPSSION_FLAG = QStringLiteral("compressed");
 
 bool Clip::write(QIODevice& output) {
+    // register the index type so the header lists it
+    auto indexFrameType = index::getFrameType();
     auto frameTypes = Frame::getFrameTypes();
     QJsonObject frameTypeObj;
     for (const auto& frameTypeName : frameTypes.keys()) {
@@ -105,17 +116,64 @@ bool Clip::write(QIODevice& output) {
     // Always mark new files as compressed
     rootObject.insert(FRAME_COMREPSSION_FLAG, true);
     QByteArray headerFrameData = QJsonDocument(rootObject).toBinaryData();
+    ClipWriter writer(output);
     // Never compress the header frame
-    if (!writeFrame(output, Frame({ Frame::TYPE_HEADER, 0, headerFrameData }), false)) {
+    if (!writer.writeFrame(Frame::TYPE_HEADER, 0, headerFrameData)) {
         return false;
     }
 
     seek(0);
 
+    // only frames of a type listed in the header are indexed, readers drop the rest anyway
+    auto frameTypeNames = Frame::getFrameTypeNames();
+    std::vector<index::Record> records;
+    records.reserve(frameCount());
     for (auto frame = nextFrame(); frame; frame = nextFrame()) {
-        if (!writeFrame(output, *frame)) {
+        if (frame->type == Frame::TYPE_INVALID) {
+            qWarning() << "Attempting to write invalid frame";
+            continue;
+        }
+        if (frameTypeNames.contains(frame->type)) {
+            records.push_back({ writer.offset(), frame->timeOffset });
+        }
+        if (!writer.writeFrame(frame->type, frame->timeOffset, qCompress(frame->data))) {
+            return false;
+        }
+    }
+
+    // the seek table holds the first record at or after each interval, up to the last frame
+    std::vector<index::SeekEntry> seekTable;
+    if (!records.empty()) {
+        seekTable.resize(records.back().timeOffset / index::SEEK_INTERVAL + 1);
+        size_t record = 0;
+        for (size_t entry = 0; entry < seekTable.size(); ++entry) {
+            while (records[record].timeOffset < entry * index::SEEK_INTERVAL) {
+                ++record;
+            }
+            seekTable[entry] = (index::SeekEntry)record;
+        }
+    }
+
+    QByteArray indexData;
+    indexData.reserve((int)(records.size() * sizeof(index::Record) + seekTable.size() * sizeof(index::SeekEntry)));
+    indexData.append((const char*)records.data(), (int)(records.size() * sizeof(index::Record)));
+    indexData.append((const char*)seekTable.data(), (int)(seekTable.size() * sizeof(index::SeekEntry)));
+
+    Frame::Time indexTime = records.empty() ? 0 : records.back().timeOffset;
+    index::Locator locator;
+    locator.indexOffset = writer.offset();
+    locator.recordCount = (quint32)records.size();
+    locator.seekEntryCount = (quint32)seekTable.size();
+    locator.seekInterval = index::SEEK_INTERVAL;
+    locator.magic = index::LOCATOR_MAGIC;
+
+    for (int chunk = 0; chunk < indexData.size(); chunk += (int)index::CHUNK_SIZE) {
+        if (!writer.writeFrame(indexFrameType, indexTime, indexData.mid(chunk, (int)index::CHUNK_SIZE))) {
             return false;
         }
     }
-    return true;
+    if (!writer.writeFrame(indexFrameType, indexTime, QByteArray((const char*)&locator, sizeof(index::Locator)))) {
+        return false;
+    }
+    return writer.flush();
 }
@@ -30,6 +30,9 @@ public:
     virtual ~Clip() {}
 
     virtual Pointer duplicate() const = 0;
+    // A read-only clip over the same frames with a position of its own.  Clips backed by a file or buffer share
+    // their bytes rather than copying the frames, so many decks can play one clip.
+    virtual Pointer share() const { return duplicate(); }
 
     virtual QString getName() const = 0;
 
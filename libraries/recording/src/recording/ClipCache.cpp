@@ -6,6 +6,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QtCore/QTemporaryFile>
 #include <QThread>
 
 #include <shared/QtHelpers.h>
@@ -20,8 +21,22 @@ NetworkClipLoader::NetworkClipLoader(const QUrl& url) :
     _clip(std::make_shared<NetworkClip>(url)) {}
 
 void NetworkClip::init(const QByteArray& clipData) {
-    _clipData = clipData;
-    PointerClip::init((uchar*)_clipData.data(), _clipData.size());
+    // Large clips are spilled to a temporary file and mapped, so a long recording only keeps the pages being played
+    // resident instead of the whole download
+    static const int MAX_IN_MEMORY_CLIP_SIZE = 4 * 1024 * 1024;
+    if (clipData.size() > MAX_IN_MEMORY_CLIP_SIZE) {
+        auto file = std::make_shared<QTemporaryFile>();
+        if (file->open() && file->write(clipData) == clipData.size() && file->flush()) {
+            if (auto mappedFile = file->map(0, clipData.size())) {
+                PointerClip::init(mappedFile, clipData.size(), getName(), file);
+                return;
+            }
+        }
+        qCWarning(recordingLog) << "Unable to spill" << getName() << "to a temporary file, keeping it in memory";
+    }
+
+    auto buffer = std::make_shared<QByteArray>(clipData);
+    PointerClip::init((uchar*)buffer->data(), buffer->size(), getName(), buffer);
 }
 
 void NetworkClipLoader::downloadFinished(const QByteArray& data) {
@@ -25,7 +25,6 @@ public:
     virtual QString getName() const override { return _url.toString(); }
 
 private:
-    QByteArray _clipData;
     QUrl _url;
 };
 
@@ -8,6 +8,9 @@
 
 #include "Deck.h"
  
+#include <algorithm>
+
+#include <QtCore/QSet>
 #include <QtCore/QThread>
 
 #include <NumericalConstants.h>
@@ -86,6 +89,7 @@ void Deck::seek(float position) {
     // reset the clips to the appropriate spot
     for (auto& clip : _clips) {
         clip->seekFrameTime(_position);
+        replayFromKeyFrames(clip);
     }
 
     if (!_pause) {
@@ -94,6 +98,59 @@ void Deck::seek(float position) {
     }
 }
 
+// Frames that only carry what changed since the frame before them are handled from the last key frame before the new
+// position on, so that their handlers catch up with the state at the position.  Key frames are recorded regularly
+// (every 60 frames for avatars), so they are looked for in a window before the position, found through the clip's
+// seek index.  The window only grows, back to the start of the clip, while a frame type in it has no key frame yet.
+static const Frame::Time INITIAL_KEY_FRAME_WINDOW = Frame::secondsToFrameTime(2.0f);
+
+void Deck::replayFromKeyFrames(const ClipPointer& clip) {
+    auto keyFrameTests = Frame::getKeyFrameTests();
+    if (keyFrameTests.isEmpty()) {
+        return;
+    }
+
+    auto replayClip = clip->share();
+    QMap<FrameType, Frame::Time> keyFramePositions;
+    Frame::Time window = INITIAL_KEY_FRAME_WINDOW;
+    Frame::Time windowStart;
+    do {
+        windowStart = _position > window ? _position - window : 0;
+        window = window > _position / 2 ? _position : window * 2;
+
+        keyFramePositions.clear();
+        QSet<FrameType> windowFrameTypes;
+        replayClip->seekFrameTime(windowStart);
+        while (replayClip->positionFrameTime() < _position) {
+            auto frame = replayClip->nextFrame();
+            auto keyFrameTest = keyFrameTests.find(frame->type);
+            if (keyFrameTest != keyFrameTests.end()) {
+                windowFrameTypes.insert(frame->type);
+                if ((*keyFrameTest)(frame->data)) {
+                    keyFramePositions[frame->type] = frame->timeOffset;
+                }
+            }
+        }
+        if (windowFrameTypes.size() == keyFramePositions.size()) {
+            break;
+        }
+    } while (windowStart > 0);
+
+    if (keyFramePositions.isEmpty()) {
+        return;
+    }
+
+    auto replayPosition = *std::min_element(keyFramePositions.begin(), keyFramePositions.end());
+    replayClip->seekFrameTime(replayPosition);
+    while (replayClip->positionFrameTime() < _position) {
+        auto frame = replayClip->nextFrame();
+        auto keyFramePosition = keyFramePositions.find(frame->type);
+        if (keyFramePosition != keyFramePositions.end() && frame->timeOffset >= *keyFramePosition) {
+            Frame::handleFrame(frame);
+        }
+    }
+}
+
 float Deck::position() const {
     Locker lock(_mutex);
     auto currentPosition = _position;
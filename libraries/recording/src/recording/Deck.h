@@ -67,6 +67,7 @@ private:
 
     ClipPointer getNextClip();
     void processFrames();
+    void replayFromKeyFrames(const ClipPointer& clip);
 
     mutable Mutex _mutex;
     QTimer _timer;
@@ -71,6 +71,7 @@ private:
 
 static Registry<FrameType, QString> frameTypes;
 static QMap<FrameType, Frame::Handler> handlerMap;
+static QMap<FrameType, Frame::KeyFrameTest> keyFrameTestMap;
 using Mutex = std::mutex;
 using Locker = std::unique_lock<Mutex>;
 static Mutex mutex;
@@ -149,6 +150,15 @@ void Frame::clearFrameHandler(const QString& frameTypeName) {
     clearFrameHandler(frameType); 
 }
 
+void Frame::registerKeyFrameTest(FrameType type, KeyFrameTest test) {
+    Locker lock(mutex);
+    keyFrameTestMap[type] = test;
+}
+
+QMap<FrameType, Frame::KeyFrameTest> Frame::getKeyFrameTests() {
+    Locker lock(mutex);
+    return keyFrameTestMap;
+}
 
 void Frame::handleFrame(const Frame::ConstPointer& frame) {
     Handler handler; 
@@ -58,6 +58,8 @@ public:
     using Pointer = std::shared_ptr<Frame>;
     using ConstPointer = std::shared_ptr<const Frame>;
     using Handler = std::function<void(Frame::ConstPointer frame)>;
+    // true for a frame that can be handled without the frames of its type before it
+    using KeyFrameTest = std::function<bool(const QByteArray& data)>;
 
     QByteArray data;
 
@@ -70,6 +72,10 @@ public:
     static Handler registerFrameHandler(const QString& frameTypeName, Handler handler);
     static void clearFrameHandler(FrameType type);
     static void clearFrameHandler(const QString& frameTypeName);
+    // frame types whose frames depend on the frames before them register a test for their key frames, so that a Deck
+    // that seeks can replay them from the last key frame before the new position
+    static void registerKeyFrameTest(FrameType type, KeyFrameTest test);
+    static QMap<FrameType, KeyFrameTest> getKeyFrameTests();
     static QMap<QString, FrameType> getFrameTypes();
     static QMap<FrameType, QString> getFrameTypeNames();
     static void handleFrame(const ConstPointer& frame);
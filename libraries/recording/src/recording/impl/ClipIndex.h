@@ -0,0 +1,75 @@
+//
+//  ClipIndex.h
+//  libraries/recording/src/recording/impl
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_Recording_Impl_ClipIndex_h
+#define hifi_Recording_Impl_ClipIndex_h
+
+#include <QtCore/QString>
+
+#include "../Frame.h"
+
+// The frame index written after the frames of a clip file:
+//
+//   [header frame][frames ...][index frames ...][locator frame]
+//
+// The index frames carry, back to back, one Record per indexed frame followed by a seek table holding the first
+// record at or after each SEEK_INTERVAL of the clip.  The locator is always the last frame in the file, so readers
+// find the index without walking the frames.  Readers that don't know the index frame type drop these frames like
+// any other unknown type, so indexed files still load in older builds.
+namespace recording { namespace index {
+
+static const QString FRAME_TYPE_NAME = QStringLiteral("com.highfidelity.recording.Index");
+
+#pragma pack(push, 1)
+struct Record {
+    quint64 frameOffset; // of the frame header, from the start of the file
+    Frame::Time timeOffset;
+};
+
+struct Locator {
+    quint64 indexOffset; // of the first index frame
+    quint32 recordCount;
+    quint32 seekEntryCount;
+    quint32 seekInterval;
+    quint32 magic;
+};
+#pragma pack(pop)
+
+using SeekEntry = quint32;
+
+static const quint32 LOCATOR_MAGIC = 0x58524648; // "HFRX"
+static const Frame::Time SEEK_INTERVAL = 1000;
+
+// the largest payload that is a whole number of both records and seek entries, so neither straddles two frames
+static const size_t CHUNK_SIZE = (std::numeric_limits<FrameSize>::max() / sizeof(Record)) * sizeof(Record);
+static_assert(CHUNK_SIZE % sizeof(SeekEntry) == 0, "Index chunks must hold whole seek entries");
+
+static const size_t FRAME_HEADER_SIZE = sizeof(FrameType) + sizeof(Frame::Time) + sizeof(FrameSize);
+
+// size of the index frames, excluding the locator, for a given size of records plus seek table
+inline quint64 framedSize(quint64 streamSize) {
+    return streamSize + FRAME_HEADER_SIZE * ((streamSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+}
+
+// offset in the file of a byte in the records plus seek table
+inline quint64 fileOffset(quint64 indexOffset, quint64 streamOffset) {
+    return indexOffset + (streamOffset / CHUNK_SIZE) * (FRAME_HEADER_SIZE + CHUNK_SIZE) +
+        FRAME_HEADER_SIZE + (streamOffset % CHUNK_SIZE);
+}
+
+inline FrameType getFrameType() {
+    static const FrameType frameType = Frame::registerFrameType(FRAME_TYPE_NAME);
+    return frameType;
+}
+
+} }
+
+#endif
@@ -21,21 +21,27 @@
 
 using namespace recording;
 
-FileClip::FileClip(const QString& fileName) : _file(fileName) {
-    auto size = _file.size();
+FileClip::FileClip(const QString& fileName) : _fileName(fileName) {
+    // the mapping lives as long as the file, which is owned by the clip data shared with every copy of this clip
+    auto file = std::make_shared<QFile>(fileName);
+    auto size = file->size();
     qDebug(recordingLog) << "Opening file of size: " << size;
-    bool opened = _file.open(QIODevice::ReadOnly);
+    bool opened = file->open(QIODevice::ReadOnly);
     if (!opened) {
         qCWarning(recordingLog) << "Unable to open file " << fileName;
         return;
     }
-    auto mappedFile = _file.map(0, size, QFile::MapPrivateOption);
-    init(mappedFile, size);
+    auto mappedFile = file->map(0, size, QFile::MapPrivateOption);
+    if (!mappedFile) {
+        qCWarning(recordingLog) << "Unable to map file " << fileName;
+        return;
+    }
+    init(mappedFile, size, fileName, file);
 }
 
 
 QString FileClip::getName() const {
-    return _file.fileName();
+    return _fileName;
 }
 
 
@@ -56,12 +62,3 @@ bool FileClip::write(const QString& fileName, Clip::Pointer clip) {
     Finally closer([&] { outputFile.close(); });
     return clip->write(outputFile);
 }
-
-FileClip::~FileClip() {
-    Locker lock(_mutex);
-    _file.unmap(_data);
-    if (_file.isOpen()) {
-        _file.close();
-    }
-    reset();
-}
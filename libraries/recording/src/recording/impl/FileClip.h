@@ -21,14 +21,13 @@ public:
     using Pointer = std::shared_ptr<FileClip>;
 
     FileClip(const QString& file);
-    virtual ~FileClip();
 
     virtual QString getName() const override;
 
     static bool write(const QString& filePath, Clip::Pointer clip);
 
 private:
-    QFile _file;
+    const QString _fileName;
 };
 
 }
@@ -58,5 +58,7 @@ Clip::Pointer OffsetClip::duplicate() const {
         _wrappedClip->duplicate(), Frame::frameTimeToSeconds(_offset));
 }
 
-
-
+Clip::Pointer OffsetClip::share() const {
+    return std::make_shared<OffsetClip>(
+        _wrappedClip->share(), Frame::frameTimeToSeconds(_offset));
+}
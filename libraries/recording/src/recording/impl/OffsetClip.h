@@ -23,6 +23,7 @@ public:
     virtual QString getName() const override;
 
     virtual Clip::Pointer duplicate() const override;
+    virtual Clip::Pointer share() const override;
     virtual float duration() const override;
     virtual void seekFrameTime(Frame::Time offset) override;
     virtual Frame::Time positionFrameTime() const override;
@@ -23,7 +23,7 @@
 
 using namespace recording;
 
-using FrameTranslationMap = QMap<FrameType, FrameType>;
+using FrameTranslationMap = QHash<FrameType, FrameType>;
 
 FrameTranslationMap parseTranslationMap(const QJsonDocument& doc) {
     FrameTranslationMap results;
@@ -44,117 +44,306 @@ FrameTranslationMap parseTranslationMap(const QJsonDocument& doc) {
     return results;
 }
 
+PointerClipData::PointerClipData(const QString& name, uchar* data, size_t size, const std::shared_ptr<void>& owner) :
+    _name(name), _data(data), _size(size), _owner(owner)
+{
+    // make sure the index type is registered before the translation map is built
+    index::getFrameType();
 
-PointerFrameHeaderList parseFrameHeaders(uchar* const start, const size_t& size) {
-    PointerFrameHeaderList results;
-    auto current = start;
-    auto end = current + size;
-    // Read all the frame headers
-    // FIXME move to Frame::readHeader?
-    while (end - current >= PointerClip::MINIMUM_FRAME_SIZE) {
-        PointerFrameHeader header;
-        memcpy(&(header.type), current, sizeof(FrameType));
-        current += sizeof(FrameType);
-        memcpy(&(header.timeOffset), current, sizeof(Frame::Time));
-        current += sizeof(Frame::Time);
-        memcpy(&(header.size), current, sizeof(FrameSize));
-        current += sizeof(FrameSize);
-        header.fileOffset = current - start;
-        if (end - current < header.size) {
-            current = end;
-            break;
-        }
-        current += header.size;
-        results.push_back(header);
-    }
-    qDebug(recordingLog) << "Parsed source data into " << results.size() << " frames";
-//    int i = 0;
-//    for (const auto& frameHeader : results) {
-//        qDebug(recordingLog) << "Frame " << i++ << " time " << frameHeader.timeOffset << " Type " << frameHeader.type;
-//    }
-    return results;
-}
+    size_t headerEnd { 0 };
+    if (!_data || !parseHeader(headerEnd)) {
+        return;
+    }
 
-void PointerClip::reset() {
-    _frames.clear();
-    _data = nullptr;
-    _size = 0;
-    _header = QJsonDocument();
+    if (!loadIndex(headerEnd)) {
+        scanFrames(headerEnd);
+    }
+    _valid = true;
 }
 
-void PointerClip::init(uchar* data, size_t size) {
-    reset();
-
-    _data = data;
-    _size = size;
+// Internal only function, callers check the header against their own bounds
+bool PointerClipData::readFrameHeader(quint64 offset, quint64 limit, PointerFrameHeader& header) const {
+    if (limit < offset || limit - offset < (quint64)PointerClip::MINIMUM_FRAME_SIZE) {
+        return false;
+    }
+    // FIXME move to Frame::readHeader?
+    auto current = _data + offset;
+    memcpy(&(header.type), current, sizeof(FrameType));
+    current += sizeof(FrameType);
+    memcpy(&(header.timeOffset), current, sizeof(Frame::Time));
+    current += sizeof(Frame::Time);
+    memcpy(&(header.size), current, sizeof(FrameSize));
+    current += sizeof(FrameSize);
+    header.fileOffset = current - _data;
+    return limit - header.fileOffset >= header.size;
+}
 
-    auto parsedFrameHeaders = parseFrameHeaders(data, size);
+bool PointerClipData::parseHeader(size_t& headerEnd) {
     // Verify that at least one frame exists and that the first frame is a header
-    if (0 == parsedFrameHeaders.size()) {
+    PointerFrameHeader fileHeaderFrameHeader;
+    if (!readFrameHeader(0, _size, fileHeaderFrameHeader)) {
         qWarning() << "No frames found, invalid file";
-        reset();
-        return;
+        return false;
     }
 
-    // Grab the file header
-    {
-        auto fileHeaderFrameHeader = *parsedFrameHeaders.begin();
-        parsedFrameHeaders.pop_front();
-        if (fileHeaderFrameHeader.type != Frame::TYPE_HEADER) {
-            qWarning() << "Missing header frame, invalid file";
-            reset();
-            return;
-        }
-
-        QByteArray fileHeaderData((char*)_data + fileHeaderFrameHeader.fileOffset, fileHeaderFrameHeader.size);
-        _header = QJsonDocument::fromBinaryData(fileHeaderData);
+    if (fileHeaderFrameHeader.type != Frame::TYPE_HEADER) {
+        qWarning() << "Missing header frame, invalid file";
+        return false;
     }
 
+    QByteArray fileHeaderData((char*)_data + fileHeaderFrameHeader.fileOffset, fileHeaderFrameHeader.size);
+    _header = QJsonDocument::fromBinaryData(fileHeaderData);
+    headerEnd = fileHeaderFrameHeader.fileOffset + fileHeaderFrameHeader.size;
+
     // Check for compression
-    {
-        _compressed = _header.object()[FRAME_COMREPSSION_FLAG].toBool();
+    _compressed = _header.object()[Clip::FRAME_COMREPSSION_FLAG].toBool();
+
+    // Find the type enum translation map
+    _translationMap = parseTranslationMap(_header);
+    if (_translationMap.empty()) {
+        qWarning() << "Header missing frame type map, invalid file";
+        return false;
+    }
+    return true;
+}
+
+bool PointerClipData::loadIndex(size_t headerEnd) {
+    // only files where every frame type is known to this build can be played straight from the index, otherwise the
+    // unknown frames have to be filtered out by a scan
+    auto storedFrameTypes = _header.object()[Clip::FRAME_TYPE_MAP].toObject();
+    if (storedFrameTypes.size() != _translationMap.size()) {
+        return false;
+    }
+
+    FrameType storedIndexType = _translationMap.key(index::getFrameType(), Frame::TYPE_INVALID);
+    if (storedIndexType == Frame::TYPE_INVALID) {
+        return false;
     }
 
-    // Find the type enum translation map and fix up the frame headers
-    {
-        FrameTranslationMap translationMap = parseTranslationMap(_header);
-        if (translationMap.empty()) {
-            qWarning() << "Header missing frame type map, invalid file";
-            reset();
-            return;
+    // the locator is always the last frame of the file
+    static const size_t LOCATOR_FRAME_SIZE = PointerClip::MINIMUM_FRAME_SIZE + sizeof(index::Locator);
+    if (_size < headerEnd + LOCATOR_FRAME_SIZE) {
+        return false;
+    }
+    size_t locatorOffset = _size - LOCATOR_FRAME_SIZE;
+    PointerFrameHeader locatorHeader;
+    if (!readFrameHeader(locatorOffset, _size, locatorHeader) ||
+        locatorHeader.type != storedIndexType || locatorHeader.size != sizeof(index::Locator)) {
+        return false;
+    }
+
+    index::Locator locator;
+    memcpy(&locator, _data + locatorHeader.fileOffset, sizeof(index::Locator));
+    quint64 streamSize = (quint64)locator.recordCount * sizeof(index::Record) +
+        (quint64)locator.seekEntryCount * sizeof(index::SeekEntry);
+    if (locator.magic != index::LOCATOR_MAGIC || locator.seekInterval == 0 || locator.indexOffset < headerEnd ||
+        locator.indexOffset + index::framedSize(streamSize) != locatorOffset) {
+        qCWarning(recordingLog) << "Ignoring damaged frame index in" << _name;
+        return false;
+    }
+
+    _indexed = true;
+    _indexOffset = locator.indexOffset;
+    _frameCount = locator.recordCount;
+    _seekEntryCount = locator.seekEntryCount;
+    _seekInterval = locator.seekInterval;
+    qDebug(recordingLog) << "Loaded frame index of" << _frameCount << "frames";
+    return true;
+}
+
+void PointerClipData::scanFrames(size_t headerEnd) {
+    auto indexType = index::getFrameType();
+    // Read all the frame headers
+    PointerFrameHeader frameHeader;
+    for (quint64 offset = headerEnd; readFrameHeader(offset, _size, frameHeader);
+         offset = frameHeader.fileOffset + frameHeader.size) {
+        auto itr = _translationMap.find(frameHeader.type);
+        if (itr == _translationMap.end() || itr.value() == indexType) {
+            continue;
         }
+        frameHeader.type = itr.value();
+        _frames.push_back(frameHeader);
+    }
+    _frames.shrink_to_fit();
+    _frameCount = _frames.size();
+    qDebug(recordingLog) << "Parsed source data into " << _frameCount << " frames";
+}
 
-        // Update the loaded headers with the frame data
-        _frames.reserve(parsedFrameHeaders.size());
-        for (auto& frameHeader : parsedFrameHeaders) {
-            if (!translationMap.contains(frameHeader.type)) {
-                continue;
+index::Record PointerClipData::readRecord(size_t recordIndex) const {
+    index::Record result;
+    memcpy(&result, _data + index::fileOffset(_indexOffset, recordIndex * sizeof(index::Record)), sizeof(index::Record));
+    return result;
+}
+
+index::SeekEntry PointerClipData::readSeekEntry(size_t entry) const {
+    quint64 streamOffset = _frameCount * sizeof(index::Record) + entry * sizeof(index::SeekEntry);
+    index::SeekEntry result;
+    memcpy(&result, _data + index::fileOffset(_indexOffset, streamOffset), sizeof(index::SeekEntry));
+    return result;
+}
+
+Frame::Time PointerClipData::frameTime(size_t frameIndex) const {
+    return _indexed ? readRecord(frameIndex).timeOffset : _frames[frameIndex].timeOffset;
+}
+
+size_t PointerClipData::lowerBound(Frame::Time time) const {
+    size_t lower = 0;
+    size_t upper = _frameCount;
+
+    // narrow the search to one seek interval, so a seek touches a handful of index pages at most
+    if (_indexed && _seekEntryCount > 0) {
+        size_t entry = time / _seekInterval;
+        if (entry < _seekEntryCount) {
+            lower = readSeekEntry(entry);
+            if (entry + 1 < _seekEntryCount) {
+                upper = readSeekEntry(entry + 1);
             }
-            frameHeader.type = translationMap[frameHeader.type];
-            _frames.push_back(frameHeader);
+        } else {
+            lower = readSeekEntry(_seekEntryCount - 1);
         }
+        upper = std::min(upper, _frameCount);
+        lower = std::min(lower, upper);
     }
 
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (frameTime(middle) < time) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower;
 }
 
-// Internal only function, needs no locking
-FrameConstPointer PointerClip::readFrame(size_t frameIndex) const {
+FrameConstPointer PointerClipData::readFrame(size_t frameIndex) const {
     FramePointer result;
-    if (frameIndex < _frames.size()) {
-        result = std::make_shared<Frame>();
-        const auto& header = _frames[frameIndex];
-        result->type = header.type;
-        result->timeOffset = header.timeOffset;
-        if (header.size) {
-            result->data.insert(0, reinterpret_cast<char*>(_data)+header.fileOffset, header.size);
-            if (_compressed) {
-                result->data = qUncompress(result->data);
-            }
+    if (frameIndex >= _frameCount) {
+        return result;
+    }
+
+    PointerFrameHeader header;
+    if (_indexed) {
+        if (!readFrameHeader(readRecord(frameIndex).frameOffset, _indexOffset, header)) {
+            qCWarning(recordingLog) << "Frame" << frameIndex << "is out of bounds in" << _name;
+            return std::make_shared<Frame>();
+        }
+        header.type = _translationMap.value(header.type, Frame::TYPE_INVALID);
+    } else {
+        header = _frames[frameIndex];
+    }
+
+    result = std::make_shared<Frame>();
+    result->type = header.type;
+    result->timeOffset = header.timeOffset;
+    if (header.size) {
+        // decode straight from the clip bytes, only the frame being played is ever resident
+        auto frameData = _data + header.fileOffset;
+        if (_compressed) {
+            result->data = qUncompress(frameData, header.size);
+        } else {
+            result->data = QByteArray(reinterpret_cast<const char*>(frameData), header.size);
         }
     }
     return result;
 }
 
+void PointerClip::reset() {
+    _clipData.reset();
+    _frameIndex = 0;
+}
+
+void PointerClip::init(uchar* data, size_t size, const QString& name, const std::shared_ptr<void>& owner) {
+    auto clipData = std::make_shared<PointerClipData>(name, data, size, owner);
+
+    Locker lock(_mutex);
+    reset();
+    if (clipData->isValid()) {
+        _clipData = clipData;
+    }
+}
+
+QString PointerClip::getName() const {
+    Locker lock(_mutex);
+    return _clipData ? _clipData->getName() : QString();
+}
+
+const QJsonDocument& PointerClip::getHeader() const {
+    static const QJsonDocument EMPTY_HEADER;
+    Locker lock(_mutex);
+    return _clipData ? _clipData->getHeader() : EMPTY_HEADER;
+}
+
+float PointerClip::duration() const {
+    Locker lock(_mutex);
+    if (!_clipData || 0 == _clipData->frameCount()) {
+        return 0;
+    }
+    return Frame::frameTimeToSeconds(_clipData->frameTime(_clipData->frameCount() - 1));
+}
+
+size_t PointerClip::frameCount() const {
+    Locker lock(_mutex);
+    return _clipData ? _clipData->frameCount() : 0;
+}
+
+Clip::Pointer PointerClip::duplicate() const {
+    auto result = newClip();
+    Locker lock(_mutex);
+    if (_clipData) {
+        for (size_t i = 0; i < _clipData->frameCount(); ++i) {
+            result->addFrame(_clipData->readFrame(i));
+        }
+    }
+    return result;
+}
+
+Clip::Pointer PointerClip::share() const {
+    auto result = std::make_shared<PointerClip>();
+    Locker lock(_mutex);
+    result->_clipData = _clipData;
+    return result;
+}
+
+void PointerClip::seekFrameTime(Frame::Time offset) {
+    Locker lock(_mutex);
+    _frameIndex = _clipData ? _clipData->lowerBound(offset) : 0;
+}
+
+Frame::Time PointerClip::positionFrameTime() const {
+    Locker lock(_mutex);
+    Frame::Time result = Frame::INVALID_TIME;
+    if (_clipData && _frameIndex < _clipData->frameCount()) {
+        result = _clipData->frameTime(_frameIndex);
+    }
+    return result;
+}
+
+FrameConstPointer PointerClip::peekFrame() const {
+    Locker lock(_mutex);
+    FrameConstPointer result;
+    if (_clipData) {
+        result = _clipData->readFrame(_frameIndex);
+    }
+    return result;
+}
+
+FrameConstPointer PointerClip::nextFrame() {
+    Locker lock(_mutex);
+    FrameConstPointer result;
+    if (_clipData && _frameIndex < _clipData->frameCount()) {
+        result = _clipData->readFrame(_frameIndex++);
+    }
+    return result;
+}
+
+void PointerClip::skipFrame() {
+    Locker lock(_mutex);
+    if (_clipData && _frameIndex < _clipData->frameCount()) {
+        ++_frameIndex;
+    }
+}
+
 void PointerClip::addFrame(FrameConstPointer) {
     throw std::runtime_error("Pointer clips are read only, use duplicate to create a read/write clip");
 }
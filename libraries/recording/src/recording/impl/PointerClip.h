@@ -10,47 +10,105 @@
 #ifndef hifi_Recording_Impl_PointerClip_h
 #define hifi_Recording_Impl_PointerClip_h
 
-#include "ArrayClip.h"
+#include "../Clip.h"
 
 #include <mutex>
+#include <vector>
 
+#include <QtCore/QHash>
 #include <QtCore/QJsonDocument>
 
 #include "../Frame.h"
+#include "ClipIndex.h"
 
 namespace recording {
 
 struct PointerFrameHeader : public FrameHeader {
-    FrameType type;
-    Frame::Time timeOffset;
     uint16_t size;
     quint64 fileOffset;
 };
 
-using PointerFrameHeaderList = std::list<PointerFrameHeader>;
+// The read-only part of a pointer clip: the clip bytes, the file header and the frame index over them.  Frames are
+// decoded on demand straight from the bytes, so any number of PointerClips can share one instance, each with a
+// position of its own.
+class PointerClipData {
+public:
+    using Pointer = std::shared_ptr<const PointerClipData>;
+
+    // owner keeps the bytes alive, e.g. the file they are mapped from, for as long as the clip data exists
+    PointerClipData(const QString& name, uchar* data, size_t size, const std::shared_ptr<void>& owner);
+
+    bool isValid() const { return _valid; }
+    const QString& getName() const { return _name; }
+    const QJsonDocument& getHeader() const { return _header; }
+
+    size_t frameCount() const { return _frameCount; }
+    Frame::Time frameTime(size_t index) const;
+    // index of the first frame at or after time
+    size_t lowerBound(Frame::Time time) const;
+    FrameConstPointer readFrame(size_t index) const;
+
+private:
+    bool parseHeader(size_t& headerEnd);
+    bool loadIndex(size_t headerEnd);
+    void scanFrames(size_t headerEnd);
+    bool readFrameHeader(quint64 offset, quint64 limit, PointerFrameHeader& header) const;
+    index::Record readRecord(size_t index) const;
+    index::SeekEntry readSeekEntry(size_t entry) const;
+
+    const QString _name;
+    uchar* const _data;
+    const size_t _size;
+    const std::shared_ptr<void> _owner;
+
+    bool _valid { false };
+    QJsonDocument _header;
+    bool _compressed { true };
+    QHash<FrameType, FrameType> _translationMap;
+    size_t _frameCount { 0 };
+
+    // indexed files read their records and seek table in place from the index frames
+    bool _indexed { false };
+    quint64 _indexOffset { 0 };
+    size_t _seekEntryCount { 0 };
+    Frame::Time _seekInterval { 0 };
 
-class PointerClip : public ArrayClip<PointerFrameHeader> {
+    // older files, and files with frame types unknown to this build, have their frame headers parsed at load
+    std::vector<PointerFrameHeader> _frames;
+};
+
+class PointerClip : public Clip {
 public:
     using Pointer = std::shared_ptr<PointerClip>;
 
     PointerClip() {};
     PointerClip(uchar* data, size_t size) { init(data, size); }
 
-    void init(uchar* data, size_t size);
+    void init(uchar* data, size_t size, const QString& name = QString(), const std::shared_ptr<void>& owner = nullptr);
+
+    virtual QString getName() const override;
+    virtual Clip::Pointer duplicate() const override;
+    virtual Clip::Pointer share() const override;
+
+    virtual float duration() const override;
+    virtual size_t frameCount() const override;
+
+    virtual void seekFrameTime(Frame::Time offset) override;
+    virtual Frame::Time positionFrameTime() const override;
+
+    virtual FrameConstPointer peekFrame() const override;
+    virtual FrameConstPointer nextFrame() override;
+    virtual void skipFrame() override;
     virtual void addFrame(FrameConstPointer) override;
-    const QJsonDocument& getHeader() const {
-        return _header;
-    }
+
+    const QJsonDocument& getHeader() const;
 
     // FIXME move to frame?
     static const qint64 MINIMUM_FRAME_SIZE = sizeof(FrameType) + sizeof(Frame::Time) + sizeof(FrameSize);
 protected:
     void reset() override;
-    virtual FrameConstPointer readFrame(size_t index) const override;
-    QJsonDocument _header;
-    uchar* _data { nullptr };
-    size_t _size { 0 };
-    bool _compressed { true };
+    PointerClipData::Pointer _clipData;
+    size_t _frameIndex { 0 };
 };
 
 }
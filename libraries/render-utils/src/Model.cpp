@@ -263,7 +263,7 @@ void Model::updateRenderItems() {
             });
         }
 
-        AbstractViewStateInterface::instance()->getMain3DScene()->enqueueTransaction(transaction);
+        AbstractViewStateInterface::instance()->getMain3DScene()->enqueueTransaction(std::move(transaction));
     });
 }
 
@@ -412,6 +412,86 @@ bool Model::findRayIntersectionAgainstSubMeshes(const glm::vec3& origin, const g
     return intersectedSomething;
 }
 
+size_t Model::findRayIntersectionsAgainstSubMeshes(const std::vector<TriangleSet::Ray>& rays,
+                                                   std::vector<TriangleSet::RayHit>& hits,
+                                                   bool pickAgainstTriangles, bool allowBackface) {
+    hits.clear();
+    hits.resize(rays.size());
+
+    // if we aren't active, we can't ray pick yet...
+    if (!isActive()) {
+        return 0;
+    }
+
+    glm::mat4 modelToWorldMatrix = createMatFromQuatAndPos(_rotation, _translation);
+    glm::mat4 worldToModelMatrix = glm::inverse(modelToWorldMatrix);
+
+    Extents modelExtents = getMeshExtents(); // NOTE: unrotated
+
+    glm::vec3 dimensions = modelExtents.maximum - modelExtents.minimum;
+    glm::vec3 corner = -(dimensions * _registrationPoint);
+    AABox modelFrameBox(corner, dimensions);
+
+    glm::mat4 meshToModelMatrix = glm::scale(_scale) * glm::translate(_offset);
+    glm::mat4 meshToWorldMatrix = modelToWorldMatrix * meshToModelMatrix;
+    glm::mat4 worldToMeshMatrix = glm::inverse(meshToWorldMatrix);
+
+    // only the rays that reach the model's box are tested against its meshes
+    std::vector<TriangleSet::Ray> meshFrameRays;
+    std::vector<size_t> rayIndices;
+    for (size_t i = 0; i < rays.size(); i++) {
+        glm::vec3 modelFrameOrigin = glm::vec3(worldToModelMatrix * glm::vec4(rays[i].origin, 1.0f));
+        glm::vec3 modelFrameDirection = glm::vec3(worldToModelMatrix * glm::vec4(rays[i].direction, 0.0f));
+        float distance;
+        BoxFace face;
+        glm::vec3 surfaceNormal;
+        if (modelFrameBox.findRayIntersection(modelFrameOrigin, modelFrameDirection, distance, face, surfaceNormal)) {
+            TriangleSet::Ray meshFrameRay;
+            meshFrameRay.origin = glm::vec3(worldToMeshMatrix * glm::vec4(rays[i].origin, 1.0f));
+            meshFrameRay.direction = glm::vec3(worldToMeshMatrix * glm::vec4(rays[i].direction, 0.0f));
+            meshFrameRays.push_back(meshFrameRay);
+            rayIndices.push_back(i);
+        }
+    }
+    if (meshFrameRays.empty()) {
+        return 0;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    if (!_triangleSetsValid) {
+        calculateTriangleSets();
+    }
+
+    size_t numHits = 0;
+    std::vector<TriangleSet::RayHit> triangleSetHits;
+    for (auto& triangleSet : _modelSpaceMeshTriangleSets) {
+        if (triangleSet.findRayIntersections(meshFrameRays, triangleSetHits, pickAgainstTriangles, allowBackface) == 0) {
+            continue;
+        }
+        for (size_t i = 0; i < meshFrameRays.size(); i++) {
+            const TriangleSet::RayHit& triangleSetHit = triangleSetHits[i];
+            if (!triangleSetHit.intersects) {
+                continue;
+            }
+            const TriangleSet::Ray& meshFrameRay = meshFrameRays[i];
+            glm::vec3 meshIntersectionPoint = meshFrameRay.origin + (meshFrameRay.direction * triangleSetHit.distance);
+            glm::vec3 worldIntersectionPoint = glm::vec3(meshToWorldMatrix * glm::vec4(meshIntersectionPoint, 1.0f));
+            float worldDistance = glm::distance(rays[rayIndices[i]].origin, worldIntersectionPoint);
+
+            TriangleSet::RayHit& hit = hits[rayIndices[i]];
+            if (worldDistance < hit.distance) {
+                numHits += hit.intersects ? 0 : 1;
+                hit.intersects = true;
+                hit.distance = worldDistance;
+                hit.face = triangleSetHit.face;
+                hit.surfaceNormal = glm::vec3(meshToWorldMatrix * glm::vec4(triangleSetHit.surfaceNormal, 0.0f));
+            }
+        }
+    }
+    return numHits;
+}
+
 bool Model::convexHullContains(glm::vec3 point) {
     // if we aren't active, we can't compute that yet...
     if (!isActive()) {
@@ -509,21 +589,26 @@ void Model::calculateTriangleSets() {
     _modelSpaceMeshTriangleSets.clear();
     _modelSpaceMeshTriangleSets.resize(numberOfMeshes);
 
+    const int INDICES_PER_TRIANGLE = 3;
+    const int INDICES_PER_QUAD = 4;
+    const int TRIANGLES_PER_QUAD = 2;
+
     for (int i = 0; i < numberOfMeshes; i++) {
         const FBXMesh& mesh = geometry.meshes.at(i);
 
+        // tell our triangleSet how many triangles to expect across all parts.
+        int totalTriangles = 0;
+        for (const auto& part : mesh.parts) {
+            totalTriangles += (part.quadIndices.size() / INDICES_PER_QUAD) * TRIANGLES_PER_QUAD;
+            totalTriangles += part.triangleIndices.size() / INDICES_PER_TRIANGLE;
+        }
+        _modelSpaceMeshTriangleSets[i].reserve(totalTriangles);
+
         for (int j = 0; j < mesh.parts.size(); j++) {
             const FBXMeshPart& part = mesh.parts.at(j);
 
-            const int INDICES_PER_TRIANGLE = 3;
-            const int INDICES_PER_QUAD = 4;
-            const int TRIANGLES_PER_QUAD = 2;
-
-            // tell our triangleSet how many triangles to expect.
             int numberOfQuads = part.quadIndices.size() / INDICES_PER_QUAD;
             int numberOfTris = part.triangleIndices.size() / INDICES_PER_TRIANGLE;
-            int totalTriangles = (numberOfQuads * TRIANGLES_PER_QUAD) + numberOfTris;
-            _modelSpaceMeshTriangleSets[i].reserve(totalTriangles);
 
             auto meshTransform = getFBXGeometry().offset * mesh.modelTransform;
 
@@ -583,7 +668,7 @@ void Model::setVisibleInScene(bool newValue, const render::ScenePointer& scene)
         foreach(auto item, _collisionRenderItemsMap.keys()) {
             transaction.resetItem(item, _collisionRenderItemsMap[item]);
         }
-        scene->enqueueTransaction(transaction);
+        scene->enqueueTransaction(std::move(transaction));
     }
 }
 
@@ -599,7 +684,7 @@ void Model::setLayeredInFront(bool layered, const render::ScenePointer& scene) {
         foreach(auto item, _collisionRenderItemsMap.keys()) {
             transaction.resetItem(item, _collisionRenderItemsMap[item]);
         }
-        scene->enqueueTransaction(transaction);
+        scene->enqueueTransaction(std::move(transaction));
     }
 }
 
@@ -159,6 +159,12 @@ public:
                                              BoxFace& face, glm::vec3& surfaceNormal, 
                                              QString& extraInfo, bool pickAgainstTriangles = false, bool allowBackface = false);
 
+    /// Same as above for a batch of world space rays, which are tested against each sub mesh together. hits is resized
+    /// to match rays, and returns the number of rays that hit the model.
+    size_t findRayIntersectionsAgainstSubMeshes(const std::vector<TriangleSet::Ray>& rays,
+                                                std::vector<TriangleSet::RayHit>& hits,
+                                                bool pickAgainstTriangles = false, bool allowBackface = false);
+
     void setOffset(const glm::vec3& offset);
     const glm::vec3& getOffset() const { return _offset; }
 
@@ -0,0 +1,107 @@
+//
+//  BlockPool.cpp
+//  render/src/render
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BlockPool.h"
+
+#include <new>
+
+using namespace render;
+
+BlockPool& BlockPool::getInstance() {
+    // never destroyed, since transactions may still be freed by other statics on the way out
+    static BlockPool* pool = new BlockPool();
+    return *pool;
+}
+
+BlockPool::~BlockPool() {
+    for (auto& chunk : _chunks) {
+        delete chunk.load();
+    }
+}
+
+BlockPool::Header* BlockPool::header(uint32_t index) const {
+    Chunk* chunk = _chunks[index / BLOCKS_PER_CHUNK].load(std::memory_order_acquire);
+    return reinterpret_cast<Header*>(chunk->blocks + (index % BLOCKS_PER_CHUNK) * STRIDE);
+}
+
+std::atomic<uint32_t>& BlockPool::next(uint32_t index) const {
+    Chunk* chunk = _chunks[index / BLOCKS_PER_CHUNK].load(std::memory_order_acquire);
+    return chunk->next[index % BLOCKS_PER_CHUNK];
+}
+
+void* BlockPool::allocate() {
+    uint64_t head = _head.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t index = headIndex(head);
+        if (index == END_OF_STACK) {
+            if (addChunk()) {
+                head = _head.load(std::memory_order_acquire);
+                continue;
+            }
+            _numHeapAllocations++;
+            Header* heapHeader = static_cast<Header*>(::operator new(STRIDE));
+            heapHeader->index = HEAP_BLOCK;
+            return heapHeader + 1;
+        }
+
+        // chunks are never freed, so this is safe to read even if another thread pops the block first, and the tag
+        // makes the exchange fail if it did
+        uint32_t nextIndex = next(index).load(std::memory_order_relaxed);
+        if (_head.compare_exchange_weak(head, makeHead(nextIndex, headTag(head) + 1),
+                std::memory_order_acquire, std::memory_order_acquire)) {
+            return header(index) + 1;
+        }
+    }
+}
+
+void BlockPool::free(void* block) {
+    if (!block) {
+        return;
+    }
+    Header* blockHeader = static_cast<Header*>(block) - 1;
+    if (blockHeader->index == HEAP_BLOCK) {
+        ::operator delete(blockHeader);
+        return;
+    }
+    push(blockHeader->index, blockHeader->index);
+}
+
+void BlockPool::push(uint32_t first, uint32_t last) {
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    do {
+        next(last).store(headIndex(head), std::memory_order_relaxed);
+    } while (!_head.compare_exchange_weak(head, makeHead(first, headTag(head) + 1),
+        std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool BlockPool::addChunk() {
+    std::lock_guard<std::mutex> lock(_chunkMutex);
+    if (headIndex(_head.load(std::memory_order_acquire)) != END_OF_STACK) {
+        return true; // another thread added one, or blocks were freed, while we waited
+    }
+
+    uint32_t chunkIndex = _numChunks.load();
+    if (chunkIndex == MAX_CHUNKS) {
+        return false;
+    }
+
+    Chunk* chunk = new Chunk();
+    _chunks[chunkIndex].store(chunk, std::memory_order_release);
+    uint32_t first = chunkIndex * BLOCKS_PER_CHUNK;
+    for (uint32_t i = 0; i < BLOCKS_PER_CHUNK; i++) {
+        header(first + i)->index = first + i;
+        chunk->next[i].store(first + i + 1, std::memory_order_relaxed);
+    }
+    _numChunks.store(chunkIndex + 1);
+
+    // the last block is linked to whatever is on the stack by now
+    push(first, first + BLOCKS_PER_CHUNK - 1);
+    return true;
+}
@@ -0,0 +1,105 @@
+//
+//  BlockPool.h
+//  render/src/render
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_render_BlockPool_h
+#define hifi_render_BlockPool_h
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace render {
+
+// A pool of small fixed size blocks that any thread can allocate and free without locking, for the objects every
+// Transaction allocates, like the UpdateFunctors and their shared_ptr control blocks.  Blocks live in chunks that are
+// never freed, and the free blocks are kept in a stack whose head is tagged, so a block popped and pushed back by other
+// threads in between can't fool a pop.  A chunk is only added, under a mutex, when the stack runs dry; once all the
+// chunks are used the pool falls back to the heap.
+class BlockPool {
+public:
+    static const size_t BLOCK_SIZE = 128; // bytes, enough for an UpdateFunctor and its control block
+    static const uint32_t BLOCKS_PER_CHUNK = 1024;
+    static const uint32_t MAX_CHUNKS = 256;
+
+    static BlockPool& getInstance();
+
+    BlockPool() {}
+    ~BlockPool();
+
+    void* allocate();
+    void free(void* block);
+
+    uint32_t getCapacity() const { return _numChunks.load() * BLOCKS_PER_CHUNK; }
+    uint32_t getNumHeapAllocations() const { return _numHeapAllocations.load(); }
+
+private:
+    static const uint32_t HEAP_BLOCK = (uint32_t)-1;
+    static const uint32_t END_OF_STACK = (uint32_t)-1;
+
+    // every block is preceded by the index it has in the pool, so free doesn't have to search the chunks
+    struct alignas(16) Header {
+        uint32_t index;
+    };
+    static const size_t STRIDE = sizeof(Header) + BLOCK_SIZE;
+
+    struct Chunk {
+        std::atomic<uint32_t> next[BLOCKS_PER_CHUNK];
+        alignas(16) uint8_t blocks[BLOCKS_PER_CHUNK * STRIDE];
+    };
+
+    static uint64_t makeHead(uint32_t index, uint32_t tag) { return ((uint64_t)tag << 32) | index; }
+    static uint32_t headIndex(uint64_t head) { return (uint32_t)head; }
+    static uint32_t headTag(uint64_t head) { return (uint32_t)(head >> 32); }
+
+    Header* header(uint32_t index) const;
+    std::atomic<uint32_t>& next(uint32_t index) const;
+
+    void push(uint32_t first, uint32_t last);
+    bool addChunk();
+
+    std::atomic<uint64_t> _head { makeHead(END_OF_STACK, 0) };
+    std::atomic<Chunk*> _chunks[MAX_CHUNKS] {};
+    std::atomic<uint32_t> _numChunks { 0 };
+    std::atomic<uint32_t> _numHeapAllocations { 0 };
+    std::mutex _chunkMutex;
+};
+
+// Allocates single objects that fit in a block from the BlockPool, and anything else from the heap.  The decision only
+// depends on the size of what is allocated, so deallocate makes the same one.
+template <class T> class BlockAllocator {
+public:
+    using value_type = T;
+
+    BlockAllocator() {}
+    template <class U> BlockAllocator(const BlockAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n * sizeof(T) <= BlockPool::BLOCK_SIZE && alignof(T) <= 16) {
+            return static_cast<T*>(BlockPool::getInstance().allocate());
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        if (n * sizeof(T) <= BlockPool::BLOCK_SIZE && alignof(T) <= 16) {
+            BlockPool::getInstance().free(pointer);
+        } else {
+            std::allocator<T>().deallocate(pointer, n);
+        }
+    }
+
+    template <class U> bool operator==(const BlockAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const BlockAllocator<U>&) const { return false; }
+};
+
+}
+
+#endif // hifi_render_BlockPool_h
@@ -14,11 +14,71 @@
 #include <algorithm>
 #include <assert.h>
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QThreadPool>
+
 #include <OctreeUtils.h>
 #include <PerfStat.h>
 
 using namespace render;
 
+static const size_t MIN_ITEMS_PER_JOB = 256;
+
+struct CullCounts {
+    int outOfView { 0 };
+    int tooSmall { 0 };
+};
+
+// Tests the items in contiguous runs, the calling thread taking the first run and the global thread pool the others,
+// each run into its own list.  The lists are appended in order, so the result is the one a serial loop gives.
+template <typename F>
+static void cullItemsInParallel(const ItemIDs& inItems, ItemBounds& outItems, RenderDetails::Item& details, const F& test) {
+    size_t numItems = inItems.size();
+    auto threadPool = QThreadPool::globalInstance();
+    size_t maxJobs = (size_t)std::max(threadPool->maxThreadCount(), 1) + 1;
+    size_t numJobs = std::min(maxJobs, (numItems + MIN_ITEMS_PER_JOB - 1) / MIN_ITEMS_PER_JOB);
+    if (numJobs <= 1) {
+        CullCounts counts;
+        for (auto id : inItems) {
+            test(id, outItems, counts);
+        }
+        details._outOfView += counts.outOfView;
+        details._tooSmall += counts.tooSmall;
+        return;
+    }
+
+    size_t itemsPerJob = (numItems + numJobs - 1) / numJobs;
+    std::vector<ItemBounds> jobItems(numJobs);
+    std::vector<CullCounts> jobCounts(numJobs);
+    const ItemID* ids = inItems.data();
+    auto cullRun = [&, ids](size_t job) {
+        size_t begin = job * itemsPerJob;
+        size_t end = std::min(begin + itemsPerJob, numItems);
+        auto& items = jobItems[job];
+        items.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            test(ids[i], items, jobCounts[job]);
+        }
+    };
+
+    std::vector<QFuture<void>> jobs;
+    for (size_t job = 1; job < numJobs; ++job) {
+        jobs.push_back(QtConcurrent::run(threadPool, [&cullRun, job] {
+            cullRun(job);
+        }));
+    }
+    cullRun(0);
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+
+    for (size_t job = 0; job < numJobs; ++job) {
+        outItems.insert(outItems.end(), jobItems[job].begin(), jobItems[job].end());
+        details._outOfView += jobCounts[job].outOfView;
+        details._tooSmall += jobCounts[job].tooSmall;
+    }
+}
+
 void render::cullItems(const RenderContextPointer& renderContext, const CullFunctor& cullFunctor, RenderDetails::Item& details,
                        const ItemBounds& inItems, ItemBounds& outItems) {
     assert(renderContext->args);
@@ -131,51 +191,54 @@ void CullSpatialSelection::run(const RenderContextPointer& renderContext,
         args->pushViewFrustum(_frozenFrutstum); // replace the true view frustum by the frozen one
     }
 
-    // Culling Frustum / solidAngle test helper class
-    struct Test {
-        CullFunctor _functor;
-        RenderArgs* _args;
-        RenderDetails::Item& _renderDetails;
-        glm::vec3 _eyePos;
-        float _squareTanAlpha;
-
-        Test(CullFunctor& functor, RenderArgs* pargs, RenderDetails::Item& renderDetails) :
-            _functor(functor),
-            _args(pargs),
-            _renderDetails(renderDetails)
-        {
-            // FIXME: Keep this code here even though we don't use it yet
-            /*_eyePos = _args->getViewFrustum().getPosition();
-            float a = glm::degrees(Octree::getAccuracyAngle(_args->_sizeScale, _args->_boundaryLevelAdjust));
-            auto angle = std::min(glm::radians(45.0f), a); // no worse than 45 degrees
-            angle = std::max(glm::radians(1.0f / 60.0f), a); // no better than 1 minute of degree
-            auto tanAlpha = tan(angle);
-            _squareTanAlpha = (float)(tanAlpha * tanAlpha);
-            */
-        }
+    // Culling Frustum / solidAngle tests, called from the worker threads with their own counts
+    const ViewFrustum& frustum = args->getViewFrustum();
+    const CullFunctor& cullFunctor = _cullFunctor;
+    const ItemFilter& filter = _filter;
 
-        bool frustumTest(const AABox& bound) {
-            if (!_args->getViewFrustum().boxIntersectsFrustum(bound)) {
-                _renderDetails._outOfView++;
-                return false;
+    auto filterTest = [&](ItemID id, ItemBounds& items, CullCounts&) {
+        auto& item = scene->getItem(id);
+        if (filter.test(item.getKey())) {
+            items.emplace_back(ItemBound(id, item.getBound()));
+        }
+    };
+    auto solidAngleTest = [&](ItemID id, ItemBounds& items, CullCounts& counts) {
+        auto& item = scene->getItem(id);
+        if (filter.test(item.getKey())) {
+            ItemBound itemBound(id, item.getBound());
+            if (!cullFunctor(args, itemBound.bound)) {
+                counts.tooSmall++;
+                return;
             }
-            return true;
+            items.emplace_back(itemBound);
         }
-
-        bool solidAngleTest(const AABox& bound) {
-            // FIXME: Keep this code here even though we don't use it yet
-            //auto eyeToPoint = bound.calcCenter() - _eyePos;
-            //auto boundSize = bound.getDimensions();
-            //float test = (glm::dot(boundSize, boundSize) / glm::dot(eyeToPoint, eyeToPoint)) - squareTanAlpha;
-            //if (test < 0.0f) {
-            if (!_functor(_args, bound)) {
-                _renderDetails._tooSmall++;
-                return false;
+    };
+    auto frustumTest = [&](ItemID id, ItemBounds& items, CullCounts& counts) {
+        auto& item = scene->getItem(id);
+        if (filter.test(item.getKey())) {
+            ItemBound itemBound(id, item.getBound());
+            if (!frustum.boxIntersectsFrustum(itemBound.bound)) {
+                counts.outOfView++;
+                return;
+            }
+            items.emplace_back(itemBound);
+        }
+    };
+    auto frustumAndSolidAngleTest = [&](ItemID id, ItemBounds& items, CullCounts& counts) {
+        auto& item = scene->getItem(id);
+        if (filter.test(item.getKey())) {
+            ItemBound itemBound(id, item.getBound());
+            if (!frustum.boxIntersectsFrustum(itemBound.bound)) {
+                counts.outOfView++;
+                return;
             }
-            return true;
+            if (!cullFunctor(args, itemBound.bound)) {
+                counts.tooSmall++;
+                return;
+            }
+            items.emplace_back(itemBound);
         }
     };
-    Test test(_cullFunctor, args, details);
 
     // Now we have a selection of items to render
     outItems.clear();
@@ -190,49 +253,25 @@ void CullSpatialSelection::run(const RenderContextPointer& renderContext,
         // inside & fit items: filter only, culling is disabled
         {
             PerformanceTimer perfTimer("insideFitItems");
-            for (auto id : inSelection.insideItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    outItems.emplace_back(itemBound);
-                }
-            }
+            cullItemsInParallel(inSelection.insideItems, outItems, details, filterTest);
         }
 
         // inside & subcell items: filter only, culling is disabled
         {
             PerformanceTimer perfTimer("insideSmallItems");
-            for (auto id : inSelection.insideSubcellItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    outItems.emplace_back(itemBound);
-                }
-            }
+            cullItemsInParallel(inSelection.insideSubcellItems, outItems, details, filterTest);
         }
 
         // partial & fit items: filter only, culling is disabled
         {
             PerformanceTimer perfTimer("partialFitItems");
-            for (auto id : inSelection.partialItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    outItems.emplace_back(itemBound);
-                }
-            }
+            cullItemsInParallel(inSelection.partialItems, outItems, details, filterTest);
         }
 
         // partial & subcell items: filter only, culling is disabled
         {
             PerformanceTimer perfTimer("partialSmallItems");
-            for (auto id : inSelection.partialSubcellItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    outItems.emplace_back(itemBound);
-                }
-            }
+            cullItemsInParallel(inSelection.partialSubcellItems, outItems, details, filterTest);
         }
 
     } else {
@@ -240,57 +279,25 @@ void CullSpatialSelection::run(const RenderContextPointer& renderContext,
         // inside & fit items: easy, just filter
         {
             PerformanceTimer perfTimer("insideFitItems");
-            for (auto id : inSelection.insideItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    outItems.emplace_back(itemBound);
-                }
-            }
+            cullItemsInParallel(inSelection.insideItems, outItems, details, filterTest);
         }
 
         // inside & subcell items: filter & distance cull
         {
             PerformanceTimer perfTimer("insideSmallItems");
-            for (auto id : inSelection.insideSubcellItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    if (test.solidAngleTest(itemBound.bound)) {
-                        outItems.emplace_back(itemBound);
-                    }
-                }
-            }
+            cullItemsInParallel(inSelection.insideSubcellItems, outItems, details, solidAngleTest);
         }
 
         // partial & fit items: filter & frustum cull
         {
             PerformanceTimer perfTimer("partialFitItems");
-            for (auto id : inSelection.partialItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    if (test.frustumTest(itemBound.bound)) {
-                        outItems.emplace_back(itemBound);
-                    }
-                }
-            }
+            cullItemsInParallel(inSelection.partialItems, outItems, details, frustumTest);
         }
 
         // partial & subcell items:: filter & frutum cull & solidangle cull
         {
             PerformanceTimer perfTimer("partialSmallItems");
-            for (auto id : inSelection.partialSubcellItems) {
-                auto& item = scene->getItem(id);
-                if (_filter.test(item.getKey())) {
-                    ItemBound itemBound(id, item.getBound());
-                    if (test.frustumTest(itemBound.bound)) {
-                        if (test.solidAngleTest(itemBound.bound)) {
-                            outItems.emplace_back(itemBound);
-                        }
-                    }
-                }
-            }
+            cullItemsInParallel(inSelection.partialSubcellItems, outItems, details, frustumAndSolidAngleTest);
         }
     }
 
@@ -14,6 +14,8 @@
 #include <algorithm>
 #include <assert.h>
 
+#include <QtCore/QThread>
+
 #include <PerfStat.h>
 #include <ViewFrustum.h>
 
@@ -163,28 +165,41 @@ void DrawStatus::run(const RenderContextPointer& renderContext, const ItemBounds
     }
 
     // Allright, something to render let's do it
-    gpu::doInBatch(args->_context, [&](gpu::Batch& batch) {
-        glm::mat4 projMat;
-        Transform viewMat;
-        args->getViewFrustum().evalProjectionMatrix(projMat);
-        args->getViewFrustum().evalViewTransform(viewMat);
+    glm::mat4 projMat;
+    Transform viewMat;
+    args->getViewFrustum().evalProjectionMatrix(projMat);
+    args->getViewFrustum().evalViewTransform(viewMat);
+
+    // the pipelines and their uniform locations are made here, before any batch records with them
+    auto drawItemBoundsPipeline = getDrawItemBoundsPipeline();
+    auto drawItemStatusPipeline = getDrawItemStatusPipeline();
+    auto statusIconMap = getStatusIconMap();
+
+    // each pass records contiguous runs of items, one batch per run, in parallel;
+    // the batches only read the bounds and status collected above and are merged into the frame in order
+    const int MIN_ITEMS_PER_BATCH = 256;
+    int numBatches = std::max(1, std::min(QThread::idealThreadCount(), nbItems / MIN_ITEMS_PER_BATCH));
+    int itemsPerBatch = (nbItems + numBatches - 1) / numBatches;
+
+    auto setupBatch = [&](gpu::Batch& batch) {
         batch.setViewportTransform(args->_viewport);
-
         batch.setProjectionTransform(projMat);
         batch.setViewTransform(viewMat, true);
         batch.setModelTransform(Transform());
+    };
 
-        // bind the one gpu::Pipeline we need
-        batch.setPipeline(getDrawItemBoundsPipeline());
+    const unsigned int VEC3_ADRESS_OFFSET = 3;
 
-        //AABox* itemAABox = reinterpret_cast<AABox*> (_itemBounds->editData());
-        //glm::ivec4* itemStatus = reinterpret_cast<glm::ivec4*> (_itemStatus->editData());
-        //Octree::Location* itemCell = reinterpret_cast<Octree::Location*> (_itemCells->editData());
+    if (_showDisplay) {
+        gpu::doInParallelBatches(args->_context, numBatches, [&](gpu::Batch& batch, size_t index) {
+            setupBatch(batch);
 
-        const unsigned int VEC3_ADRESS_OFFSET = 3;
+            // bind the one gpu::Pipeline we need
+            batch.setPipeline(drawItemBoundsPipeline);
 
-        if (_showDisplay) {
-            for (int i = 0; i < nbItems; i++) {
+            int begin = (int)index * itemsPerBatch;
+            int end = std::min(begin + itemsPerBatch, nbItems);
+            for (int i = begin; i < end; i++) {
                 batch._glUniform3fv(_drawItemBoundPosLoc, 1, (const float*)&(_itemBounds[i]));
                 batch._glUniform3fv(_drawItemBoundDimLoc, 1, ((const float*)&(_itemBounds[i])) + VEC3_ADRESS_OFFSET);
 
@@ -192,21 +207,26 @@ void DrawStatus::run(const RenderContextPointer& renderContext, const ItemBounds
                 batch._glUniform4iv(_drawItemCellLocLoc, 1, ((const int*)(&cellLocation)));
                 batch.draw(gpu::LINES, 24, 0);
             }
-        }
+        });
+    }
 
-        batch.setResourceTexture(0, gpu::TextureView(getStatusIconMap(), 0));
+    if (_showNetwork) {
+        gpu::doInParallelBatches(args->_context, numBatches, [&](gpu::Batch& batch, size_t index) {
+            setupBatch(batch);
 
-        batch.setPipeline(getDrawItemStatusPipeline());
+            batch.setResourceTexture(0, gpu::TextureView(statusIconMap, 0));
+            batch.setPipeline(drawItemStatusPipeline);
 
-        if (_showNetwork) {
-            for (int i = 0; i < nbItems; i++) {
+            int begin = (int)index * itemsPerBatch;
+            int end = std::min(begin + itemsPerBatch, nbItems);
+            for (int i = begin; i < end; i++) {
                 batch._glUniform3fv(_drawItemStatusPosLoc, 1, (const float*)&(_itemBounds[i]));
                 batch._glUniform3fv(_drawItemStatusDimLoc, 1, ((const float*)&(_itemBounds[i])) + VEC3_ADRESS_OFFSET);
                 batch._glUniform4iv(_drawItemStatusValue0Loc, 1, (const int*)&(_itemStatus[i].first));
                 batch._glUniform4iv(_drawItemStatusValue1Loc, 1, (const int*)&(_itemStatus[i].second));
                 batch.draw(gpu::TRIANGLES, 24 * NUM_STATUS_VEC4_PER_ITEM, 0);
             }
-        }
-        batch.setResourceTexture(0, 0);
-    });
+            batch.setResourceTexture(0, 0);
+        });
+    }
 }
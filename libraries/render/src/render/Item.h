@@ -393,7 +393,7 @@ public:
     typedef std::function<void(T&)> Func;
     Func _func;
 
-    UpdateFunctor(Func func): _func(func) {}
+    UpdateFunctor(Func func): _func(std::move(func)) {}
     ~UpdateFunctor() {}
 };
 
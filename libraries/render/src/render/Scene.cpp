@@ -54,6 +54,11 @@ void Transaction::resetSelection(const Selection& selection) {
     _resetSelections.emplace_back(selection);
 }
 
+bool Transaction::isEmpty() const {
+    return _resetItems.empty() && _removedItems.empty() && _updatedItems.empty() && _addedTransitions.empty() &&
+        _queriedTransitions.empty() && _reAppliedTransitions.empty() && _resetSelections.empty();
+}
+
 void Transaction::merge(const Transaction& transaction) {
     _resetItems.insert(_resetItems.end(), transaction._resetItems.begin(), transaction._resetItems.end());
     _removedItems.insert(_removedItems.end(), transaction._removedItems.begin(), transaction._removedItems.end());
@@ -73,6 +78,12 @@ Scene::Scene(glm::vec3 origin, float size) :
 
 Scene::~Scene() {
     qCDebug(renderlogging) << "Scene::~Scene()";
+    auto node = _transactionQueue.exchange(nullptr);
+    while (node) {
+        auto next = node->next;
+        delete node;
+        node = next;
+    }
 }
 
 ItemID Scene::allocateID() {
@@ -85,32 +96,39 @@ bool Scene::isAllocatedID(const ItemID& id) const {
 }
 
 /// Enqueue change batch to the scene
-void Scene::enqueueTransaction(const Transaction& transaction) {
-    _transactionQueueMutex.lock();
-    _transactionQueue.push(transaction);
-    _transactionQueueMutex.unlock();
-}
-
-void consolidateTransaction(TransactionQueue& queue, Transaction& singleBatch) {
-    while (!queue.empty()) {
-        const auto& transaction = queue.front();
-        singleBatch.merge(transaction);
-        queue.pop();
-    };
+void Scene::enqueueTransaction(Transaction&& transaction) {
+    if (transaction.isEmpty()) {
+        return;
+    }
+    auto node = new TransactionNode(std::move(transaction));
+    node->next = _transactionQueue.load(std::memory_order_relaxed);
+    while (!_transactionQueue.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
 }
 
 uint32_t Scene::enqueueFrame() {
     PROFILE_RANGE(render, __FUNCTION__);
-    Transaction consolidatedTransaction;
-    {
-        std::unique_lock<std::mutex> lock(_transactionQueueMutex);
-        consolidateTransaction(_transactionQueue, consolidatedTransaction);
+
+    // the stack is taken whole, so the nodes can't be reused under a producer
+    TransactionNode* node = _transactionQueue.exchange(nullptr, std::memory_order_acquire);
+    size_t numTransactions = 0;
+    for (auto counted = node; counted; counted = counted->next) {
+        numTransactions++;
+    }
+
+    // the stack is most recent first
+    TransactionFrame frame(numTransactions);
+    for (size_t i = numTransactions; i > 0; i--) {
+        frame[i - 1] = std::move(node->transaction);
+        auto next = node->next;
+        delete node;
+        node = next;
     }
 
     uint32_t frameNumber = 0;
     {
         std::unique_lock<std::mutex> lock(_transactionFramesMutex);
-        _transactionFrames.push_back(consolidatedTransaction);
+        _transactionFrames.push_back(std::move(frame));
         _transactionFrameNumber++;
         frameNumber = _transactionFrameNumber;
     }
@@ -126,18 +144,34 @@ void Scene::processTransactionQueue() {
     {
         // capture the queued frames and clear the queue
         std::unique_lock<std::mutex> lock(_transactionFramesMutex);
-        queuedFrames = _transactionFrames;
-        _transactionFrames.clear();
+        queuedFrames.swap(_transactionFrames);
     }
 
+    _transactionStats = TransactionStats();
+    _transactionStats.numFrames = (uint32_t)queuedFrames.size();
+
     // go through the queue of frames and process them
     for (auto& frame : queuedFrames) {
         processTransactionFrame(frame);
     }
 }
 
-void Scene::processTransactionFrame(const Transaction& transaction) {
+void Scene::processTransactionFrame(const TransactionFrame& frame) {
     PROFILE_RANGE(render, __FUNCTION__);
+
+    // the transactions of a frame are applied in the order a merge of them would have been
+    bool touchSelections = false;
+    for (const auto& transaction : frame) {
+        _transactionStats.numTransactions++;
+        _transactionStats.numResetItems += (uint32_t)transaction._resetItems.size();
+        _transactionStats.numUpdatedItems += (uint32_t)transaction._updatedItems.size();
+        _transactionStats.numRemovedItems += (uint32_t)transaction._removedItems.size();
+        _transactionStats.numTransitions += (uint32_t)(transaction._addedTransitions.size() +
+            transaction._reAppliedTransitions.size() + transaction._queriedTransitions.size());
+        _transactionStats.numSelections += (uint32_t)transaction._resetSelections.size();
+        touchSelections = touchSelections || transaction.touchTransactions();
+    }
+
     {
         std::unique_lock<std::mutex> lock(_itemsMutex);
         // Here we should be able to check the value of last ItemID allocated 
@@ -150,31 +184,45 @@ void Scene::processTransactionFrame(const Transaction& transaction) {
         // capture anything coming from the transaction
 
         // resets and potential NEW items
-        resetItems(transaction._resetItems);
+        for (const auto& transaction : frame) {
+            resetItems(transaction._resetItems);
+        }
 
         // Update the numItemsAtomic counter AFTER the reset changes went through
         _numAllocatedItems.exchange(maxID);
 
         // updates
-        updateItems(transaction._updatedItems);
+        for (const auto& transaction : frame) {
+            updateItems(transaction._updatedItems);
+        }
 
         // removes
-        removeItems(transaction._removedItems);
+        for (const auto& transaction : frame) {
+            removeItems(transaction._removedItems);
+        }
 
         // add transitions
-        transitionItems(transaction._addedTransitions);
-        reApplyTransitions(transaction._reAppliedTransitions);
-        queryTransitionItems(transaction._queriedTransitions);
+        for (const auto& transaction : frame) {
+            transitionItems(transaction._addedTransitions);
+        }
+        for (const auto& transaction : frame) {
+            reApplyTransitions(transaction._reAppliedTransitions);
+        }
+        for (const auto& transaction : frame) {
+            queryTransitionItems(transaction._queriedTransitions);
+        }
 
         // Update the numItemsAtomic counter AFTER the pending changes went through
         _numAllocatedItems.exchange(maxID);
     }
 
-    if (transaction.touchTransactions()) {
+    if (touchSelections) {
         std::unique_lock<std::mutex> lock(_selectionsMutex);
 
         // resets and potential NEW items
-        resetSelections(transaction._resetSelections);
+        for (const auto& transaction : frame) {
+            resetSelections(transaction._resetSelections);
+        }
     }
 }
 
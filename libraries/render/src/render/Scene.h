@@ -12,6 +12,7 @@
 #ifndef hifi_render_Scene_h
 #define hifi_render_Scene_h
 
+#include "BlockPool.h"
 #include "Item.h"
 #include "SpatialTree.h"
 #include "Stage.h"
@@ -51,8 +52,9 @@ public:
     void reApplyTransitionToItem(ItemID id);
     void queryTransitionOnItem(ItemID id, TransitionQueryFunc func);
 
+    // the functor and its control block come from the BlockPool, so updating every frame doesn't hit the heap
     template <class T> void updateItem(ItemID id, std::function<void(T&)> func) {
-        updateItem(id, std::make_shared<UpdateFunctor<T>>(func));
+        updateItem(id, std::allocate_shared<UpdateFunctor<T>>(BlockAllocator<UpdateFunctor<T>>(), std::move(func)));
     }
 
     void updateItem(ItemID id, const UpdateFunctorPointer& functor);
@@ -65,6 +67,7 @@ public:
 
     // Checkers if there is work to do when processing the transaction
     bool touchTransactions() const { return !_resetSelections.empty(); }
+    bool isEmpty() const;
 
 protected:
 
@@ -92,7 +95,17 @@ protected:
     TransitionReApplies _reAppliedTransitions;
     SelectionResets _resetSelections;
 };
-typedef std::queue<Transaction> TransactionQueue;
+
+// What the last call to Scene::processTransactionQueue went through
+struct TransactionStats {
+    uint32_t numFrames { 0 };
+    uint32_t numTransactions { 0 };
+    uint32_t numResetItems { 0 };
+    uint32_t numUpdatedItems { 0 };
+    uint32_t numRemovedItems { 0 };
+    uint32_t numTransitions { 0 };
+    uint32_t numSelections { 0 };
+};
 
 
 // Scene is a container for Items
@@ -115,7 +128,9 @@ public:
     size_t getNumItems() const { return _numAllocatedItems.load(); }
 
     // Enqueue transaction to the scene
-    void enqueueTransaction(const Transaction& transaction);
+    // Thread safe and lock free, the transaction is moved as is into the next frame
+    void enqueueTransaction(Transaction&& transaction);
+    void enqueueTransaction(const Transaction& transaction) { enqueueTransaction(Transaction(transaction)); }
 
     // Enqueue end of frame transactions boundary
     uint32_t enqueueFrame();
@@ -123,6 +138,9 @@ public:
     // Process the pending transactions queued
     void processTransactionQueue();
 
+    // What the last processTransactionQueue did, call it from the thread that processes the queue
+    const TransactionStats& getTransactionStats() const { return _transactionStats; }
+
     // Access a particular selection (empty if doesn't exist)
     // Thread safe
     Selection getSelection(const Selection::Name& name) const;
@@ -162,17 +180,27 @@ protected:
     // Thread safe elements that can be accessed from anywhere
     std::atomic<unsigned int> _IDAllocator{ 1 }; // first valid itemID will be One
     std::atomic<unsigned int> _numAllocatedItems{ 1 }; // num of allocated items, matching the _items.size()
-    std::mutex _transactionQueueMutex;
-    TransactionQueue _transactionQueue;
 
-    
+    // The transactions enqueued since the last frame, pushed on a stack that the producers never lock and the frame
+    // takes whole, most recent first
+    struct TransactionNode {
+        TransactionNode(Transaction&& transaction) : transaction(std::move(transaction)) {}
+        Transaction transaction;
+        TransactionNode* next { nullptr };
+    };
+    std::atomic<TransactionNode*> _transactionQueue { nullptr };
+
+    // A frame keeps the transactions of every producer as they were enqueued instead of merging them into one copy,
+    // and applies them together
+    using TransactionFrame = std::vector<Transaction>;
+    using TransactionFrames = std::vector<TransactionFrame>;
     std::mutex _transactionFramesMutex;
-    using TransactionFrames = std::list<Transaction>;
     TransactionFrames _transactionFrames;
     uint32_t _transactionFrameNumber{ 0 };
+    TransactionStats _transactionStats;
 
     // Process one transaction frame 
-    void processTransactionFrame(const Transaction& transaction);
+    void processTransactionFrame(const TransactionFrame& frame);
 
     // The actual database
     // database of items is protected for editing by a mutex
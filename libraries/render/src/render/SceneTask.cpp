@@ -18,4 +18,11 @@ void PerformSceneTransaction::configure(const Config& config) {
 
 void PerformSceneTransaction::run(const RenderContextPointer& renderContext) {
     renderContext->_scene->processTransactionQueue();
+
+    auto& stats = renderContext->_scene->getTransactionStats();
+    auto config = std::static_pointer_cast<Config>(renderContext->jobConfig);
+    config->numTransactions = (int)stats.numTransactions;
+    config->numResetItems = (int)stats.numResetItems;
+    config->numUpdatedItems = (int)stats.numUpdatedItems;
+    config->numRemovedItems = (int)stats.numRemovedItems;
 }
@@ -18,7 +18,19 @@ namespace render {
 
     class PerformSceneTransactionConfig : public Job::Config {
         Q_OBJECT
+        Q_PROPERTY(int numTransactions READ getNumTransactions)
+        Q_PROPERTY(int numResetItems READ getNumResetItems)
+        Q_PROPERTY(int numUpdatedItems READ getNumUpdatedItems)
+        Q_PROPERTY(int numRemovedItems READ getNumRemovedItems)
     public:
+        int numTransactions{ 0 };
+        int numResetItems{ 0 };
+        int numUpdatedItems{ 0 };
+        int numRemovedItems{ 0 };
+        int getNumTransactions() { return numTransactions; }
+        int getNumResetItems() { return numResetItems; }
+        int getNumUpdatedItems() { return numUpdatedItems; }
+        int getNumRemovedItems() { return numRemovedItems; }
     signals:
         void dirty();
 
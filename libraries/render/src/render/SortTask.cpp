@@ -12,71 +12,95 @@
 #include "SortTask.h"
 #include "ShapePipeline.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cstring>
+
 #include <ViewFrustum.h>
 
 using namespace render;
 
-struct ItemBoundSort {
-    float _centerDepth = 0.0f;
-    float _nearDepth = 0.0f;
-    float _farDepth = 0.0f;
-    ItemID _id = 0;
-    AABox _bounds;
-
-    ItemBoundSort() {}
-    ItemBoundSort(float centerDepth, float nearDepth, float farDepth, ItemID id, const AABox& bounds) : _centerDepth(centerDepth), _nearDepth(nearDepth), _farDepth(farDepth), _id(id), _bounds(bounds) {}
+// The items are sorted on the distance from the eye to their center.  A positive float orders the same as its bits do
+// as an unsigned integer, so the distances are sorted with a radix sort on their bits, a byte per pass, inverted to
+// sort back to front.
+struct DepthSortKey {
+    uint32_t key;
+    uint32_t index;
 };
 
-struct FrontToBackSort {
-    bool operator() (const ItemBoundSort& left, const ItemBoundSort& right) {
-        return (left._centerDepth < right._centerDepth);
-    }
-};
+static const int RADIX_BITS = 8;
+static const int RADIX_SIZE = 1 << RADIX_BITS;
+static const int NUM_RADIX_PASSES = 32 / RADIX_BITS;
+
+// below this many items the histograms cost more than a comparison sort
+static const size_t MIN_RADIX_SORT_ITEMS = 64;
+
+static uint32_t depthSortKey(float distance, bool frontToBack) {
+    uint32_t bits;
+    memcpy(&bits, &distance, sizeof(bits));
+    return frontToBack ? bits : ~bits;
+}
+
+static void radixSort(std::vector<DepthSortKey>& keys, std::vector<DepthSortKey>& scratch) {
+    size_t numKeys = keys.size();
+    scratch.resize(numKeys);
+    for (int pass = 0; pass < NUM_RADIX_PASSES; pass++) {
+        int shift = pass * RADIX_BITS;
+        size_t offsets[RADIX_SIZE] = { 0 };
+        for (const auto& key : keys) {
+            offsets[(key.key >> shift) & (RADIX_SIZE - 1)]++;
+        }
+
+        // nothing to do if every key has the same digit, typically the exponent byte of items at similar distances
+        if (offsets[(keys[0].key >> shift) & (RADIX_SIZE - 1)] == numKeys) {
+            continue;
+        }
 
-struct BackToFrontSort {
-    bool operator() (const ItemBoundSort& left, const ItemBoundSort& right) {
-        return (left._centerDepth > right._centerDepth);
+        size_t offset = 0;
+        for (int digit = 0; digit < RADIX_SIZE; digit++) {
+            size_t count = offsets[digit];
+            offsets[digit] = offset;
+            offset += count;
+        }
+        for (const auto& key : keys) {
+            scratch[offsets[(key.key >> shift) & (RADIX_SIZE - 1)]++] = key;
+        }
+        keys.swap(scratch);
     }
-};
+}
 
 void render::depthSortItems(const RenderContextPointer& renderContext, bool frontToBack, const ItemBounds& inItems, ItemBounds& outItems) {
     assert(renderContext->args);
     assert(renderContext->args->hasViewFrustum());
 
-    auto& scene = renderContext->_scene;
     RenderArgs* args = renderContext->args;
-
+    const ViewFrustum& frustum = args->getViewFrustum();
 
     // Allocate and simply copy
     outItems.clear();
     outItems.reserve(inItems.size());
 
-
-    // Make a local dataset of the center distance and closest point distance
-    std::vector<ItemBoundSort> itemBoundSorts;
-    itemBoundSorts.reserve(outItems.size());
-
-    for (auto itemDetails : inItems) {
-        auto item = scene->getItem(itemDetails.id);
-        auto bound = itemDetails.bound; // item.getBound();
-        float distance = args->getViewFrustum().distanceToCamera(bound.calcCenter());
-
-        itemBoundSorts.emplace_back(ItemBoundSort(distance, distance, distance, itemDetails.id, bound));
+    // Make a local dataset of the center distances
+    std::vector<DepthSortKey> keys;
+    keys.reserve(inItems.size());
+    for (size_t i = 0; i < inItems.size(); i++) {
+        float distance = frustum.distanceToCamera(inItems[i].bound.calcCenter());
+        keys.push_back(DepthSortKey { depthSortKey(distance, frontToBack), (uint32_t)i });
     }
 
     // sort against Z
-    if (frontToBack) {
-        FrontToBackSort frontToBackSort;
-        std::sort(itemBoundSorts.begin(), itemBoundSorts.end(), frontToBackSort);
+    if (keys.size() < MIN_RADIX_SORT_ITEMS) {
+        std::stable_sort(keys.begin(), keys.end(), [](const DepthSortKey& left, const DepthSortKey& right) {
+            return left.key < right.key;
+        });
     } else {
-        BackToFrontSort  backToFrontSort;
-        std::sort(itemBoundSorts.begin(), itemBoundSorts.end(), backToFrontSort);
+        std::vector<DepthSortKey> scratch;
+        radixSort(keys, scratch);
     }
 
     // Finally once sorted result to a list of itemID
-    for (auto& item : itemBoundSorts) {
-       outItems.emplace_back(ItemBound(item._id, item._bounds));
+    for (const auto& key : keys) {
+        outItems.emplace_back(inItems[key.index]);
     }
 }
 
@@ -10,6 +10,11 @@
 //
 #include "SpatialTree.h"
 
+#include <array>
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QThreadPool>
+
 #include <ViewFrustum.h>
 
 
@@ -581,7 +586,26 @@ int Octree::selectCellBrick(Index cellID, CellSelection& selection, bool inside)
 }
 
 
-int ItemSpatialTree::selectCells(CellSelection& selection, const ViewFrustum& frustum, float lodAngle) const {
+template <class T> static void appendIndices(std::vector<T>& indices, const std::vector<T>& others) {
+    indices.insert(indices.end(), others.begin(), others.end());
+}
+
+void Octree::CellSelection::append(const CellSelection& selection) {
+    appendIndices(insideCells, selection.insideCells);
+    appendIndices(insideBricks, selection.insideBricks);
+    appendIndices(partialCells, selection.partialCells);
+    appendIndices(partialBricks, selection.partialBricks);
+}
+
+void ItemSpatialTree::ItemSelection::append(const ItemSelection& selection) {
+    cellSelection.append(selection.cellSelection);
+    appendIndices(insideItems, selection.insideItems);
+    appendIndices(insideSubcellItems, selection.insideSubcellItems);
+    appendIndices(partialItems, selection.partialItems);
+    appendIndices(partialSubcellItems, selection.partialSubcellItems);
+}
+
+Octree::FrustumSelector ItemSpatialTree::evalFrustumSelector(const ViewFrustum& frustum, float lodAngle) const {
     auto worldPlanes = frustum.getPlanes();
     FrustumSelector selector;
     for (int i = 0; i < ViewFrustum::NUM_PLANES; i++) {
@@ -592,13 +616,14 @@ int ItemSpatialTree::selectCells(CellSelection& selection, const ViewFrustum& fr
 
     selector.eyePos = evalCoordf(frustum.getPosition(), ROOT_DEPTH);
     selector.setAngle(glm::radians(lodAngle));
-
-    return Octree::select(selection, selector);
+    return selector;
 }
 
-int ItemSpatialTree::selectCellItems(ItemSelection& selection, const ItemFilter& filter, const ViewFrustum& frustum, float lodAngle) const {
-    selectCells(selection.cellSelection, frustum, lodAngle);
+int ItemSpatialTree::selectCells(CellSelection& selection, const ViewFrustum& frustum, float lodAngle) const {
+    return Octree::select(selection, evalFrustumSelector(frustum, lodAngle));
+}
 
+void ItemSpatialTree::fetchBrickItems(ItemSelection& selection) const {
     // Just grab the items in every selected bricks
     for (auto brickId : selection.cellSelection.insideBricks) {
         auto& brickItems = getConcreteBrick(brickId).items;
@@ -615,9 +640,54 @@ int ItemSpatialTree::selectCellItems(ItemSelection& selection, const ItemFilter&
         auto& brickSubcellItems = getConcreteBrick(brickId).subcellItems;
         selection.partialSubcellItems.insert(selection.partialSubcellItems.end(), brickSubcellItems.begin(), brickSubcellItems.end());
     }
-
-    return (int) selection.numItems();
 }
 
+// below this many cells a traversal is cheaper than handing it out
+static const int MIN_CELLS_FOR_JOBS = 512;
 
+int ItemSpatialTree::selectCellItems(ItemSelection& selection, const ItemFilter& filter, const ViewFrustum& frustum, float lodAngle) const {
+    auto selector = evalFrustumSelector(frustum, lodAngle);
+    if (getNumAllocatedCells() < MIN_CELLS_FOR_JOBS) {
+        Octree::select(selection.cellSelection, selector);
+        fetchBrickItems(selection);
+        return (int) selection.numItems();
+    }
+
+    // Always include the root cell partially containing potentially outer objects
+    ItemSelection rootSelection;
+    selectCellBrick(ROOT_CELL, rootSelection.cellSelection, false);
+    fetchBrickItems(rootSelection);
+    selection.append(rootSelection);
+
+    // then each octant in its own selection, the calling thread taking the first one
+    const auto& root = getConcreteCell(ROOT_CELL);
+    std::array<ItemSelection, NUM_OCTANTS> octantSelections;
+    auto selectOctant = [this, &root, &selector, &octantSelections](int octant) {
+        Index subCellID = root.child((Link)octant);
+        if (subCellID != INVALID_CELL) {
+            auto& octantSelection = octantSelections[octant];
+            selectTraverse(subCellID, octantSelection.cellSelection, selector);
+            fetchBrickItems(octantSelection);
+        }
+    };
 
+    auto threadPool = QThreadPool::globalInstance();
+    std::vector<QFuture<void>> jobs;
+    for (int i = 1; i < NUM_OCTANTS; i++) {
+        if (root.child((Link)i) != INVALID_CELL) {
+            jobs.push_back(QtConcurrent::run(threadPool, [&selectOctant, i] {
+                selectOctant(i);
+            }));
+        }
+    }
+    selectOctant(0);
+    for (auto& job : jobs) {
+        job.waitForFinished();
+    }
+
+    for (const auto& octantSelection : octantSelections) {
+        selection.append(octantSelection);
+    }
+
+    return (int) selection.numItems();
+}
@@ -301,6 +301,8 @@ namespace render {
 
             size_t size() const { return insideBricks.size() + partialBricks.size(); }
 
+            void append(const CellSelection& selection);
+
             void clear() {
                 insideCells.clear();
                 insideBricks.clear();
@@ -444,6 +446,7 @@ namespace render {
 
         // Selection and traverse
         int selectCells(CellSelection& selection, const ViewFrustum& frustum, float lodAngle) const;
+        FrustumSelector evalFrustumSelector(const ViewFrustum& frustum, float lodAngle) const;
 
         class ItemSelection {
         public:
@@ -460,6 +463,8 @@ namespace render {
             size_t partialNumItems() const { return partialItems.size() + partialSubcellItems.size(); }
             size_t numItems() const { return insideNumItems() + partialNumItems(); }
 
+            void append(const ItemSelection& selection);
+
             void clear() {
                 cellSelection.clear();
                 insideItems.clear();
@@ -469,7 +474,12 @@ namespace render {
             }
         };
 
+        // Large trees are traversed one octant of the root per job on the global thread pool, and the selections
+        // appended in octant order, so the selection is the same as a serial traversal
         int selectCellItems(ItemSelection& selection, const ItemFilter& filter, const ViewFrustum& frustum, float lodAngle) const;
+
+    protected:
+        void fetchBrickItems(ItemSelection& selection) const;
     };
 }
 
@@ -55,7 +55,8 @@ float RecordingScriptingInterface::playerLength() const {
 }
 
 void RecordingScriptingInterface::playClip(NetworkClipLoaderPointer clipLoader, const QString& url, QScriptValue callback) {
-    _player->queueClip(clipLoader->getClip());
+    // every player of a clip shares the loaded bytes and frame index, each with a position of its own
+    _player->queueClip(clipLoader->getClip()->share());
 
     if (callback.isFunction()) {
         QScriptValueList args { true, url };
@@ -13,6 +13,10 @@
 
 #include <queue>
 
+#include <QtCore/QFuture>
+#include <QtCore/QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
 #include "DependencyManager.h"
 #include "SharedUtil.h"
 #include "StreamUtils.h"
@@ -36,6 +40,7 @@ SpatiallyNestable::SpatiallyNestable(NestableType nestableType, QUuid id) :
 SpatiallyNestable::~SpatiallyNestable() {
     forEachChild([&](SpatiallyNestablePointer object) {
         object->parentDeleted();
+        object->invalidateWorldTransforms();
     });
 }
 
@@ -66,12 +71,17 @@ const QUuid SpatiallyNestable::getParentID() const {
 }
 
 void SpatiallyNestable::setParentID(const QUuid& parentID) {
+    bool changed = false;
     _idLock.withWriteLock([&] {
         if (_parentID != parentID) {
             _parentID = parentID;
             _parentKnowsMe = false;
+            changed = true;
         }
     });
+    if (changed) {
+        invalidateWorldTransforms();
+    }
 
     bool success = false;
     getParentPointer(success);
@@ -131,6 +141,7 @@ SpatiallyNestablePointer SpatiallyNestable::getParentPointer(bool& success) cons
     if (parent) {
         parent->beParentOfChild(getThisPointer());
         _parentKnowsMe = true;
+        invalidateWorldTransforms();
     }
 
     success = (parent || parentID.isNull());
@@ -150,7 +161,10 @@ void SpatiallyNestable::forgetChild(SpatiallyNestablePointer newChild) const {
 }
 
 void SpatiallyNestable::setParentJointIndex(quint16 parentJointIndex) {
-    _parentJointIndex = parentJointIndex;
+    if (_parentJointIndex != parentJointIndex) {
+        _parentJointIndex = parentJointIndex;
+        invalidateWorldTransforms();
+    }
 }
 
 glm::vec3 SpatiallyNestable::worldToLocal(const glm::vec3& position,
@@ -397,6 +411,9 @@ void SpatiallyNestable::setPosition(const glm::vec3& position, bool& success, bo
     });
     if (success && changed) {
         locationChanged(tellPhysics);
+    } else if (changed) {
+        // without a parent nobody is told about the move, but the cached transform is still stale
+        invalidateWorldTransforms();
     }
 }
 
@@ -450,6 +467,8 @@ void SpatiallyNestable::setOrientation(const glm::quat& orientation, bool& succe
     });
     if (success && changed) {
         locationChanged(tellPhysics);
+    } else if (changed) {
+        invalidateWorldTransforms();
     }
 }
 
@@ -583,14 +602,121 @@ glm::vec3 SpatiallyNestable::getParentAngularVelocity(bool& success) const {
 
 const Transform SpatiallyNestable::getTransform(bool& success, int depth) const {
     Transform result;
+    if (getCachedTransform(result)) {
+        success = true;
+        return result;
+    }
+
+    // the version is read first, so that a move that happens while this is computed leaves the result stale
+    uint32_t version = _worldTransformVersion.load(std::memory_order_acquire);
+
     // return a world-space transform for this object's location
     Transform parentTransform = getParentTransform(success, depth);
     _transformLock.withReadLock([&] {
         Transform::mult(result, parentTransform, _transform);
     });
+    if (success && canCacheTransform()) {
+        cacheTransform(result, version);
+    }
     return result;
 }
 
+bool SpatiallyNestable::getCachedTransform(Transform& result) const {
+    uint32_t version = _worldTransformVersion.load(std::memory_order_acquire);
+
+    CachedWorldTransform cached;
+    uint32_t sequence;
+    do {
+        sequence = _worldTransformSequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            // being written, don't wait for it
+            return false;
+        }
+        cached = _cachedWorldTransform;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (sequence != _worldTransformSequence.load(std::memory_order_relaxed));
+
+    if (cached.version != version) {
+        return false;
+    }
+    result.setScale(cached.scale);
+    result.setRotation(cached.rotation);
+    result.setTranslation(cached.translation);
+    return true;
+}
+
+bool SpatiallyNestable::canCacheTransform() const {
+    // joints move without telling what is relative to them
+    if (_parentJointIndex != INVALID_JOINT_INDEX) {
+        return false;
+    }
+    // the parent's cache is only current if nothing above it is relative to a joint
+    SpatiallyNestablePointer parent = _parent.lock();
+    Transform parentTransform;
+    return !parent || parent->getCachedTransform(parentTransform);
+}
+
+void SpatiallyNestable::cacheTransform(const Transform& transform, uint32_t version) const {
+    // if another thread is already filling the cache, leave it to that one
+    uint32_t sequence = _worldTransformSequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) || !_worldTransformSequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    _cachedWorldTransform.rotation = transform.getRotation();
+    _cachedWorldTransform.scale = transform.getScale();
+    _cachedWorldTransform.translation = transform.getTranslation();
+    _cachedWorldTransform.version = version;
+    _worldTransformSequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SpatiallyNestable::invalidateWorldTransforms() const {
+    _worldTransformVersion++;
+    forEachDescendant([&](const SpatiallyNestablePointer& object) {
+        object->_worldTransformVersion++;
+    });
+}
+
+void SpatiallyNestable::updateWorldTransforms(const std::vector<SpatiallyNestablePointer>& nestables) {
+    static const size_t MIN_NESTABLES_PER_JOB = 64;
+
+    // sort by depth in the hierarchy, so the parents are cached by the time their children ask for them
+    std::vector<std::vector<SpatiallyNestablePointer>> levels;
+    for (const auto& nestable : nestables) {
+        size_t depth = 0;
+        SpatiallyNestablePointer ancestor = nestable->_parent.lock();
+        while (ancestor && depth < (size_t)maxParentingChain) {
+            depth++;
+            ancestor = ancestor->_parent.lock();
+        }
+        if (levels.size() <= depth) {
+            levels.resize(depth + 1);
+        }
+        levels[depth].push_back(nestable);
+    }
+
+    auto updateRange = [](const std::vector<SpatiallyNestablePointer>* level, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            bool success;
+            (*level)[i]->getTransform(success);
+        }
+    };
+
+    for (const auto& level : levels) {
+        size_t numJobs = std::max(std::min(level.size() / MIN_NESTABLES_PER_JOB, (size_t)QThread::idealThreadCount()), (size_t)1);
+        size_t perJob = (level.size() + numJobs - 1) / numJobs;
+        std::vector<QFuture<void>> jobs;
+        for (size_t job = 1; job < numJobs; ++job) {
+            size_t begin = job * perJob;
+            jobs.push_back(QtConcurrent::run(updateRange, &level, begin, std::min(begin + perJob, level.size())));
+        }
+        updateRange(&level, 0, std::min(perJob, level.size()));
+        for (auto& job : jobs) {
+            job.waitForFinished();
+        }
+    }
+}
+
 const Transform SpatiallyNestable::getTransform() const {
     bool success;
     Transform result = getTransform(success);
@@ -649,6 +775,8 @@ void SpatiallyNestable::setTransform(const Transform& transform, bool& success)
     });
     if (success && changed) {
         locationChanged();
+    } else if (changed) {
+        invalidateWorldTransforms();
     }
 }
 
@@ -703,6 +831,8 @@ void SpatiallyNestable::setSNScale(const glm::vec3& scale, bool& success) {
     });
     if (success && changed) {
         locationChanged();
+    } else if (changed) {
+        invalidateWorldTransforms();
     }
 }
 
@@ -843,6 +973,7 @@ void SpatiallyNestable::setLocalSNScale(const glm::vec3& scale) {
         }
     });
     if (changed) {
+        invalidateWorldTransforms();
         dimensionsChanged();
     }
 }
@@ -942,6 +1073,7 @@ void SpatiallyNestable::forEachDescendantTest(const ChildLambdaTest& actor) cons
 }
 
 void SpatiallyNestable::locationChanged(bool tellPhysics) {
+    _worldTransformVersion++;
     forEachChild([&](SpatiallyNestablePointer object) {
         object->locationChanged(tellPhysics);
     });
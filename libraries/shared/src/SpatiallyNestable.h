@@ -12,6 +12,9 @@
 #ifndef hifi_SpatiallyNestable_h
 #define hifi_SpatiallyNestable_h
 
+#include <atomic>
+#include <vector>
+
 #include <QUuid>
 
 #include "Transform.h"
@@ -78,6 +81,16 @@ public:
 
     virtual Transform getParentTransform(bool& success, int depth = 0) const;
 
+    // World transforms are cached, stamped with a version that is bumped whenever this object or something it is
+    // relative to moves.  getTransform reads the cache without locking when it is current, and otherwise walks the
+    // parents as before.  Objects that are relative to a joint are never cached, because joints move without telling
+    // their children.
+    bool getCachedTransform(Transform& result) const;
+
+    // brings the cached world transforms of these objects up to date.  Parents are done before their children, and
+    // the objects at each depth of the hierarchy are done in parallel.
+    static void updateWorldTransforms(const std::vector<SpatiallyNestablePointer>& nestables);
+
     virtual glm::vec3 getPosition(bool& success) const;
     virtual glm::vec3 getPosition() const;
     virtual void setPosition(const glm::vec3& position, bool& success, bool tellPhysics = true);
@@ -212,6 +225,7 @@ protected:
     virtual void locationChanged(bool tellPhysics = true); // called when a this object's location has changed
     virtual void dimensionsChanged() { _queryAACubeSet = false; } // called when a this object's dimensions have changed
     virtual void parentDeleted() { } // called on children of a deleted parent
+    void invalidateWorldTransforms() const; // called when this object's and its descendants' world transforms change
 
     // _queryAACube is used to decide where something lives in the octree
     mutable AACube _queryAACube;
@@ -234,6 +248,19 @@ private:
     glm::vec3 _angularVelocity;
     mutable bool _parentKnowsMe { false };
     bool _isDead { false };
+
+    struct CachedWorldTransform {
+        glm::quat rotation;
+        glm::vec3 scale;
+        glm::vec3 translation;
+        uint32_t version { 0 };
+    };
+    bool canCacheTransform() const;
+    void cacheTransform(const Transform& transform, uint32_t version) const;
+
+    mutable std::atomic<uint32_t> _worldTransformVersion { 1 };
+    mutable std::atomic<uint32_t> _worldTransformSequence { 0 }; // odd while _cachedWorldTransform is being written
+    mutable CachedWorldTransform _cachedWorldTransform;
 };
 
 
@@ -9,9 +9,36 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <numeric>
+
 #include "GLMHelpers.h"
 #include "TriangleSet.h"
 
+static const uint32_t MAX_LEAF_TRIANGLES = 4; // always split above this many triangles if a useful split exists
+static const uint32_t MAX_FORCED_LEAF_TRIANGLES = 16; // split even when the SAH says otherwise above this many
+static const int SAH_BIN_COUNT = 12;
+static const int MAX_TREE_DEPTH = 48;
+static const int TRAVERSAL_STACK_SIZE = MAX_TREE_DEPTH + 2;
+static const float SAH_TRAVERSAL_COST = 1.0f; // relative to the cost of one ray/triangle test
+
+static inline float halfSurfaceArea(const glm::vec3& minimum, const glm::vec3& maximum) {
+    glm::vec3 extent = maximum - minimum;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+// classic slab test, returns the entry distance of the ray into the box if it enters before maxDistance
+static inline bool findRaySlabIntersection(const glm::vec3& origin, const glm::vec3& inverseDirection,
+        const glm::vec3& minimum, const glm::vec3& maximum, float maxDistance, float& entryDistance) {
+    glm::vec3 t0 = (minimum - origin) * inverseDirection;
+    glm::vec3 t1 = (maximum - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    entryDistance = entry;
+    return entry <= exit;
+}
 
 void TriangleSet::insert(const Triangle& t) {
     _isBalanced = false;
@@ -24,10 +51,9 @@ void TriangleSet::insert(const Triangle& t) {
 
 void TriangleSet::clear() {
     _triangles.clear();
+    _nodes.clear();
     _bounds.clear();
     _isBalanced = false;
-
-    _triangleOctree.clear();
 }
 
 bool TriangleSet::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
@@ -36,21 +62,96 @@ bool TriangleSet::findRayIntersection(const glm::vec3& origin, const glm::vec3&
     // reset our distance to be the max possible, lower level tests will store best distance here
     distance = std::numeric_limits<float>::max();
 
+    if (_triangles.empty()) {
+        return false;
+    }
+
+    // the entry face is reported from the bounds of the set, in the non-precision case that's all we test
+    float boundsDistance = distance;
+    BoxFace boundsFace;
+    glm::vec3 boundsNormal;
+    if (!_bounds.findRayIntersection(origin, direction, boundsDistance, boundsFace, boundsNormal)) {
+        return false;
+    }
+
+    if (!precision) {
+        distance = boundsDistance;
+        face = boundsFace;
+        surfaceNormal = boundsNormal;
+        return true;
+    }
+
     if (!_isBalanced) {
-        balanceOctree();
+        balanceTree();
     }
 
     int trianglesTouched = 0;
-    auto result = _triangleOctree.findRayIntersection(origin, direction, distance, face, surfaceNormal, precision, trianglesTouched, allowBackface);
+    auto result = findRayIntersectionPrecise(origin, direction, distance, surfaceNormal, allowBackface, trianglesTouched);
+    if (result) {
+        face = boundsFace;
+    }
 
     #if WANT_DEBUGGING
-    if (precision) {
-        qDebug() << "trianglesTouched :" << trianglesTouched << "out of:" << _triangleOctree._population << "_triangles.size:" << _triangles.size();
-    }
+    qDebug() << "trianglesTouched :" << trianglesTouched << "out of:" << _triangles.size() << "nodes:" << _nodes.size();
     #endif
     return result;
 }
 
+size_t TriangleSet::findRayIntersections(const std::vector<Ray>& rays, std::vector<RayHit>& hits,
+        bool precision, bool allowBackface) {
+    hits.clear();
+    hits.resize(rays.size());
+    if (_triangles.empty()) {
+        return 0;
+    }
+
+    size_t numHits = 0;
+    if (!precision) {
+        for (size_t i = 0; i < rays.size(); i++) {
+            RayHit& hit = hits[i];
+            hit.intersects = _bounds.findRayIntersection(rays[i].origin, rays[i].direction,
+                hit.distance, hit.face, hit.surfaceNormal);
+            numHits += hit.intersects ? 1 : 0;
+        }
+        return numHits;
+    }
+
+    // like the single ray query, a set that none of the rays reach is left unbalanced
+    if (!_isBalanced) {
+        bool anyInBounds = false;
+        for (const auto& ray : rays) {
+            float boundsDistance;
+            BoxFace boundsFace;
+            glm::vec3 boundsNormal;
+            if (_bounds.findRayIntersection(ray.origin, ray.direction, boundsDistance, boundsFace, boundsNormal)) {
+                anyInBounds = true;
+                break;
+            }
+        }
+        if (!anyInBounds) {
+            return 0;
+        }
+        balanceTree();
+    }
+
+    const int PACKET_SIZE = 4;
+    for (size_t i = 0; i < rays.size(); i += PACKET_SIZE) {
+        int numRays = (int)std::min((size_t)PACKET_SIZE, rays.size() - i);
+        findRayPacketIntersections(&rays[i], &hits[i], numRays, allowBackface);
+    }
+
+    for (size_t i = 0; i < rays.size(); i++) {
+        RayHit& hit = hits[i];
+        if (hit.intersects) {
+            float boundsDistance;
+            glm::vec3 boundsNormal;
+            _bounds.findRayIntersection(rays[i].origin, rays[i].direction, boundsDistance, hit.face, boundsNormal);
+            numHits++;
+        }
+    }
+    return numHits;
+}
+
 bool TriangleSet::convexHullContains(const glm::vec3& point) const {
     if (!_bounds.contains(point)) {
         return false;
@@ -72,194 +173,392 @@ void TriangleSet::debugDump() {
     qDebug() << __FUNCTION__;
     qDebug() << "bounds:" << getBounds();
     qDebug() << "triangles:" << size() << "at top level....";
-    qDebug() << "----- _triangleOctree -----";
-    _triangleOctree.debugDump();
+    qDebug() << "----- BVH -----";
+    int leaves = 0;
+    uint32_t largestLeaf = 0;
+    for (const auto& node : _nodes) {
+        if (node.isLeaf()) {
+            leaves++;
+            largestLeaf = std::max(largestLeaf, node.count);
+        }
+    }
+    qDebug() << "nodes:" << _nodes.size() << "leaves:" << leaves << "largest leaf:" << largestLeaf;
 }
 
-void TriangleSet::balanceOctree() {
-    _triangleOctree.reset(_bounds, 0);
+void TriangleSet::balanceTree() {
+    _nodes.clear();
+    _isBalanced = true;
+    if (_triangles.empty()) {
+        return;
+    }
+
+    uint32_t numTriangles = (uint32_t)_triangles.size();
+    _centroids.resize(numTriangles);
+    _buildIndices.resize(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; i++) {
+        const Triangle& triangle = _triangles[i];
+        _centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) * (1.0f / 3.0f);
+        _buildIndices[i] = i;
+    }
+
+    // a binary tree with single triangle leaves has 2n - 1 nodes, so this never reallocates
+    _nodes.reserve(2 * numTriangles);
+    _nodes.emplace_back();
+    buildNode(0, 0, numTriangles, 0);
 
-    // insert all the triangles
-    for (size_t i = 0; i < _triangles.size(); i++) {
-        _triangleOctree.insert(i);
+    // reorder the triangles so that every leaf references a contiguous range
+    std::vector<Triangle> sortedTriangles;
+    sortedTriangles.reserve(numTriangles);
+    for (auto index : _buildIndices) {
+        sortedTriangles.push_back(_triangles[index]);
     }
+    _triangles.swap(sortedTriangles);
+    _nodes.shrink_to_fit();
 
-    _isBalanced = true;
+    std::vector<glm::vec3>().swap(_centroids);
+    std::vector<uint32_t>().swap(_buildIndices);
 
     #if WANT_DEBUGGING
     debugDump();
     #endif
 }
 
+void TriangleSet::buildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth) {
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(-std::numeric_limits<float>::max());
+    glm::vec3 centroidMinimum = minimum;
+    glm::vec3 centroidMaximum = maximum;
+    for (uint32_t i = first; i < first + count; i++) {
+        const Triangle& triangle = _triangles[_buildIndices[i]];
+        minimum = glm::min(minimum, glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)));
+        maximum = glm::max(maximum, glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+        const glm::vec3& centroid = _centroids[_buildIndices[i]];
+        centroidMinimum = glm::min(centroidMinimum, centroid);
+        centroidMaximum = glm::max(centroidMaximum, centroid);
+    }
 
-// Determine of the given ray (origin/direction) in model space intersects with any triangles
-// in the set. If an intersection occurs, the distance and surface normal will be provided.
-bool TriangleSet::TriangleOctreeCell::findRayIntersectionInternal(const glm::vec3& origin, const glm::vec3& direction,
-            float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, int& trianglesTouched, bool allowBackface) {
+    {
+        BVHNode& node = _nodes[nodeIndex];
+        node.minimum = minimum;
+        node.maximum = maximum;
+        node.leftFirst = first;
+        node.count = count;
+    }
 
-    bool intersectedSomething = false;
-    float boxDistance = distance;
-    float bestDistance = distance;
+    if (count <= MAX_LEAF_TRIANGLES || depth >= MAX_TREE_DEPTH) {
+        return;
+    }
 
-    if (_bounds.findRayIntersection(origin, direction, boxDistance, face, surfaceNormal)) {
+    // binned surface area heuristic: pick the axis and plane with the lowest expected cost
+    struct Bin {
+        glm::vec3 minimum { std::numeric_limits<float>::max() };
+        glm::vec3 maximum { -std::numeric_limits<float>::max() };
+        uint32_t count { 0 };
+    };
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestSplit = 0;
+    glm::vec3 centroidExtent = centroidMaximum - centroidMinimum;
+    for (int axis = 0; axis < 3; axis++) {
+        if (centroidExtent[axis] <= 0.0f) {
+            continue;
+        }
+        Bin bins[SAH_BIN_COUNT];
+        float binScale = (float)SAH_BIN_COUNT / centroidExtent[axis];
+        for (uint32_t i = first; i < first + count; i++) {
+            const Triangle& triangle = _triangles[_buildIndices[i]];
+            int binIndex = std::min(SAH_BIN_COUNT - 1,
+                (int)((_centroids[_buildIndices[i]][axis] - centroidMinimum[axis]) * binScale));
+            Bin& bin = bins[binIndex];
+            bin.count++;
+            bin.minimum = glm::min(bin.minimum, glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)));
+            bin.maximum = glm::max(bin.maximum, glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+        }
 
-        // if our bounding box intersects at a distance greater than the current known
-        // best distance, than we can safely not check any of our triangles
-        if (boxDistance > bestDistance) {
-            return false;
+        // sweep from the right to accumulate the cost of everything right of each plane...
+        float rightCosts[SAH_BIN_COUNT];
+        Bin accumulated;
+        for (int i = SAH_BIN_COUNT - 1; i > 0; i--) {
+            accumulated.count += bins[i].count;
+            accumulated.minimum = glm::min(accumulated.minimum, bins[i].minimum);
+            accumulated.maximum = glm::max(accumulated.maximum, bins[i].maximum);
+            rightCosts[i] = accumulated.count > 0 ?
+                (float)accumulated.count * halfSurfaceArea(accumulated.minimum, accumulated.maximum) : 0.0f;
         }
 
-        if (precision) {
-            for (const auto& triangleIndex : _triangleIndices) {
-                const auto& triangle = _allTriangles[triangleIndex];
-                float thisTriangleDistance;
-                trianglesTouched++;
-                if (findRayTriangleIntersection(origin, direction, triangle, thisTriangleDistance, allowBackface)) {
-                    if (thisTriangleDistance < bestDistance) {
-                        bestDistance = thisTriangleDistance;
-                        intersectedSomething = true;
-                        surfaceNormal = triangle.getNormal();
-                        distance = bestDistance;
-                    }
-                }
+        // ...then from the left, evaluating each plane as we go
+        accumulated = Bin();
+        for (int i = 0; i < SAH_BIN_COUNT - 1; i++) {
+            accumulated.count += bins[i].count;
+            accumulated.minimum = glm::min(accumulated.minimum, bins[i].minimum);
+            accumulated.maximum = glm::max(accumulated.maximum, bins[i].maximum);
+            if (accumulated.count == 0 || accumulated.count == count) {
+                continue;
+            }
+            float cost = (float)accumulated.count * halfSurfaceArea(accumulated.minimum, accumulated.maximum) +
+                rightCosts[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
             }
-        } else {
-            intersectedSomething = true;
-            distance = boxDistance;
         }
     }
 
-    return intersectedSomething;
-}
+    if (bestAxis < 0) {
+        return; // all centroids coincide, nothing useful to split on
+    }
 
-static const int MAX_DEPTH = 4; // for now
-static const int MAX_CHILDREN = 8;
+    float leafCost = (float)count * halfSurfaceArea(minimum, maximum);
+    float splitCost = SAH_TRAVERSAL_COST * halfSurfaceArea(minimum, maximum) + bestCost;
+    if (splitCost >= leafCost && count <= MAX_FORCED_LEAF_TRIANGLES) {
+        return;
+    }
 
-TriangleSet::TriangleOctreeCell::TriangleOctreeCell(std::vector<Triangle>& allTriangles, const AABox& bounds, int depth) :
-    _allTriangles(allTriangles)
-{
-    reset(bounds, depth);
-}
+    float binScale = (float)SAH_BIN_COUNT / centroidExtent[bestAxis];
+    auto middle = std::partition(_buildIndices.begin() + first, _buildIndices.begin() + first + count,
+        [&](uint32_t index) {
+            int binIndex = std::min(SAH_BIN_COUNT - 1,
+                (int)((_centroids[index][bestAxis] - centroidMinimum[bestAxis]) * binScale));
+            return binIndex < bestSplit;
+        });
+    uint32_t leftCount = (uint32_t)(middle - (_buildIndices.begin() + first));
+    if (leftCount == 0 || leftCount == count) {
+        return;
+    }
 
-void TriangleSet::TriangleOctreeCell::clear() {
-    _population = 0;
-    _triangleIndices.clear();
-    _bounds.clear();
-    _children.clear();
-}
+    uint32_t leftIndex = (uint32_t)_nodes.size();
+    _nodes.emplace_back();
+    _nodes.emplace_back();
+    _nodes[nodeIndex].leftFirst = leftIndex;
+    _nodes[nodeIndex].count = 0;
 
-void TriangleSet::TriangleOctreeCell::reset(const AABox& bounds, int depth) {
-    clear();
-    _bounds = bounds;
-    _depth = depth;
+    buildNode(leftIndex, first, leftCount, depth + 1);
+    buildNode(leftIndex + 1, first + leftCount, count - leftCount, depth + 1);
 }
 
-void TriangleSet::TriangleOctreeCell::debugDump() {
-    qDebug() << __FUNCTION__;
-    qDebug() << "bounds:" << getBounds();
-    qDebug() << "depth:" << _depth;
-    qDebug() << "population:" << _population << "this level or below" 
-             << " ---- triangleIndices:" << _triangleIndices.size() << "in this cell";
-
-    qDebug() << "child cells:" << _children.size();
-    if (_depth < MAX_DEPTH) {
-        int childNum = 0;
-        for (auto& child : _children) {
-            qDebug() << "child:" << childNum;
-            child.second.debugDump();
-            childNum++;
-        }
+bool TriangleSet::findRayIntersectionPrecise(const glm::vec3& origin, const glm::vec3& direction,
+        float& distance, glm::vec3& surfaceNormal, bool allowBackface, int& trianglesTouched) const {
+    if (_nodes.empty()) {
+        return false;
     }
-}
-
-void TriangleSet::TriangleOctreeCell::insert(size_t triangleIndex) {
-    const Triangle& triangle = _allTriangles[triangleIndex];
-    _population++;
-    // if we're not yet at the max depth, then check which child the triangle fits in
-    if (_depth < MAX_DEPTH) {
 
-        for (int child = 0; child < MAX_CHILDREN; child++) {
-            AABox childBounds = getBounds().getOctreeChild((AABox::OctreeChild)child);
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    float bestDistance = distance;
+    const Triangle* bestTriangle = nullptr;
+
+    struct StackEntry {
+        uint32_t node;
+        float entryDistance;
+    };
+    StackEntry stack[TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+
+    float entryDistance;
+    if (findRaySlabIntersection(origin, inverseDirection, _nodes[0].minimum, _nodes[0].maximum, bestDistance, entryDistance)) {
+        stack[stackSize++] = { 0, entryDistance };
+    }
 
+    while (stackSize > 0) {
+        StackEntry entry = stack[--stackSize];
+        // if we've found something closer since this node was pushed, none of its triangles can do better
+        if (entry.entryDistance > bestDistance) {
+            continue;
+        }
+        const BVHNode& node = _nodes[entry.node];
 
-            // if the child AABox would contain the triangle...
-            if (childBounds.contains(triangle)) {
-                // if the child cell doesn't yet exist, create it...
-                if (_children.find((AABox::OctreeChild)child) == _children.end()) {
-                    _children.insert(
-                        std::pair<AABox::OctreeChild, TriangleOctreeCell>
-                        ((AABox::OctreeChild)child, TriangleOctreeCell(_allTriangles, childBounds, _depth + 1)));
+        if (node.isLeaf()) {
+            for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                const Triangle& triangle = _triangles[i];
+                float thisTriangleDistance;
+                trianglesTouched++;
+                if (findRayTriangleIntersection(origin, direction, triangle, thisTriangleDistance, allowBackface)) {
+                    if (thisTriangleDistance < bestDistance) {
+                        bestDistance = thisTriangleDistance;
+                        bestTriangle = &triangle;
+                    }
                 }
+            }
+            continue;
+        }
 
-                // insert the triangleIndex in the child cell
-                _children.at((AABox::OctreeChild)child).insert(triangleIndex);
-                return;
+        // push the far child first so that the near child is visited first and tightens bestDistance
+        const BVHNode& left = _nodes[node.leftFirst];
+        const BVHNode& right = _nodes[node.leftFirst + 1];
+        float leftDistance, rightDistance;
+        bool hitLeft = findRaySlabIntersection(origin, inverseDirection, left.minimum, left.maximum, bestDistance, leftDistance);
+        bool hitRight = findRaySlabIntersection(origin, inverseDirection, right.minimum, right.maximum, bestDistance, rightDistance);
+        if (hitLeft && hitRight) {
+            if (leftDistance < rightDistance) {
+                stack[stackSize++] = { node.leftFirst + 1, rightDistance };
+                stack[stackSize++] = { node.leftFirst, leftDistance };
+            } else {
+                stack[stackSize++] = { node.leftFirst, leftDistance };
+                stack[stackSize++] = { node.leftFirst + 1, rightDistance };
             }
+        } else if (hitLeft) {
+            stack[stackSize++] = { node.leftFirst, leftDistance };
+        } else if (hitRight) {
+            stack[stackSize++] = { node.leftFirst + 1, rightDistance };
         }
     }
-    // either we're at max depth, or the triangle doesn't fit in one of our
-    // children and so we want to just record it here
-    _triangleIndices.push_back(triangleIndex);
+
+    if (bestTriangle) {
+        distance = bestDistance;
+        surfaceNormal = bestTriangle->getNormal();
+        return true;
+    }
+    return false;
 }
 
-bool TriangleSet::TriangleOctreeCell::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
-                float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, int& trianglesTouched, bool allowBackface) {
+// on x86 architecture, assume that SSE2 is present
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
 
-    if (_population < 1) {
-        return false; // no triangles below here, so we can't intersect
-    }
+#include <emmintrin.h>
 
-    float bestLocalDistance = distance;
-    BoxFace bestLocalFace;
-    glm::vec3 bestLocalNormal;
-    bool intersects = false;
+// Traverse the tree with four rays at once. Box and triangle tests are done for all rays of the packet
+// in parallel, and a node is visited as long as any ray in the packet still wants it.
+void TriangleSet::findRayPacketIntersections(const Ray* rays, RayHit* hits, int numRays, bool allowBackface) const {
+    if (_nodes.empty()) {
+        return;
+    }
 
-    // if the ray intersects our bounding box, then continue
-    if (getBounds().findRayIntersection(origin, direction, bestLocalDistance, bestLocalFace, bestLocalNormal)) {
+    // pad partial packets by repeating the first ray, its results are discarded
+    alignas(16) float originX[4], originY[4], originZ[4];
+    alignas(16) float inverseX[4], inverseY[4], inverseZ[4];
+    alignas(16) float directionX[4], directionY[4], directionZ[4];
+    for (int i = 0; i < 4; i++) {
+        const Ray& ray = rays[i < numRays ? i : 0];
+        originX[i] = ray.origin.x;
+        originY[i] = ray.origin.y;
+        originZ[i] = ray.origin.z;
+        directionX[i] = ray.direction.x;
+        directionY[i] = ray.direction.y;
+        directionZ[i] = ray.direction.z;
+        inverseX[i] = 1.0f / ray.direction.x;
+        inverseY[i] = 1.0f / ray.direction.y;
+        inverseZ[i] = 1.0f / ray.direction.z;
+    }
 
-        // if the intersection with our bounding box, is greater than the current best distance (the distance passed in)
-        // then we know that none of our triangles can represent a better intersection and we can return
+    const __m128 ox = _mm_load_ps(originX), oy = _mm_load_ps(originY), oz = _mm_load_ps(originZ);
+    const __m128 dx = _mm_load_ps(directionX), dy = _mm_load_ps(directionY), dz = _mm_load_ps(directionZ);
+    const __m128 ix = _mm_load_ps(inverseX), iy = _mm_load_ps(inverseY), iz = _mm_load_ps(inverseZ);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+    const Triangle* bestTriangles[4] = { nullptr, nullptr, nullptr, nullptr };
+
+    auto testBox = [&](const BVHNode& node) -> int {
+        __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minimum.x), ox), ix);
+        __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maximum.x), ox), ix);
+        __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minimum.y), oy), iy);
+        __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maximum.y), oy), iy);
+        __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.minimum.z), oz), iz);
+        __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.maximum.z), oz), iz);
+        __m128 entry = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+                                  _mm_max_ps(_mm_min_ps(t0z, t1z), zero));
+        __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+                                 _mm_min_ps(_mm_max_ps(t0z, t1z), best));
+        return _mm_movemask_ps(_mm_cmple_ps(entry, exit));
+    };
+
+    uint32_t stack[TRAVERSAL_STACK_SIZE];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = _nodes[stack[--stackSize]];
+        if (!testBox(node)) {
+            continue;
+        }
 
-        if (bestLocalDistance > distance) {
-            return false;
+        if (!node.isLeaf()) {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+            continue;
         }
 
-        bestLocalDistance = distance;
-
-        float childDistance = distance;
-        BoxFace childFace;
-        glm::vec3 childNormal;
-
-        // if we're not yet at the max depth, then check which child the triangle fits in
-        if (_depth < MAX_DEPTH) {
-            for (auto& child : _children) {
-                // check each child, if there's an intersection, it will return some distance that we need
-                // to compare against the other results, because there might be multiple intersections and
-                // we will always choose the best (shortest) intersection
-                if (child.second.findRayIntersection(origin, direction, childDistance, childFace, childNormal, precision, trianglesTouched)) {
-                    if (childDistance < bestLocalDistance) {
-                        bestLocalDistance = childDistance;
-                        bestLocalFace = childFace;
-                        bestLocalNormal = childNormal;
-                        intersects = true;
+        for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+            // same math as findRayTriangleIntersection(), with the edge tests rewritten as triple products
+            // so that everything which only depends on the triangle is computed once for the packet
+            const Triangle& triangle = _triangles[i];
+            glm::vec3 firstSide = triangle.v0 - triangle.v1;
+            glm::vec3 secondSide = triangle.v2 - triangle.v1;
+            glm::vec3 normal = glm::cross(secondSide, firstSide);
+            glm::vec3 edge0 = glm::cross(firstSide, normal);
+            glm::vec3 edge1 = glm::cross(normal, secondSide);
+            glm::vec3 edge2 = glm::cross(triangle.v2 - triangle.v0, normal);
+
+            __m128 nx = _mm_set1_ps(normal.x), ny = _mm_set1_ps(normal.y), nz = _mm_set1_ps(normal.z);
+            __m128 dividend = _mm_sub_ps(_mm_set1_ps(glm::dot(normal, triangle.v1)),
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, nx), _mm_mul_ps(oy, ny)), _mm_mul_ps(oz, nz)));
+            __m128 divisor = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, nx), _mm_mul_ps(dy, ny)), _mm_mul_ps(dz, nz));
+            __m128 valid = _mm_cmplt_ps(divisor, zero);
+            if (!allowBackface) {
+                valid = _mm_and_ps(valid, _mm_cmple_ps(dividend, zero));
+            }
+            if (!_mm_movemask_ps(valid)) {
+                continue;
+            }
+
+            __m128 t = _mm_div_ps(dividend, divisor);
+            __m128 px = _mm_add_ps(ox, _mm_mul_ps(dx, t));
+            __m128 py = _mm_add_ps(oy, _mm_mul_ps(dy, t));
+            __m128 pz = _mm_add_ps(oz, _mm_mul_ps(dz, t));
+
+            __m128 qx = _mm_sub_ps(px, _mm_set1_ps(triangle.v1.x));
+            __m128 qy = _mm_sub_ps(py, _mm_set1_ps(triangle.v1.y));
+            __m128 qz = _mm_sub_ps(pz, _mm_set1_ps(triangle.v1.z));
+            __m128 side0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_set1_ps(edge0.x)), _mm_mul_ps(qy, _mm_set1_ps(edge0.y))),
+                _mm_mul_ps(qz, _mm_set1_ps(edge0.z)));
+            __m128 side1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, _mm_set1_ps(edge1.x)), _mm_mul_ps(qy, _mm_set1_ps(edge1.y))),
+                _mm_mul_ps(qz, _mm_set1_ps(edge1.z)));
+            __m128 rx = _mm_sub_ps(px, _mm_set1_ps(triangle.v0.x));
+            __m128 ry = _mm_sub_ps(py, _mm_set1_ps(triangle.v0.y));
+            __m128 rz = _mm_sub_ps(pz, _mm_set1_ps(triangle.v0.z));
+            __m128 side2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, _mm_set1_ps(edge2.x)), _mm_mul_ps(ry, _mm_set1_ps(edge2.y))),
+                _mm_mul_ps(rz, _mm_set1_ps(edge2.z)));
+
+            valid = _mm_and_ps(valid, _mm_cmpgt_ps(side0, zero));
+            valid = _mm_and_ps(valid, _mm_cmpgt_ps(side1, zero));
+            valid = _mm_and_ps(valid, _mm_cmpgt_ps(side2, zero));
+            valid = _mm_and_ps(valid, _mm_cmplt_ps(t, best));
+
+            int mask = _mm_movemask_ps(valid);
+            if (mask) {
+                best = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, best));
+                for (int lane = 0; lane < 4; lane++) {
+                    if (mask & (1 << lane)) {
+                        bestTriangles[lane] = &triangle;
                     }
                 }
             }
         }
-        // also check our local triangle set
-        if (findRayIntersectionInternal(origin, direction, childDistance, childFace, childNormal, precision, trianglesTouched, allowBackface)) {
-            if (childDistance < bestLocalDistance) {
-                bestLocalDistance = childDistance;
-                bestLocalFace = childFace;
-                bestLocalNormal = childNormal;
-                intersects = true;
-            }
+    }
+
+    alignas(16) float bestDistances[4];
+    _mm_store_ps(bestDistances, best);
+    for (int i = 0; i < numRays; i++) {
+        RayHit& hit = hits[i];
+        hit.intersects = bestTriangles[i] != nullptr;
+        if (hit.intersects) {
+            hit.distance = bestDistances[i];
+            hit.surfaceNormal = bestTriangles[i]->getNormal();
         }
     }
-    if (intersects) {
-        distance = bestLocalDistance;
-        face = bestLocalFace;
-        surfaceNormal = bestLocalNormal;
+}
+
+#else
+
+void TriangleSet::findRayPacketIntersections(const Ray* rays, RayHit* hits, int numRays, bool allowBackface) const {
+    for (int i = 0; i < numRays; i++) {
+        int trianglesTouched = 0;
+        RayHit& hit = hits[i];
+        hit.distance = std::numeric_limits<float>::max();
+        hit.intersects = findRayIntersectionPrecise(rays[i].origin, rays[i].direction,
+            hit.distance, hit.surfaceNormal, allowBackface, trianglesTouched);
     }
-    return intersects;
 }
+
+#endif
@@ -9,6 +9,10 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#ifndef hifi_TriangleSet_h
+#define hifi_TriangleSet_h
+
+#include <limits>
 #include <vector>
 
 #include "AABox.h"
@@ -16,74 +20,75 @@
 
 class TriangleSet {
 
-    class TriangleOctreeCell {
+    // A flattened bounding volume hierarchy. Nodes are stored depth first in a single vector, and the two
+    // children of an interior node are always adjacent, so a node only needs to know the index of its first
+    // child. Leaves reference a contiguous range of the (reordered) triangle vector.
+    class BVHNode {
     public:
-        TriangleOctreeCell(std::vector<Triangle>& allTriangles) :
-            _allTriangles(allTriangles)
-        { }
-
-        void insert(size_t triangleIndex);
-        void reset(const AABox& bounds, int depth = 0);
-        void clear();
-
-        bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
-            float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, int& trianglesTouched, bool allowBackface = false);
-
-        const AABox& getBounds() const { return _bounds; }
-
-        void debugDump();
-
-    protected:
-        TriangleOctreeCell(std::vector<Triangle>& allTriangles, const AABox& bounds, int depth);
+        glm::vec3 minimum;
+        uint32_t leftFirst { 0 }; // first child for interior nodes, first triangle for leaves
+        glm::vec3 maximum;
+        uint32_t count { 0 }; // number of triangles for leaves, zero for interior nodes
 
-        // checks our internal list of triangles
-        bool findRayIntersectionInternal(const glm::vec3& origin, const glm::vec3& direction,
-            float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, int& trianglesTouched, bool allowBackface = false);
-
-        std::vector<Triangle>& _allTriangles;
-        std::map<AABox::OctreeChild, TriangleOctreeCell> _children;
-        int _depth{ 0 };
-        int _population{ 0 };
-        AABox _bounds;
-        std::vector<size_t> _triangleIndices;
-
-        friend class TriangleSet;
+        bool isLeaf() const { return count > 0; }
     };
 
 public:
-    TriangleSet() :
-        _triangleOctree(_triangles)
-    {}
+    class Ray {
+    public:
+        glm::vec3 origin;
+        glm::vec3 direction;
+    };
+
+    class RayHit {
+    public:
+        bool intersects { false };
+        float distance { std::numeric_limits<float>::max() };
+        BoxFace face { UNKNOWN_FACE };
+        glm::vec3 surfaceNormal;
+    };
 
     void debugDump();
 
     void insert(const Triangle& t);
 
+    // Determine if the given ray (origin/direction) in model space intersects with any triangles in the set. If an
+    // intersection occurs, the distance and surface normal will be provided.
+    // note: this might side-effect internal structures
     bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
         float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, bool allowBackface = false);
 
-    void balanceOctree();
+    // Intersect a batch of rays against the set. Rays are traversed in packets of four, which is considerably
+    // faster than individual queries when the rays are coherent (e.g. a grid of picks, or a laser sweep).
+    // Returns the number of rays that hit something. hits is resized to match rays.
+    // note: this might side-effect internal structures
+    size_t findRayIntersections(const std::vector<Ray>& rays, std::vector<RayHit>& hits,
+        bool precision, bool allowBackface = false);
+
+    void balanceTree();
 
     void reserve(size_t size) { _triangles.reserve(size); } // reserve space in the datastructure for size number of triangles
     size_t size() const { return _triangles.size(); }
     void clear();
 
-    // Determine if the given ray (origin/direction) in model space intersects with any triangles in the set. If an 
-    // intersection occurs, the distance and surface normal will be provided.
-    // note: this might side-effect internal structures
-    bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
-        float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision, int& trianglesTouched);
-
     // Determine if a point is "inside" all the triangles of a convex hull. It is the responsibility of the caller to
-    // determine that the triangle set is indeed a convex hull. If the triangles added to this set are not in fact a 
+    // determine that the triangle set is indeed a convex hull. If the triangles added to this set are not in fact a
     // convex hull, the result of this method is meaningless and undetermined.
     bool convexHullContains(const glm::vec3& point) const;
     const AABox& getBounds() const { return _bounds; }
 
 protected:
+    void buildNode(uint32_t nodeIndex, uint32_t first, uint32_t count, int depth);
+    bool findRayIntersectionPrecise(const glm::vec3& origin, const glm::vec3& direction,
+        float& distance, glm::vec3& surfaceNormal, bool allowBackface, int& trianglesTouched) const;
+    void findRayPacketIntersections(const Ray* rays, RayHit* hits, int numRays, bool allowBackface) const;
 
     bool _isBalanced{ false };
-    TriangleOctreeCell _triangleOctree;
     std::vector<Triangle> _triangles;
+    std::vector<BVHNode> _nodes;
+    std::vector<glm::vec3> _centroids; // only used while building
+    std::vector<uint32_t> _buildIndices; // only used while building
     AABox _bounds;
 };
+
+#endif // hifi_TriangleSet_h
@@ -35,8 +35,12 @@ public:
     virtual void releaseEncoder(Encoder* encoder) override;
     virtual void releaseDecoder(Decoder* decoder) override;
 
+    // well past the point where packet loss concealment has faded to silence
+    virtual int getDTXFlushFrames() const override { return DTX_FLUSH_FRAMES; }
+
 private:
     static const char* NAME;
+    static const int DTX_FLUSH_FRAMES = 10;
 };
 
 #endif // hifi_HiFiCodec_h
@@ -35,6 +35,9 @@ public:
     virtual void releaseEncoder(Encoder* encoder) override;
     virtual void releaseDecoder(Decoder* decoder) override;
 
+    // stateless, so there is never anything to flush
+    virtual int getDTXFlushFrames() const override { return 0; }
+
     virtual void encode(const QByteArray& decodedBuffer, QByteArray& encodedBuffer) override {
         encodedBuffer = decodedBuffer;
     }
@@ -72,6 +75,9 @@ public:
     virtual void releaseEncoder(Encoder* encoder) override;
     virtual void releaseDecoder(Decoder* decoder) override;
 
+    // stateless, so there is never anything to flush
+    virtual int getDTXFlushFrames() const override { return 0; }
+
     virtual void encode(const QByteArray& decodedBuffer, QByteArray& encodedBuffer) override {
         encodedBuffer = qCompress(decodedBuffer);
     }
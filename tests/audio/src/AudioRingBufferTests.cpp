@@ -11,6 +11,9 @@
 
 #include "AudioRingBufferTests.h"
 
+#include <thread>
+
+#include "NumericalConstants.h"
 #include "SharedUtil.h"
 
 // Adds an implicit cast to make sure that actual and expected are of the same type.
@@ -125,3 +128,52 @@ void AudioRingBufferTests::runAllTests() {
         assertBufferSize(ringBuffer, 0);
     }
 }
+
+// A producer and a consumer thread hammer one ring with no locking, the way the network and audio threads do.
+// The producer only writes what fits, so every sample must come out in order.
+void AudioRingBufferTests::contentionBenchmark() {
+    const int FRAME_SAMPLES = AudioConstants::NETWORK_FRAME_SAMPLES_STEREO;
+    const int NUM_FRAMES = 200000;
+
+    AudioRingBuffer ringBuffer(FRAME_SAMPLES, 10);
+
+    quint64 start = usecTimestampNow();
+
+    std::thread producer([&] {
+        int16_t frame[FRAME_SAMPLES];
+        int16_t next = 0;
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            for (int j = 0; j < FRAME_SAMPLES; j++) {
+                frame[j] = next++;
+            }
+            while (ringBuffer.getSampleCapacity() - ringBuffer.samplesAvailable() < FRAME_SAMPLES) {
+                std::this_thread::yield();
+            }
+            ringBuffer.writeSamples(frame, FRAME_SAMPLES);
+        }
+    });
+
+    int16_t frame[FRAME_SAMPLES];
+    int16_t expected = 0;
+    int outOfOrder = 0;
+    for (int samplesRead = 0; samplesRead < NUM_FRAMES * FRAME_SAMPLES;) {
+        int numRead = ringBuffer.readSamples(frame, FRAME_SAMPLES);
+        if (numRead == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (int j = 0; j < numRead; j++) {
+            outOfOrder += (frame[j] != expected++);
+        }
+        samplesRead += numRead;
+    }
+    producer.join();
+
+    quint64 elapsed = usecTimestampNow() - start;
+    qDebug() << "Moved" << NUM_FRAMES << "frames through the ring in" << elapsed / USECS_PER_MSEC << "ms,"
+        << (float)elapsed * NSECS_PER_USEC / NUM_FRAMES << "ns per frame";
+
+    QCOMPARE(outOfOrder, 0);
+    QCOMPARE(ringBuffer.getOverflowCount(), 0);
+    assertBufferSize(ringBuffer, 0);
+}
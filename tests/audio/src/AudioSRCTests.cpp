@@ -0,0 +1,129 @@
+//
+//  AudioSRCTests.cpp
+//  tests/audio/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioSRCTests.h"
+
+#include <cmath>
+#include <vector>
+
+#include "AudioSRC.h"
+#include "NumericalConstants.h"
+#include "SharedUtil.h"
+
+QTEST_MAIN(AudioSRCTests)
+
+static const AudioSRC::Quality QUALITIES[] = {
+    AudioSRC::LOW_QUALITY, AudioSRC::MEDIUM_QUALITY, AudioSRC::HIGH_QUALITY
+};
+static const char* QUALITY_NAMES[] = { "low", "medium", "high" };
+static const int CHANNEL_COUNTS[] = { 1, 2, 4 };
+
+// each channel gets a sine of its own amplitude, so a swapped or smeared channel shows up in its level
+static float channelAmplitude(int channel) {
+    return 0.1f * (channel + 1);
+}
+
+static std::vector<int16_t> makeSines(int numChannels, int numFrames, int sampleRate) {
+    const float FREQUENCY = 440.0f;
+    std::vector<int16_t> samples(numChannels * numFrames);
+    for (int i = 0; i < numFrames; i++) {
+        float phase = sinf(TWO_PI * FREQUENCY * i / sampleRate);
+        for (int j = 0; j < numChannels; j++) {
+            samples[numChannels * i + j] = (int16_t)(channelAmplitude(j) * phase * 32767.0f);
+        }
+    }
+    return samples;
+}
+
+void AudioSRCTests::channelOrder() {
+    // an odd block size exercises the scalar tails of the SIMD conversions
+    const int INPUT_RATE = 48000;
+    const int OUTPUT_RATE = 24000;
+    const int NUM_FRAMES = INPUT_RATE + 13;
+    const int BLOCK_FRAMES = 479;
+
+    for (int q = 0; q < 3; q++) {
+        for (int numChannels : CHANNEL_COUNTS) {
+            AudioSRC src(INPUT_RATE, OUTPUT_RATE, numChannels, QUALITIES[q]);
+            auto input = makeSines(numChannels, NUM_FRAMES, INPUT_RATE);
+
+            std::vector<int16_t> output(numChannels * src.getMaxOutput(NUM_FRAMES));
+            int outputFrames = 0;
+            for (int i = 0; i < NUM_FRAMES; i += BLOCK_FRAMES) {
+                int frames = std::min(BLOCK_FRAMES, NUM_FRAMES - i);
+                outputFrames += src.render(&input[numChannels * i], &output[numChannels * outputFrames], frames);
+            }
+            QVERIFY(outputFrames <= src.getMaxOutput(NUM_FRAMES));
+
+            // measure the level of each channel, past the filter delay
+            const int SKIP_FRAMES = 1000;
+            for (int j = 0; j < numChannels; j++) {
+                double sumSquares = 0.0;
+                for (int i = SKIP_FRAMES; i < outputFrames; i++) {
+                    double sample = output[numChannels * i + j] / 32768.0;
+                    sumSquares += sample * sample;
+                }
+                float rms = (float)sqrt(sumSquares / (outputFrames - SKIP_FRAMES));
+                float expected = channelAmplitude(j) / sqrtf(2.0f);
+                QVERIFY2(fabsf(rms - expected) < 0.02f * expected,
+                         qPrintable(QString("%1 quality, %2 channels: channel %3 rms %4, expected %5")
+                             .arg(QUALITY_NAMES[q]).arg(numChannels).arg(j).arg(rms).arg(expected)));
+            }
+        }
+    }
+}
+
+void AudioSRCTests::benchmark() {
+    const int BLOCK_FRAMES = 480;
+    const int NUM_BLOCKS = 1000;
+    const std::pair<int, int> RATES[] = { { 48000, 24000 }, { 44100, 48000 } };
+
+    for (auto& rates : RATES) {
+        for (int q = 0; q < 3; q++) {
+            for (int numChannels : CHANNEL_COUNTS) {
+                auto input = makeSines(numChannels, BLOCK_FRAMES, rates.first);
+
+                // interleaved int16_t, as used by the audio device callbacks
+                {
+                    AudioSRC src(rates.first, rates.second, numChannels, QUALITIES[q]);
+                    std::vector<int16_t> output(numChannels * src.getMaxOutput(BLOCK_FRAMES));
+
+                    quint64 start = usecTimestampNow();
+                    for (int i = 0; i < NUM_BLOCKS; i++) {
+                        src.render(input.data(), output.data(), BLOCK_FRAMES);
+                    }
+                    quint64 elapsed = usecTimestampNow() - start;
+                    qDebug().nospace() << rates.first << "->" << rates.second << " " << QUALITY_NAMES[q] << " quality, "
+                        << numChannels << " channels, int16: "
+                        << (float)elapsed * NSECS_PER_USEC / (NUM_BLOCKS * BLOCK_FRAMES) << " ns per frame";
+                }
+
+                // interleaved float
+                {
+                    AudioSRC src(rates.first, rates.second, numChannels, QUALITIES[q]);
+                    std::vector<float> floatInput(input.size());
+                    for (size_t i = 0; i < input.size(); i++) {
+                        floatInput[i] = input[i] / 32768.0f;
+                    }
+                    std::vector<float> output(numChannels * src.getMaxOutput(BLOCK_FRAMES));
+
+                    quint64 start = usecTimestampNow();
+                    for (int i = 0; i < NUM_BLOCKS; i++) {
+                        src.render(floatInput.data(), output.data(), BLOCK_FRAMES);
+                    }
+                    quint64 elapsed = usecTimestampNow() - start;
+                    qDebug().nospace() << rates.first << "->" << rates.second << " " << QUALITY_NAMES[q] << " quality, "
+                        << numChannels << " channels, float: "
+                        << (float)elapsed * NSECS_PER_USEC / (NUM_BLOCKS * BLOCK_FRAMES) << " ns per frame";
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,153 @@
+//
+//  EntitySpatialIndexTests.cpp
+//  tests/entities-index/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySpatialIndexTests.h"
+
+#include <DependencyManager.h>
+#include <NodeList.h>
+#include <OctreeConstants.h>
+
+#include <EntityItemProperties.h>
+#include <EntitySpatialIndex.h>
+#include <ShapeEntityItem.h>
+
+QTEST_MAIN(EntitySpatialIndexTests)
+
+static EntityItemPointer createBox(const glm::vec3& position, const glm::vec3& dimensions) {
+    EntityItemProperties properties;
+    properties.setPosition(position);
+    properties.setDimensions(dimensions);
+    return ShapeEntityItem::boxFactory(EntityItemID(QUuid::createUuid()), properties);
+}
+
+// the entities whose bounds touch a cube of the given size around center
+static QVector<EntityItemID> findTouching(EntitySpatialIndex& index, const glm::vec3& center, float size = 1.0f) {
+    QVector<EntityItemID> found;
+    glm::vec3 halfSize(0.5f * size);
+    index.forEachEntityTouching(center - halfSize, center + halfSize, [&](const EntityItemPointer& entity) {
+        found.push_back(entity->getEntityItemID());
+    });
+    return found;
+}
+
+void EntitySpatialIndexTests::initTestCase() {
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+}
+
+void EntitySpatialIndexTests::insert() {
+    EntitySpatialIndex index;
+    auto near = createBox(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(1.0f));
+    auto far = createBox(glm::vec3(100.0f, 2.0f, 3.0f), glm::vec3(1.0f));
+    index.addEntity(near);
+    index.addEntity(far);
+    QCOMPARE(index.size(), 2);
+
+    auto found = findTouching(index, glm::vec3(1.0f, 2.0f, 3.0f));
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found[0], near->getEntityItemID());
+
+    // a query in an empty cell between them finds neither
+    QCOMPARE(findTouching(index, glm::vec3(50.0f, 2.0f, 3.0f)).size(), 0);
+
+    // adding an entity again replaces it rather than indexing it twice
+    index.addEntity(near);
+    QCOMPARE(index.size(), 2);
+    QCOMPARE(findTouching(index, glm::vec3(1.0f, 2.0f, 3.0f)).size(), 1);
+}
+
+void EntitySpatialIndexTests::move() {
+    EntitySpatialIndex index;
+    auto entity = createBox(glm::vec3(1.0f), glm::vec3(1.0f));
+    index.addEntity(entity);
+
+    // into another cell
+    glm::vec3 newPosition(5.0f * EntitySpatialIndex::CELL_SIZE, 1.0f, 1.0f);
+    entity->setPosition(newPosition);
+    entity->updateQueryAACube();
+    index.entityMoved(entity);
+
+    QCOMPARE(findTouching(index, glm::vec3(1.0f)).size(), 0);
+    auto found = findTouching(index, newPosition);
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found[0], entity->getEntityItemID());
+    QCOMPARE(index.size(), 1);
+}
+
+void EntitySpatialIndexTests::remove() {
+    EntitySpatialIndex index;
+    auto first = createBox(glm::vec3(1.0f), glm::vec3(1.0f));
+    auto second = createBox(glm::vec3(1.5f), glm::vec3(1.0f));
+    index.addEntity(first);
+    index.addEntity(second);
+    QCOMPARE(findTouching(index, glm::vec3(1.0f)).size(), 2);
+
+    // removing the first entry of a cell moves the last one into its place
+    index.removeEntity(first->getEntityItemID());
+    QCOMPARE(index.size(), 1);
+    auto found = findTouching(index, glm::vec3(1.0f));
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found[0], second->getEntityItemID());
+
+    index.removeEntity(second->getEntityItemID());
+    QCOMPARE(index.size(), 0);
+    QCOMPARE(findTouching(index, glm::vec3(1.0f)).size(), 0);
+
+    // an entity that was removed while it was queued to move stays out
+    index.addEntity(first);
+    index.entityMoved(first);
+    index.removeEntity(first->getEntityItemID());
+    QCOMPARE(findTouching(index, glm::vec3(1.0f)).size(), 0);
+    QCOMPARE(index.size(), 0);
+}
+
+void EntitySpatialIndexTests::largeEntity() {
+    EntitySpatialIndex index;
+    float width = 4.0f * EntitySpatialIndex::CELL_SIZE;
+    auto large = createBox(glm::vec3(0.0f), glm::vec3(width, 1.0f, width));
+    index.addEntity(large);
+
+    // found far from its center, in cells it isn't binned in
+    auto found = findTouching(index, glm::vec3(0.45f * width, 0.0f, 0.45f * width));
+    QCOMPARE(found.size(), 1);
+    QCOMPARE(found[0], large->getEntityItemID());
+
+    // but not by queries outside its bounds
+    QCOMPARE(findTouching(index, glm::vec3(10.0f * width, 0.0f, 0.0f)).size(), 0);
+
+    index.removeEntity(large->getEntityItemID());
+    QCOMPARE(findTouching(index, glm::vec3(0.45f * width, 0.0f, 0.45f * width)).size(), 0);
+}
+
+void EntitySpatialIndexTests::unboundedEntity() {
+    EntitySpatialIndex index;
+    // without a SpatialParentFinder the parent is never found, so the entity has no bounds
+    EntityItemProperties properties;
+    properties.setParentID(QUuid::createUuid());
+    properties.setDimensions(glm::vec3(1.0f));
+    auto entity = ShapeEntityItem::boxFactory(EntityItemID(QUuid::createUuid()), properties);
+    bool success;
+    entity->getQueryAACube(success);
+    QVERIFY(!success);
+
+    index.addEntity(entity);
+    QCOMPARE(index.size(), 1);
+
+    // it isn't found by queries anywhere, not even the one that covers everything
+    QCOMPARE(findTouching(index, glm::vec3(1.0f)).size(), 0);
+    QCOMPARE(findTouching(index, glm::vec3(0.0f), 2.0f * HALF_TREE_SCALE).size(), 0);
+
+    // once its parent is cleared it has bounds again, at its local position, and the move bins it
+    entity->setParentID(QUuid());
+    index.entityMoved(entity);
+    QCOMPARE(findTouching(index, glm::vec3(0.0f)).size(), 1);
+
+    index.removeEntity(entity->getEntityItemID());
+    QCOMPARE(index.size(), 0);
+}
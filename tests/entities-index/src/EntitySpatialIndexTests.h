@@ -0,0 +1,28 @@
+//
+//  EntitySpatialIndexTests.h
+//  tests/entities-index/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySpatialIndexTests_h
+#define hifi_EntitySpatialIndexTests_h
+
+#include <QtTest/QtTest>
+
+class EntitySpatialIndexTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void insert();
+    void move();
+    void remove();
+    void largeEntity();
+    void unboundedEntity();
+};
+
+#endif // hifi_EntitySpatialIndexTests_h
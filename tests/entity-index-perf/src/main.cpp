@@ -0,0 +1,178 @@
+//
+//  main.cpp
+//  tests/entity-index-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Fills an entity tree and times the sphere and box queries the entity renderer and scripts make, through the octree
+// the way EntityTree used to answer them, and through the spatial index it answers them with now.
+// Usage: entity-index-perf-test [entities] [queries] [query radius]
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <DependencyManager.h>
+#include <NodeList.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include <EntityItemProperties.h>
+#include <EntityTree.h>
+#include <EntityTreeElement.h>
+
+static const int DEFAULT_ENTITIES = 100000;
+static const int DEFAULT_QUERIES = 10000;
+static const float DEFAULT_QUERY_RADIUS = 10.0f;
+static const float WORLD_HALF_SIZE = 1000.0f;
+static const int ENTITIES_PER_LARGE_ENTITY = 100;
+
+static int intArgument(const QStringList& arguments, int index, int defaultValue) {
+    bool ok = false;
+    int value = index < arguments.size() ? arguments[index].toInt(&ok) : 0;
+    return ok && value > 0 ? value : defaultValue;
+}
+
+static glm::vec3 randomPosition() {
+    return glm::vec3(randFloatInRange(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), randFloatInRange(-WORLD_HALF_SIZE, WORLD_HALF_SIZE),
+        randFloatInRange(-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+}
+
+// mostly small boxes, with the odd building sized one
+static EntityTreePointer createTree(int numEntities) {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->setIsServer(true);
+    tree->createRootElement();
+
+    tree->withWriteLock([&] {
+        for (int i = 0; i < numEntities; ++i) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setPosition(randomPosition());
+            float size = (i % ENTITIES_PER_LARGE_ENTITY) == 0 ? randFloatInRange(20.0f, 100.0f) : randFloatInRange(0.1f, 4.0f);
+            properties.setDimensions(glm::vec3(size, randFloatInRange(0.1f, size), size));
+            tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+        }
+    });
+    return tree;
+}
+
+struct SphereQuery {
+    glm::vec3 center;
+    float radius;
+    QVector<EntityItemPointer> entities;
+};
+
+// the recursion EntityTree::findEntities made before it had an index
+static bool findInSphereOperation(const OctreeElementPointer& element, void* extraData) {
+    SphereQuery* query = static_cast<SphereQuery*>(extraData);
+    glm::vec3 penetration;
+    if (element->getAACube().findSpherePenetration(query->center, query->radius, penetration)) {
+        std::static_pointer_cast<EntityTreeElement>(element)->getEntities(query->center, query->radius, query->entities);
+        return true;
+    }
+    return false;
+}
+
+struct BoxQuery {
+    AABox box;
+    QVector<EntityItemPointer> entities;
+};
+
+static bool findInBoxOperation(const OctreeElementPointer& element, void* extraData) {
+    BoxQuery* query = static_cast<BoxQuery*>(extraData);
+    if (element->getAACube().touches(query->box)) {
+        std::static_pointer_cast<EntityTreeElement>(element)->getEntities(query->box, query->entities);
+        return true;
+    }
+    return false;
+}
+
+static void report(const char* name, qint64 elapsed, int numQueries, size_t numFound) {
+    qDebug() << name << (float)numQueries * (float)NSECS_PER_SECOND / (float)elapsed << "queries per second,"
+        << (float)numFound / (float)numQueries << "entities per query";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    int numEntities = intArgument(arguments, 1, DEFAULT_ENTITIES);
+    int numQueries = intArgument(arguments, 2, DEFAULT_QUERIES);
+    float radius = (float)intArgument(arguments, 3, (int)DEFAULT_QUERY_RADIUS);
+
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+
+    qDebug() << "Creating" << numEntities << "entities";
+    EntityTreePointer tree = createTree(numEntities);
+
+    std::vector<glm::vec3> centers;
+    for (int i = 0; i < numQueries; ++i) {
+        centers.push_back(randomPosition());
+    }
+
+    tree->withReadLock([&] {
+        size_t octreeFound = 0;
+        size_t indexFound = 0;
+        QElapsedTimer timer;
+
+        qDebug() << "Sphere queries of radius" << radius;
+
+        timer.start();
+        for (const auto& center : centers) {
+            SphereQuery query { center, radius, QVector<EntityItemPointer>() };
+            tree->recurseTreeWithOperation(findInSphereOperation, &query);
+            octreeFound += query.entities.size();
+        }
+        report("  octree findEntities:", timer.nsecsElapsed(), numQueries, octreeFound);
+
+        indexFound = 0;
+        timer.start();
+        QVector<EntityItemPointer> foundEntities;
+        for (const auto& center : centers) {
+            tree->findEntities(center, radius, foundEntities);
+            indexFound += foundEntities.size();
+        }
+        report("  index findEntities:", timer.nsecsElapsed(), numQueries, indexFound);
+
+        indexFound = 0;
+        timer.start();
+        for (const auto& center : centers) {
+            tree->forEachEntityInSphere(center, radius, [&](const EntityItemPointer&) {
+                ++indexFound;
+            });
+        }
+        report("  index forEachEntityInSphere:", timer.nsecsElapsed(), numQueries, indexFound);
+        if (indexFound != octreeFound) {
+            qWarning() << "  the index found" << indexFound << "entities, the octree found" << octreeFound;
+        }
+
+        qDebug() << "Box queries of size" << 2.0f * radius;
+
+        octreeFound = 0;
+        timer.start();
+        for (const auto& center : centers) {
+            BoxQuery query { AABox(center - glm::vec3(radius), 2.0f * radius), QVector<EntityItemPointer>() };
+            tree->recurseTreeWithOperation(findInBoxOperation, &query);
+            octreeFound += query.entities.size();
+        }
+        report("  octree findEntities:", timer.nsecsElapsed(), numQueries, octreeFound);
+
+        indexFound = 0;
+        timer.start();
+        for (const auto& center : centers) {
+            tree->forEachEntityInBox(AABox(center - glm::vec3(radius), 2.0f * radius), [&](const EntityItemPointer&) {
+                ++indexFound;
+            });
+        }
+        report("  index forEachEntityInBox:", timer.nsecsElapsed(), numQueries, indexFound);
+        if (indexFound != octreeFound) {
+            qWarning() << "  the index found" << indexFound << "entities, the octree found" << octreeFound;
+        }
+    });
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+//
+//  main.cpp
+//  tests/fbx-parse-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Parses a corpus of FBX files into node trees, then reads them all the way to FBXGeometry, to time the parser and
+// the extraction in MB per second of file and to see how much memory they take at most.
+// Usage: fbx-parse-perf-test <fbx files or directories of them>...
+
+#include <memory>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include <FBXReader.h>
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+static const float BYTES_PER_MB = 1024.0f * 1024.0f;
+
+static QStringList findFiles(const QStringList& arguments) {
+    QStringList files;
+    for (int i = 1; i < arguments.size(); ++i) {
+        QFileInfo info(arguments[i]);
+        if (info.isDir()) {
+            QDirIterator it(info.filePath(), { "*.fbx", "*.FBX" }, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                files.append(it.next());
+            }
+        } else {
+            files.append(info.filePath());
+        }
+    }
+    return files;
+}
+
+// the peak commit charge on Windows, since that's what getMemoryInfo knows about
+static float peakMemoryMB() {
+#ifdef Q_OS_WIN
+    MemoryInfo info;
+    return getMemoryInfo(info) ? (float)info.processPeakUsedMemoryBytes / BYTES_PER_MB : 0.0f;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MAC
+    return (float)usage.ru_maxrss / BYTES_PER_MB;
+#else
+    return (float)usage.ru_maxrss / 1024.0f;
+#endif
+#endif
+}
+
+static void report(const char* name, qint64 elapsed, qint64 numBytes) {
+    float msecs = (float)elapsed / (float)NSECS_PER_MSEC;
+    qDebug() << name << msecs << "ms," << (float)numBytes / BYTES_PER_MB / (msecs / (float)MSECS_PER_SECOND) << "MB/s,"
+        << peakMemoryMB() << "MB peak memory";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QStringList files = findFiles(app.arguments());
+    if (files.isEmpty()) {
+        qWarning() << "Usage: fbx-parse-perf-test <fbx files or directories of them>...";
+        return 1;
+    }
+
+    qDebug() << "Reading" << files.size() << "FBX files on" << QThreadPool::globalInstance()->maxThreadCount()
+        << "threads, starting with" << peakMemoryMB() << "MB peak memory";
+
+    qint64 parseTime = 0;
+    qint64 numParsedBytes = 0;
+    for (const auto& fileName : files) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "  can't open" << fileName;
+            continue;
+        }
+        QByteArray data = file.readAll();
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+
+        QElapsedTimer timer;
+        timer.start();
+        try {
+            FBXNode root = FBXReader::parseFBX(&buffer);
+            qint64 elapsed = timer.nsecsElapsed();
+            parseTime += elapsed;
+            numParsedBytes += data.size();
+            qDebug() << "  " << QFileInfo(fileName).fileName() << (float)data.size() / BYTES_PER_MB << "MB,"
+                << (float)elapsed / (float)NSECS_PER_MSEC << "ms," << root.children.size() << "top level nodes";
+        } catch (const QString& error) {
+            qWarning() << "  can't parse" << fileName << error;
+        }
+    }
+    report("parsing:", parseTime, numParsedBytes);
+
+    // the whole readFBX, which the parsing is part of, as the model loading threads run it
+    qint64 readTime = 0;
+    qint64 numReadBytes = 0;
+    for (const auto& fileName : files) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QByteArray data = file.readAll();
+
+        QElapsedTimer timer;
+        timer.start();
+        try {
+            std::unique_ptr<FBXGeometry> geometry(readFBX(data, QVariantHash(), fileName));
+            readTime += timer.nsecsElapsed();
+            numReadBytes += data.size();
+        } catch (const QString& error) {
+            qWarning() << "  can't read" << fileName << error;
+        }
+    }
+    report("reading to FBXGeometry:", readTime, numReadBytes);
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+//
+//  main.cpp
+//  tests/gpu-batch-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Records frames of draw calls into gpu batches, on the null backend, to time the recording the render jobs do on the
+// render thread against recording the same draws split across batches on the thread pool.
+// Usage: gpu-batch-perf-test [draws per frame] [frames] [batches]
+
+#include <algorithm>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
+
+#include <NumericalConstants.h>
+
+#include <gpu/Context.h>
+#include <gpu/null/NullBackend.h>
+
+static const int DEFAULT_DRAWS = 20000;
+static const int DEFAULT_FRAMES = 200;
+static const int NUM_MESHES = 64;
+
+static int intArgument(const QStringList& arguments, int index, int defaultValue) {
+    bool ok = false;
+    int value = index < arguments.size() ? arguments[index].toInt(&ok) : 0;
+    return ok && value > 0 ? value : defaultValue;
+}
+
+struct Mesh {
+    gpu::BufferPointer vertices;
+    gpu::BufferPointer indices;
+};
+
+static std::vector<Mesh> createMeshes() {
+    std::vector<Mesh> meshes;
+    std::vector<glm::vec3> vertices(256, glm::vec3(1.0f));
+    std::vector<uint16_t> indices(768, 0);
+    for (int i = 0; i < NUM_MESHES; ++i) {
+        Mesh mesh;
+        mesh.vertices = std::make_shared<gpu::Buffer>(vertices.size() * sizeof(glm::vec3), (const gpu::Byte*)vertices.data());
+        mesh.indices = std::make_shared<gpu::Buffer>(indices.size() * sizeof(uint16_t), (const gpu::Byte*)indices.data());
+        meshes.push_back(mesh);
+    }
+    return meshes;
+}
+
+// what a shape job records for every item it draws
+static void recordDraws(gpu::Batch& batch, const std::vector<Mesh>& meshes, int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+        const auto& mesh = meshes[i % meshes.size()];
+        batch.setModelTransform(Transform(glm::quat(), glm::vec3(1.0f), glm::vec3((float)i, 0.0f, 0.0f)));
+        batch.setInputBuffer(0, mesh.vertices, 0, sizeof(glm::vec3));
+        batch.setIndexBuffer(gpu::UINT16, mesh.indices, 0);
+        batch._glUniform4f(0, 1.0f, 1.0f, 1.0f, 1.0f);
+        batch.drawIndexed(gpu::TRIANGLES, 768);
+    }
+}
+
+static void report(const char* name, qint64 elapsed, int numFrames, int numDraws) {
+    float msecs = (float)elapsed / (float)NSECS_PER_MSEC;
+    qDebug() << name << msecs / (float)numFrames << "ms per frame," << (float)numDraws * (float)numFrames / msecs
+        << "draws per ms";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    int numDraws = intArgument(arguments, 1, DEFAULT_DRAWS);
+    int numFrames = intArgument(arguments, 2, DEFAULT_FRAMES);
+    int numBatches = intArgument(arguments, 3, QThreadPool::globalInstance()->maxThreadCount() + 1);
+
+    qDebug() << "Recording" << numDraws << "draws per frame for" << numFrames << "frames";
+
+    gpu::Context::init<gpu::null::Backend>();
+    auto context = std::make_shared<gpu::Context>();
+    auto meshes = createMeshes();
+
+    // one batch on the render thread
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < numFrames; ++frame) {
+            context->beginFrame();
+            gpu::doInBatch(context, [&](gpu::Batch& batch) {
+                recordDraws(batch, meshes, 0, numDraws);
+            });
+            auto recorded = context->endFrame();
+            context->consumeFrameUpdates(recorded);
+        }
+        report("one batch:", timer.nsecsElapsed(), numFrames, numDraws);
+    }
+
+    // the same draws split in contiguous runs, one batch each, recorded on the pool
+    {
+        int drawsPerBatch = (numDraws + numBatches - 1) / numBatches;
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < numFrames; ++frame) {
+            context->beginFrame();
+            gpu::doInParallelBatches(context, (size_t)numBatches, [&](gpu::Batch& batch, size_t index) {
+                int begin = (int)index * drawsPerBatch;
+                recordDraws(batch, meshes, begin, std::min(begin + drawsPerBatch, numDraws));
+            });
+            auto recorded = context->endFrame();
+            context->consumeFrameUpdates(recorded);
+        }
+        qDebug() << numBatches << "batches";
+        report("parallel batches:", timer.nsecsElapsed(), numFrames, numDraws);
+    }
+
+    return 0;
+}
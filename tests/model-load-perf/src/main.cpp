@@ -0,0 +1,140 @@
+//
+//  main.cpp
+//  tests/model-load-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Loads a corpus of models, typically baked ones with draco meshes, the way the ModelCache does and keeps them all
+// loaded, without a GL context, to time the loading and see how much memory the loaded meshes hold on to.  Run it with
+// and without --keep-render-attributes to compare the peak memory, which only goes up within a process.
+// Usage: model-load-perf-test [--keep-render-attributes] <fbx files or directories of them>...
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include <gpu/Buffer.h>
+
+#include <FBXReader.h>
+
+#ifndef Q_OS_WIN
+#include <sys/resource.h>
+#endif
+
+static const float BYTES_PER_MB = 1024.0f * 1024.0f;
+static const QString KEEP_RENDER_ATTRIBUTES_OPTION = "--keep-render-attributes";
+
+static QStringList findFiles(const QStringList& arguments) {
+    QStringList files;
+    for (int i = 1; i < arguments.size(); ++i) {
+        if (arguments[i] == KEEP_RENDER_ATTRIBUTES_OPTION) {
+            continue;
+        }
+        QFileInfo info(arguments[i]);
+        if (info.isDir()) {
+            QDirIterator it(info.filePath(), { "*.fbx", "*.FBX" }, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                files.append(it.next());
+            }
+        } else {
+            files.append(info.filePath());
+        }
+    }
+    return files;
+}
+
+// the peak commit charge on Windows, since that's what getMemoryInfo knows about
+static float peakMemoryMB() {
+#ifdef Q_OS_WIN
+    MemoryInfo info;
+    return getMemoryInfo(info) ? (float)info.processPeakUsedMemoryBytes / BYTES_PER_MB : 0.0f;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef Q_OS_MAC
+    return (float)usage.ru_maxrss / BYTES_PER_MB;
+#else
+    return (float)usage.ru_maxrss / 1024.0f;
+#endif
+#endif
+}
+
+// what the mesh keeps on the CPU next to its gpu buffers
+static size_t getCPUAttributeSize(const FBXMesh& mesh) {
+    return (mesh.vertices.size() + mesh.normals.size() + mesh.tangents.size() + mesh.colors.size()) * sizeof(glm::vec3) +
+        (mesh.texCoords.size() + mesh.texCoords1.size()) * sizeof(glm::vec2) +
+        mesh.clusterIndices.size() * sizeof(uint16_t) + mesh.clusterWeights.size() * sizeof(uint8_t);
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    bool keepRenderAttributes = arguments.contains(KEEP_RENDER_ATTRIBUTES_OPTION);
+    QStringList files = findFiles(arguments);
+    if (files.isEmpty()) {
+        qWarning() << "Usage: model-load-perf-test [--keep-render-attributes] <fbx files or directories of them>...";
+        return 1;
+    }
+
+    std::vector<QByteArray> models;
+    qint64 numBytes = 0;
+    for (const auto& fileName : files) {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            models.push_back(file.readAll());
+            numBytes += models.back().size();
+        } else {
+            qWarning() << "can't open" << fileName;
+        }
+    }
+
+    qDebug() << "Loading" << models.size() << "models," << (float)numBytes / BYTES_PER_MB << "MB, on"
+        << QThreadPool::globalInstance()->maxThreadCount() << "threads,"
+        << (keepRenderAttributes ? "keeping" : "releasing") << "the render attributes";
+    float startMemory = peakMemoryMB();
+
+    std::vector<std::unique_ptr<FBXGeometry>> geometries;
+    QElapsedTimer timer;
+    timer.start();
+    for (size_t i = 0; i < models.size(); ++i) {
+        try {
+            geometries.emplace_back(readFBX(models[i], QVariantHash(), files[(int)i], true, 1.0f, keepRenderAttributes));
+        } catch (const QString& error) {
+            qWarning() << "can't load" << files[(int)i] << error;
+        }
+    }
+    float msecs = (float)timer.nsecsElapsed() / (float)NSECS_PER_MSEC;
+
+    int numMeshes = 0;
+    int numCompressedMeshes = 0;
+    size_t cpuAttributeSize = 0;
+    for (const auto& geometry : geometries) {
+        for (const auto& mesh : geometry->meshes) {
+            numMeshes++;
+            numCompressedMeshes += mesh.wasCompressed ? 1 : 0;
+            cpuAttributeSize += getCPUAttributeSize(mesh);
+        }
+    }
+
+    qDebug() << "loaded" << numMeshes << "meshes," << numCompressedMeshes << "of them draco, in" << msecs << "ms,"
+        << (float)numBytes / BYTES_PER_MB / (msecs / (float)MSECS_PER_SECOND) << "MB/s";
+    qDebug() << "  " << (float)cpuAttributeSize / BYTES_PER_MB << "MB of mesh attributes on the CPU,"
+        << (float)gpu::Buffer::getBufferCPUMemSize() / BYTES_PER_MB << "MB in gpu buffers";
+    qDebug() << "  " << peakMemoryMB() << "MB peak memory," << startMemory << "MB of it before loading";
+
+    return 0;
+}
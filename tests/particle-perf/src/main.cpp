@@ -0,0 +1,140 @@
+//
+//  main.cpp
+//  tests/particle-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Runs many particle emitters through the entity particle simulation, without a GL context, to time the steps the
+// entity renderer does every frame.  Usage: particle-perf-test [emitters] [frames] [particles per emitter]
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include <ParticleSimulation.h>
+
+using namespace render::entities;
+
+static const int DEFAULT_EMITTERS = 500;
+static const int DEFAULT_FRAMES = 600;
+static const int DEFAULT_PARTICLES = 300;
+static const uint64_t FRAME_USECS = USECS_PER_SECOND / 60;
+
+static int intArgument(const QStringList& arguments, int index, int defaultValue) {
+    bool ok = false;
+    int value = index < arguments.size() ? arguments[index].toInt(&ok) : 0;
+    return ok && value > 0 ? value : defaultValue;
+}
+
+static std::vector<ParticleEmitterSimulation::Pointer> createEmitters(int numEmitters, int particlesPerEmitter) {
+    particle::Properties properties;
+    properties.lifespan = 3.0f;
+    properties.emission.rate = (float)particlesPerEmitter / properties.lifespan;
+    properties.maxParticles = particlesPerEmitter;
+    properties.emission.speed.target = 1.0f;
+    properties.emission.speed.spread = 0.5f;
+    properties.emission.acceleration.target = glm::vec3(0.0f, -9.8f, 0.0f);
+    properties.emission.dimensions = glm::vec3(1.0f);
+    properties.polar.finish = PI;
+
+    std::vector<ParticleEmitterSimulation::Pointer> emitters;
+    for (int i = 0; i < numEmitters; ++i) {
+        auto emitter = std::make_shared<ParticleEmitterSimulation>();
+        emitter->setProperties(properties);
+        emitter->setEmitting(true);
+        emitter->setTransform(Transform(glm::quat(), glm::vec3(1.0f), glm::vec3((float)i, 0.0f, 0.0f)));
+        emitters.push_back(emitter);
+    }
+    return emitters;
+}
+
+static size_t countParticles(const std::vector<ParticleEmitterSimulation::Pointer>& emitters) {
+    size_t count = 0;
+    for (const auto& emitter : emitters) {
+        count += emitter->getNumParticles();
+    }
+    return count;
+}
+
+// fills every emitter up to its steady state before timing anything
+static uint64_t warmUp(const std::vector<ParticleEmitterSimulation::Pointer>& emitters, uint64_t now) {
+    static const int WARM_UP_FRAMES = 4 * 60;
+    for (int frame = 0; frame < WARM_UP_FRAMES; ++frame) {
+        now += FRAME_USECS;
+        for (const auto& emitter : emitters) {
+            emitter->setRendered();
+            emitter->step(now);
+            emitter->swapBuffers();
+        }
+    }
+    return now;
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    int numEmitters = intArgument(arguments, 1, DEFAULT_EMITTERS);
+    int numFrames = intArgument(arguments, 2, DEFAULT_FRAMES);
+    int particlesPerEmitter = intArgument(arguments, 3, DEFAULT_PARTICLES);
+
+    qDebug() << "Stepping" << numEmitters << "emitters of" << particlesPerEmitter << "particles for" << numFrames
+        << "frames, on" << QThreadPool::globalInstance()->maxThreadCount() << "threads";
+
+    // one thread, the way the renderer used to step its emitters
+    {
+        auto emitters = createEmitters(numEmitters, particlesPerEmitter);
+        uint64_t now = warmUp(emitters, usecTimestampNow());
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < numFrames; ++frame) {
+            now += FRAME_USECS;
+            for (const auto& emitter : emitters) {
+                emitter->setRendered();
+                emitter->step(now);
+                emitter->swapBuffers();
+            }
+        }
+        auto elapsed = timer.nsecsElapsed();
+        qDebug() << "serial:" << (float)elapsed / (float)(numFrames * NSECS_PER_MSEC) << "ms per frame,"
+            << countParticles(emitters) << "particles";
+    }
+
+    // on the pool, the way the entity renderer steps them now
+    {
+        auto emitters = createEmitters(numEmitters, particlesPerEmitter);
+        uint64_t now = warmUp(emitters, usecTimestampNow());
+
+        ParticleSimulationPool pool;
+        for (const auto& emitter : emitters) {
+            pool.addEmitter(emitter, render::Item::INVALID_ITEM_ID);
+        }
+
+        // there is no scene to apply the buffer swaps, so they are dropped with the transaction and the steps keep
+        // rewriting their finished buffers
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < numFrames; ++frame) {
+            now += FRAME_USECS;
+            for (const auto& emitter : emitters) {
+                emitter->setRendered();
+            }
+            render::Transaction transaction;
+            pool.start(now, transaction);
+            pool.wait();
+        }
+        auto elapsed = timer.nsecsElapsed();
+        qDebug() << "pool:" << (float)elapsed / (float)(numFrames * NSECS_PER_MSEC) << "ms per frame,"
+            << countParticles(emitters) << "particles";
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+//
+//  ThreadSafeDynamicsWorldTests.cpp
+//  tests/physics/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ThreadSafeDynamicsWorldTests.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <btBulletDynamicsCommon.h>
+
+#include <ThreadSafeDynamicsWorld.h>
+
+#include "BulletTestUtils.h"
+#include "../QTestExtensions.h"
+
+QTEST_MAIN(ThreadSafeDynamicsWorldTests)
+
+const btScalar FIXED_SUBSTEP = btScalar(1.0 / 90.0);
+const btScalar BOX_HALF_EXTENT = btScalar(0.25);
+
+// A world with a static floor and columns of boxes dropped onto it. Every column ends up in its own
+// simulation island, which is what the parallel solver distributes across threads.
+class ColumnWorld {
+public:
+    ColumnWorld(int numColumns, int boxesPerColumn, int numSolverThreads) :
+        _dispatcher(&_collisionConfig),
+        _floorShape(btVector3(0.0f, 1.0f, 0.0f), 0.0f),
+        _boxShape(btVector3(BOX_HALF_EXTENT, BOX_HALF_EXTENT, BOX_HALF_EXTENT)) {
+        _world.reset(new ThreadSafeDynamicsWorld(&_dispatcher, &_broadphase, &_solver, &_collisionConfig));
+        _world->setGravity(btVector3(0.0f, -9.8f, 0.0f));
+        _world->setNumSolverThreads(numSolverThreads);
+
+        btRigidBody::btRigidBodyConstructionInfo floorInfo(0.0f, nullptr, &_floorShape);
+        _floor.reset(new btRigidBody(floorInfo));
+        _world->addRigidBody(_floor.get());
+
+        btScalar mass = 1.0f;
+        btVector3 inertia;
+        _boxShape.calculateLocalInertia(mass, inertia);
+        int columnsPerRow = (int)ceilf(sqrtf((float)numColumns));
+        btScalar spacing = 4.0f * BOX_HALF_EXTENT;
+        for (int column = 0; column < numColumns; ++column) {
+            btScalar x = spacing * (btScalar)(column % columnsPerRow);
+            btScalar z = spacing * (btScalar)(column / columnsPerRow);
+            for (int i = 0; i < boxesPerColumn; ++i) {
+                btRigidBody::btRigidBodyConstructionInfo boxInfo(mass, nullptr, &_boxShape, inertia);
+                boxInfo.m_startWorldTransform.setOrigin(btVector3(x, BOX_HALF_EXTENT * (2.1f * (btScalar)i + 1.0f), z));
+                btRigidBody* box = new btRigidBody(boxInfo);
+                box->setActivationState(DISABLE_DEACTIVATION);
+                _boxes.push_back(std::unique_ptr<btRigidBody>(box));
+                _world->addRigidBody(box);
+            }
+        }
+    }
+
+    ~ColumnWorld() {
+        for (auto& box : _boxes) {
+            _world->removeRigidBody(box.get());
+        }
+        _world->removeRigidBody(_floor.get());
+    }
+
+    void step(int numSteps) {
+        for (int i = 0; i < numSteps; ++i) {
+            _world->stepSimulationWithSubstepCallback(FIXED_SUBSTEP, 1, FIXED_SUBSTEP);
+        }
+    }
+
+    ThreadSafeDynamicsWorld* getWorld() { return _world.get(); }
+    const std::vector<std::unique_ptr<btRigidBody>>& getBoxes() const { return _boxes; }
+
+private:
+    btDefaultCollisionConfiguration _collisionConfig;
+    btCollisionDispatcher _dispatcher;
+    btDbvtBroadphase _broadphase;
+    btSequentialImpulseConstraintSolver _solver;
+    btStaticPlaneShape _floorShape;
+    btBoxShape _boxShape;
+    std::unique_ptr<ThreadSafeDynamicsWorld> _world;
+    std::unique_ptr<btRigidBody> _floor;
+    std::vector<std::unique_ptr<btRigidBody>> _boxes;
+};
+
+void ThreadSafeDynamicsWorldTests::testParallelIslandsMatchSerial() {
+    const int NUM_COLUMNS = 64;
+    const int BOXES_PER_COLUMN = 4;
+    const int NUM_STEPS = 120;
+    ColumnWorld serialWorld(NUM_COLUMNS, BOXES_PER_COLUMN, 1);
+    ColumnWorld parallelWorld(NUM_COLUMNS, BOXES_PER_COLUMN, 4);
+    serialWorld.step(NUM_STEPS);
+    parallelWorld.step(NUM_STEPS);
+
+    // islands never share dynamic bodies, so solving them on different threads gives the same answer
+    const btScalar EPSILON = 1.0e-4f;
+    const auto& serialBoxes = serialWorld.getBoxes();
+    const auto& parallelBoxes = parallelWorld.getBoxes();
+    QCOMPARE(serialBoxes.size(), parallelBoxes.size());
+    for (size_t i = 0; i < serialBoxes.size(); ++i) {
+        QCOMPARE_WITH_ABS_ERROR(parallelBoxes[i]->getWorldTransform().getOrigin(),
+                                serialBoxes[i]->getWorldTransform().getOrigin(), EPSILON);
+    }
+
+    // and the columns are still standing
+    const btScalar topHeight = BOX_HALF_EXTENT * (2.0f * (btScalar)(BOXES_PER_COLUMN - 1) + 1.0f);
+    QCOMPARE_WITH_ABS_ERROR(parallelBoxes[BOXES_PER_COLUMN - 1]->getWorldTransform().getOrigin().getY(), topHeight, 0.05f);
+}
+
+void ThreadSafeDynamicsWorldTests::testKinematicIslands() {
+    // a kinematic paddle resting under several columns joins them into islands that share a body,
+    // which must be routed to the serial solver
+    const int NUM_COLUMNS = 16;
+    const int BOXES_PER_COLUMN = 3;
+    ColumnWorld world(NUM_COLUMNS, BOXES_PER_COLUMN, 4);
+
+    btBoxShape paddleShape(btVector3(20.0f, 0.1f, 20.0f));
+    btRigidBody::btRigidBodyConstructionInfo paddleInfo(0.0f, nullptr, &paddleShape);
+    paddleInfo.m_startWorldTransform.setOrigin(btVector3(0.0f, -0.05f, 0.0f));
+    btRigidBody paddle(paddleInfo);
+    paddle.setCollisionFlags(paddle.getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+    paddle.setActivationState(DISABLE_DEACTIVATION);
+    world.getWorld()->addRigidBody(&paddle);
+
+    world.step(90);
+    for (const auto& box : world.getBoxes()) {
+        QVERIFY(box->getWorldTransform().getOrigin().getY() > 0.0f);
+    }
+    world.getWorld()->removeRigidBody(&paddle);
+}
+
+void ThreadSafeDynamicsWorldTests::benchmarkStepSimulation() {
+    const int NUM_COLUMNS = 500;
+    const int BOXES_PER_COLUMN = 10;
+    const int NUM_WARMUP_STEPS = 30;
+    const int NUM_STEPS = 120;
+    const int MAX_THREADS = std::max(QThread::idealThreadCount(), 1);
+
+    qDebug() << "stepping" << NUM_COLUMNS * BOXES_PER_COLUMN << "dynamic bodies";
+    for (int numThreads = 1; numThreads <= MAX_THREADS; numThreads *= 2) {
+        ColumnWorld world(NUM_COLUMNS, BOXES_PER_COLUMN, numThreads);
+        world.step(NUM_WARMUP_STEPS);
+
+        QElapsedTimer timer;
+        timer.start();
+        world.step(NUM_STEPS);
+        qint64 elapsed = timer.nsecsElapsed();
+        qDebug() << "threads:" << numThreads << "step:" << (double)elapsed / (1.0e6 * NUM_STEPS) << "msec";
+    }
+}
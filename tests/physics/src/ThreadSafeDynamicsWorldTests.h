@@ -0,0 +1,25 @@
+//
+//  ThreadSafeDynamicsWorldTests.h
+//  tests/physics/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ThreadSafeDynamicsWorldTests_h
+#define hifi_ThreadSafeDynamicsWorldTests_h
+
+#include <QtTest/QtTest>
+
+class ThreadSafeDynamicsWorldTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testParallelIslandsMatchSerial();
+    void testKinematicIslands();
+    void benchmarkStepSimulation();
+};
+
+#endif // hifi_ThreadSafeDynamicsWorldTests_h
@@ -7,7 +7,13 @@
 #include <Windows.h>
 #endif
 
+#include <glm/gtc/quaternion.hpp>
+
+#include <AvatarData.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
 #include <recording/Clip.h>
+#include <recording/Deck.h>
 #include <recording/Frame.h>
 
 #include "Constants.h"
@@ -97,6 +103,214 @@ void testClipOrdering() {
     Q_UNUSED(lastFrameTimeOffset); // FIXME - Unix build not yet upgraded to Qt 5.5.1 we can remove this once it is
 }
 
+void testClipIndex() {
+    QTemporaryFile file;
+    QString fileName;
+    if (file.open()) {
+        fileName = file.fileName();
+        file.close();
+    }
+
+    // ten minutes of frames at 100Hz, with an unknown frame type mixed in
+    auto writeClip = Clip::newClip();
+    for (int i = 0; i < 60000; ++i) {
+        auto type = (i % 100 == 0) ? Frame::TYPE_INVALID - 1 : TEST_FRAME_TYPE;
+        writeClip->addFrame(std::make_shared<Frame>(type, (float)i * 0.01f, QByteArray::number(i)));
+    }
+    Clip::toFile(fileName, writeClip);
+
+    auto readClip = Clip::fromFile(fileName);
+    QVERIFY(readClip != Clip::Pointer());
+    QVERIFY(readClip->frameCount() == 60000 - 600);
+
+    // seeking through the index lands on the same frames as seeking the clip it was written from
+    for (float seconds : { 0.0f, 0.015f, 1.0f, 59.995f, 321.5f, 599.99f, 1000.0f }) {
+        readClip->seek(seconds);
+        writeClip->seek(seconds);
+        while (writeClip->peekFrame() && writeClip->peekFrame()->type != TEST_FRAME_TYPE) {
+            writeClip->skipFrame();
+        }
+        QVERIFY(readClip->positionFrameTime() == writeClip->positionFrameTime());
+        auto readFrame = readClip->peekFrame();
+        auto writeFrame = writeClip->peekFrame();
+        QVERIFY((bool)readFrame == (bool)writeFrame);
+        if (readFrame) {
+            QVERIFY(readFrame->data == writeFrame->data);
+        }
+    }
+
+    // shared clips read the same bytes with positions of their own
+    auto sharedClip = readClip->share();
+    readClip->seek(0);
+    sharedClip->seek(100.0f);
+    auto sharedPosition = sharedClip->positionFrameTime();
+    readClip->nextFrame();
+    QVERIFY(sharedPosition != readClip->positionFrameTime());
+    QVERIFY(sharedPosition == sharedClip->positionFrameTime());
+    QVERIFY(readClip->frameCount() == sharedClip->frameCount());
+
+    // files written before the index existed end at the first index frame, and are still read by a scan
+    QTemporaryFile unindexedFile;
+    QVERIFY(file.open() && unindexedFile.open());
+    auto bytes = file.readAll();
+    file.close();
+    quint64 indexOffset;
+    memcpy(&indexOffset, bytes.constData() + bytes.size() - 6 * sizeof(quint32), sizeof(quint64));
+    unindexedFile.write(bytes.left((int)indexOffset));
+    unindexedFile.close();
+
+    auto unindexedClip = Clip::fromFile(unindexedFile.fileName());
+    QVERIFY(unindexedClip != Clip::Pointer());
+    QVERIFY(unindexedClip->frameCount() == readClip->frameCount());
+    QVERIFY(unindexedClip->duration() == readClip->duration());
+    unindexedClip->seek(321.5f);
+    readClip->seek(321.5f);
+    QVERIFY(unindexedClip->nextFrame()->data == readClip->nextFrame()->data);
+}
+
+static const int NUM_AVATAR_JOINTS = 80;
+
+// animate a subset of the joints, the way a recording of a mostly idle avatar would
+static void animateAvatar(AvatarData& avatar, int frame) {
+    QVector<JointData> joints(NUM_AVATAR_JOINTS);
+    for (int i = 0; i < NUM_AVATAR_JOINTS; i++) {
+        float phase = (i % 4 == 0) ? 0.01f * (float)frame : 0.0f;
+        joints[i].rotation = glm::angleAxis(0.1f * (float)i + phase, glm::normalize(glm::vec3(1.0f, (float)i, 0.5f)));
+        joints[i].rotationSet = true;
+        joints[i].translation = glm::vec3(0.01f * (float)i, 0.1f + phase, -0.05f);
+        joints[i].translationSet = (i % 3 != 0);
+    }
+    avatar.setRawJointData(joints);
+}
+
+static void verifyJoints(const AvatarData& expected, const AvatarData& actual) {
+    const float ROTATION_TOLERANCE = 1.0e-4f;
+    const float TRANSLATION_TOLERANCE = 2.0f / 4096.0f; // TRANSLATION_COMPRESSION_RADIX
+    const auto& expectedJoints = expected.getRawJointData();
+    const auto& actualJoints = actual.getRawJointData();
+    QVERIFY(expectedJoints.size() == actualJoints.size());
+    for (int i = 0; i < expectedJoints.size(); i++) {
+        QVERIFY(expectedJoints[i].rotationSet == actualJoints[i].rotationSet);
+        QVERIFY(1.0f - fabsf(glm::dot(expectedJoints[i].rotation, actualJoints[i].rotation)) < ROTATION_TOLERANCE);
+        QVERIFY(expectedJoints[i].translationSet == actualJoints[i].translationSet);
+        if (expectedJoints[i].translationSet) {
+            QVERIFY(glm::length(expectedJoints[i].translation - actualJoints[i].translation) < TRANSLATION_TOLERANCE);
+        }
+    }
+}
+
+void testAvatarFrames() {
+    AvatarData recorded;
+    recorded.setRecordingBasis();
+
+    const int NUM_FRAMES = 150;
+    std::vector<QByteArray> frames;
+    AvatarFrameEncoder encoder;
+    AvatarData played;
+    AvatarFrameDecoder decoder;
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        animateAvatar(recorded, i);
+        frames.push_back(AvatarData::toFrame(recorded, encoder));
+
+        // play back in order
+        AvatarData::fromFrame(frames.back(), played, decoder);
+        verifyJoints(recorded, played);
+    }
+
+    // delta frames should be much smaller than key frames
+    QVERIFY(frames[1].size() < frames[0].size() / 2);
+    QVERIFY(AvatarData::isKeyFrame(frames[120]));
+    QVERIFY(!AvatarData::isKeyFrame(frames[100]));
+
+    // seeking to a key frame recovers every joint
+    AvatarData seeked;
+    AvatarFrameDecoder seekedDecoder;
+    AvatarData::fromFrame(frames[120], seeked, seekedDecoder);
+    animateAvatar(recorded, 120);
+    verifyJoints(recorded, seeked);
+
+    // a deck that seeks between key frames replays the frames since the key frame before the new position
+    const Frame::Time FRAME_INTERVAL = 16;
+    auto clip = Clip::newClip();
+    static const FrameType AVATAR_FRAME_TYPE = Frame::registerFrameType(AvatarData::FRAME_NAME);
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        auto frame = std::make_shared<Frame>(AVATAR_FRAME_TYPE, 0.0f, frames[i]);
+        frame->timeOffset = i * FRAME_INTERVAL;
+        clip->addFrame(frame);
+    }
+    AvatarData replayed;
+    AvatarFrameDecoder replayedDecoder;
+    int numReplayedFrames = 0;
+    Frame::registerKeyFrameTest(AVATAR_FRAME_TYPE, &AvatarData::isKeyFrame);
+    Frame::registerFrameHandler(AVATAR_FRAME_TYPE, [&](Frame::ConstPointer frame) {
+        AvatarData::fromFrame(frame->data, replayed, replayedDecoder);
+        numReplayedFrames++;
+    });
+    Deck deck;
+    deck.queueClip(clip);
+    deck.seek(Frame::frameTimeToSeconds(100 * FRAME_INTERVAL));
+    QVERIFY(numReplayedFrames == 100 - 60);
+    animateAvatar(recorded, 99);
+    verifyJoints(recorded, replayed);
+    Frame::clearFrameHandler(AVATAR_FRAME_TYPE);
+
+    // JSON frames from older recordings still load
+    AvatarData fromJson;
+    AvatarFrameDecoder fromJsonDecoder;
+    AvatarData::fromFrame(AvatarData::toJsonFrame(recorded), fromJson, fromJsonDecoder);
+    QVERIFY(fromJson.getRawJointData().size() == NUM_AVATAR_JOINTS);
+}
+
+void benchmarkAvatarFrames() {
+    const int NUM_FRAMES = 5000;
+    AvatarData recorded;
+    recorded.setRecordingBasis();
+    AvatarData played;
+    AvatarFrameEncoder encoder;
+
+    std::vector<QByteArray> jsonFrames;
+    std::vector<QByteArray> binaryFrames;
+    jsonFrames.reserve(NUM_FRAMES);
+    binaryFrames.reserve(NUM_FRAMES);
+
+    auto report = [](const char* name, quint64 usecs, size_t bytes) {
+        qDebug() << name << (float)usecs / (float)NUM_FRAMES << "usecs per frame,"
+                 << (float)bytes / (float)NUM_FRAMES << "bytes per frame";
+    };
+
+    size_t jsonBytes = 0;
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        animateAvatar(recorded, i);
+        jsonFrames.push_back(AvatarData::toJsonFrame(recorded));
+        jsonBytes += jsonFrames.back().size();
+    }
+    report("JSON encode  ", usecTimestampNow() - start, jsonBytes);
+
+    start = usecTimestampNow();
+    AvatarFrameDecoder jsonDecoder;
+    for (const auto& frame : jsonFrames) {
+        AvatarData::fromFrame(frame, played, jsonDecoder);
+    }
+    report("JSON decode  ", usecTimestampNow() - start, jsonBytes);
+
+    size_t binaryBytes = 0;
+    start = usecTimestampNow();
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        animateAvatar(recorded, i);
+        binaryFrames.push_back(AvatarData::toFrame(recorded, encoder));
+        binaryBytes += binaryFrames.back().size();
+    }
+    report("binary encode", usecTimestampNow() - start, binaryBytes);
+
+    start = usecTimestampNow();
+    AvatarFrameDecoder binaryDecoder;
+    for (const auto& frame : binaryFrames) {
+        AvatarData::fromFrame(frame, played, binaryDecoder);
+    }
+    report("binary decode", usecTimestampNow() - start, binaryBytes);
+}
+
 #ifdef Q_OS_WIN32
 void myMessageHandler(QtMsgType type, const QMessageLogContext & context, const QString & msg) {
     OutputDebugStringA(msg.toLocal8Bit().toStdString().c_str());
@@ -111,4 +325,7 @@ int main(int, const char**) {
     testFrameTypeRegistration();
     testFilePersist();
     testClipOrdering();
+    testClipIndex();
+    testAvatarFrames();
+    benchmarkAvatarFrames();
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+//
+//  main.cpp
+//  tests/render-cull-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Fills a render::Scene with boxes and runs the fetch, cull and depth sort jobs of the render task on it from views
+// turning around the middle of the scene, to time them the way they ran before they used the thread pool and the way
+// they run now.  The jobs get a gpu::Context on the null backend, so no GL context or GPU is needed.
+// Usage: render-cull-perf-test [items] [views]
+
+#include <algorithm>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <NumericalConstants.h>
+#include <OctreeUtils.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+
+#include <gpu/Context.h>
+#include <gpu/null/NullBackend.h>
+
+#include <render/CullTask.h>
+#include <render/Scene.h>
+#include <render/SortTask.h>
+
+using namespace render;
+
+static const int DEFAULT_ITEMS = 100000;
+static const int DEFAULT_VIEWS = 200;
+static const float WORLD_HALF_SIZE = 1000.0f;
+static const float MIN_ANGULAR_SIZE = 0.005f;
+
+struct TestItem {
+    AABox bound;
+};
+using TestPayload = Payload<TestItem>;
+
+namespace render {
+    template <> const ItemKey payloadGetKey(const std::shared_ptr<TestItem>&) {
+        return ItemKey::Builder::opaqueShape().build();
+    }
+    template <> const Item::Bound payloadGetBound(const std::shared_ptr<TestItem>& payloadData) {
+        return payloadData->bound;
+    }
+}
+
+static int intArgument(const QStringList& arguments, int index, int defaultValue) {
+    bool ok = false;
+    int value = index < arguments.size() ? arguments[index].toInt(&ok) : 0;
+    return ok && value > 0 ? value : defaultValue;
+}
+
+// mostly small boxes, with the odd building sized one
+static ScenePointer createScene(int numItems) {
+    auto scene = std::make_shared<Scene>(glm::vec3(-16384.0f), 32768.0f);
+    Transaction transaction;
+    for (int i = 0; i < numItems; ++i) {
+        auto item = std::make_shared<TestItem>();
+        glm::vec3 position(randFloatInRange(-WORLD_HALF_SIZE, WORLD_HALF_SIZE), randFloatInRange(-10.0f, 50.0f),
+            randFloatInRange(-WORLD_HALF_SIZE, WORLD_HALF_SIZE));
+        float size = (i % 100) == 0 ? randFloatInRange(20.0f, 100.0f) : randFloatInRange(0.1f, 4.0f);
+        item->bound = AABox(position, size);
+        transaction.resetItem(scene->allocateID(), std::make_shared<TestPayload>(item));
+    }
+    scene->enqueueTransaction(std::move(transaction));
+    scene->enqueueFrame();
+    scene->processTransactionQueue();
+    return scene;
+}
+
+static ViewFrustum createView(int view, int numViews) {
+    ViewFrustum frustum;
+    frustum.setProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f));
+    frustum.setPosition(glm::vec3(0.0f, 2.0f, 0.0f));
+    frustum.setOrientation(glm::angleAxis(TWO_PI * (float)view / (float)numViews, glm::vec3(0.0f, 1.0f, 0.0f)));
+    frustum.calculate();
+    return frustum;
+}
+
+static bool cullSmallItems(const RenderArgs* args, const AABox& bound) {
+    float distance = args->getViewFrustum().distanceToCamera(bound.calcCenter());
+    return bound.getLargestDimension() > MIN_ANGULAR_SIZE * distance;
+}
+
+// the traversal, culling and comparison sort the render task did on the render thread alone
+static void fetchCullSortSerially(const RenderContextPointer& renderContext, ItemBounds& outItems) {
+    auto& scene = renderContext->_scene;
+    RenderArgs* args = renderContext->args;
+    const ViewFrustum& frustum = args->getViewFrustum();
+    auto& tree = scene->getSpatialTree();
+    float angle = glm::degrees(getAccuracyAngle(args->_sizeScale, args->_boundaryLevelAdjust));
+
+    ItemSpatialTree::ItemSelection selection;
+    tree.selectCells(selection.cellSelection, frustum, angle);
+    for (bool inside : { true, false }) {
+        for (auto brickId : selection.cellSelection.bricks(inside)) {
+            auto& brick = tree.getConcreteBrick(brickId);
+            selection.items(inside).insert(selection.items(inside).end(), brick.items.begin(), brick.items.end());
+            selection.subcellItems(inside).insert(selection.subcellItems(inside).end(), brick.subcellItems.begin(),
+                brick.subcellItems.end());
+        }
+    }
+
+    ItemBounds culledItems;
+    auto cull = [&](const ItemIDs& ids, bool testFrustum, bool testSolidAngle) {
+        for (auto id : ids) {
+            ItemBound itemBound(id, scene->getItem(id).getBound());
+            if ((!testFrustum || frustum.boxIntersectsFrustum(itemBound.bound)) &&
+                (!testSolidAngle || cullSmallItems(args, itemBound.bound))) {
+                culledItems.push_back(itemBound);
+            }
+        }
+    };
+    cull(selection.insideItems, false, false);
+    cull(selection.insideSubcellItems, false, true);
+    cull(selection.partialItems, true, false);
+    cull(selection.partialSubcellItems, true, true);
+
+    std::vector<std::pair<float, size_t>> depths;
+    for (size_t i = 0; i < culledItems.size(); ++i) {
+        depths.emplace_back(frustum.distanceToCamera(culledItems[i].bound.calcCenter()), i);
+    }
+    std::sort(depths.begin(), depths.end(), [](const std::pair<float, size_t>& left, const std::pair<float, size_t>& right) {
+        return left.first < right.first;
+    });
+    outItems.clear();
+    for (const auto& depth : depths) {
+        outItems.push_back(culledItems[depth.second]);
+    }
+}
+
+// the jobs of the render task
+static void fetchCullSort(const RenderContextPointer& renderContext, FetchSpatialTree& fetch, CullSpatialSelection& cull,
+        DepthSortItems& sort, ItemBounds& outItems) {
+    ItemSpatialTree::ItemSelection selection;
+    ItemBounds culledItems;
+    fetch.run(renderContext, selection);
+    cull.run(renderContext, selection, culledItems);
+    sort.run(renderContext, culledItems, outItems);
+}
+
+static void report(const char* name, qint64 elapsed, int numViews, size_t numCulled) {
+    float msecs = (float)elapsed / (float)NSECS_PER_MSEC;
+    qDebug() << name << msecs / (float)numViews << "ms per view," << (float)numCulled / msecs << "culled items per ms,"
+        << numCulled / numViews << "items per view";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    int numItems = intArgument(arguments, 1, DEFAULT_ITEMS);
+    int numViews = intArgument(arguments, 2, DEFAULT_VIEWS);
+
+    qDebug() << "Culling" << numItems << "items from" << numViews << "views, on"
+        << QThreadPool::globalInstance()->maxThreadCount() << "threads";
+
+    gpu::Context::init<gpu::null::Backend>();
+    auto gpuContext = std::make_shared<gpu::Context>();
+
+    RenderArgs args(gpuContext);
+    auto renderContext = std::make_shared<RenderContext>();
+    renderContext->args = &args;
+    renderContext->_scene = createScene(numItems);
+    renderContext->jobConfig = std::make_shared<CullSpatialSelectionConfig>();
+
+    std::vector<ViewFrustum> views;
+    for (int view = 0; view < numViews; ++view) {
+        views.push_back(createView(view, numViews));
+    }
+
+    QElapsedTimer timer;
+    ItemBounds outItems;
+
+    size_t serialCulled = 0;
+    timer.start();
+    for (const auto& view : views) {
+        args.setViewFrustum(view);
+        fetchCullSortSerially(renderContext, outItems);
+        serialCulled += outItems.size();
+    }
+    report("serial, std::sort:", timer.nsecsElapsed(), numViews, serialCulled);
+
+    auto filter = ItemFilter::Builder::opaqueShape().withoutLayered();
+    FetchSpatialTree fetch(filter);
+    CullSpatialSelection cull(cullSmallItems, RenderDetails::ITEM, filter);
+    DepthSortItems sort;
+
+    size_t jobsCulled = 0;
+    timer.start();
+    for (const auto& view : views) {
+        args.setViewFrustum(view);
+        fetchCullSort(renderContext, fetch, cull, sort, outItems);
+        jobsCulled += outItems.size();
+    }
+    report("thread pool, radix sort:", timer.nsecsElapsed(), numViews, jobsCulled);
+
+    if (jobsCulled != serialCulled) {
+        qWarning() << "the jobs culled" << jobsCulled << "items, the serial loop" << serialCulled;
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+//
+//  main.cpp
+//  tests/render-transaction-perf/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Has many threads enqueue transactions on a render::Scene while the main thread turns them into frames and processes
+// them, without a GL context, to time the handoff from the entity, avatar and overlay threads to the render thread.
+// Usage: render-transaction-perf-test [producers] [transactions per producer] [updates per transaction]
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+
+#include <NumericalConstants.h>
+
+#include <render/Scene.h>
+
+using namespace render;
+
+static const int DEFAULT_PRODUCERS = 8;
+static const int DEFAULT_TRANSACTIONS = 20000;
+static const int DEFAULT_UPDATES = 16;
+
+struct TestItem {
+    glm::vec3 position;
+    int numUpdates { 0 };
+};
+using TestPayload = Payload<TestItem>;
+
+namespace render {
+    template <> const ItemKey payloadGetKey(const std::shared_ptr<TestItem>&) {
+        return ItemKey::Builder::opaqueShape().build();
+    }
+    template <> const Item::Bound payloadGetBound(const std::shared_ptr<TestItem>& payloadData) {
+        return Item::Bound(payloadData->position, 1.0f);
+    }
+}
+
+static int intArgument(const QStringList& arguments, int index, int defaultValue) {
+    bool ok = false;
+    int value = index < arguments.size() ? arguments[index].toInt(&ok) : 0;
+    return ok && value > 0 ? value : defaultValue;
+}
+
+static glm::vec3 itemPosition(int producer, int update) {
+    return glm::vec3((float)producer, (float)update, (float)(update % 7));
+}
+
+// every producer resets its own items, then moves them around one transaction at a time
+static void produce(const ScenePointer& scene, int producer, int numTransactions, int numUpdates,
+        std::atomic<int>& numUpdatesApplied) {
+    std::vector<ItemID> itemIDs;
+    Transaction resets;
+    for (int i = 0; i < numUpdates; ++i) {
+        auto item = std::make_shared<TestItem>();
+        item->position = itemPosition(producer, i);
+        itemIDs.push_back(scene->allocateID());
+        resets.resetItem(itemIDs.back(), std::make_shared<TestPayload>(item));
+    }
+    scene->enqueueTransaction(std::move(resets));
+
+    for (int i = 0; i < numTransactions; ++i) {
+        Transaction transaction;
+        for (int j = 0; j < numUpdates; ++j) {
+            glm::vec3 position = itemPosition(producer, i + j);
+            transaction.updateItem<TestItem>(itemIDs[j], [position, &numUpdatesApplied](TestItem& item) {
+                item.position = position;
+                item.numUpdates++;
+                numUpdatesApplied++;
+            });
+        }
+        scene->enqueueTransaction(std::move(transaction));
+    }
+}
+
+static void report(const char* name, qint64 elapsed, int numTransactions, int numFrames) {
+    qDebug() << name << (float)numTransactions * (float)NSECS_PER_SECOND / (float)elapsed << "transactions per second,"
+        << (float)numTransactions / (float)std::max(numFrames, 1) << "transactions per frame";
+}
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    auto arguments = app.arguments();
+    int numProducers = intArgument(arguments, 1, DEFAULT_PRODUCERS);
+    int numTransactions = intArgument(arguments, 2, DEFAULT_TRANSACTIONS);
+    int numUpdates = intArgument(arguments, 3, DEFAULT_UPDATES);
+    int totalTransactions = numProducers * numTransactions;
+
+    qDebug() << numProducers << "producers enqueuing" << numTransactions << "transactions of" << numUpdates << "updates";
+
+    // a mutex and a queue of transactions merged into one copy per frame, the way the Scene used to take them
+    {
+        std::mutex queueMutex;
+        std::queue<Transaction> queue;
+        std::atomic<int> numDone { 0 };
+        int numFrames = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < numProducers; ++producer) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < numTransactions; ++i) {
+                    Transaction transaction;
+                    for (int j = 0; j < numUpdates; ++j) {
+                        transaction.updateItem(ItemID(j + 1));
+                    }
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    queue.push(transaction);
+                }
+                numDone++;
+            });
+        }
+        bool done = false;
+        while (!done) {
+            done = numDone == numProducers;
+            Transaction merged;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                while (!queue.empty()) {
+                    merged.merge(queue.front());
+                    queue.pop();
+                }
+            }
+            numFrames++;
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        report("mutex queue, merged but not applied:", timer.nsecsElapsed(), totalTransactions, numFrames);
+    }
+
+    // the Scene, with the stats the render task reports
+    {
+        auto scene = std::make_shared<Scene>(glm::vec3(-16384.0f), 32768.0f);
+        std::atomic<int> numDone { 0 };
+        std::atomic<int> numUpdatesApplied { 0 };
+        int numFrames = 0;
+        int numProcessed = 0;
+        uint32_t maxTransactionsPerFrame = 0;
+        uint32_t maxUpdatesPerFrame = 0;
+        qint64 processTime = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < numProducers; ++producer) {
+            producers.emplace_back([&, producer] {
+                produce(scene, producer, numTransactions, numUpdates, numUpdatesApplied);
+                numDone++;
+            });
+        }
+        bool done = false;
+        while (!done) {
+            done = numDone == numProducers;
+            QElapsedTimer processTimer;
+            processTimer.start();
+            scene->enqueueFrame();
+            scene->processTransactionQueue();
+            processTime += processTimer.nsecsElapsed();
+
+            const auto& stats = scene->getTransactionStats();
+            numProcessed += stats.numTransactions;
+            maxTransactionsPerFrame = std::max(maxTransactionsPerFrame, stats.numTransactions);
+            maxUpdatesPerFrame = std::max(maxUpdatesPerFrame, stats.numUpdatedItems);
+            numFrames++;
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        report("scene:", timer.nsecsElapsed(), totalTransactions, numFrames);
+        qDebug() << "  " << (float)processTime / (float)(numFrames * NSECS_PER_MSEC) << "ms per frame processing,"
+            << "at most" << maxTransactionsPerFrame << "transactions and" << maxUpdatesPerFrame << "updates in a frame";
+        qDebug() << "  " << scene->getNumItems() << "items," << BlockPool::getInstance().getCapacity()
+            << "pooled functor blocks," << BlockPool::getInstance().getNumHeapAllocations() << "allocated on the heap";
+
+        // the resets are one more transaction per producer
+        if (numProcessed != totalTransactions + numProducers || numUpdatesApplied != totalTransactions * numUpdates) {
+            qWarning() << "  processed" << numProcessed << "transactions and" << numUpdatesApplied << "updates, expected"
+                << totalTransactions + numProducers << "and" << totalTransactions * numUpdates;
+        }
+    }
+
+    return 0;
+}
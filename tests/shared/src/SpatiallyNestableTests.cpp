@@ -0,0 +1,157 @@
+//
+//  SpatiallyNestableTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SpatiallyNestableTests.h"
+
+#include <DependencyManager.h>
+#include <NumericalConstants.h>
+#include <SpatialParentFinder.h>
+#include <SpatiallyNestable.h>
+
+#include <../GLMTestUtils.h>
+#include <../QTestExtensions.h>
+
+QTEST_MAIN(SpatiallyNestableTests)
+
+const float EPSILON = 0.001f;
+
+static QHash<QUuid, SpatiallyNestableWeakPointer> nestables;
+
+class TestParentFinder : public SpatialParentFinder {
+public:
+    SpatiallyNestableWeakPointer find(QUuid parentID, bool& success, SpatialParentTree* entityTree = nullptr) const override {
+        success = nestables.contains(parentID);
+        return nestables.value(parentID);
+    }
+};
+
+static SpatiallyNestablePointer createNestable(const glm::vec3& localPosition, const SpatiallyNestablePointer& parent = nullptr) {
+    auto nestable = std::make_shared<SpatiallyNestable>(NestableType::Entity, QUuid::createUuid());
+    nestables[nestable->getID()] = nestable;
+    if (parent) {
+        nestable->setParentID(parent->getID());
+    }
+    nestable->setLocalPosition(localPosition);
+    return nestable;
+}
+
+static glm::vec3 cachedPosition(const SpatiallyNestablePointer& nestable, bool& cached) {
+    Transform transform;
+    cached = nestable->getCachedTransform(transform);
+    return transform.getTranslation();
+}
+
+void SpatiallyNestableTests::initTestCase() {
+    DependencyManager::set<SpatialParentFinder, TestParentFinder>();
+}
+
+void SpatiallyNestableTests::cachedTransformFollowsParent() {
+    auto parent = createNestable(glm::vec3(1.0f, 0.0f, 0.0f));
+    auto child = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), parent);
+    bool cached;
+
+    // nothing is cached until someone asks
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(1.0f, 1.0f, 0.0f), EPSILON);
+    QCOMPARE_WITH_ABS_ERROR(cachedPosition(child, cached), glm::vec3(1.0f, 1.0f, 0.0f), EPSILON);
+    QCOMPARE(cached, true);
+
+    // moving the parent makes the child's cache stale
+    parent->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(2.0f, 1.0f, 0.0f), EPSILON);
+
+    parent->setOrientation(glm::angleAxis(PI / 2.0f, glm::vec3(0.0f, 0.0f, 1.0f)));
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(1.0f, 0.0f, 0.0f), EPSILON);
+}
+
+void SpatiallyNestableTests::scaleInvalidatesChildren() {
+    auto parent = createNestable(glm::vec3(0.0f));
+    auto child = createNestable(glm::vec3(1.0f, 0.0f, 0.0f), parent);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(1.0f, 0.0f, 0.0f), EPSILON);
+
+    parent->setLocalSNScale(glm::vec3(2.0f));
+    bool cached;
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(2.0f, 0.0f, 0.0f), EPSILON);
+}
+
+void SpatiallyNestableTests::reparentInvalidatesCache() {
+    auto first = createNestable(glm::vec3(1.0f, 0.0f, 0.0f));
+    auto second = createNestable(glm::vec3(0.0f, 0.0f, 5.0f));
+    auto child = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), first);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(1.0f, 1.0f, 0.0f), EPSILON);
+
+    child->setParentID(second->getID());
+    bool cached;
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(0.0f, 1.0f, 5.0f), EPSILON);
+}
+
+void SpatiallyNestableTests::jointChildrenAreNotCached() {
+    auto parent = createNestable(glm::vec3(1.0f, 0.0f, 0.0f));
+    auto child = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), parent);
+    child->setParentJointIndex(0);
+
+    QCOMPARE_WITH_ABS_ERROR(child->getPosition(), glm::vec3(1.0f, 1.0f, 0.0f), EPSILON);
+    bool cached;
+    cachedPosition(child, cached);
+    QCOMPARE(cached, false);
+
+    // nor is anything relative to them
+    auto grandchild = createNestable(glm::vec3(0.0f, 0.0f, 1.0f), child);
+    QCOMPARE_WITH_ABS_ERROR(grandchild->getPosition(), glm::vec3(1.0f, 1.0f, 1.0f), EPSILON);
+    cachedPosition(grandchild, cached);
+    QCOMPARE(cached, false);
+}
+
+void SpatiallyNestableTests::updateWorldTransforms() {
+    const int NUM_ROOTS = 100;
+    const int CHAIN_LENGTH = 5;
+
+    // chains of children, listed from the bottom up so the pass has to sort them
+    std::vector<SpatiallyNestablePointer> chainNestables;
+    std::vector<SpatiallyNestablePointer> roots;
+    for (int i = 0; i < NUM_ROOTS; ++i) {
+        auto nestable = createNestable(glm::vec3((float)i, 0.0f, 0.0f));
+        roots.push_back(nestable);
+        chainNestables.push_back(nestable);
+        for (int j = 1; j < CHAIN_LENGTH; ++j) {
+            nestable = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), nestable);
+            chainNestables.push_back(nestable);
+        }
+    }
+    std::reverse(chainNestables.begin(), chainNestables.end());
+
+    SpatiallyNestable::updateWorldTransforms(chainNestables);
+    for (int i = 0; i < (int)chainNestables.size(); ++i) {
+        bool cached;
+        glm::vec3 position = cachedPosition(chainNestables[i], cached);
+        QCOMPARE(cached, true);
+        int root = NUM_ROOTS - 1 - i / CHAIN_LENGTH;
+        int depth = CHAIN_LENGTH - 1 - i % CHAIN_LENGTH;
+        QCOMPARE_WITH_ABS_ERROR(position, glm::vec3((float)root, (float)depth, 0.0f), EPSILON);
+    }
+
+    // moving a root only makes its own chain stale
+    roots[0]->setPosition(glm::vec3(0.0f, 0.0f, 1.0f));
+    bool cached;
+    cachedPosition(chainNestables.back(), cached);
+    QCOMPARE(cached, false);
+    cachedPosition(chainNestables.front(), cached);
+    QCOMPARE(cached, true);
+}
@@ -0,0 +1,199 @@
+//
+//  TriangleSetTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TriangleSetTests.h"
+
+#include <GLMHelpers.h>
+#include <NumericalConstants.h>
+#include <TriangleSet.h>
+
+#include <../GLMTestUtils.h>
+#include <../QTestExtensions.h>
+
+QTEST_MAIN(TriangleSetTests)
+
+// a bumpy heightfield in the xz plane, facing +y, with 2 * resolution * resolution triangles
+static void buildHeightfield(TriangleSet& set, std::vector<Triangle>& triangles, int resolution, float size) {
+    auto vertex = [&](int x, int z) {
+        float u = (float)x / (float)resolution;
+        float v = (float)z / (float)resolution;
+        float height = 0.1f * size * sinf(u * 12.0f) * cosf(v * 9.0f);
+        return glm::vec3(u * size, height, v * size);
+    };
+    triangles.reserve(2 * resolution * resolution);
+    for (int z = 0; z < resolution; z++) {
+        for (int x = 0; x < resolution; x++) {
+            glm::vec3 v00 = vertex(x, z);
+            glm::vec3 v10 = vertex(x + 1, z);
+            glm::vec3 v01 = vertex(x, z + 1);
+            glm::vec3 v11 = vertex(x + 1, z + 1);
+            triangles.push_back({ v00, v01, v10 });
+            triangles.push_back({ v10, v01, v11 });
+        }
+    }
+    set.reserve(triangles.size());
+    for (const auto& triangle : triangles) {
+        set.insert(triangle);
+    }
+}
+
+static std::vector<TriangleSet::Ray> buildDownwardRays(int count, float size) {
+    std::vector<TriangleSet::Ray> rays;
+    rays.reserve(count);
+    int side = (int)ceilf(sqrtf((float)count));
+    for (int i = 0; i < count; i++) {
+        float u = ((float)(i % side) + 0.37f) / (float)side;
+        float v = ((float)(i / side) + 0.61f) / (float)side;
+        glm::vec3 origin(u * size, size, v * size);
+        glm::vec3 direction = glm::normalize(glm::vec3(0.05f * (u - 0.5f), -1.0f, 0.05f * (v - 0.5f)));
+        rays.push_back({ origin, direction });
+    }
+    return rays;
+}
+
+void TriangleSetTests::testEmptySet() {
+    TriangleSet set;
+    float distance;
+    BoxFace face;
+    glm::vec3 normal;
+    QCOMPARE(set.findRayIntersection(glm::vec3(0.0f), Vectors::UNIT_X, distance, face, normal, true), false);
+
+    std::vector<TriangleSet::RayHit> hits;
+    QCOMPARE(set.findRayIntersections(buildDownwardRays(3, 1.0f), hits, true), (size_t)0);
+    QCOMPARE(hits.size(), (size_t)3);
+}
+
+void TriangleSetTests::testRayIntersectionMatchesBruteForce() {
+    const float SIZE = 10.0f;
+    TriangleSet set;
+    std::vector<Triangle> triangles;
+    buildHeightfield(set, triangles, 40, SIZE);
+
+    auto rays = buildDownwardRays(500, SIZE);
+    for (const auto& ray : rays) {
+        float expectedDistance = std::numeric_limits<float>::max();
+        bool expectedHit = false;
+        for (const auto& triangle : triangles) {
+            float triangleDistance;
+            if (findRayTriangleIntersection(ray.origin, ray.direction, triangle, triangleDistance) &&
+                    triangleDistance < expectedDistance) {
+                expectedDistance = triangleDistance;
+                expectedHit = true;
+            }
+        }
+
+        float distance;
+        BoxFace face;
+        glm::vec3 normal;
+        bool hit = set.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true);
+        QCOMPARE(hit, expectedHit);
+        if (hit) {
+            QCOMPARE_WITH_ABS_ERROR(distance, expectedDistance, EPSILON);
+            QVERIFY(normal.y > 0.0f);
+        }
+    }
+
+    // pointing away from the surface never hits
+    float distance;
+    BoxFace face;
+    glm::vec3 normal;
+    QCOMPARE(set.findRayIntersection(glm::vec3(5.0f, SIZE, 5.0f), Vectors::UNIT_Y, distance, face, normal, true), false);
+}
+
+void TriangleSetTests::testBatchedRayIntersection() {
+    const float SIZE = 10.0f;
+    TriangleSet set;
+    std::vector<Triangle> triangles;
+    buildHeightfield(set, triangles, 64, SIZE);
+
+    // an odd count exercises the partial packet at the end
+    auto rays = buildDownwardRays(1001, SIZE);
+    rays.push_back({ glm::vec3(5.0f, SIZE, 5.0f), Vectors::UNIT_Y });
+
+    std::vector<TriangleSet::RayHit> hits;
+    size_t numHits = set.findRayIntersections(rays, hits, true);
+    QCOMPARE(hits.size(), rays.size());
+
+    size_t expectedHits = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        float distance;
+        BoxFace face;
+        glm::vec3 normal;
+        bool hit = set.findRayIntersection(rays[i].origin, rays[i].direction, distance, face, normal, true);
+        QCOMPARE(hits[i].intersects, hit);
+        if (hit) {
+            expectedHits++;
+            QCOMPARE_WITH_ABS_ERROR(hits[i].distance, distance, EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(hits[i].surfaceNormal, normal, EPSILON);
+            QCOMPARE(hits[i].face, face);
+        }
+    }
+    QCOMPARE(numHits, expectedHits);
+    QCOMPARE(hits.back().intersects, false);
+}
+
+void TriangleSetTests::testConvexHullContains() {
+    // a unit cube with outward facing triangles
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++) {
+        corners[i] = glm::vec3((i & 1) ? 1.0f : 0.0f, (i & 2) ? 1.0f : 0.0f, (i & 4) ? 1.0f : 0.0f);
+    }
+    const int faces[6][4] = {
+        { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 }
+    };
+    TriangleSet set;
+    for (const auto& face : faces) {
+        set.insert({ corners[face[0]], corners[face[1]], corners[face[2]] });
+        set.insert({ corners[face[0]], corners[face[2]], corners[face[3]] });
+    }
+    set.balanceTree();
+
+    QCOMPARE(set.convexHullContains(glm::vec3(0.5f)), true);
+    QCOMPARE(set.convexHullContains(glm::vec3(1.5f, 0.5f, 0.5f)), false);
+}
+
+void TriangleSetTests::benchmarkRayIntersection() {
+    const float SIZE = 100.0f;
+    const int RESOLUTION = 708; // ~1M triangles
+    const int NUM_RAYS = 200000;
+
+    TriangleSet set;
+    std::vector<Triangle> triangles;
+    buildHeightfield(set, triangles, RESOLUTION, SIZE);
+    std::vector<Triangle>().swap(triangles);
+
+    QElapsedTimer timer;
+    timer.start();
+    set.balanceTree();
+    qDebug() << "built BVH over" << set.size() << "triangles in" << timer.elapsed() << "ms";
+
+    auto rays = buildDownwardRays(NUM_RAYS, SIZE);
+
+    int singleHits = 0;
+    timer.restart();
+    for (const auto& ray : rays) {
+        float distance;
+        BoxFace face;
+        glm::vec3 normal;
+        if (set.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true)) {
+            singleHits++;
+        }
+    }
+    qint64 singleNsecs = std::max(timer.nsecsElapsed(), (qint64)1);
+    qDebug() << "single rays:" << (double)NUM_RAYS * 1.0e9 / (double)singleNsecs << "rays/sec";
+
+    std::vector<TriangleSet::RayHit> hits;
+    timer.restart();
+    size_t batchHits = set.findRayIntersections(rays, hits, true);
+    qint64 batchNsecs = std::max(timer.nsecsElapsed(), (qint64)1);
+    qDebug() << "batched rays:" << (double)NUM_RAYS * 1.0e9 / (double)batchNsecs << "rays/sec";
+
+    QCOMPARE(batchHits, (size_t)singleHits);
+}